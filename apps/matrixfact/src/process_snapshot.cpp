@@ -5,6 +5,7 @@
 #include <fstream>
 #include <map>
 #include <petuum_ps_common/storage/dense_row.hpp>
+#include <petuum_ps/server/server_table_snapshot.hpp>
 #include <petuum_ps_common/util/high_resolution_timer.hpp>
 
 #include <gflags/gflags.h>
@@ -24,9 +25,6 @@ namespace petuum {
 const int32_t kServerThreadIDStartOffset = 1;
 const int32_t kMaxNumThreadsPerClient = 1000;
 
-const int32_t kEndOfFile = -1;
-const size_t kDiskBuffSize = 64*k1_Mi;
-
 class SnapshotProcessor : boost::noncopyable {
 public:
   SnapshotProcessor(int32_t num_clients,
@@ -43,45 +41,39 @@ public:
 
   void LoadSnapshot(const std::string &snapshot_dir,
                     int32_t table_id, int32_t clock) {
-    uint8_t *disk_buff = new uint8_t[kDiskBuffSize];
-    size_t disk_buff_offset = 0;
-
     for (int i = 0; i < num_clients_; ++i) {
       for (int j = 0; j < num_comm_channels_per_client_; ++j) {
         int32_t server_id = kMaxNumThreadsPerClient*i
                             + kServerThreadIDStartOffset + j;
-        std::string snapshot_filename;
-        MakeSnapShotFileName(snapshot_dir, server_id, table_id, clock,
-                             &snapshot_filename);
-
-        std::ifstream snapshot_file;
-        snapshot_file.open(snapshot_filename, std::ifstream::binary);
-        CHECK(snapshot_file.good()) << snapshot_filename;
-
-        while (!snapshot_file.eof()) {
-          snapshot_file.read(reinterpret_cast<char*>(disk_buff), kDiskBuffSize);
-          disk_buff_offset = 0;
-          if (snapshot_file.eof()) break;
-
-          while (disk_buff_offset + sizeof(int32_t) <= kDiskBuffSize) {
-            int32_t row_id
-                = *(reinterpret_cast<int32_t*>(disk_buff + disk_buff_offset));
-            LOG(INFO) << "id = " << row_id;
-
-            if (row_id == kEndOfFile) break;
-            disk_buff_offset += sizeof(int32_t);
-            size_t row_size
-                = *(reinterpret_cast<size_t*>(disk_buff + disk_buff_offset));
-            disk_buff_offset += sizeof(size_t);
+        // Follow delta snapshots back to the full one; newer row images
+        // win.
+        int32_t snapshot_clock = clock;
+        while (true) {
+          std::string snapshot_filename;
+          MakeSnapShotFileName(snapshot_dir, server_id, table_id,
+                               snapshot_clock, &snapshot_filename);
+
+          SnapShotReader reader;
+          reader.Open(snapshot_filename);
+
+          int32_t row_id;
+          size_t row_size;
+          const void *row_data;
+          while ((row_data = reader.Next(&row_id, &row_size)) != 0) {
+            if (table_.count(row_id) > 0)
+              continue;
             DenseRow<float> *row = new DenseRow<float>();
-            row->Deserialize(disk_buff + disk_buff_offset, row_size);
-            disk_buff_offset += row_size;
+            row->Deserialize(row_data, row_size);
             table_.insert(std::make_pair(row_id, row));
           }
+
+          const SnapShotHeader &header = reader.get_header();
+          if (header.kind == kSnapShotFull)
+            break;
+          snapshot_clock = header.prev_clock;
         }
       }
     }
-    delete[] disk_buff;
   }
 
   void PrintTable() {
@@ -19,6 +19,11 @@ public:
   virtual void SingleDataSGD(const petuum::ml::AbstractFeature<float>& feature,
       int32_t label, float learning_rate) = 0;
 
+  // Compute the gradient of a minibatch (labels[i] is the label of the i-th
+  // row) at the current weights and apply it, in one step.
+  virtual void MinibatchSGD(const petuum::ml::FeatureMatrix<float>& minibatch,
+      const std::vector<int32_t>& labels, float learning_rate) = 0;
+
   // Predict the probability of each label.
   virtual void Predict(const petuum::ml::AbstractFeature<float>& feature,
       std::vector<float> *result) const = 0;
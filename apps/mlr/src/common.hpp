@@ -20,6 +20,7 @@ DECLARE_string(weight_file);
 DECLARE_int32(num_epochs);
 DECLARE_int32(num_batches_per_epoch);
 DECLARE_double(learning_rate);
+DECLARE_int32(minibatch_size);
 DECLARE_double(decay_rate);
 DECLARE_int32(num_epochs_per_eval);
 DECLARE_bool(sparse_weight);
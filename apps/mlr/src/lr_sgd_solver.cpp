@@ -57,6 +57,36 @@ void LRSGDSolver::SingleDataSGD(const petuum::ml::AbstractFeature<float>& featur
       &w_cache_);
 }
 
+void LRSGDSolver::MinibatchSGD(
+    const petuum::ml::FeatureMatrix<float>& minibatch,
+    const std::vector<int32_t>& labels, float learning_rate) {
+  int32_t num_rows = minibatch.GetNumRows();
+  CHECK_EQ(num_rows, labels.size());
+  std::vector<float>& w_cache_vec = w_cache_.GetVector();
+  std::vector<float>& w_delta_vec = w_delta_.GetVector();
+  minibatch_coeffs_.resize(num_rows);
+  petuum::ml::FeatureMatrixDotProduct(minibatch, w_cache_vec.data(),
+                                      minibatch_coeffs_.data());
+  for (int i = 0; i < num_rows; ++i) {
+    // Same as predict_buff_[1] - label in SingleDataSGD().
+    minibatch_coeffs_[i] = 1 - petuum::ml::Sigmoid(minibatch_coeffs_[i])
+      - labels[i];
+  }
+
+  // Weight decay is applied once per data, all at w_cache_ before the
+  // minibatch, and to w_delta_ first as in SingleDataSGD().
+  if (lambda_ > 0) {
+    petuum::ml::FeatureScaleAndAdd(-learning_rate * lambda_ * num_rows,
+        w_cache_, &w_delta_);
+    petuum::ml::FeatureScaleAndAdd(-learning_rate * lambda_ * num_rows,
+        w_cache_, &w_cache_);
+  }
+  petuum::ml::FeatureMatrixScaleAndAdd(-learning_rate, minibatch,
+      minibatch_coeffs_.data(), w_delta_vec.data());
+  petuum::ml::FeatureMatrixScaleAndAdd(-learning_rate, minibatch,
+      minibatch_coeffs_.data(), w_cache_vec.data());
+}
+
 void LRSGDSolver::Predict(
     const petuum::ml::AbstractFeature<float>& feature,
     std::vector<float> *result) const {
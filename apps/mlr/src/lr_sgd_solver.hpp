@@ -32,6 +32,9 @@ public:
   void SingleDataSGD(const petuum::ml::AbstractFeature<float>& feature,
       int32_t label, float learning_rate);
 
+  void MinibatchSGD(const petuum::ml::FeatureMatrix<float>& minibatch,
+      const std::vector<int32_t>& labels, float learning_rate);
+
   // Predict the probability of each label.
   void Predict(const petuum::ml::AbstractFeature<float>& feature,
       std::vector<float> *result) const;
@@ -67,6 +70,8 @@ private:
   int32_t w_table_num_cols_;  // # of cols in w_table.
   float lambda_;   // l2 regularization parameter
   std::vector<float> predict_buff_;
+  // Gradient coefficient of each row of a minibatch.
+  std::vector<float> minibatch_coeffs_;
 
   // Specialization Functions
   std::function<float(const petuum::ml::AbstractFeature<float>&,
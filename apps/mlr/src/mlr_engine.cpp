@@ -34,6 +34,8 @@ void SaveWeights(AbstractMLRSGDSolver* mlr_solver) {
 }  // anonymous namespace
 
 MLREngine::MLREngine() : thread_counter_(0) {
+  CHECK(!(FLAGS_sparse_weight && FLAGS_minibatch_size > 1))
+    << "--sparse_weight does not support --minibatch_size > 1";
   perform_test_ = FLAGS_perform_test;
   num_train_eval_ = FLAGS_num_train_eval;
   process_barrier_.reset(new boost::barrier(FLAGS_num_table_threads));
@@ -162,6 +164,7 @@ void MLREngine::Start() {
   int num_secs_per_checkpoint = FLAGS_num_secs_per_checkpoint;
   int loss_table_staleness = FLAGS_table_staleness;
   float learning_rate = FLAGS_learning_rate;
+  int minibatch_size = FLAGS_minibatch_size;
   int num_epochs_per_eval = FLAGS_num_epochs_per_eval;
   bool global_data = FLAGS_global_data;
   int num_test_eval = FLAGS_num_test_eval;
@@ -250,6 +253,9 @@ void MLREngine::Start() {
   // It's reset after every check-pointing (saving to disk).
   petuum::HighResolutionTimer checkpoint_timer;
 
+  petuum::ml::FeatureMatrix<float> minibatch(feature_dim_);
+  std::vector<int32_t> minibatch_labels;
+
   float decay_rate = FLAGS_decay_rate;
   int32_t eval_counter = 0;
   int32_t batch_counter = 0;
@@ -268,9 +274,21 @@ void MLREngine::Start() {
           train_labels_[data_idx], curr_learning_rate);
           */
 
-      mlr_solver->SingleDataSGD(
-        *train_features_[data_idx],
-        train_labels_[data_idx], curr_learning_rate);
+      if (minibatch_size > 1) {
+        minibatch.AddRow(*train_features_[data_idx]);
+        minibatch_labels.push_back(train_labels_[data_idx]);
+        if (minibatch.GetNumRows() == minibatch_size
+            || workload_mgr.IsEndOfBatch()) {
+          mlr_solver->MinibatchSGD(minibatch, minibatch_labels,
+                                   curr_learning_rate);
+          minibatch.Clear();
+          minibatch_labels.clear();
+        }
+      } else {
+        mlr_solver->SingleDataSGD(
+          *train_features_[data_idx],
+          train_labels_[data_idx], curr_learning_rate);
+      }
 
       if (workload_mgr.IsEndOfBatch()) {
         STATS_APP_ACCUM_COMP_END();
@@ -479,6 +497,7 @@ std::string MLREngine::GetExperimentInfo() const {
     << "num_epochs: " << FLAGS_num_epochs << std::endl
     << "num_batches_per_epoch: " << FLAGS_num_batches_per_epoch << std::endl
     << "learning_rate: " << FLAGS_learning_rate << std::endl
+    << "minibatch_size: " << FLAGS_minibatch_size << std::endl
     << "decay_rate: " << FLAGS_decay_rate << std::endl
     << "num_epochs_per_eval: " << FLAGS_num_epochs_per_eval << std::endl
     << "use_weight_file: " << FLAGS_use_weight_file << std::endl
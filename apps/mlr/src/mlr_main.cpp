@@ -41,6 +41,8 @@ DEFINE_int32(num_epochs, 1, "Number of data sweeps.");
 DEFINE_int32(num_batches_per_epoch, 10, "Since we Clock() at the end of each batch, "
     "num_batches_per_epoch is effectively the number of clocks per epoch (iteration)");
 DEFINE_double(learning_rate, 0.1, "Initial step size");
+DEFINE_int32(minibatch_size, 1, "Number of data per SGD step. Minibatches "
+    "end at the end of each batch.");
 DEFINE_double(decay_rate, 1, "multiplicative decay");
 DEFINE_int32(num_epochs_per_eval, 10, "Number of batches per evaluation");
 DEFINE_bool(sparse_weight, false, "Use sparse feature for model parameters");
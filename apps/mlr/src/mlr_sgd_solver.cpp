@@ -19,7 +19,7 @@ namespace mlr {
 MLRSGDSolver::MLRSGDSolver(const MLRSGDSolverConfig& config) :
   w_table_(config.w_table), feature_dim_(config.feature_dim),
   num_labels_(config.num_labels), w_dim_(feature_dim_ * num_labels_),
-  predict_buff_(config.feature_dim) {
+  predict_buff_(config.feature_dim), sparse_weight_(config.sparse_weight) {
     w_cache_.resize(num_labels_);
     w_delta_.resize(num_labels_);
     for (int i = 0; i < num_labels_; ++i) {
@@ -191,6 +191,33 @@ void MLRSGDSolver::SingleDataSGD(
    }
 }
 
+void MLRSGDSolver::MinibatchSGD(
+    const petuum::ml::FeatureMatrix<float>& minibatch,
+    const std::vector<int32_t>& labels, float learning_rate) {
+  // MLREngine rejects --sparse_weight with --minibatch_size > 1 at startup.
+  DCHECK(!sparse_weight_) << "MinibatchSGD needs dense weight";
+  std::vector<const float*> w_cache_ptrs(num_labels_);
+  for (int i = 0; i < num_labels_; ++i) {
+    w_cache_ptrs[i] = static_cast<petuum::ml::DenseFeature<float>*>(
+        w_cache_[i])->GetVector().data();
+  }
+  petuum::ml::FeatureMatrixSoftmaxGradient(minibatch, w_cache_ptrs, labels,
+                                           &minibatch_coeffs_);
+
+  // outer product
+  int32_t num_rows = minibatch.GetNumRows();
+  for (int i = 0; i < num_labels_; ++i) {
+    // w_cache_[i] += -\eta * \sum_j coeffs[i][j] * minibatch[j]
+    const float* coeffs_i = minibatch_coeffs_.data() + i * num_rows;
+    petuum::ml::FeatureMatrixScaleAndAdd(-learning_rate, minibatch, coeffs_i,
+        static_cast<petuum::ml::DenseFeature<float>*>(
+            w_cache_[i])->GetVector().data());
+    petuum::ml::FeatureMatrixScaleAndAdd(-learning_rate, minibatch, coeffs_i,
+        static_cast<petuum::ml::DenseFeature<float>*>(
+            w_delta_[i])->GetVector().data());
+  }
+}
+
 void MLRSGDSolver::SaveWeights(const std::string& filename) const {
   std::ofstream w_stream(filename, std::ofstream::out | std::ofstream::trunc);
   CHECK(w_stream);
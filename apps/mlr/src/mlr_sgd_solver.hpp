@@ -33,6 +33,10 @@ public:
   void SingleDataSGD(const petuum::ml::DenseFeature<float>& feature,
                      int32_t label, float step_size);
 
+  // Only supports dense weight.
+  void MinibatchSGD(const petuum::ml::FeatureMatrix<float>& minibatch,
+      const std::vector<int32_t>& labels, float learning_rate);
+
   // Predict the probability of each label.
   void Predict(const petuum::ml::AbstractFeature<float>& feature,
       std::vector<float> *result) const;
@@ -71,6 +75,9 @@ private:
   int32_t num_labels_; // number of classes/labels
   int32_t w_dim_;       // dimension of w_table_ = feature_dim_ * num_labels_.
   std::vector<float> predict_buff_;
+  bool sparse_weight_;
+  // Gradient coefficients of a minibatch, num_labels_ x minibatch size.
+  std::vector<float> minibatch_coeffs_;
 
   // Specialization Functions
   std::function<float(const petuum::ml::AbstractFeature<float>&,
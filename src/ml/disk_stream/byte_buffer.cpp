@@ -30,5 +30,9 @@ char* ByteBuffer::GetNextBytes() {
   return bytes_.data() + curr_offset_;
 }
 
+int32_t ByteBuffer::GetNumRemainingBytes() const {
+  return bytes_.size() - curr_offset_;
+}
+
 }  // namespace ml
 }  // namespace petuum
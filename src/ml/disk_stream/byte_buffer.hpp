@@ -30,6 +30,9 @@ public:
   // Get pointer to the next byte.
   char* GetNextBytes();
 
+  // # of bytes from GetNextBytes() to the buffer end.
+  int32_t GetNumRemainingBytes() const;
+
 private:
   // byte storage.
   std::vector<char> bytes_;
@@ -23,6 +23,7 @@ DiskReader::DiskReader(const DiskReaderConfig& config,
   multi_buffer_(CHECK_NOTNULL(multi_buffer)),
   // DiskReaderConfig parameters
   snappy_compressed_(config.snappy_compressed),
+  chunk_size_(config.chunk_size),
   num_passes_(config.num_passes),
   read_mode_(config.read_mode),
   dir_path_(config.dir_path),
@@ -30,6 +31,8 @@ DiskReader::DiskReader(const DiskReaderConfig& config,
   seq_id_begin_(config.seq_id_begin),
   num_files_(config.num_files),
   file_seq_prefix_(config.file_seq_prefix) {
+    CHECK(chunk_size_ == 0 || !snappy_compressed_)
+      << "Snappy compressed files cannot be read in chunks.";
     GenerateFileList();
   }
 
@@ -40,7 +43,8 @@ void DiskReader::Start() {
   while (buffer_ptr != 0 &&
       (num_passes_ == 0 || pass_counter_ < num_passes_)) {
     // 0 is shutdown signal.
-    std::vector<char> file_bytes = ReadNextFile();
+    std::vector<char> file_bytes = (chunk_size_ > 0) ? ReadNextChunk()
+      : ReadNextFile();
     num_bytes_read += file_bytes.size();
     buffer_ptr->SetBuffer(&file_bytes);
     multi_buffer_->DoneFillingIOBuffer();
@@ -134,12 +138,34 @@ std::vector<char> DiskReader::ReadNextFile() {
     result = std::vector<char>(uncompressed.begin(), uncompressed.end());
   }
 
+  AdvanceFileCounter();
+  return result;
+}
+
+std::vector<char> DiskReader::ReadNextChunk() {
+  if (!chunk_file_.is_open()) {
+    const std::string& filename = files_[file_counter_];
+    chunk_file_.open(filename, std::ios::binary);
+    CHECK(chunk_file_) << "Failed to open " << filename;
+  }
+  std::vector<char> result(chunk_size_);
+  chunk_file_.read(result.data(), chunk_size_);
+  result.resize(chunk_file_.gcount());
+  if (chunk_file_.eof()
+      || chunk_file_.peek() == std::ifstream::traits_type::eof()) {
+    chunk_file_.close();
+    chunk_file_.clear();
+    AdvanceFileCounter();
+  }
+  return result;
+}
+
+void DiskReader::AdvanceFileCounter() {
   ++file_counter_;
   if (file_counter_ % files_.size() == 0) {
     ++pass_counter_;
     file_counter_ = 0;
   }
-  return result;
 }
 
 }  // namespace ml
@@ -5,6 +5,7 @@
 
 #include <string>
 #include <cstdint>
+#include <fstream>
 #include <ml/disk_stream/multi_buffer.hpp>
 
 namespace petuum {
@@ -20,6 +21,12 @@ struct DiskReaderConfig {
   // True if the read data are compressed by Snappy.
   bool snappy_compressed = false;
 
+  // Read each file in chunks of chunk_size bytes instead of as a whole. 0
+  // reads whole files. Chunks split records, so they can only be consumed
+  // by parsers that carry records across buffers (ml/parsers/LibsvmParser).
+  // Not supported with snappy_compressed.
+  int64_t chunk_size = 0;
+
   // Number of passes. 0 for infinite pass.
   int32_t num_passes = 1;
 
@@ -60,6 +67,13 @@ private:    // private functions.
   // Comment (wdai): NRVO in C++ will avoid copying the returned vector.
   std::vector<char> ReadNextFile();
 
+  // Read the next chunk_size_ bytes, moving on to the next file at the end
+  // of the current one.
+  std::vector<char> ReadNextChunk();
+
+  // Move file_counter_ to the next file.
+  void AdvanceFileCounter();
+
 private:    // private members.
   // # of files read so far (wrapped around).
   int32_t file_counter_;
@@ -75,6 +89,7 @@ private:    // private members.
 
   // See DiskReaderConfig.
   bool snappy_compressed_;
+  int64_t chunk_size_;
   int32_t num_passes_;
   ReadMode read_mode_;
   std::string dir_path_;
@@ -82,6 +97,9 @@ private:    // private members.
   int32_t seq_id_begin_;
   int32_t num_files_;
   std::string file_seq_prefix_;
+
+  // File being read in chunks.
+  std::ifstream chunk_file_;
 };
 
 }  // namespace ml
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <glog/logging.h>
+#include <ml/feature/abstract_feature.hpp>
+
+namespace petuum {
+namespace ml {
+
+// FeatureMatrix holds a minibatch of features, one row per data point, in
+// compressed sparse row (CSR) form: the nonzero feature ids and values of
+// all rows in two contiguous arrays, with row i on
+// [GetRowOffsets()[i], GetRowOffsets()[i+1]). Within a row, feature ids are
+// in ascending order. Dense features are stored by their nonzero entries.
+//
+// BuildCSC() adds the compressed sparse column (CSC) form, with the row ids
+// and values of feature j on [GetColOffsets()[j], GetColOffsets()[j+1]), so
+// that a kernel writing to a dense vector of feature_dim can walk it one
+// feature at a time. It is dropped by AddRow() and Clear().
+//
+// Usage pattern:
+//  FeatureMatrix<float> minibatch(feature_dim);
+//  for (...) {
+//    minibatch.AddRow(*features[data_idx]);
+//  }
+//  // ... hand minibatch to the math_util kernels.
+//  minibatch.Clear();
+template<typename V>
+class FeatureMatrix {
+public:
+  FeatureMatrix() : feature_dim_(0), row_offsets_(1, 0), has_csc_(false) { }
+
+  FeatureMatrix(int32_t feature_dim) :
+    feature_dim_(feature_dim), row_offsets_(1, 0), has_csc_(false) { }
+
+  void Init(int32_t feature_dim) {
+    feature_dim_ = feature_dim;
+    Clear();
+  }
+
+  // Removes all rows but keeps the memory.
+  void Clear() {
+    row_offsets_.resize(1);
+    feature_ids_.clear();
+    vals_.clear();
+    has_csc_ = false;
+  }
+
+  void Reserve(int32_t num_rows, int32_t num_entries) {
+    row_offsets_.reserve(num_rows + 1);
+    feature_ids_.reserve(num_entries);
+    vals_.reserve(num_entries);
+  }
+
+  // Appends the nonzero entries of feature as a new row.
+  void AddRow(const AbstractFeature<V>& feature);
+
+  // Builds the CSC form from the CSR form.
+  void BuildCSC();
+
+  int32_t GetFeatureDim() const { return feature_dim_; }
+
+  int32_t GetNumRows() const { return row_offsets_.size() - 1; }
+
+  // Number of nonzero entries across all rows.
+  int32_t GetNumEntries() const { return feature_ids_.size(); }
+
+  // ========================== CSR form ===========================
+  // GetNumRows() + 1 offsets into GetFeatureIds() and GetVals().
+  const int32_t* GetRowOffsets() const { return row_offsets_.data(); }
+
+  const int32_t* GetFeatureIds() const { return feature_ids_.data(); }
+
+  const V* GetVals() const { return vals_.data(); }
+
+  // ========================== CSC form ===========================
+  bool HasCSC() const { return has_csc_; }
+
+  // GetFeatureDim() + 1 offsets into GetColRowIds() and GetColVals().
+  const int32_t* GetColOffsets() const { return col_offsets_.data(); }
+
+  const int32_t* GetColRowIds() const { return col_row_ids_.data(); }
+
+  const V* GetColVals() const { return col_vals_.data(); }
+
+  // print out the matrix in readable format, one row per line.
+  std::string ToString() const;
+
+private:
+  int32_t feature_dim_;
+
+  std::vector<int32_t> row_offsets_;
+  std::vector<int32_t> feature_ids_;
+  std::vector<V> vals_;
+
+  bool has_csc_;
+  std::vector<int32_t> col_offsets_;
+  std::vector<int32_t> col_row_ids_;
+  std::vector<V> col_vals_;
+};
+
+// ================ Implementation =================
+
+template<typename V>
+void FeatureMatrix<V>::AddRow(const AbstractFeature<V>& feature) {
+  CHECK_EQ(feature_dim_, feature.GetFeatureDim());
+  int32_t num_entries = feature.GetNumEntries();
+  for (int i = 0; i < num_entries; ++i) {
+    V val = feature.GetFeatureVal(i);
+    if (val == V(0))
+      continue;
+    feature_ids_.push_back(feature.GetFeatureId(i));
+    vals_.push_back(val);
+  }
+  row_offsets_.push_back(feature_ids_.size());
+  has_csc_ = false;
+}
+
+template<typename V>
+void FeatureMatrix<V>::BuildCSC() {
+  int32_t num_entries = GetNumEntries();
+  col_offsets_.assign(feature_dim_ + 1, 0);
+  for (int i = 0; i < num_entries; ++i) {
+    ++col_offsets_[feature_ids_[i] + 1];
+  }
+  for (int j = 0; j < feature_dim_; ++j) {
+    col_offsets_[j + 1] += col_offsets_[j];
+  }
+
+  // Visiting the rows in order leaves each column sorted on row id.
+  col_row_ids_.resize(num_entries);
+  col_vals_.resize(num_entries);
+  std::vector<int32_t> col_next(col_offsets_.begin(), col_offsets_.end() - 1);
+  for (int i = 0; i < GetNumRows(); ++i) {
+    for (int k = row_offsets_[i]; k < row_offsets_[i + 1]; ++k) {
+      int32_t pos = col_next[feature_ids_[k]]++;
+      col_row_ids_[pos] = i;
+      col_vals_[pos] = vals_[k];
+    }
+  }
+  has_csc_ = true;
+}
+
+template<typename V>
+std::string FeatureMatrix<V>::ToString() const {
+  std::stringstream ss;
+  for (int i = 0; i < GetNumRows(); ++i) {
+    for (int k = row_offsets_[i]; k < row_offsets_[i + 1]; ++k) {
+      ss << feature_ids_[k] << ":" << vals_[k] << " ";
+    }
+    ss << std::endl;
+  }
+  ss << "(num rows: " << GetNumRows() << " feature dim: " << feature_dim_
+     << ")";
+  return ss.str();
+}
+
+}  // namespace ml
+}  // namespace petuum
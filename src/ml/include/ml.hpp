@@ -10,3 +10,4 @@
 #include <ml/feature/dense_feature.hpp>
 #include <ml/feature/dense_decay_feature.hpp>
 #include <ml/feature/abstract_feature.hpp>
+#include <ml/feature/feature_matrix.hpp>
@@ -0,0 +1,257 @@
+#include <ml/parsers/libsvm_parser.hpp>
+#include <glog/logging.h>
+#include <string>
+#include <cstring>
+#include <cmath>
+
+namespace petuum {
+namespace ml {
+
+namespace {
+
+// Powers of ten exactly representable as double.
+const double kPow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const int32_t kMaxExactPow10 = 22;
+
+// Digits beyond this are dropped from the mantissa; they do not change a
+// float.
+const int32_t kMaxMantissaDigits = 19;
+
+inline bool IsDigit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char *SkipBlank(const char *ptr, const char *end) {
+  while (ptr < end && IsBlank(*ptr)) ++ptr;
+  return ptr;
+}
+
+}  // anonymous namespace
+
+LibsvmParser::LibsvmParser(const LibsvmParserConfig &config):
+    feature_dim_(config.feature_dim),
+    feature_one_based_(config.feature_one_based),
+    label_one_based_(config.label_one_based),
+    cursor_(0),
+    buff_end_(0),
+    end_of_stream_(false),
+    carry_complete_(false),
+    num_records_(0) { }
+
+void LibsvmParser::AssignBuffer(const void *buff, size_t buff_size) {
+  CHECK(!end_of_stream_) << "Buffer assigned after the end of stream.";
+  CHECK_EQ(cursor_, buff_end_) << "The previous buffer is not exhausted.";
+  cursor_ = reinterpret_cast<const char*>(buff);
+  buff_end_ = cursor_ + buff_size;
+}
+
+void LibsvmParser::SetEndOfStream() {
+  CHECK_EQ(cursor_, buff_end_) << "The previous buffer is not exhausted.";
+  end_of_stream_ = true;
+}
+
+bool LibsvmParser::NextLine(const char **line_begin, const char **line_end) {
+  while (true) {
+    if (carry_complete_) {
+      carry_.clear();
+      carry_complete_ = false;
+    }
+    if (!carry_.empty()) {
+      if (!end_of_stream_) {
+        const char *newline = reinterpret_cast<const char*>(
+            memchr(cursor_, '\n', buff_end_ - cursor_));
+        if (newline == 0) {
+          carry_.insert(carry_.end(), cursor_, buff_end_);
+          cursor_ = buff_end_;
+          return false;
+        }
+        carry_.insert(carry_.end(), cursor_, newline);
+        cursor_ = newline + 1;
+      }
+      // carry_ is cleared on the next call, after the line is parsed.
+      carry_complete_ = true;
+      *line_begin = carry_.data();
+      *line_end = carry_.data() + carry_.size();
+    } else {
+      if (cursor_ == buff_end_)
+        return false;
+      const char *newline = reinterpret_cast<const char*>(
+          memchr(cursor_, '\n', buff_end_ - cursor_));
+      if (newline == 0) {
+        // Keep the head of the record until the next buffer arrives.
+        carry_.assign(cursor_, buff_end_);
+        cursor_ = buff_end_;
+        continue;
+      }
+      *line_begin = cursor_;
+      *line_end = newline;
+      cursor_ = newline + 1;
+    }
+    if (SkipBlank(*line_begin, *line_end) != *line_end)
+      return true;
+  }
+}
+
+bool LibsvmParser::GetNextRecord(int32_t *label,
+                                 const std::vector<int32_t> **feature_ids,
+                                 const std::vector<float> **feature_vals) {
+  const char *line_begin, *line_end;
+  if (!NextLine(&line_begin, &line_end))
+    return false;
+  ParseLine(line_begin, line_end, label);
+  *feature_ids = &feature_ids_;
+  *feature_vals = &feature_vals_;
+  return true;
+}
+
+bool LibsvmParser::GetNext(int32_t *label, SparseFeature<float> *feature) {
+  const char *line_begin, *line_end;
+  if (!NextLine(&line_begin, &line_end))
+    return false;
+  ParseLine(line_begin, line_end, label);
+  feature->Init(feature_ids_, feature_vals_, feature_dim_);
+  return true;
+}
+
+size_t LibsvmParser::GetNextBlock(size_t max_rows, LibsvmBlock *block) {
+  if (block->row_offsets.empty())
+    block->row_offsets.push_back(0);
+  size_t num_rows = 0;
+  const char *line_begin, *line_end;
+  for (; num_rows < max_rows && NextLine(&line_begin, &line_end);
+       ++num_rows) {
+    int32_t label;
+    ParseLine(line_begin, line_end, &label);
+    block->labels.push_back(label);
+    block->feature_ids.insert(block->feature_ids.end(),
+                              feature_ids_.begin(), feature_ids_.end());
+    block->feature_vals.insert(block->feature_vals.end(),
+                               feature_vals_.begin(), feature_vals_.end());
+    block->row_offsets.push_back(block->feature_ids.size());
+  }
+  return num_rows;
+}
+
+void LibsvmParser::ParseLine(const char *begin, const char *end,
+                             int32_t *label) {
+  feature_ids_.clear();
+  feature_vals_.clear();
+
+  const char *ptr = SkipBlank(begin, end);
+  // Labels may be written as floats ("+1", "-1.0").
+  float label_val;
+  const char *endptr = ParseFloat(ptr, end, &label_val);
+  CHECK(endptr != ptr) << "Bad label in record " << num_records_ << ": "
+                       << std::string(begin, end);
+  *label = static_cast<int32_t>(label_val) - (label_one_based_ ? 1 : 0);
+  ptr = SkipBlank(endptr, end);
+
+  while (ptr < end) {
+    int32_t feature_id;
+    endptr = ParseInt(ptr, end, &feature_id);
+    CHECK(endptr != ptr && endptr < end && *endptr == ':')
+        << "Bad feature id in record " << num_records_ << ": "
+        << std::string(begin, end);
+    ptr = endptr + 1;
+
+    float feature_val;
+    endptr = ParseFloat(ptr, end, &feature_val);
+    CHECK(endptr != ptr) << "Bad feature value in record " << num_records_
+                         << ": " << std::string(begin, end);
+    feature_ids_.push_back(feature_one_based_ ? feature_id - 1 : feature_id);
+    feature_vals_.push_back(feature_val);
+    ptr = SkipBlank(endptr, end);
+  }
+  ++num_records_;
+}
+
+const char *LibsvmParser::ParseInt(const char *begin, const char *end,
+                                   int32_t *val) {
+  const char *ptr = begin;
+  bool negative = false;
+  if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+    negative = (*ptr == '-');
+    ++ptr;
+  }
+  const char *digits_begin = ptr;
+  int64_t result = 0;
+  for (; ptr < end && IsDigit(*ptr); ++ptr) {
+    result = result * 10 + (*ptr - '0');
+    CHECK_LE(result, static_cast<int64_t>(INT32_MAX) + 1)
+        << "Integer overflow: " << std::string(begin, ptr + 1);
+  }
+  if (ptr == digits_begin)
+    return begin;
+  *val = static_cast<int32_t>(negative ? -result : result);
+  return ptr;
+}
+
+const char *LibsvmParser::ParseFloat(const char *begin, const char *end,
+                                     float *val) {
+  const char *ptr = begin;
+  bool negative = false;
+  if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+    negative = (*ptr == '-');
+    ++ptr;
+  }
+
+  uint64_t mantissa = 0;
+  int32_t num_digits = 0;
+  int32_t exponent = 0;
+  bool has_digits = false;
+  for (; ptr < end && IsDigit(*ptr); ++ptr) {
+    has_digits = true;
+    if (num_digits < kMaxMantissaDigits) {
+      mantissa = mantissa * 10 + (*ptr - '0');
+      if (mantissa != 0) ++num_digits;
+    } else {
+      ++exponent;
+    }
+  }
+  if (ptr < end && *ptr == '.') {
+    ++ptr;
+    for (; ptr < end && IsDigit(*ptr); ++ptr) {
+      has_digits = true;
+      if (num_digits < kMaxMantissaDigits) {
+        mantissa = mantissa * 10 + (*ptr - '0');
+        if (mantissa != 0) ++num_digits;
+        --exponent;
+      }
+    }
+  }
+  if (!has_digits)
+    return begin;
+
+  if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+    int32_t exp_val;
+    const char *exp_end = ParseInt(ptr + 1, end, &exp_val);
+    if (exp_end != ptr + 1) {
+      exponent += exp_val;
+      ptr = exp_end;
+    }
+  }
+
+  double result = static_cast<double>(mantissa);
+  if (mantissa != 0 && exponent != 0) {
+    if (exponent > 0 && exponent <= kMaxExactPow10) {
+      result *= kPow10[exponent];
+    } else if (exponent < 0 && exponent >= -kMaxExactPow10) {
+      result /= kPow10[-exponent];
+    } else {
+      result *= std::pow(10., exponent);
+    }
+  }
+  *val = static_cast<float>(negative ? -result : result);
+  return ptr;
+}
+
+}  // namespace ml
+}  // namespace petuum
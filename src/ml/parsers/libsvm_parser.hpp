@@ -1,30 +1,115 @@
 #pragma once
 
+#include <ml/feature/sparse_feature.hpp>
 #include <boost/noncopyable.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 namespace petuum {
 namespace ml {
 
+struct LibsvmParserConfig {
+  // Dimension of the SparseFeature built by GetNext().
+  int32_t feature_dim = 0;
+  bool feature_one_based = false;
+  bool label_one_based = false;
+};
+
+// A block of parsed records in CSR layout: record i has label labels[i] and
+// features [row_offsets[i], row_offsets[i + 1]) of feature_ids and
+// feature_vals.
+struct LibsvmBlock {
+  std::vector<int32_t> labels;
+  std::vector<size_t> row_offsets;
+  std::vector<int32_t> feature_ids;
+  std::vector<float> feature_vals;
+
+  void Clear() {
+    labels.clear();
+    row_offsets.assign(1, 0);
+    feature_ids.clear();
+    feature_vals.clear();
+  }
+
+  size_t GetNumRows() const {
+    return labels.size();
+  }
+};
+
+// Parses LibSVM text ("label id:val id:val ...\n") in place from a sequence
+// of buffers, e.g. the ByteBuffers handed out by MultiBuffer. Records are
+// not copied, except for one that spans two buffers: its head is kept until
+// the next buffer is assigned. Numbers are parsed by hand, without strtod
+// and the C locale.
+//
+// Usage:
+//   while (more buffers) {
+//     parser.AssignBuffer(buff, buff_size);
+//     while (parser.GetNext(&label, &feature)) { ... }
+//   }
+//   parser.SetEndOfStream();
+//   while (parser.GetNext(&label, &feature)) { ... }
 class LibsvmParser : boost::noncopyable {
 public:
-  LibsvmParser():
-      buff_(0) { }
-  ~LibsvmParser() { }
+  explicit LibsvmParser(const LibsvmParserConfig &config);
+
+  // The parser reads buff until the Get* functions return false, after
+  // which buff may be released and the next one assigned. buff is not
+  // modified.
+  void AssignBuffer(const void *buff, size_t buff_size);
 
-  // is_last - is this the last buffer to be processed?
-  void AssignBuffer(void *buff, size_t buff_size) {
+  // No more buffer will be assigned; the bytes after the last newline form
+  // the last record.
+  void SetEndOfStream();
 
+  // Parse the next record. Return false if the assigned buffer is
+  // exhausted. The returned ids and values are valid until the next call.
+  bool GetNextRecord(int32_t *label, const std::vector<int32_t> **feature_ids,
+                     const std::vector<float> **feature_vals);
+
+  bool GetNext(int32_t *label, SparseFeature<float> *feature);
+
+  // Append up to max_rows records to block. Return the number of records
+  // appended, which is less than max_rows only if the assigned buffer is
+  // exhausted.
+  size_t GetNextBlock(size_t max_rows, LibsvmBlock *block);
+
+  size_t get_num_records() const {
+    return num_records_;
   }
 
-  bool GetNext(int32_t *row_id, int32_t *col_id, float *value) { }
+  // Exposed for testing. Parse [begin, end) as a base-10 number and return
+  // the first byte not consumed.
+  static const char *ParseInt(const char *begin, const char *end,
+                              int32_t *val);
+  static const char *ParseFloat(const char *begin, const char *end,
+                                float *val);
+
+private:
+  // Find the next non-empty line. Return false if it is not complete in the
+  // assigned buffer.
+  bool NextLine(const char **line_begin, const char **line_end);
+
+  void ParseLine(const char *begin, const char *end, int32_t *label);
+
+  const int32_t feature_dim_;
+  const bool feature_one_based_;
+  const bool label_one_based_;
+
+  const char *cursor_;
+  const char *buff_end_;
+  bool end_of_stream_;
+
+  // Head of a record that spans the previous buffer and the assigned one.
+  std::vector<char> carry_;
+  bool carry_complete_;
+
+  std::vector<int32_t> feature_ids_;
+  std::vector<float> feature_vals_;
 
- private:
-  void *buff_;
-  size_t buff_size_;
-  size_t offset_;
-  size_t num_rows_;
-  size_t num_cols_;
+  size_t num_records_;
 };
 
-}
-}
+}  // namespace ml
+}  // namespace petuum
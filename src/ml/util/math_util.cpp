@@ -8,6 +8,11 @@
 #include <sstream>
 #include <Eigen/Dense>
 
+#if defined(__x86_64__) || defined(__i386__)
+#define PETUUM_ML_KERNELS_X86
+#include <immintrin.h>
+#endif
+
 namespace petuum {
 namespace ml {
 
@@ -15,6 +20,79 @@ namespace {
 
 const float kCutoff = 1e-15;
 
+// \sum_k vals[k] * dense[ids[k]] for k < num_entries.
+typedef float (*GatherDotProductFunc)(const int32_t* ids, const float* vals,
+    int32_t num_entries, const float* dense);
+
+float GatherDotProductScalar(const int32_t* ids, const float* vals,
+    int32_t num_entries, const float* dense) {
+  float sum = 0.;
+  for (int k = 0; k < num_entries; ++k) {
+    sum += vals[k] * dense[ids[k]];
+  }
+  return sum;
+}
+
+#ifdef PETUUM_ML_KERNELS_X86
+__attribute__((target("avx2"))) float GatherDotProductAVX2(
+    const int32_t* ids, const float* vals, int32_t num_entries,
+    const float* dense) {
+  int k = 0;
+  __m256 sum8 = _mm256_setzero_ps();
+  for (; k + 8 <= num_entries; k += 8) {
+    __m256i ids8 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(ids + k));
+    __m256 dense8 = _mm256_i32gather_ps(dense, ids8, sizeof(float));
+    sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(_mm256_loadu_ps(vals + k),
+                                             dense8));
+  }
+  __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8),
+                           _mm256_extractf128_ps(sum8, 1));
+  sum4 = _mm_hadd_ps(sum4, sum4);
+  sum4 = _mm_hadd_ps(sum4, sum4);
+  float sum = _mm_cvtss_f32(sum4);
+  for (; k < num_entries; ++k) {
+    sum += vals[k] * dense[ids[k]];
+  }
+  return sum;
+}
+#endif
+
+GatherDotProductFunc SelectGatherDotProduct(const std::string& kernel_name) {
+  if (kernel_name == "scalar") {
+    return GatherDotProductScalar;
+  }
+#ifdef PETUUM_ML_KERNELS_X86
+  // CPU features are detected once, in SelectDefaultGatherDotProduct().
+  if (kernel_name == "avx2" && __builtin_cpu_supports("avx2")) {
+    return GatherDotProductAVX2;
+  }
+#endif
+  return 0;
+}
+
+// The fastest kernel the CPU supports.
+GatherDotProductFunc SelectDefaultGatherDotProduct() {
+#ifdef PETUUM_ML_KERNELS_X86
+  __builtin_cpu_init();
+#endif
+  GatherDotProductFunc gather_dot_product = SelectGatherDotProduct("avx2");
+  return (gather_dot_product != 0) ? gather_dot_product
+    : GatherDotProductScalar;
+}
+
+// Function-local static is initialized once in a thread-safe manner.
+GatherDotProductFunc& GetGatherDotProduct() {
+  static GatherDotProductFunc gather_dot_product =
+    SelectDefaultGatherDotProduct();
+  return gather_dot_product;
+}
+
+inline float GatherDotProduct(const int32_t* ids, const float* vals,
+    int32_t num_entries, const float* dense) {
+  return GetGatherDotProduct()(ids, vals, num_entries, dense);
+}
+
 }  // anonymous namespace
 
 float SafeLog(float x) {
@@ -123,5 +201,85 @@ void FeatureScaleAndAdd(float alpha, const AbstractFeature<float>& f1,
   }
 }
 
+void FeatureMatrixDotProduct(const FeatureMatrix<float>& X, const float* w,
+    float* result) {
+  const int32_t* row_offsets = X.GetRowOffsets();
+  const int32_t* feature_ids = X.GetFeatureIds();
+  const float* vals = X.GetVals();
+  for (int i = 0; i < X.GetNumRows(); ++i) {
+    int32_t begin = row_offsets[i];
+    result[i] = GatherDotProduct(feature_ids + begin, vals + begin,
+        row_offsets[i + 1] - begin, w);
+  }
+}
+
+void FeatureMatrixScaleAndAdd(float alpha, const FeatureMatrix<float>& X,
+    const float* coeffs, float* w) {
+  if (X.HasCSC()) {
+    const int32_t* col_offsets = X.GetColOffsets();
+    const int32_t* row_ids = X.GetColRowIds();
+    const float* col_vals = X.GetColVals();
+    for (int j = 0; j < X.GetFeatureDim(); ++j) {
+      int32_t begin = col_offsets[j];
+      int32_t num_entries = col_offsets[j + 1] - begin;
+      if (num_entries == 0)
+        continue;
+      w[j] += alpha * GatherDotProduct(row_ids + begin, col_vals + begin,
+          num_entries, coeffs);
+    }
+    return;
+  }
+
+  // Feature ids are distinct within a row, but AVX2 has no scatter.
+  const int32_t* row_offsets = X.GetRowOffsets();
+  const int32_t* feature_ids = X.GetFeatureIds();
+  const float* vals = X.GetVals();
+  for (int i = 0; i < X.GetNumRows(); ++i) {
+    float scale = alpha * coeffs[i];
+    if (scale == 0)
+      continue;
+    for (int k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+      w[feature_ids[k]] += scale * vals[k];
+    }
+  }
+}
+
+void FeatureMatrixSoftmaxGradient(const FeatureMatrix<float>& X,
+    const std::vector<const float*>& w, const std::vector<int32_t>& labels,
+    std::vector<float>* coeffs) {
+  CHECK_NOTNULL(coeffs);
+  int32_t num_rows = X.GetNumRows();
+  int32_t num_labels = w.size();
+  CHECK_EQ(num_rows, labels.size());
+  coeffs->resize(num_rows * num_labels);
+  for (int k = 0; k < num_labels; ++k) {
+    FeatureMatrixDotProduct(X, w[k], coeffs->data() + k * num_rows);
+  }
+
+  std::vector<float> y_vec(num_labels);
+  for (int i = 0; i < num_rows; ++i) {
+    for (int k = 0; k < num_labels; ++k) {
+      y_vec[k] = (*coeffs)[k * num_rows + i];
+    }
+    Softmax(&y_vec);
+    y_vec[labels[i]] -= 1.; // See Bishop PRML (2006) Eq. (4.109)
+    for (int k = 0; k < num_labels; ++k) {
+      (*coeffs)[k * num_rows + i] = y_vec[k];
+    }
+  }
+}
+
+bool SelectFeatureMatrixKernels(const std::string& kernel_name) {
+  // Runs the default selection (and CPU detection) before the override.
+  GetGatherDotProduct();
+  GatherDotProductFunc gather_dot_product =
+    SelectGatherDotProduct(kernel_name);
+  if (gather_dot_product == 0) {
+    return false;
+  }
+  GetGatherDotProduct() = gather_dot_product;
+  return true;
+}
+
 }  // namespace ml
 }  // namespace petuum
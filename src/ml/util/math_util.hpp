@@ -9,6 +9,7 @@
 #include <ml/feature/abstract_feature.hpp>
 #include <ml/feature/dense_feature.hpp>
 #include <ml/feature/sparse_feature.hpp>
+#include <ml/feature/feature_matrix.hpp>
 #include <sstream>
 
 namespace petuum {
@@ -67,5 +68,35 @@ void FeatureScaleAndAdd(float alpha, const DenseFeature<float>& f1,
 void FeatureScaleAndAdd(float alpha, const AbstractFeature<float>& f1,
     AbstractFeature<float>* f2);
 
+// ================ Minibatch kernels on FeatureMatrix ================
+// These walk the contiguous arrays of a FeatureMatrix instead of calling
+// AbstractFeature per entry. On CPUs with AVX2, they read the dense
+// operand 8 entries at a time with a gather; the kernels are picked at run
+// time. Dense operands are feature_dim long.
+
+// result[i] = X_i * w for each row X_i of X.
+void FeatureMatrixDotProduct(const FeatureMatrix<float>& X, const float* w,
+    float* result);
+
+// w += alpha * \sum_i coeffs[i] * X_i. Uses the CSC form of X if it has one,
+// which writes each w[j] once and gathers coeffs instead. That is for
+// callers that split w by feature; otherwise the CSR form measured faster
+// (roughly 3x for a 256 x 20000 minibatch with 200 nonzeros a row).
+void FeatureMatrixScaleAndAdd(float alpha, const FeatureMatrix<float>& X,
+    const float* coeffs, float* w);
+
+// Softmax cross-entropy gradient coefficients of minibatch X with labels,
+// for w[k] the weight of label k: coeffs[k * num_rows + i] =
+// softmax(X_i * w)[k] - (labels[i] == k), so that the gradient of w[k] is
+// \sum_i coeffs[k * num_rows + i] * X_i. The softmax is Softmax() above.
+void FeatureMatrixSoftmaxGradient(const FeatureMatrix<float>& X,
+    const std::vector<const float*>& w, const std::vector<int32_t>& labels,
+    std::vector<float>* coeffs);
+
+// Switch the FeatureMatrix kernels to kernel_name ("scalar" or "avx2").
+// Returns false, keeping the current ones, if the CPU does not support it.
+// Not thread-safe; for tests and benchmarks.
+bool SelectFeatureMatrixKernels(const std::string& kernel_name);
+
 }  // namespace ml
 }  // namespace petuum
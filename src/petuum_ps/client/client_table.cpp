@@ -20,14 +20,21 @@
 #include <petuum_ps/oplog/append_only_oplog.hpp>
 
 #include <cmath>
+#include <memory>
 
 namespace petuum {
 
 ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config):
+    ClientTable(table_id, RowShards::GetShardTableConfig(config),
+                config.table_info.row_capacity) { }
+
+ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config,
+                         size_t row_capacity):
     AbstractClientTable(),
     table_id_(table_id), row_type_(config.table_info.row_type),
     sample_row_(ClassRegistry<AbstractRow>::GetRegistry().CreateObject(
         row_type_)),
+    row_shards_(config.table_info.num_row_shards, row_capacity, row_type_),
     oplog_index_(std::ceil(static_cast<float>(config.oplog_capacity)
                            / GlobalContext::get_num_comm_channels_per_client())),
     staleness_(config.table_info.table_staleness),
@@ -74,12 +81,13 @@ ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config):
 
   switch (config.oplog_type) {
     case Sparse:
-      oplog_ = new SparseOpLog(config.oplog_capacity, sample_row_,
+      oplog_ = new SparseOpLog(table_id_, config.oplog_capacity, sample_row_,
                                dense_row_oplog_capacity_, row_oplog_type_,
                                config.table_info.version_maintain);
       break;
     case AppendOnly:
       oplog_ = new AppendOnlyOpLog(
+          table_id_,
           config.append_only_buff_capacity,
           sample_row_,
           config.append_only_oplog_type,
@@ -88,6 +96,7 @@ ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config):
       break;
     case Dense:
       oplog_ = new DenseOpLog(
+          table_id_,
           config.oplog_capacity,
           sample_row_,
           dense_row_oplog_capacity_,
@@ -168,8 +177,8 @@ ClientTable::~ClientTable() {
 void ClientTable::RegisterThread() {
   if (thread_cache_.get() == 0)
     thread_cache_.reset(new ThreadTable(
-        sample_row_, client_table_config_.table_info.row_oplog_type,
-        client_table_config_.table_info.row_capacity));
+        table_id_, sample_row_, client_table_config_.table_info.row_oplog_type,
+        row_capacity_));
 
   oplog_->RegisterThread();
 }
@@ -180,10 +189,24 @@ void ClientTable::DeregisterThread() {
 }
 
 void ClientTable::GetAsyncForced(int32_t row_id) {
+  if (row_shards_.is_split()) {
+    for (int32_t shard = 0; shard < row_shards_.get_num_shards(); ++shard) {
+      consistency_controller_->GetAsyncForced(
+          row_shards_.GetShardRowID(row_id, shard));
+    }
+    return;
+  }
   consistency_controller_->GetAsyncForced(row_id);
 }
 
 void ClientTable::GetAsync(int32_t row_id) {
+  if (row_shards_.is_split()) {
+    for (int32_t shard = 0; shard < row_shards_.get_num_shards(); ++shard) {
+      consistency_controller_->GetAsync(
+          row_shards_.GetShardRowID(row_id, shard));
+    }
+    return;
+  }
   consistency_controller_->GetAsync(row_id);
 }
 
@@ -192,16 +215,56 @@ void ClientTable::WaitPendingAsyncGet() {
 }
 
 void ClientTable::ThreadGet(int32_t row_id, ThreadRowAccessor *row_accessor) {
+  if (row_shards_.is_split()) {
+    SplitRowCache *cache = GetSplitRowCache();
+    int32_t num_shards = row_shards_.get_num_shards();
+    std::vector<AbstractRow*> shard_rows(num_shards);
+    for (int32_t shard = 0; shard < num_shards; ++shard) {
+      ThreadRowAccessor shard_accessor;
+      consistency_controller_->ThreadGet(
+          row_shards_.GetShardRowID(row_id, shard), &shard_accessor);
+      shard_rows[shard] = shard_accessor.row_data_ptr_;
+    }
+    row_accessor->row_data_ptr_
+        = AssembleSplitRow(row_id, shard_rows.data(), cache)->GetRowDataPtr();
+    return;
+  }
   consistency_controller_->ThreadGet(row_id, row_accessor);
 }
 
 void ClientTable::ThreadInc(int32_t row_id, int32_t column_id,
                             const void *update) {
+  if (row_shards_.is_split()) {
+    int32_t shard_column_id;
+    int32_t shard_row_id = row_shards_.GetShardColumn(row_id, column_id,
+                                                      &shard_column_id);
+    consistency_controller_->ThreadInc(shard_row_id, shard_column_id, update);
+    AbstractRow *split_row = FindSplitRowToInc(row_id);
+    if (split_row != 0)
+      split_row->ApplyIncUnsafe(column_id, update);
+    return;
+  }
   consistency_controller_->ThreadInc(row_id, column_id, update);
 }
 void ClientTable::ThreadBatchInc(int32_t row_id, const int32_t* column_ids,
                                  const void* updates,
                                  int32_t num_updates) {
+  if (row_shards_.is_split()) {
+    SplitRowCache *cache = GetSplitRowCache();
+    row_shards_.ForEachShardBatch(
+        row_id, column_ids, updates, num_updates, &cache->column_ids,
+        &cache->updates,
+        [this](int32_t shard_row_id, const int32_t *shard_column_ids,
+               const void *shard_updates, int32_t num_shard_updates) {
+          consistency_controller_->ThreadBatchInc(
+              shard_row_id, shard_column_ids, shard_updates,
+              num_shard_updates);
+        });
+    AbstractRow *split_row = FindSplitRowToInc(row_id);
+    if (split_row != 0)
+      split_row->ApplyBatchIncUnsafe(column_ids, updates, num_updates);
+    return;
+  }
   consistency_controller_->ThreadBatchInc(row_id, column_ids, updates,
     num_updates);
 }
@@ -211,20 +274,60 @@ void ClientTable::FlushThreadCache() {
 }
 
 ClientRow *ClientTable::Get(int32_t row_id, RowAccessor *row_accessor) {
+  if (row_shards_.is_split()) {
+    RowAccessor split_row_accessor;
+    return GetSplitRows(&row_id, 1, (row_accessor != 0) ? row_accessor
+                        : &split_row_accessor);
+  }
   return consistency_controller_->Get(row_id, row_accessor);
 }
 
+void ClientTable::GetBatch(const int32_t *row_ids, int32_t num_rows,
+                           RowAccessor *row_accessors) {
+  if (row_shards_.is_split()) {
+    GetSplitRows(row_ids, num_rows, row_accessors);
+    return;
+  }
+  consistency_controller_->GetBatch(row_ids, num_rows, row_accessors);
+}
+
 void ClientTable::Inc(int32_t row_id, int32_t column_id, const void *update) {
   STATS_APP_SAMPLE_INC_BEGIN(table_id_);
-  consistency_controller_->Inc(row_id, column_id, update);
+  if (row_shards_.is_split()) {
+    int32_t shard_column_id;
+    int32_t shard_row_id = row_shards_.GetShardColumn(row_id, column_id,
+                                                      &shard_column_id);
+    consistency_controller_->Inc(shard_row_id, shard_column_id, update);
+    AbstractRow *split_row = FindSplitRowToInc(row_id);
+    if (split_row != 0)
+      split_row->ApplyIncUnsafe(column_id, update);
+  } else {
+    consistency_controller_->Inc(row_id, column_id, update);
+  }
   STATS_APP_SAMPLE_INC_END(table_id_);
 }
 
 void ClientTable::BatchInc(int32_t row_id, const int32_t* column_ids,
   const void* updates, int32_t num_updates) {
   STATS_APP_SAMPLE_BATCH_INC_BEGIN(table_id_);
-  consistency_controller_->BatchInc(row_id, column_ids, updates,
-                                    num_updates);
+  if (row_shards_.is_split()) {
+    SplitRowCache *cache = GetSplitRowCache();
+    row_shards_.ForEachShardBatch(
+        row_id, column_ids, updates, num_updates, &cache->column_ids,
+        &cache->updates,
+        [this](int32_t shard_row_id, const int32_t *shard_column_ids,
+               const void *shard_updates, int32_t num_shard_updates) {
+          consistency_controller_->BatchInc(
+              shard_row_id, shard_column_ids, shard_updates,
+              num_shard_updates);
+        });
+    AbstractRow *split_row = FindSplitRowToInc(row_id);
+    if (split_row != 0)
+      split_row->ApplyBatchIncUnsafe(column_ids, updates, num_updates);
+  } else {
+    consistency_controller_->BatchInc(row_id, column_ids, updates,
+                                      num_updates);
+  }
   STATS_APP_SAMPLE_BATCH_INC_END(table_id_);
 }
 
@@ -232,22 +335,51 @@ void ClientTable::DenseBatchInc(
     int32_t row_id, const void *updates, int32_t index_st,
     int32_t num_updates) {
   STATS_APP_SAMPLE_BATCH_INC_BEGIN(table_id_);
-  consistency_controller_->DenseBatchInc(row_id, updates, index_st,
-                                         num_updates);
+  if (row_shards_.is_split()) {
+    row_shards_.ForEachShardDenseBatch(
+        row_id, updates, index_st, num_updates,
+        [this](int32_t shard_row_id, const void *shard_updates,
+               int32_t shard_index_st, int32_t num_shard_updates) {
+          consistency_controller_->DenseBatchInc(
+              shard_row_id, shard_updates, shard_index_st,
+              num_shard_updates);
+        });
+    AbstractRow *split_row = FindSplitRowToInc(row_id);
+    if (split_row != 0)
+      split_row->ApplyDenseBatchIncUnsafe(updates, index_st, num_updates);
+  } else {
+    consistency_controller_->DenseBatchInc(row_id, updates, index_st,
+                                           num_updates);
+  }
   STATS_APP_SAMPLE_BATCH_INC_END(table_id_);
 }
 
 void ClientTable::ThreadDenseBatchInc(int32_t row_id, const void *updates,
                                       int32_t index_st,
                                       int32_t num_updates) {
+  if (row_shards_.is_split()) {
+    row_shards_.ForEachShardDenseBatch(
+        row_id, updates, index_st, num_updates,
+        [this](int32_t shard_row_id, const void *shard_updates,
+               int32_t shard_index_st, int32_t num_shard_updates) {
+          consistency_controller_->ThreadDenseBatchInc(
+              shard_row_id, shard_updates, shard_index_st,
+              num_shard_updates);
+        });
+    AbstractRow *split_row = FindSplitRowToInc(row_id);
+    if (split_row != 0)
+      split_row->ApplyDenseBatchIncUnsafe(updates, index_st, num_updates);
+    return;
+  }
   consistency_controller_->ThreadDenseBatchInc(row_id, updates, index_st,
                                                num_updates);
 }
 
-
 void ClientTable::Clock() {
   STATS_APP_SAMPLE_CLOCK_BEGIN(table_id_);
   consistency_controller_->Clock();
+  if (row_shards_.is_split())
+    DropSplitRows();
   STATS_APP_SAMPLE_CLOCK_END(table_id_);
 }
 
@@ -260,6 +392,88 @@ size_t ClientTable::GetNumRowOpLogs(int32_t partition_num) {
   return oplog_index_.GetNumRowOpLogs(partition_num);
 }
 
+ClientTable::SplitRowCache::~SplitRowCache() {
+  for (auto &row_pair : rows) {
+    delete row_pair.second;
+  }
+}
+
+ClientTable::SplitRowCache *ClientTable::GetSplitRowCache() {
+  if (split_row_cache_.get() == 0)
+    split_row_cache_.reset(new SplitRowCache);
+  return split_row_cache_.get();
+}
+
+ClientRow *ClientTable::GetSplitRows(const int32_t *row_ids, int32_t num_rows,
+                                     RowAccessor *row_accessors) {
+  SplitRowCache *cache = GetSplitRowCache();
+  int32_t num_shards = row_shards_.get_num_shards();
+  cache->shard_row_ids.clear();
+  for (int32_t i = 0; i < num_rows; ++i) {
+    row_shards_.GetShardRowIDs(row_ids[i], &cache->shard_row_ids);
+  }
+
+  // Shards of all rows are fetched together.
+  std::unique_ptr<RowAccessor[]> shard_accessors(
+      new RowAccessor[num_rows*num_shards]);
+  consistency_controller_->GetBatch(cache->shard_row_ids.data(),
+                                    num_rows*num_shards,
+                                    shard_accessors.get());
+
+  std::vector<AbstractRow*> shard_rows(num_shards);
+  ClientRow *client_row = 0;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    for (int32_t shard = 0; shard < num_shards; ++shard) {
+      shard_rows[shard] = shard_accessors[i*num_shards + shard].GetRowData();
+    }
+    client_row = AssembleSplitRow(row_ids[i], shard_rows.data(), cache);
+    row_accessors[i].SetClientRow(client_row);
+  }
+  return client_row;
+}
+
+ClientRow *ClientTable::AssembleSplitRow(int32_t row_id,
+                                         AbstractRow *const *shard_rows,
+                                         SplitRowCache *cache) {
+  ClientRow *&client_row = cache->rows[row_id];
+  if (client_row == 0) {
+    AbstractRow *row_data
+        = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type_);
+    row_data->Init(row_shards_.get_row_capacity());
+    client_row = new ClientRow(0, row_data, true);
+  }
+  row_shards_.Assemble(shard_rows, client_row->GetRowDataPtr(),
+                       &cache->row_buff);
+  return client_row;
+}
+
+AbstractRow *ClientTable::FindSplitRowToInc(int32_t row_id) {
+  // Like the process storage rows, the copies of version maintained tables
+  // only change on Get().
+  SplitRowCache *cache = split_row_cache_.get();
+  if (cache == 0 || get_version_maintain())
+    return 0;
+  auto row_iter = cache->rows.find(row_id);
+  if (row_iter == cache->rows.end())
+    return 0;
+  return row_iter->second->GetRowDataPtr();
+}
+
+void ClientTable::DropSplitRows() {
+  SplitRowCache *cache = split_row_cache_.get();
+  if (cache == 0)
+    return;
+  auto row_iter = cache->rows.begin();
+  while (row_iter != cache->rows.end()) {
+    if (row_iter->second->HasZeroRef()) {
+      delete row_iter->second;
+      row_iter = cache->rows.erase(row_iter);
+    } else {
+      ++row_iter;
+    }
+  }
+}
+
 ClientRow *ClientTable::CreateClientRow(int32_t clock) {
   AbstractRow *row_data = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type_);
   row_data->Init(row_capacity_);
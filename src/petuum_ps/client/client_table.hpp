@@ -12,14 +12,18 @@
 #include <petuum_ps/oplog/abstract_oplog.hpp>
 #include <petuum_ps/oplog/oplog_index.hpp>
 #include <petuum_ps/client/thread_table.hpp>
+#include <petuum_ps/client/row_shards.hpp>
 
 #include <boost/thread/tss.hpp>
+#include <boost/unordered_map.hpp>
 
 namespace petuum {
 
 class ClientTable : public AbstractClientTable {
 public:
   // Instantiate AbstractRow, TableOpLog, and ProcessStorage using config.
+  // If config.table_info.num_row_shards > 1, everything below ClientTable
+  // deals with shard rows (see RowShards).
   ClientTable(int32_t table_id, const ClientTableConfig& config);
 
   ~ClientTable();
@@ -39,6 +43,8 @@ public:
   void FlushThreadCache();
 
   ClientRow *Get(int32_t row_id, RowAccessor *row_accessor);
+  void GetBatch(const int32_t *row_ids, int32_t num_rows,
+                RowAccessor *row_accessors);
   void Inc(int32_t row_id, int32_t column_id, const void *update);
   void BatchInc(int32_t row_id, const int32_t* column_ids, const void* updates,
     int32_t num_updates);
@@ -113,15 +119,59 @@ public:
     return client_table_config_.table_info.version_maintain;
   }
 
+  int32_t get_compress_type() const {
+    return client_table_config_.table_info.compress_type;
+  }
+
 private:
+  // Per app thread state for split rows.
+  struct SplitRowCache {
+    ~SplitRowCache();
+
+    // Rows assembled from their shards, handed out by Get() and
+    // ThreadGet(). Refreshed in place by every Get() of the row and updated
+    // by the thread's own Inc()s in between. Rows no RowAccessor refers to
+    // are dropped at Clock(), so a row from ThreadGet() is valid until the
+    // thread's next Clock().
+    boost::unordered_map<int32_t, ClientRow*> rows;
+    std::vector<int32_t> shard_row_ids;
+    std::vector<int32_t> column_ids;
+    std::vector<uint8_t> updates;
+    std::vector<uint8_t> row_buff;
+  };
+
+  // config is that of the shard rows, row_capacity the capacity of the
+  // rows seen by apps.
+  ClientTable(int32_t table_id, const ClientTableConfig& config,
+              size_t row_capacity);
+
+  SplitRowCache *GetSplitRowCache();
+
+  // Get and assemble the shards of num_rows rows. Return the ClientRow of
+  // the last one.
+  ClientRow *GetSplitRows(const int32_t *row_ids, int32_t num_rows,
+                          RowAccessor *row_accessors);
+
+  ClientRow *AssembleSplitRow(int32_t row_id, AbstractRow *const *shard_rows,
+                              SplitRowCache *cache);
+
+  // Returns the calling thread's assembled copy of row_id for an Inc to be
+  // applied to, 0 if there is none or the table is version maintained.
+  AbstractRow *FindSplitRowToInc(int32_t row_id);
+
+  // Drops the calling thread's assembled rows that are not referenced.
+  void DropSplitRows();
+
   const int32_t table_id_;
   const int32_t row_type_;
   const AbstractRow* const sample_row_;
+  const RowShards row_shards_;
   AbstractOpLog *oplog_;
   AbstractProcessStorage *process_storage_;
   AbstractConsistencyController *consistency_controller_;
 
   boost::thread_specific_ptr<ThreadTable> thread_cache_;
+  boost::thread_specific_ptr<SplitRowCache> split_row_cache_;
   TableOpLogIndex oplog_index_;
   int32_t staleness_;
 
@@ -0,0 +1,70 @@
+#include <petuum_ps/client/row_shards.hpp>
+#include <petuum_ps_common/util/class_register.hpp>
+#include <glog/logging.h>
+#include <memory>
+
+namespace petuum {
+
+RowShards::RowShards(int32_t num_shards, size_t row_capacity,
+                     int32_t row_type):
+    num_shards_(num_shards),
+    row_capacity_(row_capacity),
+    shard_capacity_(GetShardCapacity(row_capacity, num_shards)),
+    update_size_(0) {
+  CHECK_GE(num_shards_, 1);
+  if (!is_split())
+    return;
+
+  std::unique_ptr<AbstractRow> row(
+      ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type));
+  row->Init(shard_capacity_);
+  update_size_ = row->get_update_size();
+  CHECK_EQ(row->SerializedSize(), shard_capacity_*update_size_)
+      << "Rows of type " << row_type << " cannot be split into shards";
+}
+
+ClientTableConfig RowShards::GetShardTableConfig(
+    const ClientTableConfig &config) {
+  ClientTableConfig shard_config = config;
+  int32_t num_shards = config.table_info.num_row_shards;
+  if (num_shards <= 1)
+    return shard_config;
+
+  shard_config.table_info.row_capacity
+      = GetShardCapacity(config.table_info.row_capacity, num_shards);
+  shard_config.table_info.dense_row_oplog_capacity
+      = GetShardCapacity(config.table_info.dense_row_oplog_capacity,
+                         num_shards);
+  shard_config.process_cache_capacity *= num_shards;
+  shard_config.thread_cache_capacity *= num_shards;
+  shard_config.oplog_capacity *= num_shards;
+  return shard_config;
+}
+
+void RowShards::GetShardRowIDs(int32_t row_id,
+                               std::vector<int32_t> *shard_row_ids) const {
+  for (int32_t shard = 0; shard < num_shards_; ++shard) {
+    shard_row_ids->push_back(GetShardRowID(row_id, shard));
+  }
+}
+
+void RowShards::Assemble(AbstractRow *const *shard_rows, AbstractRow *row,
+                         std::vector<uint8_t> *buff) const {
+  size_t shard_size = shard_capacity_*update_size_;
+  buff->resize(shard_size*num_shards_);
+  for (int32_t shard = 0; shard < num_shards_; ++shard) {
+    AbstractRow *shard_row = shard_rows[shard];
+    shard_row->GetWriteLock();
+    size_t serialized_size
+        = shard_row->Serialize(buff->data() + shard*shard_size);
+    shard_row->ReleaseWriteLock();
+    CHECK_EQ(serialized_size, shard_size);
+  }
+
+  // The last shard may extend past row_capacity_.
+  row->GetWriteLock();
+  row->ResetRowData(buff->data(), row_capacity_*update_size_);
+  row->ReleaseWriteLock();
+}
+
+}  // namespace petuum
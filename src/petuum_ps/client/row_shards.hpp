@@ -0,0 +1,160 @@
+#pragma once
+
+#include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps_common/include/configs.hpp>
+#include <glog/logging.h>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+namespace petuum {
+
+// Splits every row of a table into num_shards shard rows of shard_capacity
+// consecutive columns. Shard k of row row_id is row row_id*num_shards + k
+// below ClientTable: shards are partitioned over server threads, updated
+// and fetched like separate rows, so a wide row is no longer applied by a
+// single server thread. Applications keep using row_id.
+//
+// Only row types serialized as an array of get_update_size()-byte values,
+// one per column (e.g. DenseRow), can be split.
+class RowShards {
+public:
+  RowShards(int32_t num_shards, size_t row_capacity, int32_t row_type);
+
+  static size_t GetShardCapacity(size_t row_capacity, int32_t num_shards) {
+    return (row_capacity + num_shards - 1) / num_shards;
+  }
+
+  // Config of the table of shard rows: capacities are per shard and
+  // capacities in # of rows are multiplied by the number of shards.
+  static ClientTableConfig GetShardTableConfig(const ClientTableConfig &config);
+
+  bool is_split() const {
+    return num_shards_ > 1;
+  }
+
+  int32_t get_num_shards() const {
+    return num_shards_;
+  }
+
+  size_t get_row_capacity() const {
+    return row_capacity_;
+  }
+
+  size_t get_shard_capacity() const {
+    return shard_capacity_;
+  }
+
+  int32_t GetShardRowID(int32_t row_id, int32_t shard) const {
+    CHECK_LE(row_id, INT_MAX / num_shards_ - 1)
+        << "row id too large to be split";
+    return row_id*num_shards_ + shard;
+  }
+
+  // Appends the num_shards shard row ids of row_id.
+  void GetShardRowIDs(int32_t row_id, std::vector<int32_t> *shard_row_ids) const;
+
+  // Returns the shard row id of column_id of row_id and sets
+  // shard_column_id to its column id in the shard.
+  int32_t GetShardColumn(int32_t row_id, int32_t column_id,
+                         int32_t *shard_column_id) const {
+    CHECK_GE(column_id, 0);
+    CHECK_LT(column_id, static_cast<int32_t>(row_capacity_));
+    int32_t shard = column_id / static_cast<int32_t>(shard_capacity_);
+    *shard_column_id = column_id - shard*shard_capacity_;
+    return GetShardRowID(row_id, shard);
+  }
+
+  // Calls func(shard_row_id, shard_column_ids, shard_updates, num) on the
+  // updates of each shard, with column ids relative to the shard.
+  // column_ids_buff and updates_buff are scratch buffers.
+  template<typename Func>
+  void ForEachShardBatch(int32_t row_id, const int32_t *column_ids,
+                         const void *updates, int32_t num_updates,
+                         std::vector<int32_t> *column_ids_buff,
+                         std::vector<uint8_t> *updates_buff,
+                         Func func) const;
+
+  // Calls func(shard_row_id, shard_updates, shard_index_st, num) on the part
+  // of the dense batch in each shard.
+  template<typename Func>
+  void ForEachShardDenseBatch(int32_t row_id, const void *updates,
+                              int32_t index_st, int32_t num_updates,
+                              Func func) const;
+
+  // Copy the values of shard_rows[0, num_shards) to row, which has
+  // row_capacity columns. buff is scratch memory.
+  void Assemble(AbstractRow *const *shard_rows, AbstractRow *row,
+                std::vector<uint8_t> *buff) const;
+
+private:
+  const int32_t num_shards_;
+  const size_t row_capacity_;
+  const size_t shard_capacity_;
+  size_t update_size_;
+};
+
+template<typename Func>
+void RowShards::ForEachShardBatch(
+    int32_t row_id, const int32_t *column_ids, const void *updates,
+    int32_t num_updates, std::vector<int32_t> *column_ids_buff,
+    std::vector<uint8_t> *updates_buff, Func func) const {
+  int32_t shard_capacity = shard_capacity_;
+  // Counting sort by shard.
+  std::vector<int32_t> offsets(num_shards_ + 1, 0);
+  for (int32_t i = 0; i < num_updates; ++i) {
+    CHECK_GE(column_ids[i], 0);
+    CHECK_LT(column_ids[i], static_cast<int32_t>(row_capacity_));
+    ++offsets[column_ids[i] / shard_capacity + 1];
+  }
+  for (int32_t shard = 0; shard < num_shards_; ++shard) {
+    offsets[shard + 1] += offsets[shard];
+  }
+
+  column_ids_buff->resize(num_updates);
+  updates_buff->resize(num_updates*update_size_);
+  std::vector<int32_t> next(offsets.begin(), offsets.end() - 1);
+  const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+  for (int32_t i = 0; i < num_updates; ++i) {
+    int32_t shard = column_ids[i] / shard_capacity;
+    int32_t idx = next[shard]++;
+    (*column_ids_buff)[idx] = column_ids[i] - shard*shard_capacity;
+    memcpy(updates_buff->data() + idx*update_size_,
+           updates_uint8 + i*update_size_, update_size_);
+  }
+
+  for (int32_t shard = 0; shard < num_shards_; ++shard) {
+    int32_t num_shard_updates = offsets[shard + 1] - offsets[shard];
+    if (num_shard_updates == 0)
+      continue;
+    func(GetShardRowID(row_id, shard),
+         column_ids_buff->data() + offsets[shard],
+         updates_buff->data() + offsets[shard]*update_size_,
+         num_shard_updates);
+  }
+}
+
+template<typename Func>
+void RowShards::ForEachShardDenseBatch(
+    int32_t row_id, const void *updates, int32_t index_st,
+    int32_t num_updates, Func func) const {
+  const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+  CHECK_GE(index_st, 0);
+  CHECK_LE(static_cast<size_t>(index_st) + num_updates, row_capacity_);
+  int32_t shard_capacity = shard_capacity_;
+  while (num_updates > 0) {
+    int32_t shard = index_st / shard_capacity;
+    int32_t shard_index_st = index_st - shard*shard_capacity;
+    int32_t num_shard_updates
+        = std::min(num_updates, shard_capacity - shard_index_st);
+    func(GetShardRowID(row_id, shard), updates_uint8, shard_index_st,
+         num_shard_updates);
+    updates_uint8 += num_shard_updates*update_size_;
+    index_st += num_shard_updates;
+    num_updates -= num_shard_updates;
+  }
+}
+
+}  // namespace petuum
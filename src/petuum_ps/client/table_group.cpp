@@ -62,7 +62,15 @@ TableGroup::TableGroup(const TableGroupConfig &table_group_config,
       table_group_config.numa_policy,
       table_group_config.naive_table_oplog_meta,
       table_group_config.use_approx_sort,
-      table_group_config.suppression_on);
+      table_group_config.row_delta_reply,
+      table_group_config.suppression_on,
+      table_group_config.snapshot_async,
+      table_group_config.snapshot_full_interval,
+      table_group_config.resume_num_threads,
+      table_group_config.num_server_apply_threads,
+      table_group_config.row_partitioner,
+      table_group_config.num_partition_virtual_nodes,
+      table_group_config.row_placement_file);
 
   NumaMgr::Init(table_group_config.numa_opt);
 
@@ -71,7 +79,9 @@ TableGroup::TableGroup(const TableGroupConfig &table_group_config,
   LOG(INFO) << "num_zmq_threads = " << num_zmq_threads;
 
   CommBus *comm_bus = new CommBus(local_id_min, local_id_max,
-                                  num_total_clients, num_zmq_threads);
+                                  num_total_clients, num_zmq_threads,
+                                  table_group_config.comm_bus_inproc_ring,
+                                  table_group_config.comm_bus_inproc_ring_spin);
   GlobalContext::comm_bus = comm_bus;
 
   *init_thread_id = local_id_min
@@ -4,6 +4,7 @@
 #include <petuum_ps/oplog/meta_row_oplog.hpp>
 #include <petuum_ps_common/include/configs.hpp>
 #include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps/oplog/row_oplog_pool.hpp>
 
 #include <glog/logging.h>
 #include <functional>
@@ -11,10 +12,13 @@
 namespace petuum {
 
 ThreadTable::ThreadTable(
-    const AbstractRow *sample_row, int32_t row_oplog_type,
+    int32_t table_id, const AbstractRow *sample_row, int32_t row_oplog_type,
     size_t dense_row_oplog_capacity):
+    table_id_(table_id),
     oplog_index_(GlobalContext::get_num_comm_channels_per_client()),
     sample_row_(sample_row),
+    // Thread oplogs are dense only for kDenseRowOpLog, see CreateRowOpLog_.
+    oplog_accum_(sample_row, row_oplog_type == RowOpLogType::kDenseRowOpLog),
     dense_row_oplog_capacity_(dense_row_oplog_capacity) {
 
   {
@@ -67,6 +71,9 @@ ThreadTable::~ThreadTable() {
     if (iter->second != 0)
       delete iter->second;
   }
+
+  for (auto row_oplog : free_row_oplogs_)
+    delete row_oplog;
 }
 
 void ThreadTable::UpdateOpLogClockSSPAggr(AbstractRowOpLog *row_oplog) {
@@ -76,7 +83,8 @@ void ThreadTable::UpdateOpLogClockSSPAggr(AbstractRowOpLog *row_oplog) {
 }
 
 void ThreadTable::IndexUpdate(int32_t row_id) {
-  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(row_id);
+  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(
+      table_id_, row_id);
   //LOG(INFO) << "partition num = " << partition_num
   //          << " row id = " << row_id;
   oplog_index_[partition_num].insert(row_id);
@@ -84,7 +92,8 @@ void ThreadTable::IndexUpdate(int32_t row_id) {
 }
 
 size_t ThreadTable::IndexUpdateAndGetCount(int32_t row_id, size_t num_updates) {
-  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(row_id);
+  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(
+      table_id_, row_id);
   oplog_index_[partition_num].insert(row_id);
   update_count_ += num_updates;
   return update_count_;
@@ -149,15 +158,13 @@ void ThreadTable::Inc(int32_t row_id, int32_t column_id, const void *delta) {
 
   AbstractRowOpLog *row_oplog;
   if (oplog_iter == oplog_map_.end()) {
-    row_oplog = CreateRowOpLog_(sample_row_->get_update_size(), sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog();
     oplog_map_[row_id] = row_oplog;
   } else {
     row_oplog = oplog_iter->second;
   }
 
-  void *oplog_delta = row_oplog->FindCreate(column_id);
-  sample_row_->AddUpdates(column_id, oplog_delta, delta);
+  oplog_accum_.Inc(row_oplog, column_id, delta);
 
   auto row_iter = row_storage_.find(row_id);
   if (row_iter != row_storage_.end()) {
@@ -171,20 +178,13 @@ void ThreadTable::BatchInc(int32_t row_id, const int32_t *column_ids,
 
   AbstractRowOpLog *row_oplog;
   if (oplog_iter == oplog_map_.end()) {
-    row_oplog = CreateRowOpLog_(sample_row_->get_update_size(), sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog();
     oplog_map_[row_id] = row_oplog;
   } else {
     row_oplog = oplog_iter->second;
   }
 
-  const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(deltas);
-
-  for (int i = 0; i < num_updates; ++i) {
-    void *oplog_delta = row_oplog->FindCreate(column_ids[i]);
-    sample_row_->AddUpdates(column_ids[i], oplog_delta, deltas_uint8
-                            + sample_row_->get_update_size()*i);
-  }
+  oplog_accum_.BatchInc(row_oplog, column_ids, deltas, num_updates);
 
   auto row_iter = row_storage_.find(row_id);
   if (row_iter != row_storage_.end()) {
@@ -197,19 +197,12 @@ void ThreadTable::DenseBatchInc(int32_t row_id, const void *updates,
   auto oplog_iter = oplog_map_.find(row_id);
   AbstractRowOpLog *row_oplog;
   if (oplog_iter == oplog_map_.end()) {
-    row_oplog = CreateRowOpLog_(sample_row_->get_update_size(), sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog();
     oplog_map_[row_id] = row_oplog;
     row_oplog->OverwriteWithDenseUpdate(updates, index_st, num_updates);
   } else {
     row_oplog = oplog_iter->second;
-    const uint8_t* updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
-    for (int i = 0; i < num_updates; ++i) {
-      int32_t col_id = i + index_st;
-      void *oplog_update = row_oplog->FindCreate(col_id);
-      sample_row_->AddUpdates(col_id, oplog_update, updates_uint8
-                              + sample_row_->get_update_size()*i);
-    }
+    oplog_accum_.DenseBatchInc(row_oplog, updates, index_st, num_updates);
   }
 
   auto row_iter = row_storage_.find(row_id);
@@ -253,16 +246,27 @@ void ThreadTable::FlushCacheOpLog(AbstractProcessStorage &process_storage,
 
     (this->*ApplyThreadOpLog_)(&oplog_accessor, client_row,
                                oplog_iter->second, row_id);
-    delete oplog_iter->second;
+    RowOpLogPool::ResetRowOpLog(oplog_iter->second);
+    free_row_oplogs_.push_back(oplog_iter->second);
   }
   oplog_map_.clear();
 }
 
+AbstractRowOpLog *ThreadTable::GetNewRowOpLog() {
+  if (free_row_oplogs_.empty())
+    return CreateRowOpLog_(sample_row_->get_update_size(), sample_row_,
+                           dense_row_oplog_capacity_);
+  AbstractRowOpLog *row_oplog = free_row_oplogs_.back();
+  free_row_oplogs_.pop_back();
+  return row_oplog;
+}
+
 void ThreadTable::ApplyThreadOpLogSSP(
     OpLogAccessor *oplog_accessor, ClientRow *client_row,
     AbstractRowOpLog *row_oplog, int32_t row_id) {
 
-  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(row_id);
+  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(
+      table_id_, row_id);
 
   int32_t column_id;
   void *delta = row_oplog->BeginIterate(&column_id);
@@ -283,7 +287,8 @@ void ThreadTable::ApplyThreadOpLogGetImportance(
     OpLogAccessor *oplog_accessor, ClientRow *client_row,
     AbstractRowOpLog *row_oplog, int32_t row_id) {
 
-  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(row_id);
+  int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(
+      table_id_, row_id);
 
   int32_t column_id;
   void *delta = row_oplog->BeginIterate(&column_id);
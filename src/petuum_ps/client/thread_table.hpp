@@ -11,13 +11,14 @@
 #include <petuum_ps/oplog/oplog_index.hpp>
 #include <petuum_ps/oplog/abstract_oplog.hpp>
 #include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps/oplog/row_oplog_accumulator.hpp>
 
 namespace petuum {
 
 class ThreadTable : boost::noncopyable {
 public:
-  explicit ThreadTable(const AbstractRow *sample_row, int32_t row_oplog_type,
-                       size_t dense_row_oplog_capacity);
+  ThreadTable(int32_t table_id, const AbstractRow *sample_row,
+              int32_t row_oplog_type, size_t dense_row_oplog_capacity);
   ~ThreadTable();
   void IndexUpdate(int32_t row_id);
   void FlushOpLogIndex(TableOpLogIndex &oplog_index);
@@ -46,10 +47,14 @@ public:
   }
 
 private:
+  const int32_t table_id_;
   std::vector<std::unordered_set<int32_t> > oplog_index_;
   boost::unordered_map<int32_t, AbstractRow* > row_storage_;
   boost::unordered_map<int32_t, AbstractRowOpLog* > oplog_map_;
+  // Row oplogs flushed in earlier clocks, reset for reuse.
+  std::vector<AbstractRowOpLog*> free_row_oplogs_;
   const AbstractRow *sample_row_;
+  RowOpLogAccumulator oplog_accum_;
 
   size_t update_count_;
 
@@ -63,6 +68,8 @@ private:
 
   CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog_;
 
+  AbstractRowOpLog *GetNewRowOpLog();
+
   void ApplyThreadOpLogSSP(
       OpLogAccessor *oplog_accessor, ClientRow *client_row,
       AbstractRowOpLog *row_oplog, int32_t row_id);
@@ -26,8 +26,7 @@ void SSPAggrValueConsistencyController::Inc(int32_t row_id, int32_t column_id,
   OpLogAccessor oplog_accessor;
   oplog_.FindInsertOpLog(row_id, &oplog_accessor);
 
-  void *oplog_delta = oplog_accessor.get_row_oplog()->FindCreate(column_id);
-  sample_row_->AddUpdates(column_id, oplog_delta, delta);
+  oplog_accum_.Inc(oplog_accessor.get_row_oplog(), column_id, delta);
 
   MetaRowOpLog *meta_row_oplog
       = dynamic_cast<MetaRowOpLog*>(oplog_accessor.get_row_oplog());
@@ -57,14 +56,8 @@ void SSPAggrValueConsistencyController::BatchInc(int32_t row_id,
   OpLogAccessor oplog_accessor;
   oplog_.FindInsertOpLog(row_id, &oplog_accessor);
 
-  const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-
-  for (int i = 0; i < num_updates; ++i) {
-    void *oplog_delta
-        = oplog_accessor.get_row_oplog()->FindCreate(column_ids[i]);
-    sample_row_->AddUpdates(column_ids[i], oplog_delta, deltas_uint8
-			    + sample_row_->get_update_size()*i);
-  }
+  oplog_accum_.BatchInc(oplog_accessor.get_row_oplog(), column_ids, updates,
+                        num_updates);
   MetaRowOpLog *meta_row_oplog
       = dynamic_cast<MetaRowOpLog*>(oplog_accessor.get_row_oplog());
   meta_row_oplog->GetMeta().set_clock(ThreadContext::get_clock());
@@ -96,9 +89,7 @@ void SSPAggrValueConsistencyController::DenseBatchInc(
   if (new_create) {
     row_oplog->OverwriteWithDenseUpdate(updates, index_st, num_updates);
   } else {
-    const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-    (this->*DenseBatchIncOpLog_)(row_oplog, deltas_uint8, index_st,
-                                 num_updates);
+    oplog_accum_.DenseBatchInc(row_oplog, updates, index_st, num_updates);
   }
   MetaRowOpLog *meta_row_oplog
       = dynamic_cast<MetaRowOpLog*>(row_oplog);
@@ -5,6 +5,7 @@
 #include <petuum_ps_common/util/stats.hpp>
 #include <glog/logging.h>
 #include <algorithm>
+#include <set>
 
 namespace petuum {
 
@@ -23,16 +24,8 @@ SSPConsistencyController::SSPConsistencyController(
   thread_cache_(thread_cache),
   oplog_index_(oplog_index),
   oplog_(oplog),
-  version_maintain_(info.version_maintain) {
-  AddUpdates_ = std::bind(&AbstractRow::AddUpdates,
-                          sample_row_, std::placeholders::_1,
-                          std::placeholders::_2, std::placeholders::_3);
-  if (row_oplog_type == RowOpLogType::kDenseRowOpLog) {
-    DenseBatchIncOpLog_ = &SSPConsistencyController::DenseBatchIncDenseOpLog;
-  } else {
-    DenseBatchIncOpLog_ = &SSPConsistencyController::DenseBatchIncNonDenseOpLog;
-  }
-}
+  oplog_accum_(sample_row, RowOpLogAccumulator::IsContiguous(row_oplog_type)),
+  version_maintain_(info.version_maintain) { }
 
 ClientRow *SSPConsistencyController::Get(int32_t row_id, RowAccessor* row_accessor) {
   STATS_APP_SAMPLE_SSP_GET_BEGIN(table_id_);
@@ -75,6 +68,51 @@ ClientRow *SSPConsistencyController::Get(int32_t row_id, RowAccessor* row_access
   return client_row;
 }
 
+void SSPConsistencyController::GetBatch(const int32_t *row_ids,
+                                        int32_t num_rows,
+                                        RowAccessor *row_accessors) {
+  int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
+
+  std::vector<int32_t> miss_idx;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    STATS_APP_SAMPLE_SSP_GET_BEGIN(table_id_);
+    ClientRow *client_row = process_storage_.Find(row_ids[i],
+                                                  &row_accessors[i]);
+    if (client_row != 0 && client_row->GetClock() >= stalest_clock) {
+      STATS_APP_SAMPLE_SSP_GET_END(table_id_, true);
+      continue;
+    }
+    STATS_APP_SAMPLE_SSP_GET_END(table_id_, false);
+    miss_idx.push_back(i);
+  }
+
+  if (!miss_idx.empty())
+    FetchRowBatch(row_ids, miss_idx, stalest_clock, row_accessors);
+}
+
+void SSPConsistencyController::FetchRowBatch(
+    const int32_t *row_ids, const std::vector<int32_t> &miss_idx,
+    int32_t stalest_clock, RowAccessor *row_accessors) {
+  // The same row may be asked for more than once.
+  std::set<int32_t> row_id_set;
+  for (auto idx : miss_idx) {
+    row_id_set.insert(row_ids[idx]);
+  }
+  std::vector<int32_t> request_row_ids(row_id_set.begin(), row_id_set.end());
+
+  STATS_APP_ACCUM_SSP_GET_SERVER_FETCH_BEGIN(table_id_);
+  BgWorkers::RequestRowBatch(table_id_, request_row_ids, stalest_clock);
+  STATS_APP_ACCUM_SSP_GET_SERVER_FETCH_END(table_id_);
+
+  for (auto idx : miss_idx) {
+    ClientRow *client_row = process_storage_.Find(row_ids[idx],
+                                                  &row_accessors[idx]);
+    // The row may have been evicted since; Get() fetches it again.
+    if (client_row == 0 || client_row->GetClock() < stalest_clock)
+      Get(row_ids[idx], &row_accessors[idx]);
+  }
+}
+
 void SSPConsistencyController::Inc(int32_t row_id, int32_t column_id,
     const void* delta) {
   //LOG(INFO) << "row_id = " << row_id;
@@ -83,8 +121,7 @@ void SSPConsistencyController::Inc(int32_t row_id, int32_t column_id,
   OpLogAccessor oplog_accessor;
   oplog_.FindInsertOpLog(row_id, &oplog_accessor);
 
-  void *oplog_delta = oplog_accessor.get_row_oplog()->FindCreate(column_id);
-  sample_row_->AddUpdates(column_id, oplog_delta, delta);
+  oplog_accum_.Inc(oplog_accessor.get_row_oplog(), column_id, delta);
 
   if (!version_maintain_) {
     RowAccessor row_accessor;
@@ -104,14 +141,8 @@ void SSPConsistencyController::BatchInc(int32_t row_id,
   OpLogAccessor oplog_accessor;
   oplog_.FindInsertOpLog(row_id, &oplog_accessor);
 
-  const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-
-  for (int i = 0; i < num_updates; ++i) {
-    void *oplog_delta
-        = oplog_accessor.get_row_oplog()->FindCreate(column_ids[i]);
-    sample_row_->AddUpdates(column_ids[i], oplog_delta, deltas_uint8
-			    + sample_row_->get_update_size()*i);
-  }
+  oplog_accum_.BatchInc(oplog_accessor.get_row_oplog(), column_ids, updates,
+                        num_updates);
   STATS_APP_SAMPLE_BATCH_INC_OPLOG_END();
 
   if (!version_maintain_) {
@@ -140,9 +171,7 @@ void SSPConsistencyController::DenseBatchInc(
   if (new_create) {
     row_oplog->OverwriteWithDenseUpdate(updates, index_st, num_updates);
   } else {
-    const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-    (this->*DenseBatchIncOpLog_)(row_oplog, deltas_uint8,
-                                 index_st, num_updates);
+    oplog_accum_.DenseBatchInc(row_oplog, updates, index_st, num_updates);
   }
 
   STATS_APP_SAMPLE_BATCH_INC_OPLOG_END();
@@ -159,45 +188,6 @@ void SSPConsistencyController::DenseBatchInc(
   }
 }
 
-//void SSPConsistencyController::DenseBatchIncDenseOpLog(
-//    AbstractRowOpLog *row_oplog, const uint8_t *updates,
-//    int32_t index_st, int32_t num_updates) {
-//  size_t update_size = sample_row_->get_update_size();
-//  uint8_t *oplog_delta = reinterpret_cast<uint8_t*>(
-//      row_oplog->FindCreate(index_st));
-//  for (int i = 0; i < num_updates; ++i) {
-//    int32_t col_id = i + index_st;
-//    AddUpdates_(col_id, oplog_delta, updates + update_size*i);
-//    oplog_delta += update_size;
-//  }
-//}
-
-void SSPConsistencyController::DenseBatchIncDenseOpLog(
-    AbstractRowOpLog *row_oplog, const uint8_t *updates,
-    int32_t index_st, int32_t num_updates) {
-  size_t update_size = sample_row_->get_update_size();
-  CHECK_EQ(update_size, sizeof(float));
-  float *oplog_delta = reinterpret_cast<float*>(
-      row_oplog->FindCreate(index_st));
-  const float *updates_float = reinterpret_cast<const float*>(updates);
-  for (int i = 0; i < num_updates; ++i) {
-    int32_t col_id = i + index_st;
-    oplog_delta[col_id] += updates_float[col_id];
-  }
-}
-
-void SSPConsistencyController::DenseBatchIncNonDenseOpLog(
-    AbstractRowOpLog *row_oplog, const uint8_t *updates,
-    int32_t index_st, int32_t num_updates) {
-  size_t update_size = sample_row_->get_update_size();
-  for (int i = 0; i < num_updates; ++i) {
-    int32_t col_id = i + index_st;
-    void *oplog_delta
-        = row_oplog->FindCreate(col_id);
-    sample_row_->AddUpdates(col_id, oplog_delta, updates + update_size*i);
-  }
-}
-
 void SSPConsistencyController::ThreadGet(int32_t row_id,
   ThreadRowAccessor* row_accessor) {
   STATS_APP_SAMPLE_THREAD_GET_BEGIN(table_id_);
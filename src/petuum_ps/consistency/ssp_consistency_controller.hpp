@@ -3,6 +3,7 @@
 
 #include <petuum_ps_common/consistency/abstract_consistency_controller.hpp>
 #include <petuum_ps/oplog/abstract_oplog.hpp>
+#include <petuum_ps/oplog/row_oplog_accumulator.hpp>
 #include <petuum_ps_common/util/vector_clock_mt.hpp>
 #include <petuum_ps/client/thread_table.hpp>
 #include <utility>
@@ -10,8 +11,6 @@
 #include <cstdint>
 #include <atomic>
 
-#include <functional>
-
 namespace petuum {
 
 class SSPConsistencyController : public AbstractConsistencyController {
@@ -37,6 +36,11 @@ public:
   // in storage.
   virtual ClientRow *Get(int32_t row_id, RowAccessor* row_accessor);
 
+  // Rows that are missing or too stale are requested together, one message
+  // per server, instead of one round trip each.
+  virtual void GetBatch(const int32_t *row_ids, int32_t num_rows,
+                        RowAccessor *row_accessors);
+
   // Return immediately.
   virtual void Inc(int32_t row_id, int32_t column_id, const void* delta);
 
@@ -62,13 +66,11 @@ public:
   virtual void Clock();
 
 protected:
-  void DenseBatchIncDenseOpLog(AbstractRowOpLog *row_oplog, const uint8_t *updates,
-                               int32_t index_st, int32_t num_updates);
-  void DenseBatchIncNonDenseOpLog(AbstractRowOpLog *row_oplog, const uint8_t *updates,
-                                  int32_t index_st, int32_t num_updates);
-  typedef void (SSPConsistencyController::*DenseBatchIncOpLogFunc)(
-      AbstractRowOpLog *row_oplog, const uint8_t *updates,
-      int32_t index_st, int32_t num_updates);
+  // Request row_ids[i] for each i in miss_idx in one batch, then look them
+  // up again into row_accessors[i].
+  void FetchRowBatch(const int32_t *row_ids,
+                     const std::vector<int32_t> &miss_idx,
+                     int32_t stalest_clock, RowAccessor *row_accessors);
 
   // SSP staleness parameter.
   int32_t staleness_;
@@ -80,9 +82,9 @@ protected:
   // all local updates are reflected in the row values.
   AbstractOpLog& oplog_;
 
-  typedef std::function<void(int32_t, void*, const void*)> AddUpdatesFunc;
-  AddUpdatesFunc AddUpdates_;
-  DenseBatchIncOpLogFunc DenseBatchIncOpLog_;
+  // Accumulates updates into oplog_'s row oplogs, specialized for the row
+  // type at table creation.
+  RowOpLogAccumulator oplog_accum_;
 
   bool version_maintain_;
 };
@@ -74,18 +74,7 @@ ClientRow *SSPPushConsistencyController::Get(int32_t row_id,
   // Look for row_id in process_storage_.
   int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
 
-  if (ThreadContext::GetCachedSystemClock() < stalest_clock) {
-    int32_t system_clock = BgWorkers::GetSystemClock();
-    if (system_clock < stalest_clock) {
-      //LOG(INFO) << "system_clock = " << system_clock
-      //        << " stalest_clock = " << stalest_clock;
-      STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id_);
-      BgWorkers::WaitSystemClock(stalest_clock);
-      STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_END(table_id_);
-      system_clock = BgWorkers::GetSystemClock();
-    }
-    ThreadContext::SetCachedSystemClock(system_clock);
-  }
+  WaitSystemClock(stalest_clock);
 
   ClientRow *client_row = process_storage_.Find(row_id, row_accessor);
 
@@ -116,6 +105,45 @@ ClientRow *SSPPushConsistencyController::Get(int32_t row_id,
   return client_row;
 }
 
+void SSPPushConsistencyController::GetBatch(const int32_t *row_ids,
+                                            int32_t num_rows,
+                                            RowAccessor *row_accessors) {
+  int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
+
+  WaitSystemClock(stalest_clock);
+
+  // Rows in storage are kept fresh by server push; only absent rows need a
+  // fetch.
+  std::vector<int32_t> miss_idx;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    STATS_APP_SAMPLE_SSP_GET_BEGIN(table_id_);
+    ClientRow *client_row = process_storage_.Find(row_ids[i],
+                                                  &row_accessors[i]);
+    STATS_APP_SAMPLE_SSP_GET_END(table_id_, client_row != 0);
+    if (client_row == 0)
+      miss_idx.push_back(i);
+  }
+
+  if (!miss_idx.empty())
+    FetchRowBatch(row_ids, miss_idx, stalest_clock, row_accessors);
+}
+
+void SSPPushConsistencyController::WaitSystemClock(int32_t stalest_clock) {
+  if (ThreadContext::GetCachedSystemClock() >= stalest_clock)
+    return;
+
+  int32_t system_clock = BgWorkers::GetSystemClock();
+  if (system_clock < stalest_clock) {
+    //LOG(INFO) << "system_clock = " << system_clock
+    //        << " stalest_clock = " << stalest_clock;
+    STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id_);
+    BgWorkers::WaitSystemClock(stalest_clock);
+    STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_END(table_id_);
+    system_clock = BgWorkers::GetSystemClock();
+  }
+  ThreadContext::SetCachedSystemClock(system_clock);
+}
+
 void SSPPushConsistencyController::ThreadGet(
     int32_t row_id, ThreadRowAccessor* row_accessor) {
   STATS_APP_SAMPLE_THREAD_GET_BEGIN(table_id_);
@@ -123,16 +151,7 @@ void SSPPushConsistencyController::ThreadGet(
   // Look for row_id in process_storage_.
   int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
 
-  if (ThreadContext::GetCachedSystemClock() < stalest_clock) {
-    int32_t system_clock = BgWorkers::GetSystemClock();
-    if(system_clock < stalest_clock) {
-      STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id_);
-      BgWorkers::WaitSystemClock(stalest_clock);
-      STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_END(table_id_);
-      system_clock = BgWorkers::GetSystemClock();
-    }
-    ThreadContext::SetCachedSystemClock(system_clock);
-  }
+  WaitSystemClock(stalest_clock);
 
   AbstractRow *row_data = thread_cache_->GetRow(row_id);
   if (row_data != 0) {
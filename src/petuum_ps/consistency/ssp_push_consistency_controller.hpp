@@ -30,9 +30,16 @@ public:
   // in storage.
   ClientRow *Get(int32_t row_id, RowAccessor* row_accessor);
 
+  void GetBatch(const int32_t *row_ids, int32_t num_rows,
+                RowAccessor *row_accessors);
+
   void ThreadGet(int32_t row_id, ThreadRowAccessor* row_accessor);
 
 private:
+  // Block until the system clock reaches stalest_clock, so that pushed rows
+  // in process storage are fresh enough.
+  void WaitSystemClock(int32_t stalest_clock);
+
   static const size_t kMaxPendingAsyncGetCnt = 256;
   boost::thread_specific_ptr<size_t> pending_async_get_cnt_;
 };
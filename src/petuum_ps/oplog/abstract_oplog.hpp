@@ -11,6 +11,7 @@
 #include <petuum_ps_common/include/abstract_row.hpp>
 #include <petuum_ps/oplog/row_oplog_meta.hpp>
 #include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps/oplog/row_oplog_pool.hpp>
 
 namespace petuum {
 class OpLogAccessor {
@@ -79,6 +80,12 @@ public:
       int32_t row_id, RowOpLogMeta *row_oplog_meta) = 0;
 
   virtual AbstractAppendOnlyBuffer *GetAppendOnlyBuffer(int32_t comm_channel_idx) = 0;
+
+  // Where erased row oplogs go back to once sent, 0 if they are to be
+  // deleted.
+  virtual RowOpLogPool *get_row_oplog_pool() {
+    return 0;
+  }
 };
 
 }   // namespace petuum
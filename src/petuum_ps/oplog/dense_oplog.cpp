@@ -10,10 +10,12 @@
 
 namespace petuum {
 
-DenseOpLog::DenseOpLog(int capacity, const AbstractRow *sample_row,
+DenseOpLog::DenseOpLog(int32_t table_id, int capacity,
+                       const AbstractRow *sample_row,
                        size_t dense_row_oplog_capacity,
                        int32_t row_oplog_type,
                        bool version_maintain):
+  table_id_(table_id),
   update_size_(sample_row->get_update_size()),
   locks_(GlobalContext::GetLockPoolSize(capacity)),
   oplog_vec_(capacity, reinterpret_cast<AbstractRowOpLog*>(0)),
@@ -45,6 +47,9 @@ DenseOpLog::DenseOpLog(int capacity, const AbstractRow *sample_row,
     else
       CreateRowOpLog_ = CreateRowOpLog::CreateSparseVectorRowOpLog;
   }
+  row_oplog_pool_.reset(new RowOpLogPool(CreateRowOpLog_, update_size_,
+                                         sample_row_,
+                                         dense_row_oplog_capacity_));
 }
 
 DenseOpLog::~DenseOpLog() {
@@ -222,8 +227,8 @@ AbstractRowOpLog *DenseOpLog::FindRowOpLog(int32_t row_id) {
 
 AbstractRowOpLog *DenseOpLog::CreateAndInsertRowOpLog(int32_t row_id) {
   int32_t vec_index = GetVecIndex(row_id);
-  AbstractRowOpLog* row_oplog = CreateRowOpLog_(update_size_, sample_row_,
-                                                dense_row_oplog_capacity_);
+  AbstractRowOpLog* row_oplog = row_oplog_pool_->Get(
+      GlobalContext::GetPartitionCommChannelIndex(table_id_, row_id));
   oplog_vec_[vec_index] = row_oplog;
   return row_oplog;
 }
@@ -5,11 +5,13 @@
 #include <petuum_ps/oplog/abstract_oplog.hpp>
 
 #include <petuum_ps_common/util/striped_lock.hpp>
+#include <boost/scoped_ptr.hpp>
 
 namespace petuum {
 class DenseOpLog : public AbstractOpLog {
 public:
-  DenseOpLog(int32_t capacity, const AbstractRow *sample_row,
+  DenseOpLog(int32_t table_id, int32_t capacity,
+             const AbstractRow *sample_row,
              size_t dense_row_oplog_capacity,
              int32_t row_oplog_type,
              bool version_maintain);
@@ -50,6 +52,10 @@ public:
   AbstractAppendOnlyBuffer *GetAppendOnlyBuffer(int32_t comm_channel_idx);
   void PutBackBuffer(int32_t comm_channel_idx, AbstractAppendOnlyBuffer* buff);
 
+  RowOpLogPool *get_row_oplog_pool() {
+    return row_oplog_pool_.get();
+  }
+
 private:
 
   AbstractRowOpLog *FindRowOpLog(int32_t row_id);
@@ -57,12 +63,14 @@ private:
 
   int32_t GetVecIndex(int32_t row_id);
 
+  const int32_t table_id_;
   const size_t update_size_;
   StripedLock<int32_t> locks_;
   std::vector<AbstractRowOpLog*> oplog_vec_;
   const AbstractRow *sample_row_;
   const size_t dense_row_oplog_capacity_;
   CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog_;
+  boost::scoped_ptr<RowOpLogPool> row_oplog_pool_;
   const size_t capacity_;
 };
 
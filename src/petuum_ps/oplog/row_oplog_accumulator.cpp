@@ -0,0 +1,44 @@
+#include <petuum_ps/oplog/row_oplog_accumulator.hpp>
+#include <petuum_ps_common/include/configs.hpp>
+
+namespace petuum {
+
+RowOpLogAccumulator::RowOpLogAccumulator(const AbstractRow *sample_row,
+                                         bool contiguous_oplog):
+    sample_row_(sample_row),
+    Inc_(IncGeneric),
+    BatchInc_(BatchIncGeneric),
+    DenseBatchInc_(DenseBatchIncGeneric) {
+  switch (sample_row->get_update_value_type()) {
+    case UpdateValueType::kFloat:
+      SetTypedFuncs<float>(contiguous_oplog);
+      break;
+    case UpdateValueType::kDouble:
+      SetTypedFuncs<double>(contiguous_oplog);
+      break;
+    case UpdateValueType::kInt32:
+      SetTypedFuncs<int32_t>(contiguous_oplog);
+      break;
+    default:
+      break;
+  }
+}
+
+template<typename V>
+void RowOpLogAccumulator::SetTypedFuncs(bool contiguous) {
+  Inc_ = IncTyped<V>;
+  if (contiguous) {
+    BatchInc_ = BatchIncTypedContiguous<V>;
+    DenseBatchInc_ = DenseBatchIncTypedContiguous<V>;
+  } else {
+    BatchInc_ = BatchIncTyped<V>;
+    DenseBatchInc_ = DenseBatchIncTyped<V>;
+  }
+}
+
+bool RowOpLogAccumulator::IsContiguous(int32_t row_oplog_type) {
+  return row_oplog_type == RowOpLogType::kDenseRowOpLog
+      || row_oplog_type == RowOpLogType::kDenseRowOpLogFloat16;
+}
+
+}  // namespace petuum
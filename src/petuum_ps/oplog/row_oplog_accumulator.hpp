@@ -0,0 +1,145 @@
+#pragma once
+
+#include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+#include <petuum_ps_common/util/dense_kernels.hpp>
+
+#include <stdint.h>
+
+namespace petuum {
+
+// Accumulates application updates into row oplogs. The functions are picked
+// once per table: rows with plain additive updates of a common numeric type
+// (see AbstractRow::get_update_value_type()) get typed loops with no virtual
+// call per update, and dense row oplogs, whose updates are stored
+// contiguously, are added to in a single pass. Others go through
+// AbstractRow::AddUpdates() for each update.
+class RowOpLogAccumulator {
+public:
+  // contiguous_oplog tells whether the row oplogs this accumulates into hold
+  // the update of column i at FindCreate(0) + i (dense row oplogs).
+  RowOpLogAccumulator(const AbstractRow *sample_row, bool contiguous_oplog);
+
+  void Inc(AbstractRowOpLog *row_oplog, int32_t column_id,
+           const void *delta) const {
+    Inc_(sample_row_, row_oplog, column_id, delta);
+  }
+
+  void BatchInc(AbstractRowOpLog *row_oplog, const int32_t *column_ids,
+                const void *updates, int32_t num_updates) const {
+    BatchInc_(sample_row_, row_oplog, column_ids, updates, num_updates);
+  }
+
+  void DenseBatchInc(AbstractRowOpLog *row_oplog, const void *updates,
+                     int32_t index_st, int32_t num_updates) const {
+    DenseBatchInc_(sample_row_, row_oplog, updates, index_st, num_updates);
+  }
+
+  // Whether the table oplog creates contiguous row oplogs for
+  // row_oplog_type.
+  static bool IsContiguous(int32_t row_oplog_type);
+
+private:
+  typedef void (*IncFunc)(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      int32_t column_id, const void *delta);
+
+  typedef void (*BatchIncFunc)(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const int32_t *column_ids, const void *updates, int32_t num_updates);
+
+  typedef void (*DenseBatchIncFunc)(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const void *updates, int32_t index_st, int32_t num_updates);
+
+  template<typename V>
+  void SetTypedFuncs(bool contiguous);
+
+  static void IncGeneric(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      int32_t column_id, const void *delta) {
+    void *oplog_delta = row_oplog->FindCreate(column_id);
+    sample_row->AddUpdates(column_id, oplog_delta, delta);
+  }
+
+  static void BatchIncGeneric(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const int32_t *column_ids, const void *updates, int32_t num_updates) {
+    const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+    size_t update_size = sample_row->get_update_size();
+    for (int32_t i = 0; i < num_updates; ++i) {
+      void *oplog_delta = row_oplog->FindCreate(column_ids[i]);
+      sample_row->AddUpdates(column_ids[i], oplog_delta,
+                             updates_uint8 + update_size*i);
+    }
+  }
+
+  static void DenseBatchIncGeneric(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const void *updates, int32_t index_st, int32_t num_updates) {
+    const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+    size_t update_size = sample_row->get_update_size();
+    for (int32_t i = 0; i < num_updates; ++i) {
+      int32_t col_id = i + index_st;
+      void *oplog_delta = row_oplog->FindCreate(col_id);
+      sample_row->AddUpdates(col_id, oplog_delta,
+                             updates_uint8 + update_size*i);
+    }
+  }
+
+  template<typename V>
+  static void IncTyped(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      int32_t column_id, const void *delta) {
+    *reinterpret_cast<V*>(row_oplog->FindCreate(column_id))
+        += *reinterpret_cast<const V*>(delta);
+  }
+
+  template<typename V>
+  static void BatchIncTyped(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const int32_t *column_ids, const void *updates, int32_t num_updates) {
+    const V *typed_updates = reinterpret_cast<const V*>(updates);
+    for (int32_t i = 0; i < num_updates; ++i) {
+      *reinterpret_cast<V*>(row_oplog->FindCreate(column_ids[i]))
+          += typed_updates[i];
+    }
+  }
+
+  template<typename V>
+  static void BatchIncTypedContiguous(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const int32_t *column_ids, const void *updates, int32_t num_updates) {
+    V *oplog_base = reinterpret_cast<V*>(row_oplog->FindCreate(0));
+    const V *typed_updates = reinterpret_cast<const V*>(updates);
+    for (int32_t i = 0; i < num_updates; ++i) {
+      oplog_base[column_ids[i]] += typed_updates[i];
+    }
+  }
+
+  template<typename V>
+  static void DenseBatchIncTyped(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const void *updates, int32_t index_st, int32_t num_updates) {
+    const V *typed_updates = reinterpret_cast<const V*>(updates);
+    for (int32_t i = 0; i < num_updates; ++i) {
+      *reinterpret_cast<V*>(row_oplog->FindCreate(i + index_st))
+          += typed_updates[i];
+    }
+  }
+
+  template<typename V>
+  static void DenseBatchIncTypedContiguous(
+      const AbstractRow *sample_row, AbstractRowOpLog *row_oplog,
+      const void *updates, int32_t index_st, int32_t num_updates) {
+    DenseKernels::Add(reinterpret_cast<V*>(row_oplog->FindCreate(index_st)),
+                      reinterpret_cast<const V*>(updates), num_updates);
+  }
+
+  const AbstractRow *sample_row_;
+  IncFunc Inc_;
+  BatchIncFunc BatchInc_;
+  DenseBatchIncFunc DenseBatchInc_;
+};
+
+}  // namespace petuum
@@ -0,0 +1,116 @@
+#include <petuum_ps/oplog/row_oplog_pool.hpp>
+#include <petuum_ps/oplog/meta_row_oplog.hpp>
+#include <petuum_ps/thread/context.hpp>
+#include <petuum_ps_common/util/stats.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace petuum {
+
+RowOpLogPool::RowOpLogPool(
+    CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog,
+    size_t update_size, const AbstractRow *sample_row,
+    size_t dense_row_oplog_capacity):
+    CreateRowOpLog_(CreateRowOpLog),
+    update_size_(update_size),
+    sample_row_(sample_row),
+    dense_row_oplog_capacity_(dense_row_oplog_capacity),
+    num_free_lists_(GlobalContext::get_num_comm_channels_per_client()),
+    free_lists_(new FreeList[num_free_lists_]),
+    num_in_use_(0) {
+  for (int32_t i = 0; i < num_free_lists_; ++i) {
+    free_lists_[i].num_taken = 0;
+    free_lists_[i].num_missed = 0;
+    // Unbounded until the first Refill() measures a clock.
+    free_lists_[i].capacity = std::numeric_limits<size_t>::max();
+  }
+}
+
+RowOpLogPool::~RowOpLogPool() {
+  for (int32_t i = 0; i < num_free_lists_; ++i) {
+    for (auto row_oplog : free_lists_[i].row_oplogs)
+      delete row_oplog;
+  }
+}
+
+AbstractRowOpLog *RowOpLogPool::Get(int32_t comm_channel_idx) {
+  size_t num_in_use
+      = num_in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+  FreeList &free_list = free_lists_[comm_channel_idx];
+  {
+    std::lock_guard<std::mutex> lock(free_list.mtx);
+    ++free_list.num_taken;
+    if (!free_list.row_oplogs.empty()) {
+      AbstractRowOpLog *row_oplog = free_list.row_oplogs.back();
+      free_list.row_oplogs.pop_back();
+      STATS_APP_ROW_OPLOG_RECYCLED(num_in_use);
+      return row_oplog;
+    }
+    ++free_list.num_missed;
+  }
+  AbstractRowOpLog *row_oplog = Create();
+  STATS_APP_ROW_OPLOG_CREATED(num_in_use);
+  return row_oplog;
+}
+
+void RowOpLogPool::PutBack(int32_t comm_channel_idx,
+                           AbstractRowOpLog *row_oplog) {
+  num_in_use_.fetch_sub(1, std::memory_order_relaxed);
+  FreeList &free_list = free_lists_[comm_channel_idx];
+  {
+    std::lock_guard<std::mutex> lock(free_list.mtx);
+    if (free_list.row_oplogs.size() < free_list.capacity) {
+      ResetRowOpLog(row_oplog);
+      free_list.row_oplogs.push_back(row_oplog);
+      return;
+    }
+  }
+  delete row_oplog;
+}
+
+void RowOpLogPool::Refill(int32_t comm_channel_idx) {
+  FreeList &free_list = free_lists_[comm_channel_idx];
+  std::vector<AbstractRowOpLog*> surplus;
+  size_t num_to_create = 0;
+  {
+    std::lock_guard<std::mutex> lock(free_list.mtx);
+    free_list.capacity = free_list.num_taken;
+    size_t num_free = free_list.row_oplogs.size();
+    if (num_free > free_list.capacity) {
+      surplus.assign(free_list.row_oplogs.begin() + free_list.capacity,
+                     free_list.row_oplogs.end());
+      free_list.row_oplogs.resize(free_list.capacity);
+    } else {
+      num_to_create = std::min(free_list.num_missed,
+                               free_list.capacity - num_free);
+    }
+    free_list.num_taken = 0;
+    free_list.num_missed = 0;
+  }
+  for (auto row_oplog : surplus)
+    delete row_oplog;
+  if (num_to_create == 0)
+    return;
+
+  std::vector<AbstractRowOpLog*> row_oplogs(num_to_create);
+  for (auto &row_oplog : row_oplogs)
+    row_oplog = Create();
+
+  std::lock_guard<std::mutex> lock(free_list.mtx);
+  free_list.row_oplogs.insert(free_list.row_oplogs.end(),
+                              row_oplogs.begin(), row_oplogs.end());
+}
+
+void RowOpLogPool::ResetRowOpLog(AbstractRowOpLog *row_oplog) {
+  row_oplog->Reset();
+  MetaRowOpLog *meta_row_oplog = dynamic_cast<MetaRowOpLog*>(row_oplog);
+  if (meta_row_oplog != 0)
+    meta_row_oplog->SetMeta(RowOpLogMeta());
+}
+
+AbstractRowOpLog *RowOpLogPool::Create() {
+  return CreateRowOpLog_(update_size_, sample_row_, dense_row_oplog_capacity_);
+}
+
+}  // namespace petuum
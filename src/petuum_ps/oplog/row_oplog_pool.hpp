@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+#include <petuum_ps/oplog/create_row_oplog.hpp>
+
+namespace petuum {
+
+// Row oplogs of a table are created when a row is first updated in a clock
+// and handed to a bg worker when the clock's updates are sent. The pool
+// takes them back once the bg worker is done with them and reuses them,
+// along with the update memory they hold, instead of deleting them.
+//
+// There is a free list per comm channel: row oplogs of a channel are only
+// taken by app threads and returned by that channel's bg worker, which
+// keeps them on the memory node the bg worker is bound to under
+// PETUUM_NUMA (see Refill()).
+//
+// A free list holds at most as many row oplogs as were taken from it in
+// the previous clock. Row oplogs beyond that, e.g. left over from a burst
+// of updates, are deleted when they come back or at the next Refill().
+class RowOpLogPool : boost::noncopyable {
+public:
+  RowOpLogPool(CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog,
+               size_t update_size, const AbstractRow *sample_row,
+               size_t dense_row_oplog_capacity);
+  // Deletes the free row oplogs; the others are owned by the caller.
+  ~RowOpLogPool();
+
+  // Thread-safe. Called by app threads.
+  AbstractRowOpLog *Get(int32_t comm_channel_idx);
+
+  // Thread-safe. Called by the channel's bg worker.
+  void PutBack(int32_t comm_channel_idx, AbstractRowOpLog *row_oplog);
+
+  // Called by the channel's bg worker once per clock. Sets the free list's
+  // capacity to the number of row oplogs taken since the last Refill(),
+  // trims the surplus and creates on the calling thread as many row oplogs
+  // as Get() had to create, so that the next clock finds them on the free
+  // list.
+  void Refill(int32_t comm_channel_idx);
+
+  // Row oplogs taken by Get() and not put back yet.
+  size_t get_num_in_use() const {
+    return num_in_use_.load(std::memory_order_relaxed);
+  }
+
+  // Empties a row oplog as if it were just created.
+  static void ResetRowOpLog(AbstractRowOpLog *row_oplog);
+
+private:
+  struct FreeList {
+    std::mutex mtx;
+    std::vector<AbstractRowOpLog*> row_oplogs;
+    // Get() calls since the last Refill() and how many of them found the
+    // free list empty.
+    size_t num_taken;
+    size_t num_missed;
+    // PutBack() deletes row oplogs that would grow the free list beyond it.
+    size_t capacity;
+  };
+
+  AbstractRowOpLog *Create();
+
+  CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog_;
+  const size_t update_size_;
+  const AbstractRow *sample_row_;
+  const size_t dense_row_oplog_capacity_;
+
+  const int32_t num_free_lists_;
+  boost::scoped_array<FreeList> free_lists_;
+  std::atomic<size_t> num_in_use_;
+};
+
+}  // namespace petuum
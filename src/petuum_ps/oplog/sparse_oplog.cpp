@@ -10,10 +10,12 @@
 
 namespace petuum {
 
-SparseOpLog::SparseOpLog(int capacity, const AbstractRow *sample_row,
+SparseOpLog::SparseOpLog(int32_t table_id, int capacity,
+                         const AbstractRow *sample_row,
                          size_t dense_row_oplog_capacity,
                          int32_t row_oplog_type,
                          bool version_maintain):
+  table_id_(table_id),
   update_size_(sample_row->get_update_size()),
   locks_(GlobalContext::GetLockPoolSize(capacity)),
   oplog_map_(capacity * kCuckooExpansionFactor),
@@ -45,6 +47,9 @@ SparseOpLog::SparseOpLog(int capacity, const AbstractRow *sample_row,
     else
       CreateRowOpLog_ = CreateRowOpLog::CreateSparseVectorRowOpLog;
   }
+  row_oplog_pool_.reset(new RowOpLogPool(CreateRowOpLog_, update_size_,
+                                         sample_row_,
+                                         dense_row_oplog_capacity_));
 }
 
 SparseOpLog::~SparseOpLog() {
@@ -58,8 +63,7 @@ int32_t SparseOpLog::Inc(int32_t row_id, int32_t column_id, const void *delta) {
   locks_.Lock(row_id);
   AbstractRowOpLog *row_oplog = 0;
   if(!oplog_map_.find(row_id, row_oplog)){
-    row_oplog = CreateRowOpLog_(update_size_, sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog(row_id);
     oplog_map_.insert(row_id, row_oplog);
   }
 
@@ -75,8 +79,7 @@ int32_t SparseOpLog::BatchInc(int32_t row_id, const int32_t *column_ids,
   locks_.Lock(row_id);
   AbstractRowOpLog *row_oplog = 0;
   if(!oplog_map_.find(row_id, row_oplog)){
-    row_oplog = CreateRowOpLog_(update_size_, sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog(row_id);
     oplog_map_.insert(row_id, row_oplog);
   }
   const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(deltas);
@@ -115,8 +118,7 @@ bool SparseOpLog::FindInsertOpLog(int32_t row_id,
   AbstractRowOpLog *row_oplog;
   if (!oplog_map_.find(row_id, row_oplog)) {
     new_create = true;
-    row_oplog = CreateRowOpLog_(update_size_, sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog(row_id);
     oplog_map_.insert(row_id, row_oplog);
   }
   oplog_accessor->set_row_oplog(row_oplog);
@@ -145,8 +147,7 @@ AbstractRowOpLog *SparseOpLog::FindOpLog(int row_id) {
 AbstractRowOpLog *SparseOpLog::FindInsertOpLog(int row_id) {
   AbstractRowOpLog *row_oplog;
   if (!oplog_map_.find(row_id, row_oplog)) {
-    row_oplog = CreateRowOpLog_(update_size_, sample_row_,
-                                dense_row_oplog_capacity_);
+    row_oplog = GetNewRowOpLog(row_id);
     oplog_map_.insert(row_id, row_oplog);
   }
   return row_oplog;
@@ -212,4 +213,9 @@ void SparseOpLog::PutBackBuffer(int32_t comm_channel_idx, AbstractAppendOnlyBuff
   LOG(FATAL) << "Unsupported operation for OpLogType";
 }
 
+AbstractRowOpLog *SparseOpLog::GetNewRowOpLog(int32_t row_id) {
+  return row_oplog_pool_->Get(
+      GlobalContext::GetPartitionCommChannelIndex(table_id_, row_id));
+}
+
 }
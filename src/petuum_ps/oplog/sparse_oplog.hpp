@@ -6,11 +6,13 @@
 
 #include <libcuckoo/cuckoohash_map.hh>
 #include <petuum_ps_common/util/striped_lock.hpp>
+#include <boost/scoped_ptr.hpp>
 
 namespace petuum {
 class SparseOpLog : public AbstractOpLog {
 public:
-  SparseOpLog(int32_t capacity, const AbstractRow *sample_row,
+  SparseOpLog(int32_t table_id, int32_t capacity,
+              const AbstractRow *sample_row,
               size_t dense_row_oplog_capacity,
               int32_t row_oplog_type,
               bool version_maintain);
@@ -51,13 +53,21 @@ public:
   AbstractAppendOnlyBuffer *GetAppendOnlyBuffer(int32_t comm_channel_idx);
   void PutBackBuffer(int32_t comm_channel_idx, AbstractAppendOnlyBuffer* buff);
 
+  RowOpLogPool *get_row_oplog_pool() {
+    return row_oplog_pool_.get();
+  }
+
 private:
+  AbstractRowOpLog *GetNewRowOpLog(int32_t row_id);
+
+  const int32_t table_id_;
   const size_t update_size_;
   StripedLock<int32_t> locks_;
   cuckoohash_map<int32_t, AbstractRowOpLog*> oplog_map_;
   const AbstractRow *sample_row_;
   const size_t dense_row_oplog_capacity_;
   CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog_;
+  boost::scoped_ptr<RowOpLogPool> row_oplog_pool_;
 };
 
 }   // namespace petuum
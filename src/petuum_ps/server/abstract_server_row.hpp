@@ -44,11 +44,10 @@ public:
 
   virtual void Unsubscribe(int32_t client_id) = 0;
 
-  virtual bool AppendRowToBuffs(
-      int32_t client_id_st,
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      const void *row_data, size_t row_size, int32_t row_id,
-      int32_t *failed_client_id, uint64_t *num_clients) = 0;
+  // Returns the number of subscribed clients.
+  virtual size_t AppendRecordToPushBodies(std::vector<PushRowBody> *bodies,
+                                          size_t offset,
+                                          size_t record_size) = 0;
 
   virtual bool IsDirty() const = 0;
 
@@ -57,11 +56,6 @@ public:
   virtual void AccumSerializedSizePerClient(
       boost::unordered_map<int32_t, size_t> *client_size_map) = 0;
 
-  virtual void AppendRowToBuffs(
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      const void *row_data, size_t row_size, int32_t row_id,
-      size_t *num_clients) = 0;
-
   virtual double get_importance() = 0;
 
   virtual void AccumImportance(double importance) = 0;
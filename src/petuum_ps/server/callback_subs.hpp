@@ -1,99 +1,155 @@
 #pragma once
 #include <stdint.h>
-#include <bitset>
+#include <vector>
+#include <algorithm>
 
-#include <petuum_ps_common/util/record_buff.hpp>
+#include <petuum_ps/server/push_row_segment.hpp>
+#include <boost/unordered_map.hpp>
 #include <petuum_ps_common/util/stats.hpp>
 #include <petuum_ps/thread/context.hpp>
 #include <glog/logging.h>
 
-#ifndef PETUUM_MAX_NUM_CLIENTS
-#define PETUUM_MAX_NUM_CLIENTS 8
-#endif
-
 namespace petuum {
 
+// Set of clients subscribed to a row, sized by the number of clients at
+// runtime. Like a roaring bitmap container, it is a sorted array of 16-bit
+// client ids while few clients subscribe and turns into a bitmap of
+// get_num_clients() bits once the array would be larger than the bitmap.
+// Either way iteration visits only subscribed clients and the storage stays
+// within min(2 * #subscribers, #clients / 8) bytes.
 class CallBackSubs {
 public:
-  CallBackSubs() { }
-  ~CallBackSubs() { }
+  CallBackSubs():
+      is_bitmap_(false),
+      num_subs_(0) { }
 
   bool Subscribe(int32_t client_id) {
-    bool bit_changed = false;
-    if (!subscriptions_.test(client_id)) {
-      bit_changed = true;
-      subscriptions_.set(client_id);
+    CHECK_LT(client_id, kMaxNumClients);
+    if (is_bitmap_) {
+      uint16_t &word = data_[client_id / kWordBits];
+      uint16_t mask = 1 << (client_id % kWordBits);
+      if (word & mask)
+        return false;
+      word |= mask;
+    } else {
+      std::vector<uint16_t>::iterator iter
+          = std::lower_bound(data_.begin(), data_.end(), client_id);
+      if (iter != data_.end() && *iter == client_id)
+        return false;
+      data_.insert(iter, client_id);
+      if (data_.size() > GetNumBitmapWords())
+        ToBitmap();
     }
-    return bit_changed;
+    ++num_subs_;
+    return true;
   }
 
   bool Unsubscribe(int32_t client_id) {
-    bool bit_changed = false;
-    if (subscriptions_.test(client_id)) {
-      bit_changed = true;
-      subscriptions_.reset(client_id);
+    if (is_bitmap_) {
+      uint16_t &word = data_[client_id / kWordBits];
+      uint16_t mask = 1 << (client_id % kWordBits);
+      if (!(word & mask))
+        return false;
+      word &= ~mask;
+      --num_subs_;
+      // Leave some slack so a row on the border does not flip back and
+      // forth.
+      if (num_subs_ < data_.size() / 2)
+        ToArray();
+    } else {
+      std::vector<uint16_t>::iterator iter
+          = std::lower_bound(data_.begin(), data_.end(), client_id);
+      if (iter == data_.end() || *iter != client_id)
+        return false;
+      data_.erase(iter);
+      --num_subs_;
     }
-    return bit_changed;
+    return true;
   }
 
-  bool AppendRowToBuffs(
-      int32_t client_id_st,
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      const void *row_data, size_t row_size, int32_t row_id,
-      int32_t *failed_client_id, size_t *num_clients) {
-    // Some simple tests show that iterating bitset isn't too bad.
-    // For bitset size below 512, it takes 200~300 ns on an Intel i5 CPU.
-    for (int32_t client_id = client_id_st;
-         client_id < GlobalContext::get_num_clients(); ++client_id) {
-      if (subscriptions_.test(client_id)) {
-        bool suc = (*buffs)[client_id].Append(row_id, row_data, row_size);
-        if (!suc) {
-          *failed_client_id = client_id;
-          return false;
-        }
-        ++(*num_clients);
-      }
-    }
-    STATS_SERVER_ADD_PER_CLOCK_ACCUM_DUP_ROWS_SENT(*num_clients);
-    return true;
+  // Add the record to the push body of every subscribed client and return
+  // the number of them.
+  size_t AppendRecordToPushBodies(std::vector<PushRowBody> *bodies,
+                                  size_t offset, size_t record_size) {
+    size_t num_clients = 0;
+    ForEachClient(0, [&](int32_t client_id) {
+        (*bodies)[client_id].AppendRecord(offset, record_size);
+        ++num_clients;
+        return true;
+      });
+    STATS_SERVER_ADD_PER_CLOCK_ACCUM_DUP_ROWS_SENT(num_clients);
+    return num_clients;
   }
 
   void AccumSerializedSizePerClient(
       boost::unordered_map<int32_t, size_t> *client_size_map,
       size_t serialized_size) {
-    int32_t client_id;
-    for (client_id = 0;
-         client_id < GlobalContext::get_num_clients(); ++client_id) {
-      if (subscriptions_.test(client_id)) {
+    ForEachClient(0, [&](int32_t client_id) {
         (*client_size_map)[client_id] += serialized_size + sizeof(int32_t)
                                          + sizeof(size_t);
+        return true;
+      });
+  }
+
+private:
+  static const int32_t kMaxNumClients = 1 << 16;
+  static const int32_t kWordBits = 16;
+
+  static size_t GetNumBitmapWords() {
+    return (GlobalContext::get_num_clients() + kWordBits - 1) / kWordBits;
+  }
+
+  // Call func on subscribed clients in increasing order, starting from
+  // client_id_st. Stop and return false when func returns false.
+  template<typename Func>
+  bool ForEachClient(int32_t client_id_st, Func func) const {
+    if (is_bitmap_) {
+      for (size_t w = client_id_st / kWordBits; w < data_.size(); ++w) {
+        uint32_t word = data_[w];
+        if (w == client_id_st / kWordBits)
+          word &= ~((1u << (client_id_st % kWordBits)) - 1);
+        while (word != 0) {
+          int32_t bit = __builtin_ctz(word);
+          if (!func(static_cast<int32_t>(w * kWordBits + bit)))
+            return false;
+          word &= word - 1;
+        }
+      }
+    } else {
+      for (std::vector<uint16_t>::const_iterator iter
+               = std::lower_bound(data_.begin(), data_.end(), client_id_st);
+           iter != data_.end(); ++iter) {
+        if (!func(static_cast<int32_t>(*iter)))
+          return false;
       }
     }
+    return true;
   }
 
-  void AppendRowToBuffs(
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      const void *row_data, size_t row_size, int32_t row_id,
-      size_t *num_clients) {
-    // Some simple tests show that iterating bitset isn't too bad.
-    // For bitset size below 512, it takes 200~300 ns on an Intel i5 CPU.
-    int32_t client_id;
-    for (client_id = 0;
-         client_id < GlobalContext::get_num_clients(); ++client_id) {
-      if (subscriptions_.test(client_id)) {
-        bool suc = (*buffs)[client_id].Append(row_id, row_data, row_size);
-        if (!suc) {
-          (*buffs)[client_id].PrintInfo();
-          LOG(FATAL) << "should never happen";
-        } else
-          (*num_clients)++;
-      }
+  void ToBitmap() {
+    std::vector<uint16_t> bitmap(GetNumBitmapWords(), 0);
+    for (uint16_t client_id : data_) {
+      bitmap[client_id / kWordBits] |= 1 << (client_id % kWordBits);
     }
-    STATS_SERVER_ADD_PER_CLOCK_ACCUM_DUP_ROWS_SENT(*num_clients);
+    data_.swap(bitmap);
+    is_bitmap_ = true;
   }
 
-private:
-  std::bitset<PETUUM_MAX_NUM_CLIENTS> subscriptions_;
+  void ToArray() {
+    std::vector<uint16_t> ids;
+    ids.reserve(num_subs_);
+    ForEachClient(0, [&](int32_t client_id) {
+        ids.push_back(client_id);
+        return true;
+      });
+    data_.swap(ids);
+    is_bitmap_ = false;
+  }
+
+  // Sorted client ids, or a bitmap of 16-bit words if is_bitmap_.
+  std::vector<uint16_t> data_;
+  bool is_bitmap_;
+  size_t num_subs_;
 };
 
 }  //namespace petuum
@@ -7,6 +7,7 @@
 #include <pthread.h>
 #include <utility>
 #include <iostream>
+#include <string.h>
 
 namespace petuum {
 
@@ -80,6 +81,15 @@ int32_t NameNodeThread::GetConnection(bool *is_client, int32_t *client_id) {
 
   server_obj_.Init(0, bg_worker_ids_, 0);
 
+  if (!GlobalContext::get_row_placement_file().empty()) {
+    RowPartitioner::ReadPlacements(
+        GlobalContext::get_row_placement_file(),
+        GlobalContext::get_num_comm_channels_per_client(),
+        GlobalContext::get_num_clients(), &row_placements_);
+    LOG(INFO) << "read " << row_placements_.size() << " row placements from "
+              << GlobalContext::get_row_placement_file();
+  }
+
   ConnectServerMsg connect_server_msg;
   SendToAllBgThreads(reinterpret_cast<MsgBase*>(&connect_server_msg));
 
@@ -132,6 +142,27 @@ bool NameNodeThread::HandleShutDownMsg() {
   return false;
 }
 
+void NameNodeThread::SendCreateTableReply(int32_t bg_id, int32_t table_id) {
+  std::vector<RowPlacement> table_placements;
+  for (const auto &placement : row_placements_) {
+    if (placement.table_id == table_id)
+      table_placements.push_back(placement);
+  }
+
+  CreateTableReplyMsg create_table_reply_msg(
+      table_placements.size()*sizeof(RowPlacement));
+  create_table_reply_msg.get_table_id() = table_id;
+  if (!table_placements.empty()) {
+    memcpy(create_table_reply_msg.get_row_placements(),
+           table_placements.data(),
+           table_placements.size()*sizeof(RowPlacement));
+  }
+  size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
+      bg_id, create_table_reply_msg.get_mem(),
+      create_table_reply_msg.get_size());
+  CHECK_EQ(sent_size, create_table_reply_msg.get_size());
+}
+
 void NameNodeThread::HandleCreateTable (int32_t sender_id,
   CreateTableMsg &create_table_msg) {
   int32_t table_id = create_table_msg.get_table_id();
@@ -143,18 +174,14 @@ void NameNodeThread::HandleCreateTable (int32_t sender_id,
     table_info.oplog_dense_serialized = create_table_msg.get_oplog_dense_serialized();
     table_info.row_oplog_type = create_table_msg.get_row_oplog_type();
     table_info.dense_row_oplog_capacity = create_table_msg.get_dense_row_oplog_capacity();
+    table_info.compress_type = create_table_msg.get_compress_type();
     server_obj_.CreateTable(table_id, table_info);
 
     create_table_map_.insert(std::make_pair(table_id, CreateTableInfo())); // access it to call default constructor
     SendToAllServers(reinterpret_cast<MsgBase*>(&create_table_msg));
   }
   if (create_table_map_[table_id].ReceivedFromAllServers()) {
-    CreateTableReplyMsg create_table_reply_msg;
-    create_table_reply_msg.get_table_id() = create_table_msg.get_table_id();
-    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
-        sender_id, create_table_reply_msg.get_mem(),
-        create_table_reply_msg.get_size());
-    CHECK_EQ(sent_size, create_table_reply_msg.get_size());
+    SendCreateTableReply(sender_id, table_id);
     ++create_table_map_[table_id].num_clients_replied_;
     if (HaveCreatedAllTables())
       SendCreatedAllTablesMsg();
@@ -176,10 +203,7 @@ void NameNodeThread::HandleCreateTableReply(
     while (!bgs_to_reply.empty()) {
       int32_t bg_id = bgs_to_reply.front();
       bgs_to_reply.pop();
-      size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
-          bg_id, create_table_reply_msg.get_mem(),
-          create_table_reply_msg.get_size());
-      CHECK_EQ(sent_size, create_table_reply_msg.get_size());
+      SendCreateTableReply(bg_id, table_id);
       ++create_table_map_[table_id].num_clients_replied_;
     }
     if (HaveCreatedAllTables())
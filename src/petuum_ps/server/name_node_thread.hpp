@@ -68,6 +68,8 @@ private:
   bool HandleShutDownMsg(); // returns true if the server may shut down
   void HandleCreateTable(int32_t sender_id, CreateTableMsg &create_table_msg);
   void HandleCreateTableReply(CreateTableReplyMsg &create_table_reply_msg);
+  // The reply carries the table's entries of row_placements_.
+  void SendCreateTableReply(int32_t bg_id, int32_t table_id);
 
   int32_t my_id_;
   pthread_barrier_t *init_barrier_;
@@ -78,5 +80,7 @@ private:
   std::map<int32_t, CreateTableInfo> create_table_map_;
   Server server_obj_;
   int32_t num_shutdown_bgs_;
+  // Read from the row placement file.
+  std::vector<RowPlacement> row_placements_;
 };
 }
@@ -0,0 +1,69 @@
+#include <petuum_ps/server/oplog_apply_pool.hpp>
+
+#include <glog/logging.h>
+
+namespace petuum {
+
+OpLogApplyPool::OpLogApplyPool(int32_t num_workers):
+    num_workers_(num_workers),
+    func_(0),
+    generation_(0),
+    num_running_(0),
+    shutting_down_(false) {
+  CHECK_GT(num_workers, 0);
+  for (int32_t i = 1; i < num_workers; ++i) {
+    workers_.emplace_back(&OpLogApplyPool::WorkerMain, this, i);
+  }
+}
+
+OpLogApplyPool::~OpLogApplyPool() {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    CHECK_EQ(num_running_, 0);
+    shutting_down_ = true;
+    work_cv_.notify_all();
+  }
+  for (auto &worker : workers_)
+    worker.join();
+}
+
+void OpLogApplyPool::Run(const std::function<void(int32_t)> &func) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    func_ = &func;
+    ++generation_;
+    num_running_ = num_workers_ - 1;
+    work_cv_.notify_all();
+  }
+
+  func(0);
+
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (num_running_ > 0)
+    done_cv_.wait(lock);
+  func_ = 0;
+}
+
+void OpLogApplyPool::WorkerMain(int32_t worker_idx) {
+  uint64_t last_generation = 0;
+  while (true) {
+    const std::function<void(int32_t)> *func = 0;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      while (generation_ == last_generation && !shutting_down_)
+        work_cv_.wait(lock);
+      if (shutting_down_)
+        return;
+      last_generation = generation_;
+      func = func_;
+    }
+
+    (*func)(worker_idx);
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (--num_running_ == 0)
+      done_cv_.notify_one();
+  }
+}
+
+}  // namespace petuum
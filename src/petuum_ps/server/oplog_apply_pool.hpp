@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+
+namespace petuum {
+
+// Worker threads a server thread applies the rows of one oplog message
+// with. The server thread itself is worker 0, so a pool of num_workers
+// starts num_workers - 1 threads.
+class OpLogApplyPool : boost::noncopyable {
+public:
+  explicit OpLogApplyPool(int32_t num_workers);
+
+  // Joins the worker threads.
+  ~OpLogApplyPool();
+
+  int32_t get_num_workers() const {
+    return num_workers_;
+  }
+
+  // Call func(worker_idx) once for every worker, worker 0 being the calling
+  // thread, and return when all calls have returned.
+  void Run(const std::function<void(int32_t)> &func);
+
+private:
+  void WorkerMain(int32_t worker_idx);
+
+  const int32_t num_workers_;
+
+  std::mutex mtx_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int32_t)> *func_;
+  // Bumped by every Run() so a worker runs func_ once per call.
+  uint64_t generation_;
+  // Workers other than the caller that have not finished the current Run().
+  int32_t num_running_;
+  bool shutting_down_;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace petuum
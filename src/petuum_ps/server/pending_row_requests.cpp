@@ -0,0 +1,105 @@
+#include <petuum_ps/server/pending_row_requests.hpp>
+
+#include <algorithm>
+#include <glog/logging.h>
+
+namespace petuum {
+
+PendingRowRequests::PendingRowRequests():
+    ring_(kInitRingSize),
+    min_clock_(0),
+    max_clock_(0),
+    num_pending_(0) { }
+
+void PendingRowRequests::Add(int32_t bg_id, int32_t table_id, int32_t row_id,
+                             int32_t clock, bool accept_row_delta,
+                             uint64_t cached_row_version) {
+  if (num_pending_ == 0) {
+    min_clock_ = clock;
+    max_clock_ = clock;
+  } else {
+    int32_t min_clock = std::min(min_clock_, clock);
+    int32_t max_clock = std::max(max_clock_, clock);
+    if (static_cast<size_t>(max_clock - min_clock) >= ring_.size())
+      Grow(min_clock, max_clock);
+    min_clock_ = min_clock;
+    max_clock_ = max_clock;
+  }
+  FulfilledRowRequests::Requester requester = {0, bg_id, accept_row_delta,
+                                               cached_row_version};
+  AddToBucket(&GetBucket(clock), table_id, row_id, requester);
+  ++num_pending_;
+}
+
+bool PendingRowRequests::TakeFulfilled(int32_t clock,
+                                       FulfilledRowRequests *fulfilled) {
+  fulfilled->Clear();
+  if (num_pending_ == 0 || clock < min_clock_)
+    return false;
+
+  bool found = false;
+  for (int32_t c = min_clock_; c <= std::min(clock, max_clock_); ++c) {
+    Bucket &bucket = GetBucket(c);
+    FulfilledRowRequests &requests = bucket.requests;
+    if (requests.requesters.empty())
+      continue;
+    num_pending_ -= requests.requesters.size();
+
+    if (!found) {
+      // Hand the bucket over as is; it gets fulfilled's cleared vectors.
+      fulfilled->rows.swap(requests.rows);
+      fulfilled->requesters.swap(requests.requesters);
+      merge_index_.swap(bucket.row_index);
+      found = true;
+      continue;
+    }
+
+    // A row requested for several of the clocks is still sent once.
+    for (const auto &requester : requests.requesters) {
+      const FulfilledRowRequests::Row &row = requests.rows[requester.row_idx];
+      auto ret = merge_index_.emplace(GetRowKey(row.table_id, row.row_id),
+                                      fulfilled->rows.size());
+      if (ret.second)
+        fulfilled->rows.push_back(row);
+      fulfilled->requesters.push_back(requester);
+      fulfilled->requesters.back().row_idx = ret.first->second;
+    }
+    requests.Clear();
+    bucket.row_index.clear();
+  }
+  merge_index_.clear();
+  min_clock_ = clock + 1;
+  return found;
+}
+
+void PendingRowRequests::AddToBucket(
+    Bucket *bucket, int32_t table_id, int32_t row_id,
+    const FulfilledRowRequests::Requester &requester) {
+  FulfilledRowRequests &requests = bucket->requests;
+  auto ret = bucket->row_index.emplace(GetRowKey(table_id, row_id),
+                                       requests.rows.size());
+  if (ret.second) {
+    FulfilledRowRequests::Row row = {table_id, row_id};
+    requests.rows.push_back(row);
+  }
+  requests.requesters.push_back(requester);
+  requests.requesters.back().row_idx = ret.first->second;
+}
+
+void PendingRowRequests::Grow(int32_t min_clock, int32_t max_clock) {
+  size_t new_size = ring_.size();
+  while (static_cast<size_t>(max_clock - min_clock) >= new_size)
+    new_size *= 2;
+
+  std::vector<Bucket> new_ring(new_size);
+  for (int32_t c = min_clock_; c <= max_clock_; ++c) {
+    Bucket &bucket = GetBucket(c);
+    Bucket &new_bucket = new_ring[c & (new_size - 1)];
+    new_bucket.requests.rows.swap(bucket.requests.rows);
+    new_bucket.requests.requesters.swap(bucket.requests.requesters);
+    new_bucket.row_index.swap(bucket.row_index);
+  }
+  ring_.swap(new_ring);
+}
+
+}  // namespace petuum
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+#include <petuum_ps_common/include/constants.hpp>
+
+namespace petuum {
+
+// Row requests that became fulfilled together. Each requested row is in
+// rows once, however many bg threads asked for it.
+struct FulfilledRowRequests {
+  struct Row {
+    int32_t table_id;
+    int32_t row_id;
+  };
+
+  struct Requester {
+    // index into rows
+    int32_t row_idx;
+    int32_t bg_id;
+    // see RowRequestMsg
+    bool accept_row_delta;
+    uint64_t cached_row_version;
+  };
+
+  std::vector<Row> rows;
+  // In the order the requests arrived.
+  std::vector<Requester> requesters;
+
+  void Clear() {
+    rows.clear();
+    requesters.clear();
+  }
+};
+
+// Row requests parked on a server thread until its min clock reaches the
+// requested clock. Requests are bucketed by clock in a ring indexed by
+// clock modulo the ring size, which covers the clocks between the min clock
+// and the furthest clock requested, i.e. the staleness. Adding a request is
+// O(1) and taking the requests of a clock swaps out its bucket without
+// copying. The ring only grows when a request is further ahead than it
+// covers.
+//
+// Accessed by the server thread only.
+class PendingRowRequests : boost::noncopyable {
+public:
+  PendingRowRequests();
+
+  void Add(int32_t bg_id, int32_t table_id, int32_t row_id, int32_t clock,
+           bool accept_row_delta = false,
+           uint64_t cached_row_version = kNoRowDeltaVersion);
+
+  // Move the requests of clocks up to clock to fulfilled, which is cleared
+  // first. Returns false if there are none.
+  bool TakeFulfilled(int32_t clock, FulfilledRowRequests *fulfilled);
+
+  size_t get_num_pending() const {
+    return num_pending_;
+  }
+
+private:
+  struct Bucket {
+    FulfilledRowRequests requests;
+    // (table id, row id) -> index into requests.rows
+    boost::unordered_map<uint64_t, int32_t> row_index;
+  };
+
+  static uint64_t GetRowKey(int32_t table_id, int32_t row_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(table_id)) << 32)
+        | static_cast<uint32_t>(row_id);
+  }
+
+  static void AddToBucket(Bucket *bucket, int32_t table_id, int32_t row_id,
+                          const FulfilledRowRequests::Requester &requester);
+
+  Bucket &GetBucket(int32_t clock) {
+    return ring_[clock & (ring_.size() - 1)];
+  }
+
+  // Grow the ring to cover [min_clock, max_clock], which contains the
+  // current window.
+  void Grow(int32_t min_clock, int32_t max_clock);
+
+  static const size_t kInitRingSize = 8;
+
+  // Size is a power of 2.
+  std::vector<Bucket> ring_;
+  // Pending requests are of clocks in [min_clock_, max_clock_], which is
+  // less than the ring size wide.
+  int32_t min_clock_;
+  int32_t max_clock_;
+  size_t num_pending_;
+  // Rows of the fulfilled buckets after the first one are merged with it
+  // through this map.
+  boost::unordered_map<uint64_t, int32_t> merge_index_;
+};
+
+}  // namespace petuum
@@ -0,0 +1,119 @@
+#include <petuum_ps/server/push_row_segment.hpp>
+#include <glog/logging.h>
+#include <string.h>
+#include <algorithm>
+
+namespace petuum {
+
+PushRowSegment::PushRowSegment():
+    mem_(new uint8_t[kCapacityInit]),
+    capacity_(kCapacityInit),
+    size_(0),
+    curr_record_offset_(0),
+    ref_count_(1) { }
+
+PushRowSegment::~PushRowSegment() {
+  delete[] mem_;
+}
+
+uint8_t *PushRowSegment::BeginRecord(int32_t row_id, size_t max_row_size) {
+  size_t needed = size_ + sizeof(int32_t) + sizeof(size_t) + max_row_size;
+  if (needed > capacity_) {
+    size_t new_capacity = std::max(capacity_*2, needed);
+    uint8_t *new_mem = new uint8_t[new_capacity];
+    memcpy(new_mem, mem_, size_);
+    delete[] mem_;
+    mem_ = new_mem;
+    capacity_ = new_capacity;
+  }
+  curr_record_offset_ = size_;
+  *(reinterpret_cast<int32_t*>(mem_ + size_)) = row_id;
+  return mem_ + size_ + sizeof(int32_t) + sizeof(size_t);
+}
+
+size_t PushRowSegment::EndRecord(size_t row_size, size_t *record_size) {
+  *(reinterpret_cast<size_t*>(mem_ + curr_record_offset_ + sizeof(int32_t)))
+      = row_size;
+  *record_size = sizeof(int32_t) + sizeof(size_t) + row_size;
+  size_ += *record_size;
+  return curr_record_offset_;
+}
+
+void PushRowSegment::ZmqFree(void *data, void *hint) {
+  reinterpret_cast<PushRowSegment*>(hint)->DecRef();
+}
+
+void PushRowBody::AppendInt32(int32_t val) {
+  const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&val);
+  if (!pieces_.empty() && !pieces_.back().shared) {
+    pieces_.back().size += sizeof(int32_t);
+  } else {
+    Piece piece = {false, owned_.size(), sizeof(int32_t)};
+    pieces_.push_back(piece);
+  }
+  owned_.insert(owned_.end(), bytes, bytes + sizeof(int32_t));
+  size_ += sizeof(int32_t);
+}
+
+void PushRowBody::AppendRecord(size_t offset, size_t record_size) {
+  // Records of consecutive rows a client subscribes to are consecutive in
+  // the segment.
+  if (!pieces_.empty() && pieces_.back().shared
+      && pieces_.back().offset + pieces_.back().size == offset) {
+    pieces_.back().size += record_size;
+  } else {
+    Piece piece = {true, offset, record_size};
+    pieces_.push_back(piece);
+  }
+  size_ += record_size;
+  ++num_records_;
+}
+
+void PushRowBody::CopyTo(uint8_t *mem) const {
+  for (const auto &piece : pieces_) {
+    const uint8_t *src = piece.shared ? segment_->get_mem() + piece.offset
+                         : owned_.data() + piece.offset;
+    memcpy(mem, src, piece.size);
+    mem += piece.size;
+  }
+}
+
+size_t PushRowBody::Send(CommBus *comm_bus, int32_t entity_id,
+                         const void *header, size_t header_size) const {
+  // At most one copied frame before each zero-copy one, plus the last.
+  zmq::message_t *frames = new zmq::message_t[pieces_.size()*2 + 1];
+  int32_t num_frames = 0;
+
+  const uint8_t *header_bytes = reinterpret_cast<const uint8_t*>(header);
+  std::vector<uint8_t> pending(header_bytes, header_bytes + header_size);
+  for (const auto &piece : pieces_) {
+    if (piece.shared && piece.size >= kMinZeroCopySize) {
+      if (!pending.empty()) {
+        frames[num_frames].rebuild(pending.size());
+        memcpy(frames[num_frames].data(), pending.data(), pending.size());
+        ++num_frames;
+        pending.clear();
+      }
+      segment_->IncRef();
+      frames[num_frames].rebuild(segment_->get_mem() + piece.offset,
+                                 piece.size, &PushRowSegment::ZmqFree,
+                                 segment_);
+      ++num_frames;
+    } else {
+      const uint8_t *src = piece.shared ? segment_->get_mem() + piece.offset
+                           : owned_.data() + piece.offset;
+      pending.insert(pending.end(), src, src + piece.size);
+    }
+  }
+  if (!pending.empty()) {
+    frames[num_frames].rebuild(pending.size());
+    memcpy(frames[num_frames].data(), pending.data(), pending.size());
+    ++num_frames;
+  }
+
+  size_t sent_size = comm_bus->SendMultiPart(entity_id, frames, num_frames);
+  delete[] frames;
+  return sent_size;
+}
+
+}  // namespace petuum
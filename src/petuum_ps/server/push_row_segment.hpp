@@ -0,0 +1,113 @@
+// author: jinliang
+#pragma once
+
+#include <petuum_ps_common/comm_bus/comm_bus.hpp>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+// Rows of one server push, each serialized once in the RecordBuff layout
+// (int32_t row id, size_t row size, row data) and shared by the push
+// messages of all clients subscribed to it.
+//
+// Reference counted: the creator holds the first reference and zero-copy
+// zmq frames hold one each until zmq is done sending them, possibly on
+// zmq's io thread.
+class PushRowSegment : boost::noncopyable {
+public:
+  PushRowSegment();
+
+  // Reserve room for a record holding at most max_row_size bytes of row data
+  // and return where the row data goes. Offsets returned so far stay valid,
+  // pointers do not.
+  uint8_t *BeginRecord(int32_t row_id, size_t max_row_size);
+
+  // Finish the record started by BeginRecord(). Return its offset and set
+  // record_size to its size including the record header.
+  size_t EndRecord(size_t row_size, size_t *record_size);
+
+  uint8_t *get_mem() {
+    return mem_;
+  }
+
+  void IncRef() {
+    ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Deletes the segment when the last reference is dropped.
+  void DecRef() {
+    if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  // zmq::free_fn for frames pointing into a segment passed as hint.
+  static void ZmqFree(void *data, void *hint);
+
+private:
+  ~PushRowSegment();
+
+  uint8_t *mem_;
+  size_t capacity_;
+  size_t size_;
+  size_t curr_record_offset_;
+  std::atomic<int32_t> ref_count_;
+
+  static const size_t kCapacityInit = 64*1024;
+};
+
+// The data part of one client's ServerPushRowMsg: table markers owned by
+// the body and the client's records as references into a PushRowSegment.
+// The bytes are those the client used to get in its own RecordBuff, so
+// SerializedRowReader reads them as before.
+class PushRowBody {
+public:
+  explicit PushRowBody(PushRowSegment *segment):
+      segment_(segment),
+      size_(0),
+      num_records_(0) { }
+
+  // Table id, st_separator or st_end.
+  void AppendInt32(int32_t val);
+
+  void AppendRecord(size_t offset, size_t record_size);
+
+  size_t get_size() const {
+    return size_;
+  }
+
+  size_t get_num_records() const {
+    return num_records_;
+  }
+
+  // Copy the body (get_size() bytes) to mem.
+  void CopyTo(uint8_t *mem) const;
+
+  // Send header followed by the body as one multipart message, which the
+  // receiver gets as a single message. Runs of records of at least
+  // kMinZeroCopySize bytes are handed to zmq without copying; the rest is
+  // coalesced with the header.
+  size_t Send(CommBus *comm_bus, int32_t entity_id, const void *header,
+              size_t header_size) const;
+
+private:
+  struct Piece {
+    // Offset into segment_ if shared, otherwise into owned_.
+    bool shared;
+    size_t offset;
+    size_t size;
+  };
+
+  // Below this, copying is cheaper than a zmq message of its own.
+  static const size_t kMinZeroCopySize = 4*1024;
+
+  PushRowSegment *segment_;
+  std::vector<Piece> pieces_;
+  std::vector<uint8_t> owned_;
+  size_t size_;
+  size_t num_records_;
+};
+
+}  // namespace petuum
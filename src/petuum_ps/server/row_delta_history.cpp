@@ -0,0 +1,80 @@
+#include <petuum_ps/server/row_delta_history.hpp>
+
+#include <string.h>
+#include <boost/unordered_map.hpp>
+
+namespace petuum {
+
+RowDeltaHistory::RowDeltaHistory():
+    version_(0),
+    first_version_(0),
+    size_(0) { }
+
+void RowDeltaHistory::Record(int32_t client_id, const int32_t *column_ids,
+                             const void *updates, int32_t num_updates,
+                             bool dense, size_t update_size,
+                             size_t max_size) {
+  entries_.push_back(Entry());
+  Entry &entry = entries_.back();
+  entry.client_id = client_id;
+  entry.num_updates = num_updates;
+  if (!dense)
+    entry.column_ids.assign(column_ids, column_ids + num_updates);
+  const uint8_t *update_bytes = reinterpret_cast<const uint8_t*>(updates);
+  entry.updates.assign(update_bytes, update_bytes + num_updates*update_size);
+  size_ += GetEntrySize(entry);
+  ++version_;
+
+  while (size_ > max_size && !entries_.empty()) {
+    size_ -= GetEntrySize(entries_.front());
+    entries_.pop_front();
+    ++first_version_;
+  }
+}
+
+size_t RowDeltaHistory::SerializeDelta(uint64_t base_version,
+                                       int32_t client_id,
+                                       const AbstractRow *sample_row,
+                                       size_t update_size, size_t max_size,
+                                       void *mem) const {
+  if (base_version < first_version_ || base_version > version_
+      || sizeof(int32_t) > max_size)
+    return 0;
+
+  // column id -> index into column_ids and delta
+  boost::unordered_map<int32_t, size_t> column_index;
+  std::vector<int32_t> column_ids;
+  std::vector<uint8_t> delta;
+  for (size_t i = base_version - first_version_; i < entries_.size(); ++i) {
+    const Entry &entry = entries_[i];
+    if (entry.client_id == client_id)
+      continue;
+    for (int32_t j = 0; j < entry.num_updates; ++j) {
+      int32_t column_id = entry.column_ids.empty() ? j : entry.column_ids[j];
+      auto ret = column_index.emplace(column_id, column_ids.size());
+      if (ret.second) {
+        if (sizeof(int32_t) + (column_ids.size() + 1)
+            *(sizeof(int32_t) + update_size) > max_size)
+          return 0;
+        column_ids.push_back(column_id);
+        delta.resize(delta.size() + update_size);
+        sample_row->InitUpdate(column_id,
+                               delta.data() + ret.first->second*update_size);
+      }
+      sample_row->AddUpdates(column_id,
+                             delta.data() + ret.first->second*update_size,
+                             entry.updates.data() + j*update_size);
+    }
+  }
+
+  uint8_t *mem_uint8 = reinterpret_cast<uint8_t*>(mem);
+  *(reinterpret_cast<int32_t*>(mem_uint8)) = column_ids.size();
+  mem_uint8 += sizeof(int32_t);
+  memcpy(mem_uint8, column_ids.data(), column_ids.size()*sizeof(int32_t));
+  mem_uint8 += column_ids.size()*sizeof(int32_t);
+  memcpy(mem_uint8, delta.data(), delta.size());
+  mem_uint8 += delta.size();
+  return mem_uint8 - reinterpret_cast<uint8_t*>(mem);
+}
+
+}  // namespace petuum
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <petuum_ps_common/include/abstract_row.hpp>
+
+namespace petuum {
+
+// Recent updates applied to a server row, each tagged with the client that
+// sent it, so that a client caching an older version of the row can be sent
+// the updates of the other clients since then instead of the whole row.
+// Its own updates are excluded because the client's cached row already has
+// them, whether or not they had reached the server.
+//
+// The version counts the updates recorded. Old updates are dropped once
+// the recorded ones take more than max_size bytes; deltas can only start
+// from versions after that.
+class RowDeltaHistory : boost::noncopyable {
+public:
+  RowDeltaHistory();
+
+  uint64_t get_version() const {
+    return version_;
+  }
+
+  // Record updates applied to the row. column_ids is ignored if dense, in
+  // which case the updates are of columns [0, num_updates).
+  void Record(int32_t client_id, const int32_t *column_ids,
+              const void *updates, int32_t num_updates, bool dense,
+              size_t update_size, size_t max_size);
+
+  // Serialize the sum of the updates recorded after base_version by clients
+  // other than client_id in the sparse oplog format. Returns 0 if the
+  // history does not go back to base_version or if the delta would take
+  // more than max_size bytes. sample_row adds up the updates.
+  size_t SerializeDelta(uint64_t base_version, int32_t client_id,
+                        const AbstractRow *sample_row, size_t update_size,
+                        size_t max_size, void *mem) const;
+
+private:
+  struct Entry {
+    int32_t client_id;
+    int32_t num_updates;
+    // empty if the updates are dense
+    std::vector<int32_t> column_ids;
+    std::vector<uint8_t> updates;
+  };
+
+  static size_t GetEntrySize(const Entry &entry) {
+    return entry.column_ids.size()*sizeof(int32_t) + entry.updates.size();
+  }
+
+  uint64_t version_;
+  // entries_[i] took the row from version first_version_ + i to
+  // first_version_ + i + 1.
+  std::deque<Entry> entries_;
+  uint64_t first_version_;
+  size_t size_;
+};
+
+}  // namespace petuum
@@ -3,6 +3,7 @@
 #include <boost/noncopyable.hpp>
 #include <petuum_ps/server/server_table.hpp>
 #include <petuum_ps/thread/context.hpp>
+#include <petuum_ps_common/util/mem_segments.hpp>
 
 
 namespace petuum {
@@ -16,22 +17,25 @@ namespace petuum {
 // 2. int32_t : table id
 // 3. size_t : update_size for this table
 // 4. serialized table, details in oplog_partition
+//
+// The byte string may be held in several segments, such as the frames of a
+// multipart message, as long as no row is split across segments.
 
 class SerializedOpLogReader : boost::noncopyable {
 public:
   // does not take ownership
   SerializedOpLogReader(
-      const void *oplog_ptr,
+      const MemSegment *oplog_segments, size_t num_segments,
       const boost::unordered_map<int32_t, ServerTable> &server_tables):
-      serialized_oplog_ptr_(reinterpret_cast<const uint8_t*>(oplog_ptr)),
+      oplog_segments_(oplog_segments),
+      num_segments_(num_segments),
+      reader_(oplog_segments, num_segments),
       server_tables_(server_tables) { }
   ~SerializedOpLogReader() {}
 
   bool Restart() {
-    offset_ = 0;
-    num_tables_left_ =
-      *(reinterpret_cast<const int32_t*>(serialized_oplog_ptr_ + offset_));
-    offset_ += sizeof(int32_t);
+    reader_ = MemSegmentReader(oplog_segments_, num_segments_);
+    num_tables_left_ = reader_.Read<int32_t>();
     if(num_tables_left_ == 0)
       return false;
     StartNewTable();
@@ -48,15 +52,12 @@ public:
       // can read from current row
       if (num_rows_left_in_current_table_ > 0) {
         *table_id = current_table_id_;
-        *row_id = *(reinterpret_cast<const int32_t*>(
-            serialized_oplog_ptr_ + offset_));
-        offset_ += sizeof(int32_t);
+        *row_id = reader_.Read<int32_t>();
         size_t serialized_size;
         const void *update
-            = GetNextUpdate_(curr_sample_row_oplog_,
-                             serialized_oplog_ptr_ + offset_,
+            = GetNextUpdate_(curr_sample_row_oplog_, reader_.GetPtr(),
                              column_ids, num_updates, &serialized_size);
-        offset_ += serialized_size;
+        reader_.Advance(serialized_size);
         --num_rows_left_in_current_table_;
         return update;
       } else {
@@ -95,17 +96,9 @@ private:
   }
 
   void StartNewTable() {
-    current_table_id_ = *(reinterpret_cast<const int32_t*>(serialized_oplog_ptr_
-      + offset_));
-    offset_ += sizeof(int32_t);
-
-    update_size_ = *(reinterpret_cast<const size_t*>(serialized_oplog_ptr_
-      + offset_));
-    offset_ += sizeof(size_t);
-
-    num_rows_left_in_current_table_ =
-      *(reinterpret_cast<const int32_t*>(serialized_oplog_ptr_ + offset_));
-    offset_ += sizeof(int32_t);
+    current_table_id_ = reader_.Read<int32_t>();
+    update_size_ = reader_.Read<size_t>();
+    num_rows_left_in_current_table_ = reader_.Read<int32_t>();
 
     auto table_iter = server_tables_.find(current_table_id_);
 
@@ -132,9 +125,10 @@ private:
       GetNextUpdate_ = GetNextUpdateSparse;
   }
 
-  const uint8_t *serialized_oplog_ptr_;
+  const MemSegment *oplog_segments_;
+  size_t num_segments_;
+  MemSegmentReader reader_;
   size_t update_size_;
-  int32_t offset_; // bytes to be read next
   int32_t num_tables_left_; // number of tables that I have not finished
                             //reading (might have started)
   int32_t current_table_id_;
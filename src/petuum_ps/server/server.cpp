@@ -4,16 +4,30 @@
 #include <petuum_ps/server/serialized_oplog_reader.hpp>
 #include <petuum_ps_common/util/class_register.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
 
 #include <utility>
 #include <fstream>
 #include <map>
+#include <algorithm>
 
 namespace petuum {
 
-Server::Server() {}
-
-Server::~Server() {}
+Server::Server():
+    snapshot_io_thread_(0),
+    apply_pool_(0) { }
+
+Server::~Server() {
+  delete apply_pool_;
+  if (snapshot_io_thread_ != 0) {
+    snapshot_io_thread_->ShutDown();
+    for (auto job : snapshot_jobs_) {
+      job->Release();
+      delete job;
+    }
+    delete snapshot_io_thread_;
+  }
+}
 
 void Server::Init(int32_t server_id,
                   const std::vector<int32_t> &bg_ids,
@@ -22,17 +36,25 @@ void Server::Init(int32_t server_id,
     bg_clock_.AddClock(*iter, 0);
     bg_version_map_[*iter] = -1;
   }
-   push_row_msg_data_size_ = kPushRowMsgSizeInit;
-
    server_id_ = server_id;
 
    accum_oplog_count_ = 0;
    msg_tracker_ = msg_tracker;
+
+   apply_stripes_.resize(
+       std::max(GlobalContext::get_num_server_apply_threads(), 1));
+
+   if (GlobalContext::get_snapshot_clock() > 0
+       && GlobalContext::get_snapshot_async()) {
+     snapshot_io_thread_ = new SnapShotIOThread;
+     CHECK_EQ(snapshot_io_thread_->Start(), 0);
+   }
  }
 
  void Server::CreateTable(int32_t table_id, TableInfo &table_info){
    auto ret = tables_.emplace(table_id, ServerTable(table_id, table_info));
    CHECK(ret.second);
+   msg_compressor_.AddServerTable(table_info.compress_type);
 
    if (GlobalContext::get_resume_clock() > 0) {
      boost::unordered_map<int32_t, ServerTable>::iterator table_iter
@@ -62,64 +84,77 @@ void Server::Init(int32_t server_id,
  bool Server::ClockUntil(int32_t bg_id, int32_t clock) {
    int new_clock = bg_clock_.TickUntil(bg_id, clock);
    if(new_clock) {
+     if (!snapshot_jobs_.empty())
+       ReleaseSnapShotJobs(false);
+
      if (GlobalContext::get_snapshot_clock() <= 0
          || new_clock % GlobalContext::get_snapshot_clock() != 0)
        return true;
-     for (auto table_iter = tables_.begin(); table_iter != tables_.end();
-          table_iter++) {
-       //LOG(INFO) << "Take snapshot - new clock = " << new_clock;
-       table_iter->second.TakeSnapShot(GlobalContext::get_snapshot_dir(),
-                                       server_id_,
-                                       table_iter->first, new_clock);
-     }
+     TakeSnapShot(new_clock);
      return true;
    }
 
    return false;
  }
 
- void Server::AddRowRequest(int32_t bg_id, int32_t table_id, int32_t row_id,
-   int32_t clock) {
-
-   ServerRowRequest server_row_request;
-   server_row_request.bg_id = bg_id;
-   server_row_request.table_id = table_id;
-   server_row_request.row_id = row_id;
-   server_row_request.clock = clock;
-
-   if (clock_bg_row_requests_.count(clock) == 0) {
-     clock_bg_row_requests_.insert(std::make_pair(clock,
-       boost::unordered_map<int32_t, std::vector<ServerRowRequest> >()));
-   }
-   if (clock_bg_row_requests_[clock].count(bg_id) == 0) {
-     clock_bg_row_requests_[clock].insert(std::make_pair(bg_id,
-       std::vector<ServerRowRequest>()));
+ void Server::TakeSnapShot(int32_t clock) {
+   STATS_SERVER_ACCUM_SNAPSHOT_STALL_BEGIN();
+   if (snapshot_io_thread_ == 0) {
+     for (auto table_iter = tables_.begin(); table_iter != tables_.end();
+          table_iter++) {
+       HighResolutionTimer write_timer;
+       size_t num_bytes = table_iter->second.TakeSnapShot(
+           GlobalContext::get_snapshot_dir(), server_id_,
+           table_iter->first, clock);
+       STATS_SERVER_ACCUM_SNAPSHOT_WRITTEN(num_bytes, write_timer.elapsed());
+     }
+   } else {
+     // A row can only be part of one in-flight snapshot.
+     ReleaseSnapShotJobs(true);
+     for (auto table_iter = tables_.begin(); table_iter != tables_.end();
+          table_iter++) {
+       SnapShotJob *job = table_iter->second.CreateSnapShotJob(
+           GlobalContext::get_snapshot_dir(), server_id_,
+           table_iter->first, clock);
+       snapshot_jobs_.push_back(job);
+       snapshot_io_thread_->Enqueue(job);
+     }
    }
-   clock_bg_row_requests_[clock][bg_id].push_back(server_row_request);
+   STATS_SERVER_ACCUM_SNAPSHOT_STALL_END();
  }
 
- void Server::GetFulfilledRowRequests(std::vector<ServerRowRequest> *requests) {
-   int32_t clock = bg_clock_.get_min_clock();
-   requests->clear();
-   auto iter = clock_bg_row_requests_.find(clock);
-
-   if(iter == clock_bg_row_requests_.end())
-     return;
-   boost::unordered_map<int32_t,
-     std::vector<ServerRowRequest> > &bg_row_requests = iter->second;
-
-   for (auto bg_iter = bg_row_requests.begin(); bg_iter != bg_row_requests.end();
-     bg_iter++) {
-     requests->insert(requests->end(), bg_iter->second.begin(),
-       bg_iter->second.end());
+ void Server::ReleaseSnapShotJobs(bool wait) {
+   if (wait)
+     snapshot_io_thread_->WaitForJobs();
+
+   auto job_iter = snapshot_jobs_.begin();
+   for (; job_iter != snapshot_jobs_.end(); ++job_iter) {
+     SnapShotJob *job = *job_iter;
+     // jobs finish in order
+     if (!job->IsDone())
+       break;
+     job->Release();
+     STATS_SERVER_ACCUM_SNAPSHOT_WRITTEN(job->get_bytes_written(),
+                                         job->get_write_sec());
+     delete job;
    }
+   snapshot_jobs_.erase(snapshot_jobs_.begin(), job_iter);
+ }
+
+ void Server::AddRowRequest(int32_t bg_id, int32_t table_id, int32_t row_id,
+   int32_t clock, bool accept_row_delta, uint64_t cached_row_version) {
+   pending_row_requests_.Add(bg_id, table_id, row_id, clock, accept_row_delta,
+                             cached_row_version);
+ }
 
-   clock_bg_row_requests_.erase(clock);
+ bool Server::GetFulfilledRowRequests(FulfilledRowRequests *fulfilled) {
+   return pending_row_requests_.TakeFulfilled(bg_clock_.get_min_clock(),
+                                              fulfilled);
  }
 
  void Server::ApplyOpLogUpdateVersion(
-     const void *oplog, size_t oplog_size, int32_t bg_thread_id,
-     uint32_t version) {
+     const MemSegment *oplog_segments, size_t num_segments,
+     size_t oplog_size, int32_t bg_thread_id, uint32_t version) {
 
    CHECK_EQ(bg_version_map_[bg_thread_id] + 1, version)
        << "bg_thread_id = " << bg_thread_id;
@@ -127,7 +162,7 @@ void Server::Init(int32_t server_id,
 
    if (oplog_size == 0) return;
 
-   SerializedOpLogReader oplog_reader(oplog, tables_);
+   SerializedOpLogReader oplog_reader(oplog_segments, num_segments, tables_);
    bool to_read = oplog_reader.Restart();
 
    //LOG(INFO) << "oplog size = " << oplog_size
@@ -144,6 +179,11 @@ void Server::Init(int32_t server_id,
                                            &num_updates, &started_new_table);
 
    ServerTable *server_table;
+   size_t num_rows = 0;
+   size_t num_stripe_rows = 0;
+   const size_t num_stripes = apply_stripes_.size();
+   const int32_t client_id
+       = GlobalContext::thread_id_to_client_id(bg_thread_id);
    if (updates != 0) {
      auto table_iter = tables_.find(table_id);
      CHECK(table_iter != tables_.end())
@@ -153,16 +193,29 @@ void Server::Init(int32_t server_id,
 
    while (updates != 0) {
      ++accum_oplog_count_;
+     ++num_rows;
      //LOG(INFO) << "table_id = " << table_id
      //        << " row_id = " << row_id
      //        << " updates = " << updates
      //        << " num_updates = " << num_updates;
-     bool found
-       = server_table->ApplyRowOpLog(row_id, column_ids, updates, num_updates);
-
-     if (!found) {
-       server_table->CreateRow(row_id);
-       server_table->ApplyRowOpLog(row_id, column_ids, updates, num_updates);
+     if (num_stripes > 1 && server_table->can_apply_concurrently()) {
+       // Rows are created and preserved for snapshots here as that changes
+       // the table; only applying the updates is left to the stripes.
+       OpLogApplyEntry entry = {server_table,
+                                server_table->PrepareRowOpLog(row_id),
+                                column_ids, updates, num_updates, client_id};
+       apply_stripes_[static_cast<uint32_t>(row_id) % num_stripes].push_back(
+           entry);
+       ++num_stripe_rows;
+     } else {
+       bool found = server_table->ApplyRowOpLog(row_id, column_ids, updates,
+                                                num_updates, client_id);
+
+       if (!found) {
+         server_table->CreateRow(row_id);
+         server_table->ApplyRowOpLog(row_id, column_ids, updates, num_updates,
+                                     client_id);
+       }
      }
 
      updates = oplog_reader.Next(&table_id, &row_id, &column_ids,
@@ -176,6 +229,64 @@ void Server::Init(int32_t server_id,
        server_table = &(table_iter->second);
      }
    }
+   if (num_stripe_rows > 0)
+     ApplyOpLogStripes(num_stripe_rows);
+   STATS_SERVER_ACCUM_OPLOG_ROWS(num_rows);
+ }
+
+ void Server::ApplyOpLogStripes(size_t num_rows) {
+   // Waking the pool costs about as much as applying a few small rows.
+   const size_t kMinRowsPerWorker = 16;
+
+   auto apply_stripe = [this](int32_t stripe) {
+     for (const auto &entry : apply_stripes_[stripe]) {
+       entry.server_table->ApplyPreparedRowOpLog(
+           entry.server_row, entry.column_ids, entry.updates,
+           entry.num_updates, entry.client_id);
+     }
+   };
+
+   if (num_rows < kMinRowsPerWorker*apply_stripes_.size()) {
+     for (size_t i = 0; i < apply_stripes_.size(); ++i)
+       apply_stripe(i);
+   } else {
+     if (apply_pool_ == 0)
+       apply_pool_ = new OpLogApplyPool(apply_stripes_.size());
+     // Returns after all stripes are applied, so the message is done with
+     // before the server thread moves on to clocks and replies.
+     apply_pool_->Run(apply_stripe);
+   }
+
+   for (auto &stripe : apply_stripes_)
+     stripe.clear();
+ }
+
+ size_t Server::GetRowReplySizeBound(int32_t table_id,
+                                     ServerRow *server_row) {
+   auto table_iter = tables_.find(table_id);
+   CHECK(table_iter != tables_.end()) << "Not found table_id = " << table_id;
+   return table_iter->second.GetRowReplySizeBound(server_row);
+ }
+
+ size_t Server::SerializeRowReply(int32_t table_id, ServerRow *server_row,
+                                  int32_t bg_id, bool accept_row_delta,
+                                  uint64_t cached_row_version, void *mem) {
+   auto table_iter = tables_.find(table_id);
+   CHECK(table_iter != tables_.end()) << "Not found table_id = " << table_id;
+   return table_iter->second.SerializeRowReply(
+       server_row, GlobalContext::thread_id_to_client_id(bg_id),
+       accept_row_delta, cached_row_version, mem);
+ }
+
+ size_t Server::SerializeRowDeltaReply(int32_t table_id, ServerRow *server_row,
+                                       int32_t bg_id,
+                                       uint64_t cached_row_version,
+                                       void *mem) {
+   auto table_iter = tables_.find(table_id);
+   CHECK(table_iter != tables_.end()) << "Not found table_id = " << table_id;
+   return table_iter->second.SerializeRowDeltaReply(
+       server_row, GlobalContext::thread_id_to_client_id(bg_id),
+       cached_row_version, mem);
  }
 
  int32_t Server::GetMinClock() {
@@ -186,11 +297,9 @@ void Server::Init(int32_t server_id,
    return bg_version_map_[bg_thread_id];
  }
 
- size_t Server::CreateSendServerPushRowMsgs(PushMsgSendFunc PushMsgSend,
-                                            bool clock_changed) {
-   boost::unordered_map<int32_t, RecordBuff> buffs;
-   boost::unordered_map<int32_t, ServerPushRowMsg*> msg_map;
-
+ size_t Server::CreateSendServerPushRowMsgs(
+     PushMsgSendFunc PushMsgSend, PushMsgSendBodyFunc PushMsgSendBody,
+     bool clock_changed) {
    accum_oplog_count_ = 0;
 
    size_t accum_send_bytes = 0;
@@ -198,120 +307,48 @@ void Server::Init(int32_t server_id,
    int32_t comm_channel_idx
        = GlobalContext::GetCommChannelIndexServer(server_id_);
 
-   // Create a message for each bg thread
-   int32_t client_id = 0;
-   for (client_id = 0;
-        client_id < GlobalContext::get_num_clients(); ++client_id) {
-    ServerPushRowMsg *msg = new ServerPushRowMsg(push_row_msg_data_size_);
-    msg_map[client_id] = msg;
-    buffs.insert(
-        std::make_pair(client_id,
-                       RecordBuff(msg->get_data(), push_row_msg_data_size_)));
-  }
+   PushRowSegment *segment = new PushRowSegment;
+   std::vector<PushRowBody> bodies(GlobalContext::get_num_clients(),
+                                   PushRowBody(segment));
 
-  int32_t num_tables_left = GlobalContext::get_num_tables();
-  for (auto table_iter = tables_.begin(); table_iter != tables_.end();
-       table_iter++) {
-    int32_t table_id = table_iter->first;
+   int32_t num_tables_left = GlobalContext::get_num_tables();
+   for (auto table_iter = tables_.begin(); table_iter != tables_.end();
+        table_iter++) {
+     int32_t table_id = table_iter->first;
 
-    STATS_SERVER_ACCUM_IMPORTANCE(table_id, 0.0, false);
+     STATS_SERVER_ACCUM_IMPORTANCE(table_id, 0.0, false);
 
-    ServerTable &server_table = table_iter->second;
-    for (client_id = 0;
-         client_id < GlobalContext::get_num_clients(); ++client_id) {
-      RecordBuff &record_buff = buffs[client_id];
-      int32_t *table_id_ptr = record_buff.GetMemPtrInt32();
-      if (table_id_ptr == 0) {
-        int32_t bg_id = GlobalContext::get_bg_thread_id(client_id,
-                                                        comm_channel_idx);
-        PushMsgSend(bg_id, msg_map[client_id], false && clock_changed,
-                    GetBgVersion(bg_id), GetMinClock(), msg_tracker_);
-        memset((msg_map[client_id])->get_data(), 0, push_row_msg_data_size_);
-        record_buff.ResetOffset();
-        table_id_ptr = record_buff.GetMemPtrInt32();
-      }
-      *table_id_ptr = table_id;
-    }
+     for (auto &body : bodies) {
+       body.AppendInt32(table_id);
+     }
 
-    // ServerTable packs the data.
-    server_table.InitAppendTableToBuffs();
-    int32_t failed_client_id;
-    size_t num_clients = 0;
-    bool pack_suc = server_table.AppendTableToBuffs(
-        0, &buffs, &failed_client_id, false,
-        &num_clients);
-
-    while (!pack_suc) {
-      RecordBuff &record_buff = buffs[failed_client_id];
-      int32_t *buff_end_ptr = record_buff.GetMemPtrInt32();
-      if (buff_end_ptr != 0)
-        *buff_end_ptr = GlobalContext::get_serialized_table_end();
-
-      int32_t bg_id = GlobalContext::get_bg_thread_id(failed_client_id,
-                                                      comm_channel_idx);
-      PushMsgSend(bg_id, msg_map[failed_client_id], false && clock_changed,
-                  GetBgVersion(bg_id), GetMinClock(), msg_tracker_);
-      memset((msg_map[failed_client_id])->get_data(), 0,
-             push_row_msg_data_size_);
-      record_buff.ResetOffset();
-      int32_t *table_id_ptr = record_buff.GetMemPtrInt32();
-      *table_id_ptr = table_id;
-      pack_suc = server_table.AppendTableToBuffs(
-          failed_client_id, &buffs, &failed_client_id, true,
-          &num_clients);
-    }
+     table_iter->second.AppendTableToPushBodies(segment, &bodies);
 
-    --num_tables_left;
-    if (num_tables_left > 0) {
-      for (client_id = 0;
-           client_id < GlobalContext::get_num_clients(); ++client_id) {
-
-        RecordBuff &record_buff = buffs[client_id];
-        int32_t *table_sep_ptr = record_buff.GetMemPtrInt32();
-        if (table_sep_ptr == 0) {
-          int32_t bg_id = GlobalContext::get_bg_thread_id(client_id,
-                                                          comm_channel_idx);
-
-          PushMsgSend(bg_id, msg_map[client_id], false && clock_changed,
-                      GetBgVersion(bg_id), GetMinClock(), msg_tracker_);
-          memset((msg_map[client_id])->get_data(), 0, push_row_msg_data_size_);
-          record_buff.ResetOffset();
-        } else {
-          *table_sep_ptr = GlobalContext::get_serialized_table_separator();
-        }
-      }
-    } else
-      break;
-  }
+     --num_tables_left;
+     if (num_tables_left > 0) {
+       for (auto &body : bodies) {
+         body.AppendInt32(GlobalContext::get_serialized_table_separator());
+       }
+     } else
+       break;
+   }
 
-  for (client_id = 0;
-       client_id < GlobalContext::get_num_clients(); ++client_id) {
-    RecordBuff &record_buff = buffs[client_id];
-    int32_t *table_end_ptr = record_buff.GetMemPtrInt32();
-    if (table_end_ptr == 0) {
-      int32_t bg_id = GlobalContext::get_bg_thread_id(client_id,
-                                                      comm_channel_idx);
-      PushMsgSend(bg_id, msg_map[client_id], true && clock_changed,
-                  GetBgVersion(bg_id), GetMinClock(), msg_tracker_);
-      continue;
-    }
-    *table_end_ptr = GlobalContext::get_serialized_table_end();
-    msg_map[client_id]->get_avai_size() = buffs[client_id].GetMemUsedSize();
-    accum_send_bytes += msg_map[client_id]->get_size();
+   for (int32_t client_id = 0;
+        client_id < GlobalContext::get_num_clients(); ++client_id) {
+     PushRowBody &body = bodies[client_id];
+     body.AppendInt32(GlobalContext::get_serialized_table_end());
 
-    int32_t bg_id = GlobalContext::get_bg_thread_id(client_id,
-                                                    comm_channel_idx);
-    PushMsgSend(bg_id, msg_map[client_id], true && clock_changed,
-                GetBgVersion(bg_id), GetMinClock(), msg_tracker_);
-    delete msg_map[client_id];
-  }
-  return accum_send_bytes;
-}
+     int32_t bg_id = GlobalContext::get_bg_thread_id(client_id,
+                                                     comm_channel_idx);
+     accum_send_bytes += SendPushRowBody(PushMsgSend, PushMsgSendBody, bg_id,
+                                         body, clock_changed);
+   }
+   segment->DecRef();
+   return accum_send_bytes;
+ }
 
 size_t Server::CreateSendServerPushRowMsgsPartial(
-    PushMsgSendFunc PushMsgSend) {
-  boost::unordered_map<int32_t, RecordBuff> buffs;
-  boost::unordered_map<int32_t, ServerPushRowMsg*> msg_map;
+    PushMsgSendFunc PushMsgSend, PushMsgSendBodyFunc PushMsgSendBody) {
   boost::unordered_map<int32_t, size_t> client_buff_size;
   boost::unordered_map<int32_t,
                        std::vector<std::pair<int32_t, ServerRow*> > >
@@ -325,7 +362,6 @@ size_t Server::CreateSendServerPushRowMsgsPartial(
   int32_t comm_channel_idx
       = GlobalContext::GetCommChannelIndexServer(server_id_);
 
-  // Create a message for each bg thread
   int32_t client_id = 0;
   for (client_id = 0;
        client_id < GlobalContext::get_num_clients(); ++client_id) {
@@ -347,31 +383,9 @@ size_t Server::CreateSendServerPushRowMsgsPartial(
 
   if (!has_to_send) return 0;
 
-  size_t num_tables = tables_.size();
-
-  for (auto buff_size_iter = client_buff_size.begin();
-       buff_size_iter != client_buff_size.end(); ++buff_size_iter) {
-
-    if (buff_size_iter->second > 0)
-      buff_size_iter->second += (sizeof(int32_t) + sizeof(int32_t))*num_tables;
-  }
-
-  for (auto buff_size_iter = client_buff_size.begin();
-       buff_size_iter != client_buff_size.end(); buff_size_iter++) {
-    size_t buff_size = buff_size_iter->second;
-    int32_t client_id = buff_size_iter->first;
-
-    if (buff_size == 0) {
-      msg_map[client_id] = 0;
-      continue;
-    }
-
-    ServerPushRowMsg *msg = new ServerPushRowMsg(buff_size);
-    msg_map[client_id] = msg;
-    buffs.insert(
-        std::make_pair(client_id,
-                       RecordBuff(msg->get_data(), buff_size)));
-  }
+  PushRowSegment *segment = new PushRowSegment;
+  std::vector<PushRowBody> bodies(GlobalContext::get_num_clients(),
+                                  PushRowBody(segment));
 
   size_t num_tables_left = tables_.size();
 
@@ -380,53 +394,83 @@ size_t Server::CreateSendServerPushRowMsgsPartial(
     int32_t table_id = table_iter->first;
     ServerTable &server_table = table_iter->second;
 
-    for (auto buff_iter = buffs.begin(); buff_iter != buffs.end();
-         ++buff_iter) {
-      RecordBuff &record_buff = buff_iter->second;
-      int32_t *table_id_ptr = record_buff.GetMemPtrInt32();
-      CHECK_NOTNULL(table_id_ptr);
-      *table_id_ptr = table_id;
+    for (auto &body : bodies) {
+      body.AppendInt32(table_id);
     }
 
-    server_table.AppendRowsToBuffsPartial(
-        &buffs, table_rows_to_send[table_id]);
+    server_table.AppendRowsToPushBodies(
+        segment, &bodies, table_rows_to_send[table_id]);
 
     --num_tables_left;
 
-    for (auto buff_iter = buffs.begin(); buff_iter != buffs.end();
-         ++buff_iter) {
-      RecordBuff &record_buff = buff_iter->second;
-      int32_t *table_end_ptr = record_buff.GetMemPtrInt32();
-      CHECK_NOTNULL(table_end_ptr);
-
+    for (auto &body : bodies) {
       if (num_tables_left == 0)
-        *table_end_ptr = GlobalContext::get_serialized_table_end();
+        body.AppendInt32(GlobalContext::get_serialized_table_end());
       else
-        *table_end_ptr = GlobalContext::get_serialized_table_separator();
+        body.AppendInt32(GlobalContext::get_serialized_table_separator());
     }
   }
 
-  for (auto msg_iter = msg_map.begin(); msg_iter != msg_map.end();
-       msg_iter++) {
-    int32_t client_id = msg_iter->first;
-    ServerPushRowMsg *msg = msg_iter->second;
-    if (msg == 0)
+  for (client_id = 0;
+       client_id < GlobalContext::get_num_clients(); ++client_id) {
+    const PushRowBody &body = bodies[client_id];
+    if (body.get_num_records() == 0)
       continue;
 
-    accum_send_bytes += msg->get_size();
-
     int32_t bg_id = GlobalContext::get_bg_thread_id(client_id,
                                                     comm_channel_idx);
-    PushMsgSend(bg_id, msg, false, GetBgVersion(bg_id), GetMinClock(), msg_tracker_);
+    size_t sent_size = SendPushRowBody(PushMsgSend, PushMsgSendBody, bg_id,
+                                       body, false);
+    accum_send_bytes += sent_size;
 
-    VLOG(0) << "Send server push row size = " << msg->get_avai_size()
+    VLOG(0) << "Send server push row size = " << sent_size
             << " to bg id = " << bg_id
             << " server id = " << ThreadContext::get_id();
+  }
+  segment->DecRef();
+
+  return accum_send_bytes;
+}
 
+size_t Server::SendPushRowBody(PushMsgSendFunc PushMsgSend,
+                               PushMsgSendBodyFunc PushMsgSendBody,
+                               int32_t bg_id, const PushRowBody &body,
+                               bool is_last) {
+  // MsgCompressor needs the message in one piece.
+  if (msg_compressor_.get_compress_push()
+      && !GlobalContext::comm_bus->IsLocalEntity(bg_id)) {
+    ServerPushRowMsg *msg = new ServerPushRowMsg(body.get_size());
+    body.CopyTo(reinterpret_cast<uint8_t*>(msg->get_data()));
+    size_t msg_size = msg->get_size();
+    SendPushRowMsg(PushMsgSend, bg_id, msg, is_last);
     delete msg;
+    return msg_size;
   }
 
-  return accum_send_bytes;
+  // Header only, the data goes out of body.
+  ServerPushRowMsg msg(static_cast<size_t>(0));
+  msg.get_avai_size() = body.get_size();
+  PushMsgSendBody(bg_id, &msg, body, is_last, GetBgVersion(bg_id),
+                  GetMinClock(), msg_tracker_);
+  return msg.get_size();
+}
+
+void Server::SendPushRowMsg(PushMsgSendFunc PushMsgSend, int32_t bg_id,
+                            ServerPushRowMsg *msg, bool is_last) {
+  ServerPushRowMsg *compressed_msg = 0;
+  // Compression only pays off over the network.
+  if (!GlobalContext::comm_bus->IsLocalEntity(bg_id))
+    compressed_msg = msg_compressor_.CompressPushRowMsg(*msg);
+
+  if (compressed_msg == 0) {
+    PushMsgSend(bg_id, msg, is_last, GetBgVersion(bg_id), GetMinClock(),
+                msg_tracker_);
+    return;
+  }
+
+  PushMsgSend(bg_id, compressed_msg, is_last, GetBgVersion(bg_id),
+              GetMinClock(), msg_tracker_);
+  delete compressed_msg;
 }
 
 bool Server::AccumedOpLogSinceLastPush() {
@@ -10,19 +10,17 @@
 #include <petuum_ps_common/include/abstract_row.hpp>
 #include <petuum_ps_common/include/constants.hpp>
 #include <petuum_ps_common/util/vector_clock.hpp>
+#include <petuum_ps_common/util/mem_segments.hpp>
 #include <petuum_ps_common/thread/msg_tracker.hpp>
 #include <petuum_ps/server/server_table.hpp>
+#include <petuum_ps/server/push_row_segment.hpp>
+#include <petuum_ps/server/snapshot_io_thread.hpp>
+#include <petuum_ps/server/oplog_apply_pool.hpp>
+#include <petuum_ps/server/pending_row_requests.hpp>
 #include <petuum_ps/thread/ps_msgs.hpp>
+#include <petuum_ps/thread/msg_compressor.hpp>
 
 namespace petuum {
-struct ServerRowRequest {
-public:
-  int32_t bg_id; // requesting bg thread id
-  int32_t table_id;
-  int32_t row_id;
-  int32_t clock;
-};
-
 // 1. Manage the table storage on server;
 // 2. Manage the pending reads;
 // 3. Manage the vector clock for clients
@@ -41,47 +39,108 @@ public:
   ServerRow *FindCreateRow(int32_t table_id, int32_t row_id);
   bool ClockUntil(int32_t bg_id, int32_t clock);
   void AddRowRequest(int32_t bg_id, int32_t table_id, int32_t row_id,
-    int32_t clock);
-  void GetFulfilledRowRequests(std::vector<ServerRowRequest> *requests);
+    int32_t clock, bool accept_row_delta = false,
+    uint64_t cached_row_version = kNoRowDeltaVersion);
+  // Returns false if no pending request is fulfilled by the current min
+  // clock.
+  bool GetFulfilledRowRequests(FulfilledRowRequests *fulfilled);
+  // oplog_size is the total size of the oplog segments.
   void ApplyOpLogUpdateVersion(
-      const void *oplog, size_t oplog_size, int32_t bg_thread_id,
-      uint32_t version);
+      const MemSegment *oplog_segments, size_t num_segments,
+      size_t oplog_size, int32_t bg_thread_id, uint32_t version);
   int32_t GetMinClock();
+
+  // See ServerTable::SerializeRowReply().
+  size_t GetRowReplySizeBound(int32_t table_id, ServerRow *server_row);
+  size_t SerializeRowReply(int32_t table_id, ServerRow *server_row,
+                           int32_t bg_id, bool accept_row_delta,
+                           uint64_t cached_row_version, void *mem);
+  size_t SerializeRowDeltaReply(int32_t table_id, ServerRow *server_row,
+                                int32_t bg_id, uint64_t cached_row_version,
+                                void *mem);
   int32_t GetBgVersion(int32_t bg_thread_id);
 
   typedef void (*PushMsgSendFunc)(int32_t bg_id, ServerPushRowMsg *msg,
                                   bool is_last, int32_t version,
                                   int32_t server_min_clock,
                                   MsgTracker *msg_tracker);
-  size_t CreateSendServerPushRowMsgs(PushMsgSendFunc PushMsgSender,
+  // msg holds only the header; the data is body.
+  typedef void (*PushMsgSendBodyFunc)(int32_t bg_id, ServerPushRowMsg *msg,
+                                      const PushRowBody &body, bool is_last,
+                                      int32_t version,
+                                      int32_t server_min_clock,
+                                      MsgTracker *msg_tracker);
+
+  // Dirty rows are serialized once into a PushRowSegment shared by the
+  // messages to all clients subscribed to them.
+  size_t CreateSendServerPushRowMsgs(PushMsgSendFunc PushMsgSend,
+                                     PushMsgSendBodyFunc PushMsgSendBody,
                                      bool clock_changed = true);
 
   size_t CreateSendServerPushRowMsgsPartial(
-      PushMsgSendFunc PushMsgSend);
+      PushMsgSendFunc PushMsgSend, PushMsgSendBodyFunc PushMsgSendBody);
 
   bool AccumedOpLogSinceLastPush();
 
   void RowSent(int32_t table_id, int32_t row_id, ServerRow *row, size_t num_clients);
 
 private:
+  // Sends msg through PushMsgSend, compressed if it pays off; msg is left
+  // to the caller.
+  void SendPushRowMsg(PushMsgSendFunc PushMsgSend, int32_t bg_id,
+                      ServerPushRowMsg *msg, bool is_last);
+
+  // Sends body to bg_id without copying it unless it is to be compressed.
+  // Returns the message size.
+  size_t SendPushRowBody(PushMsgSendFunc PushMsgSend,
+                         PushMsgSendBodyFunc PushMsgSendBody, int32_t bg_id,
+                         const PushRowBody &body, bool is_last);
+
+  // Apply the rows collected in apply_stripes_, on the apply pool if there
+  // are enough of them.
+  void ApplyOpLogStripes(size_t num_rows);
+
+  void TakeSnapShot(int32_t clock);
+  // Release background snapshot jobs that are done; if wait is true, wait
+  // for all of them first.
+  void ReleaseSnapShotJobs(bool wait);
+
   VectorClock bg_clock_;
 
   boost::unordered_map<int32_t, ServerTable> tables_;
-  // mapping <clock, table id> to an array of read requests
-  std::map<int32_t,
-    boost::unordered_map<int32_t,
-      std::vector<ServerRowRequest> > > clock_bg_row_requests_;
+  // read requests waiting for the min clock to reach theirs
+  PendingRowRequests pending_row_requests_;
 
   // latest oplog version that I have received from a bg thread
   std::map<int32_t, uint32_t> bg_version_map_;
-  // Assume a single row does not exceed this size!
-  static const size_t kPushRowMsgSizeInit = 4*k1_Mi;
-  size_t push_row_msg_data_size_;
-
   int32_t server_id_;
 
   size_t accum_oplog_count_;
   MsgTracker *msg_tracker_;
+
+  MsgCompressor msg_compressor_;
+
+  // Only used with GlobalContext::get_snapshot_async().
+  SnapShotIOThread *snapshot_io_thread_;
+  std::vector<SnapShotJob*> snapshot_jobs_;
+
+  // A row of an oplog message to be applied by the apply pool.
+  struct OpLogApplyEntry {
+    ServerTable *server_table;
+    ServerRow *server_row;
+    const int32_t *column_ids;
+    const void *updates;
+    int32_t num_updates;
+    int32_t client_id;
+  };
+
+  // Only used with GlobalContext::get_num_server_apply_threads() > 1. The
+  // pool is created on the first oplog that needs it, so the name node
+  // does not start one.
+  OpLogApplyPool *apply_pool_;
+  // apply_stripes_[i] holds the rows worker i applies, which are the rows
+  // whose id is i modulo the number of workers.
+  std::vector<std::vector<OpLogApplyEntry> > apply_stripes_;
 };
 
 }  // namespace petuum
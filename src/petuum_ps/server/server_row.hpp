@@ -1,33 +1,48 @@
 // author: jinliang
 
 #include <petuum_ps/server/abstract_server_row.hpp>
+#include <petuum_ps/server/row_delta_history.hpp>
 
 #pragma once
 
 namespace petuum {
 
+struct SnapShotRowEntry;
+
 // Disallow copy to avoid shared ownership of row_data.
 // Allow move sematic for it to be stored in STL containers.
 class ServerRow : public AbstractServerRow {
 public:
   ServerRow():
-      dirty_(false) { }
+      dirty_(false),
+      snapshot_dirty_(true),
+      snapshot_entry_(0),
+      delta_history_(0) { }
 
   explicit ServerRow(AbstractRow *row_data):
       row_data_(row_data),
       num_clients_subscribed_(0),
-      dirty_(false) { }
+      dirty_(false),
+      snapshot_dirty_(true),
+      snapshot_entry_(0),
+      delta_history_(0) { }
 
   ~ServerRow() {
     if(row_data_ != 0)
       delete row_data_;
+    delete delta_history_;
   }
 
   ServerRow(ServerRow && other):
+      callback_subs_(std::move(other.callback_subs_)),
       row_data_(other.row_data_),
       num_clients_subscribed_(other.num_clients_subscribed_),
-      dirty_(other.dirty_) {
+      dirty_(other.dirty_),
+      snapshot_dirty_(other.snapshot_dirty_),
+      snapshot_entry_(other.snapshot_entry_),
+      delta_history_(other.delta_history_) {
     other.row_data_ = 0;
+    other.delta_history_ = 0;
   }
 
   ServerRow & operator = (ServerRow & other) = delete;
@@ -37,6 +52,7 @@ public:
       const void *update_batch, int32_t num_updates) {
     row_data_->ApplyBatchIncUnsafe(column_ids, update_batch, num_updates);
     dirty_ = true;
+    snapshot_dirty_ = true;
   }
 
   virtual void ApplyBatchIncAccumImportance(
@@ -46,11 +62,13 @@ public:
         column_ids, update_batch, num_updates);
     AccumImportance(importance);
     dirty_ = true;
+    snapshot_dirty_ = true;
   }
 
   virtual void ApplyDenseBatchInc(const void *update_batch, int32_t num_updates) {
     row_data_->ApplyDenseBatchIncUnsafe(update_batch, 0, num_updates);
     dirty_ = true;
+    snapshot_dirty_ = true;
   }
 
   virtual void ApplyDenseBatchIncAccumImportance(const void *update_batch,
@@ -60,6 +78,7 @@ public:
             update_batch, 0, num_updates);
     AccumImportance(importance);
     dirty_ = true;
+    snapshot_dirty_ = true;
   }
 
   virtual size_t SerializedSize() const {
@@ -84,14 +103,10 @@ public:
       --num_clients_subscribed_;
   }
 
-  bool AppendRowToBuffs(
-      int32_t client_id_st,
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      const void *row_data, size_t row_size, int32_t row_id,
-      int32_t *failed_client_id, size_t *num_clients) {
-    return callback_subs_.AppendRowToBuffs(
-        client_id_st, buffs, row_data,
-        row_size, row_id, failed_client_id, num_clients);
+  size_t AppendRecordToPushBodies(std::vector<PushRowBody> *bodies,
+                                  size_t offset, size_t record_size) {
+    return callback_subs_.AppendRecordToPushBodies(bodies, offset,
+                                                   record_size);
   }
 
   bool IsDirty() const {
@@ -108,15 +123,6 @@ public:
         client_size_map, SerializedSize());
   }
 
-  void AppendRowToBuffs(
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      const void *row_data, size_t row_size, int32_t row_id,
-      size_t *num_clients) {
-    callback_subs_.AppendRowToBuffs(
-        buffs, row_data,
-        row_size, row_id, num_clients);
-  }
-
   double get_importance() {
     return importance_;
   }
@@ -133,13 +139,49 @@ public:
     return row_data_;
   }
 
+  // Whether the row has been modified since it was last written to a
+  // snapshot. Unlike dirty_, it is not affected by pushing rows to clients.
+  bool IsSnapShotDirty() const {
+    return snapshot_dirty_;
+  }
+
+  void ResetSnapShotDirty() {
+    snapshot_dirty_ = false;
+  }
+
+  // Non-null while the row belongs to a snapshot that is still being
+  // written in the background.
+  SnapShotRowEntry *get_snapshot_entry() const {
+    return snapshot_entry_;
+  }
+
+  void set_snapshot_entry(SnapShotRowEntry *snapshot_entry) {
+    snapshot_entry_ = snapshot_entry;
+  }
+
+  // Non-null once a client has asked for delta replies of the row.
+  RowDeltaHistory *get_delta_history() const {
+    return delta_history_;
+  }
+
+  RowDeltaHistory *GetCreateDeltaHistory() {
+    if (delta_history_ == 0)
+      delta_history_ = new RowDeltaHistory;
+    return delta_history_;
+  }
+
 protected:
   CallBackSubs callback_subs_;
   AbstractRow *row_data_;
   size_t num_clients_subscribed_;
 
   bool dirty_;
+  bool snapshot_dirty_;
 
   double importance_;
+
+  SnapShotRowEntry *snapshot_entry_;
+
+  RowDeltaHistory *delta_history_;
 };
 }
@@ -1,29 +1,29 @@
 #include <petuum_ps/server/server_table.hpp>
+#include <petuum_ps/server/oplog_apply_pool.hpp>
 #include <petuum_ps_common/util/stats.hpp>
 #include <petuum_ps_common/storage/dense_row.hpp>
 #include <iterator>
 #include <vector>
 #include <sstream>
-#include <leveldb/db.h>
 #include <random>
 #include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <thread>
+#include <functional>
 #include <time.h>
 
 namespace petuum {
 
-const int32_t kEndOfFile = -1;
-const size_t kDiskBuffSize = 64*k1_Mi;
-
 ServerTable::ServerTable(int32_t table_id, const TableInfo &table_info):
     table_id_(table_id),
     table_info_(table_info),
-    tmp_row_buff_size_ (kTmpRowBuffSizeInit),
     sample_row_(
         ClassRegistry<AbstractRow>::GetRegistry().CreateObject(
             table_info.row_type)),
-    server_table_logic_(0) {
+    server_table_logic_(0),
+    base_snapshot_clock_(-1),
+    last_snapshot_clock_(-1),
+    num_snapshots_since_base_(0) {
 
 #ifdef PETUUM_COMP_IMPORTANCE
   if (GlobalContext::get_consistency_model() == SSPAggr
@@ -43,6 +43,8 @@ ServerTable::ServerTable(int32_t table_id, const TableInfo &table_info):
 
     ResetImportance_ = ResetImportance;
     SortCandidateVector_ = SortCandidateVectorImportance;
+    // The server table logic applies updates on its own.
+    track_importance_ = (table_info.server_table_logic < 0);
   } else {
     if (table_info.oplog_dense_serialized)
       ApplyRowBatchInc_ = ApplyRowDenseBatchInc;
@@ -51,6 +53,7 @@ ServerTable::ServerTable(int32_t table_id, const TableInfo &table_info):
 
     ResetImportance_ = ResetImportanceNoOp;
     SortCandidateVector_ = SortCandidateVectorRandom;
+    track_importance_ = false;
   }
 
   if (table_info.row_oplog_type == RowOpLogType::kDenseRowOpLog) {
@@ -116,8 +119,12 @@ ServerTable::ServerTable(ServerTable && other):
     table_id_(other.table_id_),
     table_info_(other.table_info_),
     storage_(std::move(other.storage_)) ,
-    tmp_row_buff_size_(other.tmp_row_buff_size_),
-    push_row_iter_(storage_.begin()) {
+    push_row_iter_(storage_.begin()),
+    base_snapshot_clock_(other.base_snapshot_clock_),
+    last_snapshot_clock_(other.last_snapshot_clock_),
+    num_snapshots_since_base_(other.num_snapshots_since_base_),
+    track_importance_(other.track_importance_),
+    importance_histogram_(std::move(other.importance_histogram_)) {
   ApplyRowBatchInc_ = other.ApplyRowBatchInc_;
   ResetImportance_ = other.ResetImportance_;
   SortCandidateVector_ = other.SortCandidateVector_;
@@ -162,13 +169,15 @@ ServerRow *ServerTable::CreateRow (int32_t row_id) {
 }
 
 bool ServerTable::ApplyRowOpLog (int32_t row_id, const int32_t *column_ids,
-        const void *updates, int32_t num_updates) {
+        const void *updates, int32_t num_updates, int32_t client_id) {
 
   auto row_iter = storage_.find(row_id);
   if (row_iter == storage_.end()) {
     return false;
   }
 
+  PreserveRowForSnapShot(row_iter->second);
+
   uint64_t row_version = 0;
   bool end_of_version = false;
   if (table_info_.version_maintain) {
@@ -177,7 +186,9 @@ bool ServerTable::ApplyRowOpLog (int32_t row_id, const int32_t *column_ids,
 
   // TODO: fix this one
   if (server_table_logic_ == 0) {
-    ApplyRowBatchInc_(column_ids, updates, num_updates, row_iter->second);
+    ApplyRowBatchInc(row_iter->second, column_ids, updates, num_updates);
+    RecordRowDelta(row_iter->second, column_ids, updates, num_updates,
+                   client_id);
   } else {
     server_table_logic_->ApplyRowOpLog(
         row_id,
@@ -188,80 +199,106 @@ bool ServerTable::ApplyRowOpLog (int32_t row_id, const int32_t *column_ids,
   return true;
 }
 
-void ServerTable::RowSent(int32_t row_id, ServerRow *row, size_t num_clients) {
-  if (server_table_logic_ != 0) {
-    server_table_logic_->ServerRowSent(row_id, row->get_version(), num_clients);
+void ServerTable::PreserveRowForSnapShot(ServerRow *server_row) {
+  if (server_row->get_snapshot_entry() != 0) {
+    STATS_SERVER_ACCUM_SNAPSHOT_STALL_BEGIN();
+    SnapShotJob::PreserveRow(server_row->get_snapshot_entry());
+    STATS_SERVER_ACCUM_SNAPSHOT_STALL_END();
   }
 }
 
-bool ServerTable::AppendTableToBuffs(
-    int32_t client_id_st,
-    boost::unordered_map<int32_t, RecordBuff> *buffs,
-    int32_t *failed_client_id, bool resume, size_t *num_clients) {
-
-  if (resume) {
-    bool append_row_suc
-        = row_iter_->second->AppendRowToBuffs(
-            client_id_st, buffs, tmp_row_buff_, curr_row_size_,
-            row_iter_->first, failed_client_id, num_clients);
-    if (!append_row_suc)
-      return false;
-    else {
-      if (server_table_logic_ != 0) {
-        server_table_logic_->ServerRowSent(
-            row_iter_->first, row_iter_->second->get_version(), *num_clients);
-      }
-      *num_clients = 0;
-    }
-    ++row_iter_;
-    client_id_st = 0;
+ServerRow *ServerTable::PrepareRowOpLog(int32_t row_id) {
+  ServerRow *server_row = FindRow(row_id);
+  if (server_row == 0)
+    server_row = CreateRow(row_id);
+  PreserveRowForSnapShot(server_row);
+  return server_row;
+}
+
+size_t ServerTable::SerializeRowReply(ServerRow *server_row, int32_t client_id,
+                                      bool accept_row_delta,
+                                      uint64_t cached_row_version,
+                                      void *mem) {
+  RowReplyHeader *header = reinterpret_cast<RowReplyHeader*>(mem);
+  header->row_version = kNoRowDeltaVersion;
+  header->base_version = kNoRowDeltaVersion;
+
+  if (accept_row_delta && row_delta_supported()) {
+    header->row_version = server_row->GetCreateDeltaHistory()->get_version();
+    size_t reply_size = SerializeRowDeltaReply(server_row, client_id,
+                                               cached_row_version, mem);
+    if (reply_size > 0)
+      return reply_size;
   }
+  return sizeof(RowReplyHeader) + server_row->Serialize(
+      reinterpret_cast<uint8_t*>(mem) + sizeof(RowReplyHeader));
+}
 
-  size_t num_no_subscription = 0;
-  for (; row_iter_ != storage_.end(); ++row_iter_) {
-    if (row_iter_->second->NoClientSubscribed()) {
-      num_no_subscription++;
-      continue;
-    }
+size_t ServerTable::SerializeRowDeltaReply(ServerRow *server_row,
+                                           int32_t client_id,
+                                           uint64_t cached_row_version,
+                                           void *mem) {
+  RowDeltaHistory *delta_history = server_row->get_delta_history();
+  if (delta_history == 0 || cached_row_version == kNoRowDeltaVersion)
+    return 0;
+
+  size_t row_size = server_row->SerializedSize();
+  size_t delta_size = delta_history->SerializeDelta(
+      cached_row_version, client_id, sample_row_,
+      sample_row_->get_update_size(), row_size,
+      reinterpret_cast<uint8_t*>(mem) + sizeof(RowReplyHeader));
+  if (delta_size == 0)
+    return 0;
+
+  RowReplyHeader *header = reinterpret_cast<RowReplyHeader*>(mem);
+  header->row_version = delta_history->get_version();
+  header->base_version = cached_row_version;
+  STATS_SERVER_ACCUM_ROW_DELTA_REPLY(row_size, delta_size);
+  return sizeof(RowReplyHeader) + delta_size;
+}
+
+void ServerTable::RowSent(int32_t row_id, ServerRow *row, size_t num_clients) {
+  if (server_table_logic_ != 0) {
+    server_table_logic_->ServerRowSent(row_id, row->get_version(), num_clients);
+  }
+}
 
-    if (!row_iter_->second->IsDirty())
+void ServerTable::AppendTableToPushBodies(
+    PushRowSegment *segment, std::vector<PushRowBody> *bodies) {
+  for (auto &row_pair : storage_) {
+    int32_t row_id = row_pair.first;
+    ServerRow *row = row_pair.second;
+    if (row->NoClientSubscribed() || !row->IsDirty())
       continue;
 
-    STATS_SERVER_ACCUM_IMPORTANCE(
-        table_id_,
-        row_iter_->second->get_importance(),
-        true);
+    STATS_SERVER_ACCUM_IMPORTANCE(table_id_, row->get_importance(), true);
 
-    row_iter_->second->ResetDirty();
-    ResetImportance_(row_iter_->second);
+    row->ResetDirty();
+    ResetRowImportance(row);
 
-    curr_row_size_ = row_iter_->second->SerializedSize();
-    if (curr_row_size_ > tmp_row_buff_size_) {
-      delete[] tmp_row_buff_;
-      tmp_row_buff_size_ = curr_row_size_;
-      tmp_row_buff_ = new uint8_t[curr_row_size_];
-    }
-    curr_row_size_ = row_iter_->second->Serialize(tmp_row_buff_);
-
-    bool append_row_suc = row_iter_->second->AppendRowToBuffs(
-        client_id_st, buffs, tmp_row_buff_, curr_row_size_, row_iter_->first,
-        failed_client_id, num_clients);
-
-    if (!append_row_suc) {
-      return false;
-    } else if (server_table_logic_ != 0) {
-      server_table_logic_->ServerRowSent(
-          row_iter_->first, row_iter_->second->get_version(), *num_clients);
-      *num_clients = 0;
-    }
+    AppendRowToPushBodies(segment, bodies, row_id, row);
   }
-  delete[] tmp_row_buff_;
+}
 
-  return true;
+void ServerTable::AppendRowToPushBodies(
+    PushRowSegment *segment, std::vector<PushRowBody> *bodies,
+    int32_t row_id, ServerRow *row) {
+  uint8_t *row_mem = segment->BeginRecord(row_id, row->SerializedSize());
+  size_t row_size = row->Serialize(row_mem);
+  size_t record_size = 0;
+  size_t offset = segment->EndRecord(row_size, &record_size);
+
+  size_t num_clients = row->AppendRecordToPushBodies(bodies, offset,
+                                                     record_size);
+  if (server_table_logic_ != 0) {
+    server_table_logic_->ServerRowSent(row_id, row->get_version(),
+                                       num_clients);
+  }
 }
 
 void ServerTable::SortCandidateVectorRandom(
-    std::vector<CandidateServerRow> *candidate_row_vector) {
+    std::vector<CandidateServerRow> *candidate_row_vector,
+    size_t num_rows_to_select) {
   std::random_device rd;
   std::mt19937 g(rd());
 
@@ -270,20 +307,20 @@ void ServerTable::SortCandidateVectorRandom(
 }
 
 void ServerTable::SortCandidateVectorImportance(
-    std::vector<CandidateServerRow> *candidate_row_vector) {
-
-  std::sort((*candidate_row_vector).begin(),
-            (*candidate_row_vector).end(),
-            [] (const CandidateServerRow &row1, const CandidateServerRow &row2)
-            {
-              if (row1.server_row_ptr->get_importance() ==
-                  row2.server_row_ptr->get_importance()) {
-                return row1.row_id < row2.row_id;
-              } else {
-                return (row1.server_row_ptr->get_importance() >
-                    row2.server_row_ptr->get_importance());
-              }
-            });
+    std::vector<CandidateServerRow> *candidate_row_vector,
+    size_t num_rows_to_select) {
+
+  SelectTopK(candidate_row_vector, num_rows_to_select,
+             [] (const CandidateServerRow &row1, const CandidateServerRow &row2)
+             {
+               if (row1.server_row_ptr->get_importance() ==
+                   row2.server_row_ptr->get_importance()) {
+                 return row1.row_id < row2.row_id;
+               } else {
+                 return (row1.server_row_ptr->get_importance() >
+                     row2.server_row_ptr->get_importance());
+               }
+             });
 }
 
 void ServerTable::GetPartialTableToSend(
@@ -309,10 +346,22 @@ void ServerTable::GetPartialTableToSendRegular(
 
   size_t storage_size = storage_.size();
 
-  if (num_candidate_rows > storage_size)
-    num_candidate_rows = storage_size;
+  // Rows less important than the threshold cannot make the rows to send,
+  // unless too few of the rows above it are dirty and subscribed to.
+  double importance_threshold = 0;
+  size_t num_rows_above_threshold = storage_size;
+  if (track_importance_) {
+    importance_threshold = importance_histogram_.GetThreshold(
+        num_rows_threshold, &num_rows_above_threshold);
+    if (importance_threshold == 0)
+      num_rows_above_threshold = storage_size;
+  }
 
-  double select_prob = double(num_candidate_rows) / double(storage_size);
+  if (num_candidate_rows > num_rows_above_threshold)
+    num_candidate_rows = num_rows_above_threshold;
+
+  double select_prob = double(num_candidate_rows)
+                       / double(num_rows_above_threshold);
   std::mt19937 generator(time(NULL)); // max 4.2 billion
   std::uniform_real_distribution<> uniform_dist(0, 1);
 
@@ -320,7 +369,8 @@ void ServerTable::GetPartialTableToSendRegular(
 
     for (auto &row_pair : storage_) {
       if (row_pair.second->NoClientSubscribed()
-          || !row_pair.second->IsDirty())
+          || !row_pair.second->IsDirty()
+          || row_pair.second->get_importance() < importance_threshold)
         continue;
 
       double prob = uniform_dist(generator);
@@ -330,7 +380,21 @@ void ServerTable::GetPartialTableToSendRegular(
       if (candidate_row_vector.size() == num_candidate_rows) break;
   }
 
-  SortCandidateVector_(&candidate_row_vector);
+  if (importance_threshold > 0
+      && candidate_row_vector.size() < num_rows_threshold) {
+    for (auto &row_pair : storage_) {
+      if (row_pair.second->NoClientSubscribed()
+          || !row_pair.second->IsDirty()
+          || row_pair.second->get_importance() >= importance_threshold)
+        continue;
+
+      candidate_row_vector.push_back(CandidateServerRow(
+          row_pair.first, row_pair.second));
+      if (candidate_row_vector.size() == num_rows_threshold) break;
+    }
+  }
+
+  SortCandidateVector_(&candidate_row_vector, num_rows_threshold);
 
   for (auto vec_iter = candidate_row_vector.begin();
        vec_iter != candidate_row_vector.end(); vec_iter++) {
@@ -378,13 +442,9 @@ void ServerTable::GetPartialTableToSendFixedOrder(
   }
 }
 
-void ServerTable::AppendRowsToBuffsPartial(
-    boost::unordered_map<int32_t, RecordBuff> *buffs,
+void ServerTable::AppendRowsToPushBodies(
+    PushRowSegment *segment, std::vector<PushRowBody> *bodies,
     const std::vector<std::pair<int32_t, ServerRow*> > &rows_to_send) {
-
-  tmp_row_buff_ = new uint8_t[tmp_row_buff_size_];
-
-  size_t num_clients = 0;
   for (const auto &row_pair : rows_to_send) {
     int32_t row_id = row_pair.first;
     ServerRow *row = row_pair.second;
@@ -396,27 +456,10 @@ void ServerTable::AppendRowsToBuffsPartial(
     STATS_SERVER_ACCUM_IMPORTANCE(table_id_, row->get_importance(), true);
 
     row->ResetDirty();
-    ResetImportance_(row);
+    ResetRowImportance(row);
 
-    curr_row_size_ = row->SerializedSize();
-    if (curr_row_size_ > tmp_row_buff_size_) {
-      delete[] tmp_row_buff_;
-      tmp_row_buff_size_ = curr_row_size_;
-      tmp_row_buff_ = new uint8_t[curr_row_size_];
-    }
-
-    curr_row_size_ = row->Serialize(tmp_row_buff_);
-
-    row->AppendRowToBuffs(
-        buffs, tmp_row_buff_, curr_row_size_, row_id, &num_clients);
-    if (server_table_logic_ != 0) {
-      server_table_logic_->ServerRowSent(
-          row_id, row->get_version(), num_clients);
-      num_clients = 0;
-    }
+    AppendRowToPushBodies(segment, bodies, row_id, row);
   }
-
-  delete[] tmp_row_buff_;
 }
 
 void ServerTable::MakeSnapShotFileName(
@@ -431,97 +474,197 @@ void ServerTable::MakeSnapShotFileName(
   *filename = ss.str();
 }
 
-void ServerTable::TakeSnapShot(
-    const std::string &snapshot_dir,
-    int32_t server_id, int32_t table_id, int32_t clock) const {
+SnapShotKind ServerTable::NextSnapShot(int32_t clock, int32_t *base_clock,
+                                       int32_t *prev_clock) {
+  SnapShotKind kind = kSnapShotDelta;
+  if (last_snapshot_clock_ < 0
+      || num_snapshots_since_base_ + 1
+      >= GlobalContext::get_snapshot_full_interval()) {
+    kind = kSnapShotFull;
+    base_snapshot_clock_ = clock;
+    num_snapshots_since_base_ = 0;
+  } else {
+    ++num_snapshots_since_base_;
+  }
+
+  *base_clock = base_snapshot_clock_;
+  *prev_clock = last_snapshot_clock_;
+  last_snapshot_clock_ = clock;
+  return kind;
+}
 
-  uint8_t *disk_buff = new uint8_t[kDiskBuffSize];
-  size_t disk_buff_offset = 0;
+size_t ServerTable::TakeSnapShot(
+    const std::string &snapshot_dir,
+    int32_t server_id, int32_t table_id, int32_t clock) {
 
   std::string output_name;
   MakeSnapShotFileName(snapshot_dir, server_id, table_id, clock, &output_name);
 
-  std::ofstream snapshot_file;
-  snapshot_file.open(output_name, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc);
-  CHECK(snapshot_file.good());
+  int32_t base_clock, prev_clock;
+  SnapShotKind kind = NextSnapShot(clock, &base_clock, &prev_clock);
 
-  uint8_t *mem_buff = new uint8_t[512];
-  int32_t buff_size = 512;
+  SnapShotWriter writer;
+  writer.Open(output_name, table_id, server_id, clock, table_info_.row_type,
+              kind, base_clock, prev_clock);
   for (auto row_iter = storage_.begin(); row_iter != storage_.end();
        row_iter++) {
-    size_t serialized_size = row_iter->second->SerializedSize();
-    if (buff_size < serialized_size) {
-      delete[] mem_buff;
-      buff_size = serialized_size;
-      mem_buff = new uint8_t[buff_size];
-    }
-    row_iter->second->Serialize(mem_buff);
-    size_t row_size = sizeof(int32_t) + sizeof(size_t) + serialized_size;
-
-    if (disk_buff_offset + row_size > kDiskBuffSize) {
-      if (disk_buff_offset <= buff_size - sizeof(int32_t)) {
-        *reinterpret_cast<int32_t*>(disk_buff + disk_buff_offset) = kEndOfFile;
-        disk_buff_offset += sizeof(int32_t);
-      }
+    if (!IncludeRowInSnapShot(kind, row_iter->second))
+      continue;
+    writer.AppendRow(row_iter->first, row_iter->second->get_row_data());
+  }
+  return writer.Close();
+}
 
-      snapshot_file.write(reinterpret_cast<const char*>(disk_buff), kDiskBuffSize);
-      CHECK(snapshot_file.good()) << snapshot_file.fail() << snapshot_file.bad();
-      disk_buff_offset = 0;
-    }
+SnapShotJob *ServerTable::CreateSnapShotJob(
+    const std::string &snapshot_dir,
+    int32_t server_id, int32_t table_id, int32_t clock) {
 
-    *(reinterpret_cast<int32_t*>(disk_buff + disk_buff_offset)) = row_iter->first;
-    disk_buff_offset += sizeof(int32_t);
+  std::string output_name;
+  MakeSnapShotFileName(snapshot_dir, server_id, table_id, clock, &output_name);
 
-    *(reinterpret_cast<size_t*>(disk_buff + disk_buff_offset)) = serialized_size;
-    disk_buff_offset += sizeof(size_t);
+  int32_t base_clock, prev_clock;
+  SnapShotKind kind = NextSnapShot(clock, &base_clock, &prev_clock);
 
-    memcpy(disk_buff + disk_buff_offset, mem_buff, serialized_size);
-    disk_buff_offset += serialized_size;
+  size_t num_rows = storage_.size();
+  if (kind == kSnapShotDelta) {
+    num_rows = 0;
+    for (const auto &row_pair : storage_) {
+      if (row_pair.second->IsSnapShotDirty())
+        ++num_rows;
+    }
   }
 
-  if (disk_buff_offset + sizeof(int32_t) <= kDiskBuffSize) {
-    *(reinterpret_cast<int32_t*>(disk_buff + disk_buff_offset)) = kEndOfFile;
+  SnapShotJob *job = new SnapShotJob(output_name, table_id, server_id, clock,
+                                     table_info_.row_type, kind, base_clock,
+                                     prev_clock, num_rows);
+  for (auto row_iter = storage_.begin(); row_iter != storage_.end();
+       row_iter++) {
+    if (!IncludeRowInSnapShot(kind, row_iter->second))
+      continue;
+    job->AddRow(row_iter->first, row_iter->second);
   }
+  return job;
+}
+
+namespace {
 
-  snapshot_file.write(reinterpret_cast<const char*>(disk_buff), kDiskBuffSize);
-  CHECK(snapshot_file.good());
-  snapshot_file.close();
-  delete[] mem_buff;
-  delete[] disk_buff;
+// Rows are located, verified and deserialized a batch at a time so that
+// memory used besides the table itself stays bounded.
+const size_t kResumeBatchSize = 64*k1_Ki;
+// Fewer rows than this per thread are not worth a helper thread.
+const size_t kResumeMinRowsPerThread = 1024;
+
+void DeserializeSnapShotRows(int32_t row_type, const std::string &snapshot_name,
+                             const SnapShotRowRef *rows, size_t begin,
+                             size_t end, AbstractRow **row_data) {
+  for (size_t i = begin; i < end; ++i) {
+    if (rows[i].data == 0) {
+      row_data[i] = 0;
+      continue;
+    }
+    CHECK(rows[i].Verify()) << "checksum mismatch on row " << rows[i].row_id
+                            << " in " << snapshot_name;
+    AbstractRow *abstract_row
+        = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type);
+    abstract_row->Deserialize(rows[i].data, rows[i].size);
+    row_data[i] = abstract_row;
+  }
 }
 
+}  // anonymous namespace
+
 void ServerTable::ReadSnapShot(const std::string &resume_dir,
                                int32_t server_id, int32_t table_id, int32_t clock) {
+  HighResolutionTimer resume_timer;
+
+  std::vector<SnapShotRowRef> rows(kResumeBatchSize);
+  std::vector<AbstractRow*> row_data(kResumeBatchSize);
+  // The calling thread plus resume_num_threads helpers, started once for the
+  // whole chain rather than per batch.
+  OpLogApplyPool decode_pool(
+      std::max(GlobalContext::get_resume_num_threads(), 0) + 1);
+  size_t num_bytes = 0;
+
+  // Walk the chain from the newest snapshot back to its full base. A row is
+  // taken from the newest file that has it, so older images are skipped
+  // without being deserialized.
+  int32_t row_type = table_info_.row_type;
+  int32_t snapshot_clock = clock;
+  int32_t chain_length = 0;
+  while (true) {
+    std::string snapshot_name;
+    MakeSnapShotFileName(resume_dir, server_id, table_id, snapshot_clock,
+                         &snapshot_name);
+
+    SnapShotReader reader;
+    reader.Open(snapshot_name);
+    const SnapShotHeader &header = reader.get_header();
+    CHECK_EQ(header.table_id, table_id) << snapshot_name;
+    CHECK_EQ(header.row_type, row_type) << snapshot_name;
+    CHECK_EQ(header.clock, snapshot_clock) << snapshot_name;
+    num_bytes += reader.get_file_size();
+
+    if (chain_length == 0) {
+      storage_.reserve(storage_.size() + reader.get_num_rows());
+      base_snapshot_clock_ = header.base_clock;
+    }
 
-  std::string db_name;
-  MakeSnapShotFileName(resume_dir, server_id, table_id, clock, &db_name);
-
-  leveldb::DB* db;
-  leveldb::Options options;
-  options.create_if_missing = true;
-  leveldb::Status status = leveldb::DB::Open(options, db_name, &db);
-
-  leveldb::Iterator* it = db->NewIterator(leveldb::ReadOptions());
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    int32_t row_id = *(reinterpret_cast<const int32_t*>(it->key().data()));
-    const uint8_t *row_data
-        = reinterpret_cast<const uint8_t*>(it->value().data());
-    size_t row_data_size = it->value().size();
+    size_t num_rows;
+    while ((num_rows = reader.NextBatch(rows.data(), kResumeBatchSize)) > 0) {
+      if (chain_length > 0) {
+        for (size_t i = 0; i < num_rows; ++i) {
+          if (storage_.count(rows[i].row_id) > 0)
+            rows[i].data = 0;
+        }
+      }
 
-    int32_t row_type = table_info_.row_type;
-    AbstractRow *abstract_row
-        = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type);
-    abstract_row->Deserialize(row_data, row_data_size);
-    if (table_info_.version_maintain) {
-      storage_.insert(std::make_pair(row_id, new VersionServerRow(abstract_row)));
-    } else {
-      storage_.insert(std::make_pair(row_id, new ServerRow(abstract_row)));
+      size_t num_workers = std::min(
+          size_t(decode_pool.get_num_workers()),
+          num_rows / kResumeMinRowsPerThread + 1);
+      size_t rows_per_worker = (num_rows + num_workers - 1) / num_workers;
+      decode_pool.Run([&](int32_t worker_idx) {
+          size_t begin = std::min(num_rows, worker_idx*rows_per_worker);
+          size_t end = std::min(num_rows, begin + rows_per_worker);
+          DeserializeSnapShotRows(row_type, snapshot_name, rows.data(),
+                                  begin, end, row_data.data());
+        });
+
+      for (size_t i = 0; i < num_rows; ++i) {
+        if (row_data[i] == 0)
+          continue;
+        ServerRow *server_row = 0;
+        if (table_info_.version_maintain) {
+          server_row = new VersionServerRow(row_data[i]);
+        } else {
+          server_row = new ServerRow(row_data[i]);
+        }
+        server_row->ResetSnapShotDirty();
+        storage_.insert(std::make_pair(rows[i].row_id, server_row));
+      }
+      reader.ReleaseConsumed();
     }
-    VLOG(0) << "ReadSnapShot, row_id = " << row_id;
+
+    ++chain_length;
+    if (header.kind == kSnapShotFull)
+      break;
+    CHECK_EQ(header.kind, static_cast<uint32_t>(kSnapShotDelta))
+        << snapshot_name;
+    CHECK_LT(header.prev_clock, snapshot_clock) << snapshot_name;
+    snapshot_clock = header.prev_clock;
   }
-  delete it;
-  delete db;
+
+  // Continue the chain we resumed from.
+  last_snapshot_clock_ = clock;
+  num_snapshots_since_base_ = chain_length - 1;
   push_row_iter_ = storage_.begin();
+
+  double resume_sec = resume_timer.elapsed();
+  STATS_SERVER_ACCUM_RESUME(num_bytes, resume_sec);
+  LOG(INFO) << "Server " << server_id << " resumed table " << table_id
+            << " at clock " << clock << ": " << storage_.size() << " rows, "
+            << num_bytes / double(k1_Mi) << " MB from " << chain_length
+            << " snapshot(s) in " << resume_sec << " sec ("
+            << num_bytes / double(k1_Mi) / resume_sec << " MB/s)";
 }
 
 void ServerTable::ExtractOpLogVersion(const void *bytes, size_t num_updates,
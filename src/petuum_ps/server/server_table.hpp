@@ -3,7 +3,11 @@
 #pragma once
 #include <petuum_ps/server/server_row.hpp>
 #include <petuum_ps/server/version_server_row.hpp>
+#include <petuum_ps/server/server_table_snapshot.hpp>
+#include <petuum_ps/server/push_row_segment.hpp>
+#include <petuum_ps/thread/ps_msgs.hpp>
 #include <petuum_ps_common/util/class_register.hpp>
+#include <petuum_ps_common/util/top_k.hpp>
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps_common/oplog/dense_row_oplog.hpp>
 #include <petuum_ps_common/oplog/version_dense_row_oplog.hpp>
@@ -41,16 +45,52 @@ public:
 
   ServerRow *CreateRow (int32_t row_id);
 
+  // client_id is the client that sent the updates.
   bool ApplyRowOpLog (int32_t row_id, const int32_t *column_ids,
-                      const void *updates, int32_t num_updates);
+                      const void *updates, int32_t num_updates,
+                      int32_t client_id);
 
-  void RowSent(int32_t row_id, ServerRow *row, size_t num_clients);
+  // Rows of tables without server table logic may be applied concurrently
+  // as long as each row is applied by one thread at a time.
+  bool can_apply_concurrently() const {
+    return server_table_logic_ == 0;
+  }
+
+  // The part of ApplyRowOpLog() that touches the table: find or create the
+  // row and preserve it for a pending snapshot. Server thread only.
+  ServerRow *PrepareRowOpLog(int32_t row_id);
+
+  // The rest of ApplyRowOpLog() for a row returned by PrepareRowOpLog(). May
+  // run on any thread if can_apply_concurrently().
+  void ApplyPreparedRowOpLog(ServerRow *server_row, const int32_t *column_ids,
+                             const void *updates, int32_t num_updates,
+                             int32_t client_id) {
+    ApplyRowBatchInc(server_row, column_ids, updates, num_updates);
+    RecordRowDelta(server_row, column_ids, updates, num_updates, client_id);
+  }
 
-  void InitAppendTableToBuffs() {
-    row_iter_ = storage_.begin();
-    tmp_row_buff_ = new uint8_t[tmp_row_buff_size_];
+  // Upper bound of the size of a row request reply made by
+  // SerializeRowReply().
+  size_t GetRowReplySizeBound(ServerRow *server_row) const {
+    return sizeof(RowReplyHeader) + server_row->SerializedSize();
   }
 
+  // Serialize the row data of a reply to a row request of client_id, which
+  // starts with a RowReplyHeader. If accept_row_delta, the row keeps a delta
+  // history from now on, and a delta since cached_row_version is serialized
+  // instead of the row if the history allows and it is smaller. Returns the
+  // size.
+  size_t SerializeRowReply(ServerRow *server_row, int32_t client_id,
+                           bool accept_row_delta, uint64_t cached_row_version,
+                           void *mem);
+
+  // Like SerializeRowReply() but returns 0 instead of serializing the row if
+  // no delta is sent.
+  size_t SerializeRowDeltaReply(ServerRow *server_row, int32_t client_id,
+                                uint64_t cached_row_version, void *mem);
+
+  void RowSent(int32_t row_id, ServerRow *row, size_t num_clients);
+
   const AbstractRowOpLog *get_sample_row_oplog() const {
     return sample_row_oplog_;
   }
@@ -63,32 +103,47 @@ public:
     return table_info_.server_push_row_upper_bound;
   }
 
-  bool AppendTableToBuffs(
-      int32_t client_id_st,
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
-      int32_t *failed_client_id, bool resume,
-      size_t *num_clients);
+  int32_t get_compress_type() const {
+    return table_info_.compress_type;
+  }
+
+  // Serialize the dirty subscribed rows into segment and add them to the
+  // bodies of their subscribers.
+  void AppendTableToPushBodies(PushRowSegment *segment,
+                               std::vector<PushRowBody> *bodies);
 
   static void SortCandidateVectorRandom(
-      std::vector<CandidateServerRow> *candidate_row_vector);
+      std::vector<CandidateServerRow> *candidate_row_vector,
+      size_t num_rows_to_select __attribute__((unused)));
 
+  // Only the num_rows_to_select most important rows are put in order, at
+  // the front.
   static void SortCandidateVectorImportance(
-      std::vector<CandidateServerRow> *candidate_row_vector);
+      std::vector<CandidateServerRow> *candidate_row_vector,
+      size_t num_rows_to_select);
 
   void GetPartialTableToSend(
       std::vector<std::pair<int32_t, ServerRow*> > *rows_to_send,
       boost::unordered_map<int32_t, size_t> *client_size_map);
 
-  void AppendRowsToBuffsPartial(
-      boost::unordered_map<int32_t, RecordBuff> *buffs,
+  void AppendRowsToPushBodies(
+      PushRowSegment *segment, std::vector<PushRowBody> *bodies,
       const std::vector<std::pair<int32_t, ServerRow*> > &rows_to_send);
 
   void MakeSnapShotFileName(const std::string &snapshot_dir, int32_t server_id,
                             int32_t table_id, int32_t clock,
                             std::string *filename) const;
 
-  void TakeSnapShot(const std::string &snapshot_dir, int32_t server_id,
-                    int32_t table_id, int32_t clock) const;
+  // Returns the number of bytes written. Writes a delta snapshot unless a
+  // full one is due (see TableGroupConfig::snapshot_full_interval).
+  size_t TakeSnapShot(const std::string &snapshot_dir, int32_t server_id,
+                      int32_t table_id, int32_t clock);
+
+  // Freeze the current rows into a copy-on-write snapshot job to be written
+  // by a SnapShotIOThread.
+  SnapShotJob *CreateSnapShotJob(const std::string &snapshot_dir,
+                                 int32_t server_id, int32_t table_id,
+                                 int32_t clock);
 
   void ReadSnapShot(const std::string &resume_dir, int32_t server_id,
                     int32_t table_id, int32_t clock);
@@ -96,6 +151,40 @@ public:
   void ExtractOpLogVersion(const void *bytes, size_t num_updates,
                            uint64_t *row_version, bool *end_of_version);
 private:
+  // Decide the kind of the snapshot taken at clock and advance the chain.
+  SnapShotKind NextSnapShot(int32_t clock, int32_t *base_clock,
+                            int32_t *prev_clock);
+
+  void AppendRowToPushBodies(PushRowSegment *segment,
+                             std::vector<PushRowBody> *bodies,
+                             int32_t row_id, ServerRow *row);
+
+  void PreserveRowForSnapShot(ServerRow *server_row);
+
+  void RecordRowDelta(ServerRow *server_row, const int32_t *column_ids,
+                      const void *updates, int32_t num_updates,
+                      int32_t client_id) {
+    RowDeltaHistory *delta_history = server_row->get_delta_history();
+    if (delta_history != 0) {
+      delta_history->Record(client_id, column_ids, updates, num_updates,
+                            table_info_.oplog_dense_serialized,
+                            sample_row_->get_update_size(),
+                            server_row->SerializedSize());
+    }
+  }
+
+  // Tables whose rows are only changed by adding updates.
+  bool row_delta_supported() const {
+    return server_table_logic_ == 0 && !table_info_.version_maintain;
+  }
+
+  bool IncludeRowInSnapShot(SnapShotKind kind, ServerRow *server_row) {
+    if (kind == kSnapShotDelta && !server_row->IsSnapShotDirty())
+      return false;
+    server_row->ResetSnapShotDirty();
+    return true;
+  }
+
   static void ApplyRowBatchInc(
       const int32_t *column_ids,
       const void *updates, int32_t num_updates,
@@ -134,6 +223,23 @@ private:
     server_row->ResetImportance();
   }
 
+  void ApplyRowBatchInc(ServerRow *server_row, const int32_t *column_ids,
+                        const void *updates, int32_t num_updates) {
+    if (!track_importance_) {
+      ApplyRowBatchInc_(column_ids, updates, num_updates, server_row);
+      return;
+    }
+    double importance = server_row->get_importance();
+    ApplyRowBatchInc_(column_ids, updates, num_updates, server_row);
+    importance_histogram_.Update(importance, server_row->get_importance());
+  }
+
+  void ResetRowImportance(ServerRow *server_row) {
+    if (track_importance_)
+      importance_histogram_.Update(server_row->get_importance(), 0);
+    ResetImportance_(server_row);
+  }
+
   void GetPartialTableToSendRegular(
       std::vector<std::pair<int32_t, ServerRow*> > *rows_to_send,
       boost::unordered_map<int32_t, size_t> *client_size_map);
@@ -147,7 +253,8 @@ private:
   typedef void (*ResetImportanceFunc)(ServerRow *server_row);
 
   typedef void (*SortCandidateVectorFunc)(
-      std::vector<CandidateServerRow> *candidate_row_vector);
+      std::vector<CandidateServerRow> *candidate_row_vector,
+      size_t num_rows_to_select);
 
   typedef void (ServerTable::*GetPartialTableToSendFunc)(
       std::vector<std::pair<int32_t, ServerRow*> > *rows_to_send,
@@ -157,13 +264,6 @@ private:
   TableInfo table_info_;
   boost::unordered_map<int32_t, ServerRow*> storage_;
 
-  // used for appending rows to buffs
-  boost::unordered_map<int32_t, ServerRow*>::iterator row_iter_;
-  uint8_t *tmp_row_buff_;
-  size_t tmp_row_buff_size_;
-  static const size_t kTmpRowBuffSizeInit = 512;
-  size_t curr_row_size_;
-
   ApplyRowBatchIncFunc ApplyRowBatchInc_;
   ResetImportanceFunc ResetImportance_;
   SortCandidateVectorFunc SortCandidateVector_;
@@ -175,6 +275,16 @@ private:
   const AbstractRowOpLog *sample_row_oplog_;
 
   AbstractServerTableLogic *server_table_logic_;
+
+  // snapshot chain, -1 if no snapshot has been taken or resumed from
+  int32_t base_snapshot_clock_;
+  int32_t last_snapshot_clock_;
+  int32_t num_snapshots_since_base_;
+
+  // Row importances are tracked in importance_histogram_ when rows are
+  // pushed in order of importance.
+  bool track_importance_;
+  ImportanceHistogram importance_histogram_;
 };
 
 }
@@ -0,0 +1,401 @@
+#include <petuum_ps/server/server_table_snapshot.hpp>
+#include <petuum_ps_common/util/crc32c.hpp>
+#include <petuum_ps_common/include/constants.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <thread>
+
+namespace petuum {
+
+const size_t SnapShotWriter::kDiskBuffSize = 64*k1_Mi;
+
+namespace {
+
+void WriteAll(int fd, const uint8_t *data, size_t size,
+              const std::string &filename) {
+  while (size > 0) {
+    ssize_t ret = write(fd, data, size);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    CHECK_GT(ret, 0) << "write to " << filename << " failed: "
+                     << strerror(errno);
+    data += ret;
+    size -= ret;
+  }
+}
+
+void SyncParentDir(const std::string &filename) {
+  size_t pos = filename.find_last_of('/');
+  std::string dir = (pos == std::string::npos) ? "." : filename.substr(0, pos);
+  if (dir.empty())
+    dir = "/";
+  int dir_fd = open(dir.c_str(), O_RDONLY);
+  if (dir_fd < 0)
+    return;
+  fsync(dir_fd);
+  close(dir_fd);
+}
+
+// Covers the row's framing as well as its bytes, so that a corrupted row_id
+// or row_size is caught like corrupted data.
+uint32_t RowChecksum(int32_t row_id, uint64_t row_size, const void *data) {
+  uint32_t crc = CRC32C::Extend(0, &row_id, sizeof(row_id));
+  crc = CRC32C::Extend(crc, &row_size, sizeof(row_size));
+  return CRC32C::Extend(crc, data, row_size);
+}
+
+}  // anonymous namespace
+
+SnapShotWriter::SnapShotWriter():
+    fd_(-1),
+    disk_buff_(0),
+    disk_buff_offset_(0),
+    row_buff_(0),
+    row_buff_size_(0),
+    num_rows_(0),
+    num_row_bytes_(0),
+    bytes_written_(0) { }
+
+SnapShotWriter::~SnapShotWriter() {
+  if (fd_ >= 0) {
+    // Close() was never called; leave no partial file behind.
+    close(fd_);
+    unlink(tmp_filename_.c_str());
+  }
+  free(disk_buff_);
+  delete[] row_buff_;
+}
+
+void SnapShotWriter::Open(const std::string &filename, int32_t table_id,
+                          int32_t server_id, int32_t clock,
+                          int32_t row_type, SnapShotKind kind,
+                          int32_t base_clock, int32_t prev_clock) {
+  CHECK_LT(fd_, 0) << "snapshot writer is already open";
+  filename_ = filename;
+  tmp_filename_ = filename + ".tmp";
+
+  fd_ = open(tmp_filename_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  CHECK_GE(fd_, 0) << "cannot open " << tmp_filename_ << ": "
+                   << strerror(errno);
+
+  if (disk_buff_ == 0) {
+    void *mem = 0;
+    int ret = posix_memalign(&mem, kDiskBuffAlignment, kDiskBuffSize);
+    CHECK_EQ(ret, 0) << "posix_memalign failed";
+    disk_buff_ = reinterpret_cast<uint8_t*>(mem);
+  }
+  disk_buff_offset_ = 0;
+  num_rows_ = 0;
+  num_row_bytes_ = 0;
+  bytes_written_ = 0;
+
+  SnapShotHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kSnapShotMagic;
+  header.version = kSnapShotVersion;
+  header.table_id = table_id;
+  header.server_id = server_id;
+  header.clock = clock;
+  header.row_type = row_type;
+  header.kind = kind;
+  header.base_clock = (kind == kSnapShotFull) ? clock : base_clock;
+  header.prev_clock = prev_clock;
+  header.checksum = CRC32C::Value(&header, offsetof(SnapShotHeader, checksum));
+  Append(&header, sizeof(header));
+}
+
+void SnapShotWriter::AppendRow(int32_t row_id, const AbstractRow *row) {
+  size_t serialized_size = row->SerializedSize();
+  if (serialized_size > row_buff_size_) {
+    delete[] row_buff_;
+    row_buff_size_ = serialized_size;
+    row_buff_ = new uint8_t[row_buff_size_];
+  }
+  size_t row_size = row->Serialize(row_buff_);
+  AppendRow(row_id, row_buff_, row_size);
+}
+
+void SnapShotWriter::AppendRow(int32_t row_id, const void *row_data,
+                               size_t row_size) {
+  SnapShotRowHeader row_header;
+  row_header.row_id = row_id;
+  row_header.row_size = row_size;
+  row_header.checksum = RowChecksum(row_id, row_header.row_size, row_data);
+
+  Append(&row_header, sizeof(row_header));
+  Append(row_data, row_size);
+
+  ++num_rows_;
+  num_row_bytes_ += row_size;
+}
+
+size_t SnapShotWriter::Close() {
+  CHECK_GE(fd_, 0) << "snapshot writer is not open";
+
+  SnapShotFooter footer;
+  memset(&footer, 0, sizeof(footer));
+  footer.num_rows = num_rows_;
+  footer.num_row_bytes = num_row_bytes_;
+  footer.magic = kSnapShotMagic;
+  footer.checksum = CRC32C::Value(&footer, offsetof(SnapShotFooter, checksum));
+  Append(&footer, sizeof(footer));
+  Flush();
+
+  CHECK_EQ(fdatasync(fd_), 0) << "fdatasync " << tmp_filename_ << " failed: "
+                              << strerror(errno);
+  CHECK_EQ(close(fd_), 0);
+  fd_ = -1;
+
+  CHECK_EQ(rename(tmp_filename_.c_str(), filename_.c_str()), 0)
+      << "rename " << tmp_filename_ << " failed: " << strerror(errno);
+  SyncParentDir(filename_);
+
+  return bytes_written_;
+}
+
+void SnapShotWriter::Append(const void *data, size_t size) {
+  const uint8_t *data_uint8 = reinterpret_cast<const uint8_t*>(data);
+  while (size > 0) {
+    size_t copy_size = std::min(size, kDiskBuffSize - disk_buff_offset_);
+    memcpy(disk_buff_ + disk_buff_offset_, data_uint8, copy_size);
+    disk_buff_offset_ += copy_size;
+    data_uint8 += copy_size;
+    size -= copy_size;
+    if (disk_buff_offset_ == kDiskBuffSize)
+      Flush();
+  }
+}
+
+void SnapShotWriter::Flush() {
+  if (disk_buff_offset_ == 0)
+    return;
+  WriteAll(fd_, disk_buff_, disk_buff_offset_, tmp_filename_);
+  bytes_written_ += disk_buff_offset_;
+  disk_buff_offset_ = 0;
+}
+
+SnapShotReader::SnapShotReader():
+    mem_(0),
+    file_size_(0),
+    offset_(0),
+    rows_end_(0),
+    num_rows_read_(0),
+    released_offset_(0) { }
+
+SnapShotReader::~SnapShotReader() {
+  Close();
+}
+
+void SnapShotReader::Open(const std::string &filename) {
+  CHECK(mem_ == 0) << "snapshot reader is already open";
+  filename_ = filename;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "cannot open snapshot " << filename << ": "
+                  << strerror(errno);
+
+  struct stat file_stat;
+  CHECK_EQ(fstat(fd, &file_stat), 0) << "fstat " << filename << " failed";
+  file_size_ = file_stat.st_size;
+  CHECK_GE(file_size_, sizeof(SnapShotHeader) + sizeof(SnapShotFooter))
+      << "snapshot " << filename << " is truncated";
+
+  void *mem = mmap(0, file_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  CHECK(mem != MAP_FAILED) << "mmap " << filename << " failed: "
+                           << strerror(errno);
+  close(fd);
+  madvise(mem, file_size_, MADV_SEQUENTIAL);
+  mem_ = reinterpret_cast<const uint8_t*>(mem);
+
+  memcpy(&header_, mem_, sizeof(header_));
+  CHECK_EQ(header_.magic, kSnapShotMagic)
+      << filename << " is not a server table snapshot";
+  CHECK_EQ(header_.version, kSnapShotVersion)
+      << "unsupported snapshot version in " << filename;
+  CHECK_EQ(header_.checksum,
+           CRC32C::Value(&header_, offsetof(SnapShotHeader, checksum)))
+      << "corrupted snapshot header in " << filename;
+
+  memcpy(&footer_, mem_ + file_size_ - sizeof(footer_), sizeof(footer_));
+  CHECK_EQ(footer_.magic, kSnapShotMagic)
+      << "missing snapshot footer in " << filename;
+  CHECK_EQ(footer_.checksum,
+           CRC32C::Value(&footer_, offsetof(SnapShotFooter, checksum)))
+      << "corrupted snapshot footer in " << filename;
+
+  offset_ = sizeof(SnapShotHeader);
+  rows_end_ = file_size_ - sizeof(SnapShotFooter);
+  num_rows_read_ = 0;
+  released_offset_ = 0;
+}
+
+bool SnapShotRowRef::Verify() const {
+  return checksum == RowChecksum(row_id, size, data);
+}
+
+bool SnapShotReader::NextRowRef(SnapShotRowRef *row) {
+  if (offset_ == rows_end_) {
+    CHECK_EQ(num_rows_read_, footer_.num_rows)
+        << "row count mismatch in " << filename_;
+    return false;
+  }
+
+  CHECK_LE(offset_ + sizeof(SnapShotRowHeader), rows_end_)
+      << "truncated row header in " << filename_;
+  SnapShotRowHeader row_header;
+  memcpy(&row_header, mem_ + offset_, sizeof(row_header));
+  offset_ += sizeof(row_header);
+
+  CHECK_LE(row_header.row_size, rows_end_ - offset_)
+      << "truncated row " << row_header.row_id << " in " << filename_;
+  row->row_id = row_header.row_id;
+  row->checksum = row_header.checksum;
+  row->data = mem_ + offset_;
+  row->size = row_header.row_size;
+  offset_ += row_header.row_size;
+
+  ++num_rows_read_;
+  return true;
+}
+
+const void *SnapShotReader::Next(int32_t *row_id, size_t *row_size) {
+  SnapShotRowRef row;
+  if (!NextRowRef(&row))
+    return 0;
+  CHECK(row.Verify()) << "checksum mismatch on row " << row.row_id
+                      << " in " << filename_;
+  *row_id = row.row_id;
+  *row_size = row.size;
+  return row.data;
+}
+
+size_t SnapShotReader::NextBatch(SnapShotRowRef *rows, size_t max_rows) {
+  size_t num_rows = 0;
+  while (num_rows < max_rows && NextRowRef(rows + num_rows))
+    ++num_rows;
+  return num_rows;
+}
+
+void SnapShotReader::ReleaseConsumed() {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t release_end = offset_ / page_size * page_size;
+  if (release_end <= released_offset_)
+    return;
+  madvise(const_cast<uint8_t*>(mem_) + released_offset_,
+          release_end - released_offset_, MADV_DONTNEED);
+  released_offset_ = release_end;
+}
+
+void SnapShotReader::Close() {
+  if (mem_ == 0)
+    return;
+  munmap(const_cast<uint8_t*>(mem_), file_size_);
+  mem_ = 0;
+  file_size_ = 0;
+}
+
+SnapShotJob::SnapShotJob(const std::string &filename, int32_t table_id,
+                         int32_t server_id, int32_t clock, int32_t row_type,
+                         SnapShotKind kind, int32_t base_clock,
+                         int32_t prev_clock, size_t num_rows):
+    filename_(filename),
+    table_id_(table_id),
+    server_id_(server_id),
+    clock_(clock),
+    row_type_(row_type),
+    kind_(kind),
+    base_clock_(base_clock),
+    prev_clock_(prev_clock),
+    entries_(new SnapShotRowEntry[num_rows]),
+    num_entries_(0),
+    capacity_(num_rows),
+    bytes_written_(0),
+    write_sec_(0.0),
+    done_(false) { }
+
+SnapShotJob::~SnapShotJob() {
+  delete[] entries_;
+}
+
+void SnapShotJob::AddRow(int32_t row_id, ServerRow *row) {
+  CHECK_LT(num_entries_, capacity_);
+  CHECK(row->get_snapshot_entry() == 0) << "row " << row_id
+                                        << " is in two snapshots";
+  SnapShotRowEntry &entry = entries_[num_entries_++];
+  entry.row_id = row_id;
+  entry.row = row;
+  entry.state.store(SnapShotRowEntry::kPending, std::memory_order_relaxed);
+  entry.copy = 0;
+  entry.copy_size = 0;
+  row->set_snapshot_entry(&entry);
+}
+
+void SnapShotJob::PreserveRow(SnapShotRowEntry *entry) {
+  int32_t state = SnapShotRowEntry::kPending;
+  if (entry->state.compare_exchange_strong(state,
+                                           SnapShotRowEntry::kClaimed)) {
+    const AbstractRow *row_data = entry->row->get_row_data();
+    entry->copy = new uint8_t[row_data->SerializedSize()];
+    entry->copy_size = row_data->Serialize(entry->copy);
+    entry->state.store(SnapShotRowEntry::kCopied, std::memory_order_release);
+    return;
+  }
+
+  // The I/O thread is serializing this row; it takes no longer than the
+  // copy we would otherwise make.
+  while (state == SnapShotRowEntry::kClaimed) {
+    std::this_thread::yield();
+    state = entry->state.load(std::memory_order_acquire);
+  }
+}
+
+void SnapShotJob::Write() {
+  HighResolutionTimer write_timer;
+
+  SnapShotWriter writer;
+  writer.Open(filename_, table_id_, server_id_, clock_, row_type_,
+              kind_, base_clock_, prev_clock_);
+  for (size_t i = 0; i < num_entries_; ++i) {
+    SnapShotRowEntry &entry = entries_[i];
+    int32_t state = SnapShotRowEntry::kPending;
+    if (entry.state.compare_exchange_strong(state,
+                                            SnapShotRowEntry::kClaimed)) {
+      writer.AppendRow(entry.row_id, entry.row->get_row_data());
+      entry.state.store(SnapShotRowEntry::kWritten,
+                        std::memory_order_release);
+      continue;
+    }
+
+    while (state != SnapShotRowEntry::kCopied) {
+      std::this_thread::yield();
+      state = entry.state.load(std::memory_order_acquire);
+    }
+    writer.AppendRow(entry.row_id, entry.copy, entry.copy_size);
+    delete[] entry.copy;
+    entry.copy = 0;
+    entry.state.store(SnapShotRowEntry::kWritten, std::memory_order_relaxed);
+  }
+  bytes_written_ = writer.Close();
+  write_sec_ = write_timer.elapsed();
+  done_.store(true, std::memory_order_release);
+}
+
+void SnapShotJob::Release() {
+  CHECK(IsDone());
+  for (size_t i = 0; i < num_entries_; ++i) {
+    entries_[i].row->set_snapshot_entry(0);
+  }
+}
+
+}  // namespace petuum
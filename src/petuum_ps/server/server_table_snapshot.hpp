@@ -0,0 +1,254 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <atomic>
+#include <boost/noncopyable.hpp>
+
+#include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps/server/server_row.hpp>
+
+namespace petuum {
+
+// On-disk layout of a server table snapshot (native byte order):
+//
+// 1. SnapShotHeader
+// 2. A sequence of rows, each framed as
+//    SnapShotRowHeader followed by row_size bytes of AbstractRow::Serialize()
+//    output. The checksum covers row_id, row_size and the row bytes.
+// 3. SnapShotFooter
+//
+// The writer produces "<filename>.tmp" and renames it to <filename> only after
+// all data is on disk, so a file with the final name is always complete. The
+// footer records the number of rows so that a reader can pre-size its storage
+// before deserializing anything.
+//
+// A delta snapshot only holds rows modified since the snapshot taken at
+// prev_clock. Following prev_clock leads back to the full snapshot taken at
+// base_clock; a row's latest image is the one in the newest file of that
+// chain containing it.
+
+const uint32_t kSnapShotMagic = 0x50535331;  // "PSS1"
+const uint32_t kSnapShotVersion = 2;
+
+enum SnapShotKind {
+  kSnapShotFull = 0,
+  kSnapShotDelta = 1
+};
+
+struct SnapShotHeader {
+  uint32_t magic;
+  uint32_t version;
+  int32_t table_id;
+  int32_t server_id;
+  int32_t clock;
+  int32_t row_type;
+  uint32_t kind;        // SnapShotKind
+  int32_t base_clock;   // clock of the full snapshot of the chain
+  int32_t prev_clock;   // for deltas, clock of the preceding snapshot
+  uint32_t reserved[6];
+  uint32_t checksum;  // covers all preceding fields
+};
+
+struct SnapShotRowHeader {
+  int32_t row_id;
+  uint32_t checksum;
+  uint64_t row_size;
+};
+
+struct SnapShotFooter {
+  uint64_t num_rows;
+  uint64_t num_row_bytes;
+  uint32_t magic;
+  uint32_t checksum;  // covers all preceding fields
+};
+
+static_assert(sizeof(SnapShotHeader) == 64, "unexpected header size");
+static_assert(sizeof(SnapShotRowHeader) == 16, "unexpected row header size");
+static_assert(sizeof(SnapShotFooter) == 24, "unexpected footer size");
+
+// Streams rows into a snapshot file through a large page-aligned buffer.
+// Every write to the file except the final one is exactly kDiskBuffSize
+// bytes.
+class SnapShotWriter : boost::noncopyable {
+public:
+  SnapShotWriter();
+  ~SnapShotWriter();
+
+  void Open(const std::string &filename, int32_t table_id, int32_t server_id,
+            int32_t clock, int32_t row_type,
+            SnapShotKind kind = kSnapShotFull, int32_t base_clock = -1,
+            int32_t prev_clock = -1);
+
+  void AppendRow(int32_t row_id, const AbstractRow *row);
+
+  // Append a row that is already serialized.
+  void AppendRow(int32_t row_id, const void *row_data, size_t row_size);
+
+  // Flush, write the footer, sync and atomically publish the file.
+  // Returns the total number of bytes written.
+  size_t Close();
+
+  static const size_t kDiskBuffSize;
+  static const size_t kDiskBuffAlignment = 4096;
+
+private:
+  void Append(const void *data, size_t size);
+  void Flush();
+
+  std::string filename_;
+  std::string tmp_filename_;
+  int fd_;
+
+  uint8_t *disk_buff_;
+  size_t disk_buff_offset_;
+
+  uint8_t *row_buff_;
+  size_t row_buff_size_;
+
+  uint64_t num_rows_;
+  uint64_t num_row_bytes_;
+  size_t bytes_written_;
+};
+
+// A row located in a mapped snapshot file whose checksum is not verified
+// yet; see SnapShotReader::NextBatch().
+struct SnapShotRowRef {
+  int32_t row_id;
+  uint32_t checksum;
+  const void *data;
+  size_t size;
+
+  bool Verify() const;
+};
+
+// Maps a snapshot file into memory and validates it while iterating. Row
+// data returned by Next() points into the mapping and stays valid until
+// Close().
+class SnapShotReader : boost::noncopyable {
+public:
+  SnapShotReader();
+  ~SnapShotReader();
+
+  void Open(const std::string &filename);
+
+  const SnapShotHeader &get_header() const {
+    return header_;
+  }
+
+  uint64_t get_num_rows() const {
+    return footer_.num_rows;
+  }
+
+  size_t get_file_size() const {
+    return file_size_;
+  }
+
+  // Returns a pointer to the serialized row, or 0 after the last row.
+  const void *Next(int32_t *row_id, size_t *row_size);
+
+  // Locate up to max_rows rows without verifying their checksums, so that
+  // the caller can verify and deserialize them in parallel. Returns the
+  // number of rows, 0 after the last row.
+  size_t NextBatch(SnapShotRowRef *rows, size_t max_rows);
+
+  // Drop the pages of rows returned so far from memory. Row data returned
+  // before the call must not be accessed anymore.
+  void ReleaseConsumed();
+
+  void Close();
+
+private:
+  // Returns false after the last row.
+  bool NextRowRef(SnapShotRowRef *row);
+
+  std::string filename_;
+  const uint8_t *mem_;
+  size_t file_size_;
+  size_t offset_;
+  size_t rows_end_;
+  uint64_t num_rows_read_;
+  size_t released_offset_;
+
+  SnapShotHeader header_;
+  SnapShotFooter footer_;
+};
+
+// A row of an in-flight background snapshot. The server thread and the
+// snapshot I/O thread race to claim the row: whoever moves state out of
+// kPending first serializes it. The I/O thread writes the live row; the
+// server thread, which is about to modify the row, saves a private copy that
+// the I/O thread writes later.
+struct SnapShotRowEntry {
+  enum State {
+    kPending = 0,
+    kClaimed = 1,
+    kCopied = 2,
+    kWritten = 3
+  };
+
+  int32_t row_id;
+  ServerRow *row;
+  std::atomic<int32_t> state;
+  uint8_t *copy;
+  size_t copy_size;
+};
+
+// A copy-on-write snapshot of one server table. It is created on the server
+// thread at the snapshot clock, written by the snapshot I/O thread and
+// released on the server thread once done.
+class SnapShotJob : boost::noncopyable {
+public:
+  SnapShotJob(const std::string &filename, int32_t table_id,
+              int32_t server_id, int32_t clock, int32_t row_type,
+              SnapShotKind kind, int32_t base_clock, int32_t prev_clock,
+              size_t num_rows);
+  ~SnapShotJob();
+
+  // Server thread. Must be called for all rows before the job is handed to
+  // the I/O thread.
+  void AddRow(int32_t row_id, ServerRow *row);
+
+  // Server thread. Must be called before modifying a row whose snapshot
+  // entry is set.
+  static void PreserveRow(SnapShotRowEntry *entry);
+
+  // I/O thread.
+  void Write();
+
+  bool IsDone() const {
+    return done_.load(std::memory_order_acquire);
+  }
+
+  // Server thread, after IsDone(). Detaches the job from the rows.
+  void Release();
+
+  size_t get_bytes_written() const {
+    return bytes_written_;
+  }
+
+  double get_write_sec() const {
+    return write_sec_;
+  }
+
+private:
+  const std::string filename_;
+  const int32_t table_id_;
+  const int32_t server_id_;
+  const int32_t clock_;
+  const int32_t row_type_;
+  const SnapShotKind kind_;
+  const int32_t base_clock_;
+  const int32_t prev_clock_;
+
+  SnapShotRowEntry *entries_;
+  size_t num_entries_;
+  size_t capacity_;
+
+  size_t bytes_written_;
+  double write_sec_;
+  std::atomic<bool> done_;
+};
+
+}  // namespace petuum
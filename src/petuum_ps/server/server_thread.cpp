@@ -6,6 +6,7 @@
 #include <petuum_ps_common/thread/mem_transfer.hpp>
 #include <petuum_ps/thread/numa_mgr.hpp>
 #include <unistd.h>
+#include <map>
 namespace petuum {
 
 bool ServerThread::WaitMsgBusy(int32_t *sender_id, zmq::message_t *zmq_msg,
@@ -50,6 +51,8 @@ void ServerThread::SetWaitMsg() {
 void ServerThread::SetUpCommBus() {
   CommBus::Config comm_config;
   comm_config.entity_id_ = my_id_;
+  // Oplogs gathered by remote bg threads are read from the frames.
+  comm_config.keep_more_frames_ = true;
 
   if (GlobalContext::get_num_clients() > 1) {
     comm_config.ltype_ = CommBus::kInProc | CommBus::kInterProc;
@@ -147,7 +150,7 @@ void ServerThread::HandleCreateTable(int32_t sender_id,
   int32_t table_id = create_table_msg.get_table_id();
 
   // I'm not name node
-  CreateTableReplyMsg create_table_reply_msg;
+  CreateTableReplyMsg create_table_reply_msg(static_cast<size_t>(0));
   create_table_reply_msg.get_table_id() = create_table_msg.get_table_id();
   size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(sender_id,
     create_table_reply_msg.get_mem(), create_table_reply_msg.get_size());
@@ -167,6 +170,8 @@ void ServerThread::HandleCreateTable(int32_t sender_id,
       = create_table_msg.get_server_table_logic();
   table_info.version_maintain
       = create_table_msg.get_version_maintain();
+  table_info.compress_type
+      = create_table_msg.get_compress_type();
 
   //LOG(INFO) << "server table logic = " << table_info.server_table_logic
   //        << " version maintain = " << table_info.version_maintain;
@@ -187,10 +192,13 @@ void ServerThread::HandleRowRequest(int32_t sender_id,
   int32_t table_id = row_request_msg.get_table_id();
   int32_t row_id = row_request_msg.get_row_id();
   int32_t clock = row_request_msg.get_clock();
+  bool accept_row_delta = row_request_msg.get_accept_row_delta();
+  uint64_t cached_row_version = row_request_msg.get_cached_row_version();
   int32_t server_clock = server_obj_.GetMinClock();
   if (server_clock < clock) {
     // not fresh enough, wait
-    server_obj_.AddRowRequest(sender_id, table_id, row_id, clock);
+    server_obj_.AddRowRequest(sender_id, table_id, row_id, clock,
+                              accept_row_delta, cached_row_version);
     return;
   }
 
@@ -199,13 +207,44 @@ void ServerThread::HandleRowRequest(int32_t sender_id,
   RowSubscribe(server_row, GlobalContext::thread_id_to_client_id(sender_id));
 
   ReplyRowRequest(sender_id, server_row, table_id, row_id, server_clock,
-                  version);
+                  version, accept_row_delta, cached_row_version);
+}
+
+void ServerThread::HandleBatchRowRequest(
+    int32_t sender_id, BatchRowRequestMsg &batch_row_request_msg) {
+  int32_t table_id = batch_row_request_msg.get_table_id();
+  int32_t clock = batch_row_request_msg.get_clock();
+  int32_t num_rows = batch_row_request_msg.get_num_rows();
+  const int32_t *row_ids = batch_row_request_msg.get_row_ids();
+  int32_t server_clock = server_obj_.GetMinClock();
+
+  if (server_clock < clock) {
+    // not fresh enough, wait
+    for (int32_t i = 0; i < num_rows; ++i) {
+      server_obj_.AddRowRequest(sender_id, table_id, row_ids[i], clock);
+    }
+    return;
+  }
+
+  uint32_t version = server_obj_.GetBgVersion(sender_id);
+  int32_t client_id = GlobalContext::thread_id_to_client_id(sender_id);
+  std::vector<RowToReply> rows(num_rows);
+  for (int32_t i = 0; i < num_rows; ++i) {
+    ServerRow *server_row = server_obj_.FindCreateRow(table_id, row_ids[i]);
+    RowSubscribe(server_row, client_id);
+    rows[i].table_id = table_id;
+    rows[i].row_id = row_ids[i];
+    rows[i].server_row = server_row;
+  }
+  ReplyRowRequests(sender_id, rows, server_clock, version);
 }
 
 void ServerThread::ReplyRowRequest(int32_t bg_id, ServerRow *server_row,
                                    int32_t table_id, int32_t row_id,
-                                   int32_t server_clock, uint32_t version) {
-  size_t row_size = server_row->SerializedSize();
+                                   int32_t server_clock, uint32_t version,
+                                   bool accept_row_delta,
+                                   uint64_t cached_row_version) {
+  size_t row_size = server_obj_.GetRowReplySizeBound(table_id, server_row);
 
   ServerRowRequestReplyMsg server_row_request_reply_msg(row_size);
   server_row_request_reply_msg.get_table_id() = table_id;
@@ -213,16 +252,162 @@ void ServerThread::ReplyRowRequest(int32_t bg_id, ServerRow *server_row,
   server_row_request_reply_msg.get_clock() = server_clock;
   server_row_request_reply_msg.get_version() = version;
 
-  row_size = server_row->Serialize(server_row_request_reply_msg.get_row_data());
+  row_size = server_obj_.SerializeRowReply(
+      table_id, server_row, bg_id, accept_row_delta, cached_row_version,
+      server_row_request_reply_msg.get_row_data());
 
   server_row_request_reply_msg.get_row_size() = row_size;
+  // Only the bytes used are sent.
+  server_row_request_reply_msg.get_avai_size() = row_size;
 
   MemTransfer::TransferMem(comm_bus_, bg_id, &server_row_request_reply_msg);
   server_obj_.RowSent(table_id, row_id, server_row, 1);
 }
 
+void ServerThread::ReplyRowRequests(int32_t bg_id,
+                                    const std::vector<RowToReply> &rows,
+                                    int32_t server_clock, uint32_t version) {
+  size_t row_header_size
+      = ServerBatchRowRequestReplyMsg::get_row_header_size();
+  auto batch_begin = rows.begin();
+  while (batch_begin != rows.end()) {
+    // SerializedSize() is an upper bound of the serialized size.
+    size_t batch_size = 0;
+    auto batch_end = batch_begin;
+    do {
+      batch_size += row_header_size + server_obj_.GetRowReplySizeBound(
+          batch_end->table_id, batch_end->server_row);
+      ++batch_end;
+    } while (batch_end != rows.end()
+             && batch_size + row_header_size
+             + server_obj_.GetRowReplySizeBound(
+                 batch_end->table_id, batch_end->server_row)
+             <= kMaxBatchReplySize);
+
+    ServerBatchRowRequestReplyMsg batch_reply_msg(batch_size);
+    batch_reply_msg.get_clock() = server_clock;
+    batch_reply_msg.get_version() = version;
+    batch_reply_msg.get_num_rows() = batch_end - batch_begin;
+
+    uint8_t *mem = batch_reply_msg.get_data();
+    for (auto row_iter = batch_begin; row_iter != batch_end; ++row_iter) {
+      *(reinterpret_cast<int32_t*>(mem)) = row_iter->table_id;
+      mem += sizeof(int32_t);
+      *(reinterpret_cast<int32_t*>(mem)) = row_iter->row_id;
+      mem += sizeof(int32_t);
+      size_t &row_size = *(reinterpret_cast<size_t*>(mem));
+      mem += sizeof(size_t);
+      // Batch requests do not carry cached row versions.
+      row_size = server_obj_.SerializeRowReply(
+          row_iter->table_id, row_iter->server_row, bg_id, false,
+          kNoRowDeltaVersion, mem);
+      mem += row_size;
+    }
+    batch_reply_msg.get_avai_size() = mem - batch_reply_msg.get_data();
+
+    MemTransfer::TransferMem(comm_bus_, bg_id, &batch_reply_msg);
+    for (auto row_iter = batch_begin; row_iter != batch_end; ++row_iter) {
+      server_obj_.RowSent(row_iter->table_id, row_iter->row_id,
+                          row_iter->server_row, 1);
+    }
+    batch_begin = batch_end;
+  }
+}
+
+void ServerThread::ReplyFulfilledRowRequests(
+    const FulfilledRowRequests &fulfilled, int32_t server_clock) {
+  struct SerializedRow {
+    ServerRow *server_row;
+    size_t offset;
+    size_t record_size;
+    size_t num_requesters;
+  };
+
+  std::vector<bool> accept_row_delta(fulfilled.rows.size(), false);
+  for (const auto &requester : fulfilled.requesters) {
+    if (requester.accept_row_delta)
+      accept_row_delta[requester.row_idx] = true;
+  }
+
+  PushRowSegment *segment = new PushRowSegment;
+  std::vector<SerializedRow> rows(fulfilled.rows.size());
+  for (size_t i = 0; i < fulfilled.rows.size(); ++i) {
+    SerializedRow &row = rows[i];
+    int32_t table_id = fulfilled.rows[i].table_id;
+    row.server_row = server_obj_.FindCreateRow(table_id,
+                                               fulfilled.rows[i].row_id);
+    uint8_t *row_mem = segment->BeginRecord(
+        fulfilled.rows[i].row_id,
+        server_obj_.GetRowReplySizeBound(table_id, row.server_row));
+    // The row version in the shared record is that of a full reply to any
+    // of the requesters.
+    size_t row_size = server_obj_.SerializeRowReply(
+        table_id, row.server_row, -1, accept_row_delta[i],
+        kNoRowDeltaVersion, row_mem);
+    row.offset = segment->EndRecord(row_size, &row.record_size);
+    row.num_requesters = 0;
+  }
+
+  // A reply record is the table id followed by the segment record, which
+  // makes up the row header of ServerBatchRowRequestReplyMsg.
+  std::map<int32_t, std::vector<PushRowBody> > bg_bodies;
+  for (const auto &requester : fulfilled.requesters) {
+    SerializedRow &row = rows[requester.row_idx];
+    int32_t table_id = fulfilled.rows[requester.row_idx].table_id;
+    RowSubscribe(row.server_row,
+                 GlobalContext::thread_id_to_client_id(requester.bg_id));
+    ++row.num_requesters;
+
+    size_t offset = row.offset;
+    size_t record_size = row.record_size;
+    if (requester.accept_row_delta
+        && requester.cached_row_version != kNoRowDeltaVersion) {
+      uint8_t *delta_mem = segment->BeginRecord(
+          fulfilled.rows[requester.row_idx].row_id,
+          server_obj_.GetRowReplySizeBound(table_id, row.server_row));
+      size_t delta_size = server_obj_.SerializeRowDeltaReply(
+          table_id, row.server_row, requester.bg_id,
+          requester.cached_row_version, delta_mem);
+      if (delta_size > 0)
+        offset = segment->EndRecord(delta_size, &record_size);
+    }
+
+    std::vector<PushRowBody> &bodies = bg_bodies[requester.bg_id];
+    if (bodies.empty() || (bodies.back().get_size() > 0
+                           && bodies.back().get_size() + sizeof(int32_t)
+                           + record_size > kMaxBatchReplySize)) {
+      bodies.push_back(PushRowBody(segment));
+    }
+    bodies.back().AppendInt32(table_id);
+    bodies.back().AppendRecord(offset, record_size);
+  }
+
+  for (const auto &bg_pair : bg_bodies) {
+    int32_t bg_id = bg_pair.first;
+    for (const auto &body : bg_pair.second) {
+      // Header only, the data goes out of body.
+      ServerBatchRowRequestReplyMsg batch_reply_msg(static_cast<size_t>(0));
+      batch_reply_msg.get_avai_size() = body.get_size();
+      batch_reply_msg.get_clock() = server_clock;
+      batch_reply_msg.get_version() = server_obj_.GetBgVersion(bg_id);
+      batch_reply_msg.get_num_rows() = body.get_num_records();
+      size_t sent_size = body.Send(comm_bus_, bg_id,
+                                   batch_reply_msg.get_mem(),
+                                   batch_reply_msg.get_header_size());
+      CHECK_EQ(sent_size, batch_reply_msg.get_size());
+    }
+  }
+  segment->DecRef();
+
+  for (size_t i = 0; i < fulfilled.rows.size(); ++i) {
+    server_obj_.RowSent(fulfilled.rows[i].table_id, fulfilled.rows[i].row_id,
+                        rows[i].server_row, rows[i].num_requesters);
+  }
+}
+
 void ServerThread::HandleOpLogMsg(int32_t sender_id,
-                                  ClientSendOpLogMsg &client_send_oplog_msg) {
+                                  ClientSendOpLogMsg &client_send_oplog_msg,
+                                  size_t msg_size) {
   //LOG(INFO) << __func__;
   bool is_clock = client_send_oplog_msg.get_is_clock();
 
@@ -238,9 +423,27 @@ void ServerThread::HandleOpLogMsg(int32_t sender_id,
   //        << " " << my_id_;
 
   STATS_SERVER_ACCUM_APPLY_OPLOG_BEGIN();
-  server_obj_.ApplyOpLogUpdateVersion(
-      client_send_oplog_msg.get_data(), client_send_oplog_msg.get_avai_size(),
-      sender_id, version);
+  size_t oplog_size;
+  void *oplog = MsgCompressor::DecompressOpLogMsg(
+      client_send_oplog_msg, &oplog_decompress_buff_, &oplog_size);
+  oplog_segments_.clear();
+  if (oplog != client_send_oplog_msg.get_data()) {
+    // Compressed messages are sent in one piece.
+    CHECK_EQ(comm_bus_->GetMoreFrames().size(), 0);
+    oplog_segments_.push_back(MemSegment(oplog, oplog_size));
+  } else {
+    // The rows gathered by OpLogMsgGather follow in the other frames.
+    size_t header_size = client_send_oplog_msg.get_size() - oplog_size;
+    oplog_segments_.push_back(MemSegment(oplog, msg_size - header_size));
+    ZMQFrames &more_frames = comm_bus_->GetMoreFrames();
+    for (size_t i = 0; i < more_frames.size(); ++i) {
+      oplog_segments_.push_back(MemSegment(more_frames[i].data(),
+                                           more_frames[i].size()));
+    }
+  }
+  server_obj_.ApplyOpLogUpdateVersion(oplog_segments_.data(),
+                                      oplog_segments_.size(), oplog_size,
+                                      sender_id, version);
   STATS_SERVER_ACCUM_APPLY_OPLOG_END();
 
   bool clock_changed = false;
@@ -262,20 +465,9 @@ void ServerThread::HandleOpLogMsg(int32_t sender_id,
       //         << " size = " << client_send_oplog_msg.get_size()
       //         << " clock changed = " << clock_changed
       //         << " " << my_id_;
-      std::vector<ServerRowRequest> requests;
-      server_obj_.GetFulfilledRowRequests(&requests);
-      for (auto request_iter = requests.begin();
-	   request_iter != requests.end(); request_iter++) {
-	int32_t table_id = request_iter->table_id;
-	int32_t row_id = request_iter->row_id;
-	int32_t bg_id = request_iter->bg_id;
-	uint32_t version = server_obj_.GetBgVersion(bg_id);
-	ServerRow *server_row = server_obj_.FindCreateRow(table_id, row_id);
-        RowSubscribe(server_row,
-                     GlobalContext::thread_id_to_client_id(bg_id));
-	int32_t server_clock = server_obj_.GetMinClock();
-	ReplyRowRequest(bg_id, server_row, table_id, row_id, server_clock,
-                        version);
+      if (server_obj_.GetFulfilledRowRequests(&fulfilled_row_requests_)) {
+        ReplyFulfilledRowRequests(fulfilled_row_requests_,
+                                  server_obj_.GetMinClock());
       }
     }
   } else if (my_id_ == 1 && GlobalContext::get_suppression_on()) {
@@ -416,11 +608,19 @@ void *ServerThread::operator() () {
           HandleRowRequest(sender_id, row_request_msg);
         }
         break;
+      case kBatchRowRequest:
+        {
+          BatchRowRequestMsg batch_row_request_msg(msg_mem);
+          HandleBatchRowRequest(sender_id, batch_row_request_msg);
+        }
+        break;
       case kClientSendOpLog:
         {
           ClientSendOpLogMsg client_send_oplog_msg(msg_mem);
-
-          HandleOpLogMsg(sender_id, client_send_oplog_msg);
+          // Transferred memory is the whole message.
+          size_t msg_size = destroy_mem ? client_send_oplog_msg.get_size()
+                            : zmq_msg.size();
+          HandleOpLogMsg(sender_id, client_send_oplog_msg, msg_size);
           STATS_SERVER_OPLOG_MSG_RECV_INC_ONE();
         }
       break;
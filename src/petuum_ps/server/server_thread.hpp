@@ -57,11 +57,34 @@ protected:
   bool HandleShutDownMsg();
   void HandleCreateTable(int32_t sender_id, CreateTableMsg &create_table_msg);
   void HandleRowRequest(int32_t sender_id, RowRequestMsg &row_request_msg);
+  void HandleBatchRowRequest(int32_t sender_id,
+                             BatchRowRequestMsg &batch_row_request_msg);
   void ReplyRowRequest(int32_t bg_id, ServerRow *server_row,
                        int32_t table_id, int32_t row_id, int32_t server_clock,
-                       uint32_t version);
+                       uint32_t version, bool accept_row_delta,
+                       uint64_t cached_row_version);
+
+  struct RowToReply {
+    int32_t table_id;
+    int32_t row_id;
+    ServerRow *server_row;
+  };
+
+  // Reply to a number of row requests from bg_id with as few
+  // ServerBatchRowRequestReplyMsgs of at most kMaxBatchReplySize bytes as
+  // possible.
+  void ReplyRowRequests(int32_t bg_id, const std::vector<RowToReply> &rows,
+                        int32_t server_clock, uint32_t version);
+  // Reply to the requests fulfilled by a clock advance. Each row is
+  // serialized once into a PushRowSegment shared by the replies to all bg
+  // threads that requested it, except those sent a delta.
+  void ReplyFulfilledRowRequests(const FulfilledRowRequests &fulfilled,
+                                 int32_t server_clock);
+  // msg_size is the size of the message memory received; with a multipart
+  // message, that is the first frame and the others are read in place.
   void HandleOpLogMsg(int32_t sender_id,
-                      ClientSendOpLogMsg &client_send_oplog_msg);
+                      ClientSendOpLogMsg &client_send_oplog_msg,
+                      size_t msg_size);
 
   virtual void HandleEarlyCommOn();
   virtual void HandleEarlyCommOff();
@@ -85,6 +108,9 @@ protected:
 
   virtual void AdjustSuppressionLevel(int32_t bg_id, int32_t bg_clock);
 
+  // A row larger than this gets a message of its own.
+  static const size_t kMaxBatchReplySize = 64*1024;
+
   int32_t my_id_;
   std::vector<int32_t> bg_worker_ids_;
   Server server_obj_;
@@ -94,6 +120,12 @@ protected:
   pthread_barrier_t *init_barrier_;
 
   MsgTracker msg_tracker_;
+
+  // Holds decoded oplogs of compressed ClientSendOpLogMsgs.
+  std::vector<uint8_t> oplog_decompress_buff_;
+  std::vector<MemSegment> oplog_segments_;
+  // Reused to keep its capacity.
+  FulfilledRowRequests fulfilled_row_requests_;
   bool pending_clock_push_row_;
   bool pending_shut_down_;
 
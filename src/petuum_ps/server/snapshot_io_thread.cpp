@@ -0,0 +1,58 @@
+#include <petuum_ps/server/snapshot_io_thread.hpp>
+
+#include <glog/logging.h>
+
+namespace petuum {
+
+SnapShotIOThread::SnapShotIOThread():
+    num_pending_jobs_(0),
+    shutting_down_(false) { }
+
+SnapShotIOThread::~SnapShotIOThread() {
+  CHECK(jobs_.empty());
+}
+
+void *SnapShotIOThread::operator() () {
+  while (true) {
+    SnapShotJob *job = 0;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      while (jobs_.empty() && !shutting_down_)
+        cv_.wait(lock);
+      if (jobs_.empty())
+        return 0;
+      job = jobs_.front();
+      jobs_.pop_front();
+    }
+    job->Write();
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    --num_pending_jobs_;
+    if (num_pending_jobs_ == 0)
+      jobs_done_cv_.notify_all();
+  }
+}
+
+void SnapShotIOThread::Enqueue(SnapShotJob *job) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  jobs_.push_back(job);
+  ++num_pending_jobs_;
+  cv_.notify_one();
+}
+
+void SnapShotIOThread::WaitForJobs() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (num_pending_jobs_ > 0)
+    jobs_done_cv_.wait(lock);
+}
+
+void SnapShotIOThread::ShutDown() {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    shutting_down_ = true;
+    cv_.notify_one();
+  }
+  Join();
+}
+
+}  // namespace petuum
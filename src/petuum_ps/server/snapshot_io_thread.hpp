@@ -0,0 +1,41 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <boost/noncopyable.hpp>
+
+#include <petuum_ps_common/util/thread.hpp>
+#include <petuum_ps/server/server_table_snapshot.hpp>
+
+namespace petuum {
+
+// Writes background snapshots for one server thread. Jobs are written in
+// the order they are enqueued; the server thread owns them and polls
+// SnapShotJob::IsDone().
+class SnapShotIOThread : public Thread, boost::noncopyable {
+public:
+  SnapShotIOThread();
+  ~SnapShotIOThread();
+
+  void *operator() ();
+
+  void Enqueue(SnapShotJob *job);
+
+  // Block until all enqueued jobs are written.
+  void WaitForJobs();
+
+  // Finish the queued jobs and exit the thread.
+  void ShutDown();
+
+private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::condition_variable jobs_done_cv_;
+  std::deque<SnapShotJob*> jobs_;
+  // jobs enqueued but not yet written, including the one being written
+  size_t num_pending_jobs_;
+  bool shutting_down_;
+};
+
+}  // namespace petuum
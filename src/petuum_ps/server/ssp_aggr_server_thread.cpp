@@ -29,7 +29,8 @@ long SSPAggrServerThread::ServerIdleWork() {
 
   STATS_SERVER_ACCUM_IDLE_SEND_BEGIN();
   size_t sent_bytes
-      = server_obj_.CreateSendServerPushRowMsgsPartial(SendServerPushRowMsg);
+      = server_obj_.CreateSendServerPushRowMsgsPartial(
+          SendServerPushRowMsg, SendServerPushRowBody);
 
   STATS_SERVER_ACCUM_IDLE_SEND_END();
 
@@ -77,7 +78,8 @@ void SSPAggrServerThread::ServerPushRow() {
 
   STATS_SERVER_ACCUM_PUSH_ROW_BEGIN();
   size_t sent_bytes
-      = server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg);
+      = server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg,
+                                                SendServerPushRowBody);
   STATS_SERVER_ACCUM_PUSH_ROW_END();
 
   double left_over_send_milli_sec = 0;
@@ -16,19 +16,14 @@ void SSPPushServerThread::SendServerPushRowMsg(
   //	    << " to = " << bg_id
   //        << " " << ThreadContext::get_id();
 
-  msg->get_version() = version;
-  msg->get_seq_num() = msg_tracker->IncGetSeq(bg_id);
-  STATS_SERVER_ADD_PER_CLOCK_PUSH_ROW_SIZE(msg->get_size());
-  STATS_SERVER_PUSH_ROW_MSG_SEND_INC_ONE();
+  InitServerPushRowMsgHeader(bg_id, msg, last_msg, version, server_min_clock,
+                             msg_tracker);
 
   //LOG(INFO) << "send " << bg_id << " " << msg->get_seq_num();
 
   if (last_msg) {
-    msg->get_is_clock() = true;
-    msg->get_clock() = server_min_clock;
     MemTransfer::TransferMem(GlobalContext::comm_bus, bg_id, msg);
   } else {
-    msg->get_is_clock() = false;
     size_t sent_size = (GlobalContext::comm_bus->*(
         GlobalContext::comm_bus->SendAny_))(
         bg_id, msg->get_mem(), msg->get_size());
@@ -36,6 +31,31 @@ void SSPPushServerThread::SendServerPushRowMsg(
   }
 }
 
+void SSPPushServerThread::SendServerPushRowBody(
+    int32_t bg_id, ServerPushRowMsg *msg, const PushRowBody &body,
+    bool last_msg, int32_t version, int32_t server_min_clock,
+    MsgTracker *msg_tracker) {
+  InitServerPushRowMsgHeader(bg_id, msg, last_msg, version, server_min_clock,
+                             msg_tracker);
+  size_t sent_size = body.Send(GlobalContext::comm_bus, bg_id,
+                               msg->get_mem(), msg->get_header_size());
+  CHECK_EQ(sent_size, msg->get_size());
+}
+
+void SSPPushServerThread::InitServerPushRowMsgHeader(
+    int32_t bg_id, ServerPushRowMsg *msg, bool last_msg,
+    int32_t version, int32_t server_min_clock,
+    MsgTracker *msg_tracker) {
+  msg->get_version() = version;
+  msg->get_seq_num() = msg_tracker->IncGetSeq(bg_id);
+  STATS_SERVER_ADD_PER_CLOCK_PUSH_ROW_SIZE(msg->get_size());
+  STATS_SERVER_PUSH_ROW_MSG_SEND_INC_ONE();
+
+  msg->get_is_clock() = last_msg;
+  if (last_msg)
+    msg->get_clock() = server_min_clock;
+}
+
 void SSPPushServerThread::ServerPushRow() {
   if (!msg_tracker_.CheckSendAll()) {
     STATS_SERVER_ACCUM_WAITS_ON_ACK_CLOCK();
@@ -44,7 +64,8 @@ void SSPPushServerThread::ServerPushRow() {
   }
   //LOG(INFO) << __func__;
   STATS_SERVER_ACCUM_PUSH_ROW_BEGIN();
-  server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg);
+  server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg,
+                                          SendServerPushRowBody);
   STATS_SERVER_ACCUM_PUSH_ROW_END();
 }
 
@@ -17,6 +17,17 @@ protected:
                                     int32_t server_min_clock,
                                     MsgTracker *msg_tracker);
 
+  // msg holds only the header; the data is body.
+  static void SendServerPushRowBody(int32_t bg_id, ServerPushRowMsg *msg,
+                                    const PushRowBody &body, bool last_msg,
+                                    int32_t version, int32_t server_min_clock,
+                                    MsgTracker *msg_tracker);
+
+  static void InitServerPushRowMsgHeader(int32_t bg_id, ServerPushRowMsg *msg,
+                                         bool last_msg, int32_t version,
+                                         int32_t server_min_clock,
+                                         MsgTracker *msg_tracker);
+
   virtual void RowSubscribe(ServerRow *server_row, int32_t client_id);
 
   void HandleBgServerPushRowAck(
@@ -6,6 +6,7 @@
 #include <petuum_ps_common/include/constants.hpp>
 #include <petuum_ps/client/oplog_serializer.hpp>
 #include <petuum_ps/client/ssp_client_row.hpp>
+#include <petuum_ps/client/row_shards.hpp>
 #include <petuum_ps_common/util/stats.hpp>
 #include <petuum_ps_common/comm_bus/comm_bus.hpp>
 #include <petuum_ps_common/thread/mem_transfer.hpp>
@@ -114,6 +115,10 @@ bool AbstractBgWorker::CreateTable(int32_t table_id,
 
     bg_create_table_msg.get_version_maintain()
         = table_info.version_maintain;
+    bg_create_table_msg.get_compress_type()
+        = table_info.compress_type;
+    bg_create_table_msg.get_num_row_shards()
+        = table_info.num_row_shards;
 
     size_t sent_size = SendMsg(
         reinterpret_cast<MsgBase*>(&bg_create_table_msg));
@@ -165,6 +170,21 @@ void AbstractBgWorker::RequestRowAsync(int32_t table_id, int32_t row_id,
   CHECK_EQ(sent_size, request_row_msg.get_size());
 }
 
+void AbstractBgWorker::RequestRowBatchAsync(
+    int32_t table_id, const int32_t *row_ids, int32_t num_rows,
+    int32_t clock) {
+  BatchRowRequestMsg batch_row_request_msg(num_rows*sizeof(int32_t));
+  batch_row_request_msg.get_table_id() = table_id;
+  batch_row_request_msg.get_clock() = clock;
+  batch_row_request_msg.get_num_rows() = num_rows;
+  memcpy(batch_row_request_msg.get_row_ids(), row_ids,
+         num_rows*sizeof(int32_t));
+
+  size_t sent_size = SendMsg(
+      reinterpret_cast<MsgBase*>(&batch_row_request_msg));
+  CHECK_EQ(sent_size, batch_row_request_msg.get_size());
+}
+
 void AbstractBgWorker::GetAsyncRowRequestReply() {
   zmq::message_t zmq_msg;
   int32_t sender_id;
@@ -336,6 +356,10 @@ void AbstractBgWorker::HandleCreateTables() {
           = bg_create_table_msg.get_server_table_logic();
       client_table_config.table_info.version_maintain
           = bg_create_table_msg.get_version_maintain();
+      client_table_config.table_info.compress_type
+          = bg_create_table_msg.get_compress_type();
+      client_table_config.table_info.num_row_shards
+          = bg_create_table_msg.get_num_row_shards();
 
       client_table_config.oplog_type
           = bg_create_table_msg.get_oplog_type();
@@ -358,14 +382,19 @@ void AbstractBgWorker::HandleCreateTables() {
       create_table_msg.get_table_id() = bg_create_table_msg.get_table_id();
       create_table_msg.get_staleness() = bg_create_table_msg.get_staleness();
       create_table_msg.get_row_type() = bg_create_table_msg.get_row_type();
+      // Servers only see shard rows.
+      int32_t num_row_shards = bg_create_table_msg.get_num_row_shards();
       create_table_msg.get_row_capacity()
-	= bg_create_table_msg.get_row_capacity();
+          = RowShards::GetShardCapacity(
+              bg_create_table_msg.get_row_capacity(), num_row_shards);
       create_table_msg.get_oplog_dense_serialized()
           = bg_create_table_msg.get_oplog_dense_serialized();
       create_table_msg.get_row_oplog_type()
           = bg_create_table_msg.get_row_oplog_type();
       create_table_msg.get_dense_row_oplog_capacity()
-          = bg_create_table_msg.get_dense_row_oplog_capacity();
+          = RowShards::GetShardCapacity(
+              bg_create_table_msg.get_dense_row_oplog_capacity(),
+              num_row_shards);
       create_table_msg.get_server_push_row_upper_bound()
           = bg_create_table_msg.get_server_push_row_upper_bound();
       create_table_msg.get_server_table_logic()
@@ -373,6 +402,8 @@ void AbstractBgWorker::HandleCreateTables() {
 
       create_table_msg.get_version_maintain()
           = bg_create_table_msg.get_version_maintain();
+      create_table_msg.get_compress_type()
+          = bg_create_table_msg.get_compress_type();
 
       table_id = create_table_msg.get_table_id();
 
@@ -393,6 +424,9 @@ void AbstractBgWorker::HandleCreateTables() {
       CHECK_EQ(msg_type, kCreateTableReply);
       CreateTableReplyMsg create_table_reply_msg(zmq_msg.data());
       CHECK_EQ(create_table_reply_msg.get_table_id(), table_id);
+      GlobalContext::AddRowPlacements(
+          create_table_reply_msg.get_row_placements(),
+          create_table_reply_msg.get_num_row_placements());
 
       ClientTable *client_table;
       try {
@@ -436,6 +470,7 @@ long AbstractBgWorker::HandleClockMsg(bool clock_advanced) {
 
   SendOpLogMsgs(clock_advanced);
   TrackBgOpLog(bg_oplog);
+  RefillRowOpLogPools();
   return 0;
 }
 
@@ -446,6 +481,19 @@ void AbstractBgWorker::HandleServerPushRow(int32_t sender_id, ServerPushRowMsg &
 
 void AbstractBgWorker::PrepareBeforeInfiniteLoop() { }
 
+void AbstractBgWorker::InitMsgCompressor() {
+  for (const auto &table_pair : (*tables_)) {
+    ClientTable *table = table_pair.second;
+    const AbstractRow *sample_row = table->get_sample_row();
+    msg_compressor_.AddTable(
+        table_pair.first, table->get_compress_type(),
+        sample_row->get_update_size(), table->oplog_dense_serialized(),
+        table->get_row_oplog_type(), table->get_version_maintain(),
+        table->get_dense_row_oplog_capacity(),
+        sample_row->get_update_value_type() == UpdateValueType::kFloat);
+  }
+}
+
 void AbstractBgWorker::FinalizeTableStats() { }
 
 long AbstractBgWorker::ResetBgIdleMilli() {
@@ -638,7 +686,8 @@ void AbstractBgWorker::CreateOpLogMsgs(const BgOpLog *bg_oplog) {
       CHECK(serializer_iter != row_oplog_serializer_map_.end());
 
       RowOpLogSerializer *row_oplog_serializer = serializer_iter->second;
-      row_oplog_serializer->SerializeByServer(&(table_server_mem_map[table_id]));
+      row_oplog_serializer->SerializeByServer(&(table_server_mem_map[table_id]),
+                                              &server_oplog_gather_map_);
     } else {
       BgOpLogPartition *oplog_partition = bg_oplog->Get(table_id);
       oplog_partition->SerializeByServer(
@@ -653,6 +702,25 @@ size_t AbstractBgWorker::SendOpLogMsgs(bool clock_advanced) {
   for (const auto &server_id : server_ids_) {
     auto oplog_msg_iter = server_oplog_msg_map_.find(server_id);
     if (oplog_msg_iter != server_oplog_msg_map_.end()) {
+      OpLogMsgGather &oplog_gather = server_oplog_gather_map_[server_id];
+      bool is_local = comm_bus_->IsLocalEntity(server_id);
+      // In process, the message memory is transferred as a whole.
+      if (!oplog_gather.empty() && is_local)
+        oplog_gather.CopyTo();
+
+      // Compression only pays off over the network. It reads the gathered
+      // buffers in place.
+      if (!is_local) {
+        ClientSendOpLogMsg *compressed_msg = msg_compressor_.CompressOpLogMsg(
+            *(oplog_msg_iter->second), oplog_gather,
+            server_table_oplog_size_map_[server_id]);
+        if (compressed_msg != 0) {
+          delete oplog_msg_iter->second;
+          oplog_msg_iter->second = compressed_msg;
+          oplog_gather.Clear();
+        }
+      }
+
       oplog_msg_iter->second->get_is_clock() = clock_advanced;
       oplog_msg_iter->second->get_client_id() = GlobalContext::get_client_id();
       oplog_msg_iter->second->get_version() = version_;
@@ -662,7 +730,10 @@ size_t AbstractBgWorker::SendOpLogMsgs(bool clock_advanced) {
 
       accum_size += oplog_msg_iter->second->get_size();
       //LOG(INFO) << "send " << server_id << " " << oplog_msg_iter->second->get_seq_num();
-      MemTransfer::TransferMem(comm_bus_, server_id, oplog_msg_iter->second);
+      if (!oplog_gather.empty())
+        oplog_gather.Send(comm_bus_, server_id, oplog_msg_iter->second);
+      else
+        MemTransfer::TransferMem(comm_bus_, server_id, oplog_msg_iter->second);
       // delete message after send
       delete oplog_msg_iter->second;
       oplog_msg_iter->second = 0;
@@ -688,6 +759,15 @@ size_t AbstractBgWorker::SendOpLogMsgs(bool clock_advanced) {
   return accum_size;
 }
 
+void AbstractBgWorker::RefillRowOpLogPools() {
+  for (const auto &table_pair : (*tables_)) {
+    RowOpLogPool *row_oplog_pool
+        = table_pair.second->get_oplog().get_row_oplog_pool();
+    if (row_oplog_pool != 0)
+      row_oplog_pool->Refill(my_comm_channel_idx_);
+  }
+}
+
 size_t AbstractBgWorker::CountRowOpLogToSend(
       int32_t row_id, AbstractRowOpLog *row_oplog,
       std::map<int32_t, size_t> *table_num_bytes_by_server,
@@ -696,7 +776,7 @@ size_t AbstractBgWorker::CountRowOpLogToSend(
 
   // update oplog message size
   int32_t server_id = GlobalContext::GetPartitionServerID(
-      row_id, my_comm_channel_idx_);
+      bg_table_oplog->get_table_id(), row_id, my_comm_channel_idx_);
   // 1) row id
   // 2) serialized row size
   size_t serialized_size = sizeof(int32_t)
@@ -716,37 +796,42 @@ void AbstractBgWorker::RecvAppInitThreadConnection(int32_t *num_connected_app_th
   CHECK(*num_connected_app_threads <= GlobalContext::get_num_app_threads());
 }
 
+bool AbstractBgWorker::RowFreshInProcessStorage(
+    ClientTable *table, int32_t row_id, int32_t clock) {
+  AbstractProcessStorage &table_storage = table->get_process_storage();
+  RowAccessor row_accessor;
+  ClientRow *client_row = table_storage.Find(row_id, &row_accessor);
+  if (client_row == 0)
+    return false;
+  return (GlobalContext::get_consistency_model() == SSP
+          && client_row->GetClock() >= clock)
+      || (GlobalContext::get_consistency_model() == SSPPush)
+      || (GlobalContext::get_consistency_model() == SSPAggr);
+}
+
+void AbstractBgWorker::ReplyRowRequestToApp(int32_t app_thread_id) {
+  RowRequestReplyMsg row_request_reply_msg;
+  size_t sent_size = comm_bus_->SendInProc(
+      app_thread_id, row_request_reply_msg.get_mem(),
+      row_request_reply_msg.get_size());
+  CHECK_EQ(sent_size, row_request_reply_msg.get_size());
+}
+
 void AbstractBgWorker::CheckForwardRowRequestToServer(
     int32_t app_thread_id, RowRequestMsg &row_request_msg) {
 
   int32_t table_id = row_request_msg.get_table_id();
   int32_t row_id = row_request_msg.get_row_id();
-  int32_t clock = row_request_msg.get_clock();
   bool forced = row_request_msg.get_forced_request();
 
   if (!forced) {
     // Check if the row exists in process cache
     auto table_iter = tables_->find(table_id);
     CHECK(table_iter != tables_->end());
-    {
-      // check if it is in process storage
-      ClientTable *table = table_iter->second;
-      AbstractProcessStorage &table_storage = table->get_process_storage();
-      RowAccessor row_accessor;
-      ClientRow *client_row = table_storage.Find(row_id, &row_accessor);
-      if (client_row != 0) {
-        if ((GlobalContext::get_consistency_model() == SSP
-             && client_row->GetClock() >= clock)
-            || (GlobalContext::get_consistency_model() == SSPPush)
-            || (GlobalContext::get_consistency_model() == SSPAggr)) {
-          RowRequestReplyMsg row_request_reply_msg;
-          size_t sent_size = comm_bus_->SendInProc(
-              app_thread_id, row_request_reply_msg.get_mem(),
-              row_request_reply_msg.get_size());
-          CHECK_EQ(sent_size, row_request_reply_msg.get_size());
-          return;
-        }
-      }
+    if (RowFreshInProcessStorage(table_iter->second, row_id,
+                                 row_request_msg.get_clock())) {
+      ReplyRowRequestToApp(app_thread_id);
+      return;
     }
   }
 
@@ -764,7 +849,9 @@ void AbstractBgWorker::CheckForwardRowRequestToServer(
 
   if (should_be_sent) {
     int32_t server_id
-        = GlobalContext::GetPartitionServerID(row_id, my_comm_channel_idx_);
+        = GlobalContext::GetPartitionServerID(
+            table_id, row_id, my_comm_channel_idx_);
+    SetRowDeltaRequest(table_id, row_id, &row_request_msg);
 
     size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(server_id,
       row_request_msg.get_mem(), row_request_msg.get_size());
@@ -772,11 +859,93 @@ void AbstractBgWorker::CheckForwardRowRequestToServer(
   }
 }
 
+void AbstractBgWorker::SetRowDeltaRequest(int32_t table_id, int32_t row_id,
+                                          RowRequestMsg *row_request_msg) {
+  row_request_msg->get_accept_row_delta() = false;
+  row_request_msg->get_cached_row_version() = kNoRowDeltaVersion;
+  if (!GlobalContext::get_row_delta_reply())
+    return;
+
+  auto table_iter = tables_->find(table_id);
+  CHECK(table_iter != tables_->end());
+  ClientTable *client_table = table_iter->second;
+  // Deltas rely on the cached row having all of this client's updates,
+  // which oplog replay maintains.
+  if ((client_table->get_oplog_type() != Sparse
+       && client_table->get_oplog_type() != Dense)
+      || client_table->get_no_oplog_replay()
+      || client_table->get_version_maintain())
+    return;
+
+  row_request_msg->get_accept_row_delta() = true;
+  RowAccessor row_accessor;
+  ClientRow *client_row = client_table->get_process_storage().Find(
+      row_id, &row_accessor);
+  if (client_row != 0) {
+    row_request_msg->get_cached_row_version()
+        = client_row->get_row_delta_version();
+  }
+}
+
+void AbstractBgWorker::CheckForwardBatchRowRequestToServer(
+    int32_t app_thread_id, BatchRowRequestMsg &batch_row_request_msg) {
+  int32_t table_id = batch_row_request_msg.get_table_id();
+  int32_t clock = batch_row_request_msg.get_clock();
+  int32_t num_rows = batch_row_request_msg.get_num_rows();
+  const int32_t *row_ids = batch_row_request_msg.get_row_ids();
+
+  auto table_iter = tables_->find(table_id);
+  CHECK(table_iter != tables_->end());
+  ClientTable *table = table_iter->second;
+
+  RowRequestInfo row_request;
+  row_request.app_thread_id = app_thread_id;
+  row_request.clock = clock;
+  row_request.version = version_ - 1;
+
+  // Rows not yet requested by anyone, coalesced by server.
+  std::map<int32_t, std::vector<int32_t> > server_row_ids;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    int32_t row_id = row_ids[i];
+    if (RowFreshInProcessStorage(table, row_id, clock)) {
+      ReplyRowRequestToApp(app_thread_id);
+      continue;
+    }
+
+    bool should_be_sent
+        = row_request_oplog_mgr_->AddRowRequest(row_request, table_id, row_id);
+    if (should_be_sent) {
+      int32_t server_id
+          = GlobalContext::GetPartitionServerID(
+            table_id, row_id, my_comm_channel_idx_);
+      server_row_ids[server_id].push_back(row_id);
+    }
+  }
+
+  for (const auto &server_rows : server_row_ids) {
+    int32_t server_id = server_rows.first;
+    const std::vector<int32_t> &server_row_id_vec = server_rows.second;
+    BatchRowRequestMsg server_msg(server_row_id_vec.size()*sizeof(int32_t));
+    server_msg.get_table_id() = table_id;
+    server_msg.get_clock() = clock;
+    server_msg.get_num_rows() = server_row_id_vec.size();
+    memcpy(server_msg.get_row_ids(), server_row_id_vec.data(),
+           server_row_id_vec.size()*sizeof(int32_t));
+
+    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(server_id,
+      server_msg.get_mem(), server_msg.get_size());
+    CHECK_EQ(sent_size, server_msg.get_size());
+  }
+}
+
 void AbstractBgWorker::UpdateExistingRow(
     int32_t table_id,
     int32_t row_id, ClientRow *client_row, ClientTable *client_table,
     const void *data, size_t row_size, uint32_t version,
     bool version_maintain, uint64_t row_version) {
+  // Set again by ApplyServerRowRequestReply() if the row data comes from a
+  // row request reply.
+  client_row->set_row_delta_version(kNoRowDeltaVersion);
   AbstractRow *row_data = client_row->GetRowDataPtr();
   if (client_table->get_oplog_type() == Sparse
       || client_table->get_oplog_type() == Dense) {
@@ -852,7 +1021,8 @@ void AbstractBgWorker::UpdateExistingRow(
 void AbstractBgWorker::InsertNonexistentRow(int32_t table_id, int32_t row_id,
                                             ClientTable *client_table, const void *data,
                                             size_t row_size, uint32_t version,
-                                            int32_t clock) {
+                                            int32_t clock,
+                                            uint64_t row_delta_version) {
   int32_t row_type = client_table->get_row_type();
   AbstractRow *row_data
       = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type);
@@ -864,6 +1034,7 @@ void AbstractBgWorker::InsertNonexistentRow(int32_t table_id, int32_t row_id,
     CheckAndApplyOldOpLogsToRowData(table_id, row_id, version, row_data);
 
   ClientRow *client_row = CreateClientRow(clock, row_data);
+  client_row->set_row_delta_version(row_delta_version);
   if (client_table->get_oplog_type() == Sparse ||
       client_table->get_oplog_type() == Dense) {
     AbstractOpLog &table_oplog = client_table->get_oplog();
@@ -907,36 +1078,88 @@ void AbstractBgWorker::InsertNonexistentRow(int32_t table_id, int32_t row_id,
 void AbstractBgWorker::HandleServerRowRequestReply(
     int32_t server_id,
     ServerRowRequestReplyMsg &server_row_request_reply_msg) {
-
-  int32_t table_id = server_row_request_reply_msg.get_table_id();
-  int32_t row_id = server_row_request_reply_msg.get_row_id();
-  int32_t clock = server_row_request_reply_msg.get_clock();
   uint32_t version = server_row_request_reply_msg.get_version();
+  row_request_oplog_mgr_->ServerAcknowledgeVersion(server_id, version);
 
-  auto table_iter = tables_->find(table_id);
-  CHECK(table_iter != tables_->end()) << "Cannot find table " << table_id;
-  ClientTable *client_table = table_iter->second;
+  ApplyServerRowRequestReply(
+      server_row_request_reply_msg.get_table_id(),
+      server_row_request_reply_msg.get_row_id(),
+      server_row_request_reply_msg.get_clock(), version,
+      server_row_request_reply_msg.get_row_data(),
+      server_row_request_reply_msg.get_row_size());
+}
 
+void AbstractBgWorker::HandleServerBatchRowRequestReply(
+    int32_t server_id,
+    ServerBatchRowRequestReplyMsg &server_batch_row_request_reply_msg) {
+  int32_t clock = server_batch_row_request_reply_msg.get_clock();
+  uint32_t version = server_batch_row_request_reply_msg.get_version();
+  int32_t num_rows = server_batch_row_request_reply_msg.get_num_rows();
   row_request_oplog_mgr_->ServerAcknowledgeVersion(server_id, version);
 
-  RowAccessor row_accessor;
-  ClientRow *client_row = client_table->get_process_storage().Find(
-      row_id, &row_accessor);
-
-  const void *data = server_row_request_reply_msg.get_row_data();
-  size_t row_size = server_row_request_reply_msg.get_row_size();
+  const uint8_t *mem = server_batch_row_request_reply_msg.get_data();
+  for (int32_t i = 0; i < num_rows; ++i) {
+    int32_t table_id = *(reinterpret_cast<const int32_t*>(mem));
+    mem += sizeof(int32_t);
+    int32_t row_id = *(reinterpret_cast<const int32_t*>(mem));
+    mem += sizeof(int32_t);
+    size_t row_size = *(reinterpret_cast<const size_t*>(mem));
+    mem += sizeof(size_t);
+    ApplyServerRowRequestReply(table_id, row_id, clock, version, mem,
+                               row_size);
+    mem += row_size;
+  }
+}
 
-  bool table_version_maintain = client_table->get_version_maintain();
-  uint64_t row_version = 0;
-  if (table_version_maintain)
-    row_version = ExtractRowVersion(data, &row_size);
+void AbstractBgWorker::ApplyServerRowRequestReply(
+    int32_t table_id, int32_t row_id, int32_t clock, uint32_t version,
+    const void *data, size_t row_size) {
+  auto table_iter = tables_->find(table_id);
+  CHECK(table_iter != tables_->end()) << "Cannot find table " << table_id;
+  ClientTable *client_table = table_iter->second;
 
-  if (client_row != 0) {
-    UpdateExistingRow(table_id, row_id, client_row, client_table, data,
-                      row_size, version, table_version_maintain, row_version);
-    client_row->SetClock(clock);
-  } else { // not found
-    InsertNonexistentRow(table_id, row_id, client_table, data, row_size, version, clock);
+  const RowReplyHeader &header
+      = *reinterpret_cast<const RowReplyHeader*>(data);
+  data = reinterpret_cast<const uint8_t*>(data) + sizeof(RowReplyHeader);
+  row_size -= sizeof(RowReplyHeader);
+
+  if (header.base_version != kNoRowDeltaVersion) {
+    if (!ApplyRowDelta(client_table, row_id, clock, header, data)) {
+      // The row was evicted or reset since it was requested; ask for it
+      // again and leave the waiting app threads to that reply.
+      RowRequestMsg row_request_msg;
+      row_request_msg.get_table_id() = table_id;
+      row_request_msg.get_row_id() = row_id;
+      row_request_msg.get_clock() = clock;
+      SetRowDeltaRequest(table_id, row_id, &row_request_msg);
+
+      int32_t server_id = GlobalContext::GetPartitionServerID(
+          table_id, row_id, my_comm_channel_idx_);
+      size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(server_id,
+        row_request_msg.get_mem(), row_request_msg.get_size());
+      CHECK_EQ(sent_size, row_request_msg.get_size());
+      return;
+    }
+  } else {
+    RowAccessor row_accessor;
+    ClientRow *client_row = client_table->get_process_storage().Find(
+        row_id, &row_accessor);
+
+    bool table_version_maintain = client_table->get_version_maintain();
+    uint64_t row_version = 0;
+    if (table_version_maintain)
+      row_version = ExtractRowVersion(data, &row_size);
+
+    if (client_row != 0) {
+      UpdateExistingRow(table_id, row_id, client_row, client_table, data,
+                        row_size, version, table_version_maintain,
+                        row_version);
+      client_row->SetClock(clock);
+      client_row->set_row_delta_version(header.row_version);
+    } else { // not found
+      InsertNonexistentRow(table_id, row_id, client_table, data, row_size,
+                           version, clock, header.row_version);
+    }
   }
 
   std::vector<int32_t> app_thread_ids;
@@ -949,9 +1172,10 @@ void AbstractBgWorker::HandleServerRowRequestReply(
     row_request_msg.get_table_id() = table_id;
     row_request_msg.get_row_id() = row_id;
     row_request_msg.get_clock() = clock_to_request;
+    SetRowDeltaRequest(table_id, row_id, &row_request_msg);
 
     int32_t server_id = GlobalContext::GetPartitionServerID(
-        row_id, my_comm_channel_idx_);
+        table_id, row_id, my_comm_channel_idx_);
 
     size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(server_id,
       row_request_msg.get_mem(), row_request_msg.get_size());
@@ -968,6 +1192,35 @@ void AbstractBgWorker::HandleServerRowRequestReply(
   }
 }
 
+bool AbstractBgWorker::ApplyRowDelta(ClientTable *client_table, int32_t row_id,
+                                     int32_t clock,
+                                     const RowReplyHeader &header,
+                                     const void *delta) {
+  RowAccessor row_accessor;
+  ClientRow *client_row = client_table->get_process_storage().Find(
+      row_id, &row_accessor);
+  if (client_row == 0
+      || client_row->get_row_delta_version() != header.base_version)
+    return false;
+
+  // int32_t num_updates, int32_t column_ids[num_updates], updates
+  const uint8_t *delta_uint8 = reinterpret_cast<const uint8_t*>(delta);
+  int32_t num_updates = *(reinterpret_cast<const int32_t*>(delta_uint8));
+  delta_uint8 += sizeof(int32_t);
+  const int32_t *column_ids = reinterpret_cast<const int32_t*>(delta_uint8);
+  const void *updates = delta_uint8 + num_updates*sizeof(int32_t);
+
+  // The cached row already has this client's updates, so the others' are
+  // all that is missing; no oplog replay.
+  AbstractRow *row_data = client_row->GetRowDataPtr();
+  row_data->GetWriteLock();
+  row_data->ApplyBatchIncUnsafe(column_ids, updates, num_updates);
+  row_data->ReleaseWriteLock();
+  client_row->SetClock(clock);
+  client_row->set_row_delta_version(header.row_version);
+  return true;
+}
+
 size_t AbstractBgWorker::SendMsg(MsgBase *msg) {
   size_t sent_size = comm_bus_->SendInProc(my_id_, msg->get_mem(),
                                             msg->get_size());
@@ -1043,7 +1296,7 @@ RowOpLogSerializer *AbstractBgWorker::FindAndCreateRowOpLogSerializer(
 
   if (serializer_iter == row_oplog_serializer_map_.end()) {
     RowOpLogSerializer *row_oplog_serializer
-        = new RowOpLogSerializer(table->oplog_dense_serialized(),
+        = new RowOpLogSerializer(table_id, table->oplog_dense_serialized(),
                                  my_comm_channel_idx_);
     row_oplog_serializer_map_.insert(std::make_pair(table_id, row_oplog_serializer));
     serializer_iter = row_oplog_serializer_map_.find(table_id);
@@ -1077,6 +1330,7 @@ void *AbstractBgWorker::operator() () {
   pthread_barrier_wait(create_table_barrier_);
 
   FinalizeTableStats();
+  InitMsgCompressor();
 
   zmq::message_t zmq_msg;
   int32_t sender_id;
@@ -1154,12 +1408,27 @@ void *AbstractBgWorker::operator() () {
           CheckForwardRowRequestToServer(sender_id, row_request_msg);
         }
         break;
+      case kBatchRowRequest:
+        {
+          BatchRowRequestMsg batch_row_request_msg(msg_mem);
+          CheckForwardBatchRowRequestToServer(sender_id,
+                                              batch_row_request_msg);
+        }
+        break;
       case kServerRowRequestReply:
         {
           ServerRowRequestReplyMsg server_row_request_reply_msg(msg_mem);
           HandleServerRowRequestReply(sender_id, server_row_request_reply_msg);
         }
         break;
+      case kServerBatchRowRequestReply:
+        {
+          ServerBatchRowRequestReplyMsg server_batch_row_request_reply_msg(
+              msg_mem);
+          HandleServerBatchRowRequestReply(
+              sender_id, server_batch_row_request_reply_msg);
+        }
+        break;
       case kBgClock:
         {
           //LOG(INFO) << "bg_recv_clock = " << (client_clock_ + 1)
@@ -17,6 +17,7 @@
 #include <petuum_ps/client/client_table.hpp>
 #include <petuum_ps/thread/append_only_row_oplog_buffer.hpp>
 #include <petuum_ps/thread/row_oplog_serializer.hpp>
+#include <petuum_ps/thread/msg_compressor.hpp>
 #include <petuum_ps_common/thread/msg_tracker.hpp>
 
 namespace petuum {
@@ -39,6 +40,10 @@ public:
   bool RequestRow(int32_t table_id, int32_t row_id, int32_t clock);
   void RequestRowAsync(int32_t table_id, int32_t row_id, int32_t clock,
                        bool forced);
+  // Request rows asynchronously; the app thread receives one
+  // RowRequestReplyMsg for each row.
+  void RequestRowBatchAsync(int32_t table_id, const int32_t *row_ids,
+                            int32_t num_rows, int32_t clock);
   void GetAsyncRowRequestReply();
   void SignalHandleAppendOnlyBuffer(int32_t table_id);
 
@@ -81,6 +86,7 @@ protected:
   virtual void PrepareBeforeInfiniteLoop();
   // invoked after all tables have been created
   virtual void FinalizeTableStats();
+  void InitMsgCompressor();
   virtual long ResetBgIdleMilli();
   virtual long BgIdleWork();
 
@@ -111,6 +117,10 @@ protected:
 
   virtual void TrackBgOpLog(BgOpLog *bg_oplog) = 0;
 
+  // Allocates, on this bg worker, the row oplogs its channel of each table
+  // ran short of in the last clock.
+  void RefillRowOpLogPools();
+
   void FinalizeOpLogMsgStats(
       int32_t table_id,
       std::map<int32_t, size_t> *table_num_bytes_by_server,
@@ -121,9 +131,31 @@ protected:
   /* Handles Row Requests -- BEGIN */
   void CheckForwardRowRequestToServer(int32_t app_thread_id,
                                       RowRequestMsg &row_request_msg);
+  void CheckForwardBatchRowRequestToServer(
+      int32_t app_thread_id, BatchRowRequestMsg &batch_row_request_msg);
+  // Whether the process storage already has a row that satisfies a request
+  // for clock.
+  bool RowFreshInProcessStorage(ClientTable *table, int32_t row_id,
+                                int32_t clock);
+  void ReplyRowRequestToApp(int32_t app_thread_id);
   void HandleServerRowRequestReply(
       int32_t server_id,
       ServerRowRequestReplyMsg &server_row_request_reply_msg);
+  void HandleServerBatchRowRequestReply(
+      int32_t server_id,
+      ServerBatchRowRequestReplyMsg &server_batch_row_request_reply_msg);
+  void ApplyServerRowRequestReply(int32_t table_id, int32_t row_id,
+                                  int32_t clock, uint32_t version,
+                                  const void *data, size_t row_size);
+  // Apply a delta reply to the cached row. Returns false if the row is no
+  // longer cached at base_version.
+  bool ApplyRowDelta(ClientTable *client_table, int32_t row_id,
+                     int32_t clock, const RowReplyHeader &header,
+                     const void *delta);
+  // Fill in RowRequestMsg::get_accept_row_delta() and
+  // get_cached_row_version() before the request goes to the server.
+  void SetRowDeltaRequest(int32_t table_id, int32_t row_id,
+                          RowRequestMsg *row_request_msg);
 
   virtual void CheckAndApplyOldOpLogsToRowData(int32_t table_id,
                                                int32_t row_id, uint32_t row_version,
@@ -148,7 +180,8 @@ protected:
 
   virtual void InsertNonexistentRow(int32_t table_id,
                                     int32_t row_id, ClientTable *client_table, const void *data,
-                                    size_t row_size, uint32_t version, int32_t clock);
+                                    size_t row_size, uint32_t version, int32_t clock,
+                                    uint64_t row_delta_version);
 
   virtual void HandleEarlyCommOn();
   virtual void HandleEarlyCommOff();
@@ -181,6 +214,8 @@ protected:
   std::map<int32_t, std::map<int32_t, size_t> > server_table_oplog_size_map_;
   // The OpLog msg to each server
   std::map<int32_t, ClientSendOpLogMsg* > server_oplog_msg_map_;
+  // Rows of server_oplog_msg_map_ left in RowOpLogSerializer's buffers
+  std::map<int32_t, OpLogMsgGather> server_oplog_gather_map_;
   // size of oplog per table, reused across multiple tables
   std::map<int32_t, size_t> table_num_bytes_by_server_;
 
@@ -190,6 +225,8 @@ protected:
   std::unordered_map<int32_t, RowOpLogSerializer*> row_oplog_serializer_map_;
 
   MsgTracker msg_tracker_;
+
+  MsgCompressor msg_compressor_;
   bool pending_clock_send_oplog_;
   bool clock_advanced_buffed_;
   bool pending_shut_down_;
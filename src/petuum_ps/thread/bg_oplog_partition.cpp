@@ -4,14 +4,19 @@
 namespace petuum {
 
 BgOpLogPartition::BgOpLogPartition(int32_t table_id, size_t update_size,
-                                   int32_t my_comm_channel_idx):
+                                   int32_t my_comm_channel_idx,
+                                   RowOpLogPool *row_oplog_pool):
     table_id_(table_id),
     update_size_(update_size),
-    comm_channel_idx_(my_comm_channel_idx){ }
+    comm_channel_idx_(my_comm_channel_idx),
+    row_oplog_pool_(row_oplog_pool) { }
 
 BgOpLogPartition::~BgOpLogPartition() {
   for (auto iter = oplog_map_.begin(); iter != oplog_map_.end(); iter++) {
-    delete iter->second;
+    if (row_oplog_pool_ != 0)
+      row_oplog_pool_->PutBack(comm_channel_idx_, iter->second);
+    else
+      delete iter->second;
   }
 }
 
@@ -50,7 +55,7 @@ void BgOpLogPartition::SerializeByServer(
   for (auto iter = oplog_map_.cbegin(); iter != oplog_map_.cend(); iter++) {
     int32_t row_id = iter->first;
     int32_t server_id = GlobalContext::GetPartitionServerID(
-        row_id, comm_channel_idx_);
+        table_id_, row_id, comm_channel_idx_);
 
     auto server_iter = (*bytes_by_server).find(server_id);
     CHECK(server_iter != (*bytes_by_server).end());
@@ -8,24 +8,34 @@
 
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+#include <petuum_ps/oplog/row_oplog_pool.hpp>
 
 namespace petuum {
 
 class BgOpLogPartition : boost::noncopyable {
 public:
+  // Row oplogs are put back to row_oplog_pool when the partition is
+  // destroyed, or deleted if it is 0.
   BgOpLogPartition(int32_t table_id, size_t update_size,
-                   int32_t my_comm_channel_idx);
+                   int32_t my_comm_channel_idx,
+                   RowOpLogPool *row_oplog_pool = 0);
   ~BgOpLogPartition();
 
   AbstractRowOpLog *FindOpLog(int32_t row_id);
   void InsertOpLog(int32_t row_id, AbstractRowOpLog *row_oplog);
   void SerializeByServer(std::map<int32_t, void* > *bytes_by_server,
                          bool dense_serialize = false);
+
+  int32_t get_table_id() const {
+    return table_id_;
+  }
+
 private:
   std::unordered_map<int32_t,  AbstractRowOpLog*> oplog_map_;
   const int32_t table_id_;
   const size_t update_size_;
   const int32_t comm_channel_idx_;
+  RowOpLogPool *row_oplog_pool_;
 };
 
 }   // namespace petuum
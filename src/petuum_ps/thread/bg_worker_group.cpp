@@ -71,16 +71,38 @@ void BgWorkerGroup::WaitCreateTable() {
 
 bool BgWorkerGroup::RequestRow(int32_t table_id, int32_t row_id,
                                int32_t clock) {
-  int32_t bg_idx = GlobalContext::GetPartitionCommChannelIndex(row_id);
+  int32_t bg_idx = GlobalContext::GetPartitionCommChannelIndex(table_id, row_id);
   return bg_worker_vec_[bg_idx]->RequestRow(table_id, row_id, clock);
 }
 
 void BgWorkerGroup::RequestRowAsync(int32_t table_id, int32_t row_id,
                                     int32_t clock, bool forced){
-  int32_t bg_idx = GlobalContext::GetPartitionCommChannelIndex(row_id);
+  int32_t bg_idx = GlobalContext::GetPartitionCommChannelIndex(table_id, row_id);
   bg_worker_vec_[bg_idx]->RequestRowAsync(table_id, row_id, clock, forced);
 }
 
+void BgWorkerGroup::RequestRowBatch(
+    int32_t table_id, const std::vector<int32_t> &row_ids, int32_t clock) {
+  std::vector<std::vector<int32_t> > bg_row_ids(bg_worker_vec_.size());
+  for (auto row_id : row_ids) {
+    int32_t bg_idx = GlobalContext::GetPartitionCommChannelIndex(table_id, row_id);
+    bg_row_ids[bg_idx].push_back(row_id);
+  }
+
+  for (size_t bg_idx = 0; bg_idx < bg_row_ids.size(); ++bg_idx) {
+    if (bg_row_ids[bg_idx].empty())
+      continue;
+    bg_worker_vec_[bg_idx]->RequestRowBatchAsync(
+        table_id, bg_row_ids[bg_idx].data(), bg_row_ids[bg_idx].size(),
+        clock);
+  }
+
+  // Bg workers reply once for each row, as the row arrives.
+  for (size_t i = 0; i < row_ids.size(); ++i) {
+    GetAsyncRowRequestReply();
+  }
+}
+
 void BgWorkerGroup::GetAsyncRowRequestReply() {
   zmq::message_t zmq_msg;
   int32_t sender_id;
@@ -24,6 +24,11 @@ public:
   bool RequestRow(int32_t table_id, int32_t row_id, int32_t clock);
   void RequestRowAsync(int32_t table_id, int32_t row_id, int32_t clock,
                        bool forced);
+  // Block until all rows are fresh enough for clock. Rows are requested
+  // with one message per bg worker, which forwards them to each server in
+  // one message.
+  void RequestRowBatch(int32_t table_id, const std::vector<int32_t> &row_ids,
+                       int32_t clock);
   void GetAsyncRowRequestReply();
   void SignalHandleAppendOnlyBuffer(int32_t table_id, int32_t channel_idx);
 
@@ -23,6 +23,10 @@ public:
   // it exists in the process storage and clock is fresh enough.
   static void RequestRowAsync(int32_t table_id, int32_t row_id, int32_t clock,
                               bool forced);
+  // row_ids must not contain duplicates.
+  static void RequestRowBatch(int32_t table_id,
+                              const std::vector<int32_t> &row_ids,
+                              int32_t clock);
   static void GetAsyncRowRequestReply();
   static void SignalHandleAppendOnlyBuffer(int32_t table_id, int32_t channel_idx);
   static void ClockAllTables();
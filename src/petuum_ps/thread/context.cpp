@@ -44,6 +44,14 @@ int32_t GlobalContext::resume_clock_;
 
 std::string GlobalContext::resume_dir_;
 
+bool GlobalContext::snapshot_async_;
+
+int32_t GlobalContext::snapshot_full_interval_;
+
+int32_t GlobalContext::resume_num_threads_;
+
+int32_t GlobalContext::num_server_apply_threads_;
+
 UpdateSortPolicy GlobalContext::update_sort_policy_;
 
 long GlobalContext::bg_idle_milli_;
@@ -66,4 +74,10 @@ bool GlobalContext::naive_table_oplog_meta_;
 bool GlobalContext::suppression_on_;
 
 bool GlobalContext::use_approx_sort_;
+
+bool GlobalContext::row_delta_reply_;
+
+RowPartitioner GlobalContext::row_partitioner_;
+
+std::string GlobalContext::row_placement_file_;
 }   // namespace petuum
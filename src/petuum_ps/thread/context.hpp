@@ -12,6 +12,7 @@
 #include <petuum_ps_common/comm_bus/comm_bus.hpp>
 #include <petuum_ps_common/include/configs.hpp>
 #include <petuum_ps_common/util/vector_clock_mt.hpp>
+#include <petuum_ps/thread/row_partitioner.hpp>
 
 namespace petuum {
 
@@ -156,7 +157,15 @@ public:
       NumaPolicy numa_policy,
       bool naive_table_oplog_meta,
       bool use_approx_sort,
-      bool suppression_on) {
+      bool row_delta_reply,
+      bool suppression_on,
+      bool snapshot_async,
+      int32_t snapshot_full_interval,
+      int32_t resume_num_threads,
+      int32_t num_server_apply_threads,
+      RowPartitionerType row_partitioner_type,
+      int32_t num_partition_virtual_nodes,
+      const std::string &row_placement_file) {
 
     num_comm_channels_per_client_
         = num_comm_channels_per_client;
@@ -199,8 +208,19 @@ public:
 
     use_approx_sort_ = use_approx_sort;
 
+    row_delta_reply_ = row_delta_reply;
+
     suppression_on_ = suppression_on;
 
+    snapshot_async_ = snapshot_async;
+    snapshot_full_interval_ = snapshot_full_interval;
+    resume_num_threads_ = resume_num_threads;
+    num_server_apply_threads_ = num_server_apply_threads;
+
+    row_partitioner_.Init(row_partitioner_type, num_comm_channels_per_client,
+                          num_clients, num_partition_virtual_nodes);
+    row_placement_file_ = row_placement_file;
+
     for (auto host_iter = host_map.begin();
          host_iter != host_map.end(); ++host_iter) {
       HostInfo host_info = host_iter->second;
@@ -288,21 +308,36 @@ public:
     return client_id_;
   }
 
-  static int32_t GetPartitionCommChannelIndex(int32_t row_id) {
-    return row_id % num_comm_channels_per_client_;
+  static int32_t GetPartitionCommChannelIndex(int32_t table_id,
+                                              int32_t row_id) {
+    return row_partitioner_.GetPartition(table_id, row_id)
+        % num_comm_channels_per_client_;
   }
 
   // get the id of the server who is responsible for holding that row
-  static int32_t GetPartitionClientID(int32_t row_id) {
-    return (row_id / num_comm_channels_per_client_) % num_clients_;
+  static int32_t GetPartitionClientID(int32_t table_id, int32_t row_id) {
+    return row_partitioner_.GetPartition(table_id, row_id)
+        / num_comm_channels_per_client_;
   }
 
-  static int32_t GetPartitionServerID(int32_t row_id,
+  static int32_t GetPartitionServerID(int32_t table_id, int32_t row_id,
                                       int32_t comm_channel_idx) {
-    int32_t client_id = GetPartitionClientID(row_id);
+    int32_t client_id = GetPartitionClientID(table_id, row_id);
     return get_server_thread_id(client_id, comm_channel_idx);
   }
 
+  // Rows placed explicitly, overriding the row partitioner. Must be added
+  // before the table is accessed, i.e. when the table is created.
+  static void AddRowPlacements(const RowPlacement *placements,
+                               int32_t num_placements) {
+    row_partitioner_.AddPlacements(placements, num_placements);
+  }
+
+  // Only read by the name node.
+  static const std::string &get_row_placement_file() {
+    return row_placement_file_;
+  }
+
   static int32_t GetCommChannelIndexServer(int32_t server_id) {
     int32_t index = server_id % kMaxNumThreadsPerClient
                     - kServerThreadIDStartOffset;
@@ -355,6 +390,22 @@ public:
     return resume_dir_;
   }
 
+  static bool get_snapshot_async() {
+    return snapshot_async_;
+  }
+
+  static int32_t get_snapshot_full_interval() {
+    return snapshot_full_interval_;
+  }
+
+  static int32_t get_resume_num_threads() {
+    return resume_num_threads_;
+  }
+
+  static int32_t get_num_server_apply_threads() {
+    return num_server_apply_threads_;
+  }
+
   static UpdateSortPolicy get_update_sort_policy() {
     return update_sort_policy_;
   }
@@ -399,6 +450,10 @@ public:
     return use_approx_sort_;
   }
 
+  static bool get_row_delta_reply() {
+    return row_delta_reply_;
+  }
+
   static CommBus* comm_bus;
 
   // name node thread id - 0
@@ -439,6 +494,10 @@ private:
   static std::string snapshot_dir_;
   static int32_t resume_clock_;
   static std::string resume_dir_;
+  static bool snapshot_async_;
+  static int32_t snapshot_full_interval_;
+  static int32_t resume_num_threads_;
+  static int32_t num_server_apply_threads_;
   static UpdateSortPolicy update_sort_policy_;
   static long bg_idle_milli_;
 
@@ -461,6 +520,12 @@ private:
 
   static bool use_approx_sort_;
 
+  static bool row_delta_reply_;
+
+  static RowPartitioner row_partitioner_;
+
+  static std::string row_placement_file_;
+
   //static std::vector<CommBus*> comm_bus;
 };
 
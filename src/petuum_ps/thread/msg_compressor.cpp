@@ -0,0 +1,412 @@
+// author: jinliang
+#include <petuum_ps/thread/msg_compressor.hpp>
+#include <petuum_ps_common/util/dense_kernels.hpp>
+
+#include <float16_compressor.hpp>
+#include <snappy.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <cstring>
+
+namespace petuum {
+
+namespace {
+
+const int32_t kRowCodingFlags = CompressType::kVarintIds
+                                | CompressType::kFloat16
+                                | CompressType::kBFloat16;
+
+const int32_t kValueCodingFlags = CompressType::kFloat16
+                                  | CompressType::kBFloat16;
+
+template<typename T>
+void Append(std::vector<uint8_t> *buff, T val) {
+  const uint8_t *val_ptr = reinterpret_cast<const uint8_t*>(&val);
+  buff->insert(buff->end(), val_ptr, val_ptr + sizeof(T));
+}
+
+template<typename T>
+T Read(const uint8_t **mem) {
+  T val;
+  memcpy(&val, *mem, sizeof(T));
+  *mem += sizeof(T);
+  return val;
+}
+
+// Feeds snappy the next size bytes of a MemSegmentReader a segment at a
+// time.
+class SegmentSource : public snappy::Source {
+public:
+  SegmentSource(MemSegmentReader *reader, size_t size):
+      reader_(reader),
+      size_left_(size) { }
+
+  size_t Available() const {
+    return size_left_;
+  }
+
+  const char *Peek(size_t *len) {
+    *len = std::min(size_left_, reader_->GetContiguousSize());
+    CHECK(*len > 0 || size_left_ == 0) << "read past the end";
+    return (*len == 0) ? 0
+        : reinterpret_cast<const char*>(reader_->GetPtr());
+  }
+
+  void Skip(size_t n) {
+    reader_->Advance(n);
+    size_left_ -= n;
+  }
+
+private:
+  MemSegmentReader *reader_;
+  size_t size_left_;
+};
+
+}  // anonymous namespace
+
+void MsgCompressor::AddTable(
+    int32_t table_id, int32_t compress_type, size_t update_size,
+    bool dense_serialized, int32_t row_oplog_type, bool version_maintain,
+    size_t dense_row_oplog_capacity, bool float_updates) {
+  bool plain_serialized = !version_maintain
+                          && (row_oplog_type == RowOpLogType::kDenseRowOpLog
+                              || (!dense_serialized
+                                  && (row_oplog_type
+                                      == RowOpLogType::kSparseRowOpLog
+                                      || row_oplog_type
+                                      == RowOpLogType::kSparseVectorRowOpLog)));
+
+  if (!plain_serialized)
+    compress_type &= ~kRowCodingFlags;
+  if (!float_updates || update_size != sizeof(float))
+    compress_type &= ~kValueCodingFlags;
+
+  TableCompressInfo &info = table_info_[table_id];
+  info.compress_type = compress_type;
+  info.update_size = update_size;
+  info.dense_num_updates = dense_serialized ? dense_row_oplog_capacity : 0;
+  if (compress_type != CompressType::kNone)
+    compress_oplog_ = true;
+}
+
+size_t MsgCompressor::EncodeRows(MemSegmentReader *rows, size_t raw_size,
+                                 const TableCompressInfo &info, uint8_t *to) {
+  size_t rows_begin = rows->get_num_read();
+  uint8_t *to_begin = to;
+  size_t update_size = info.update_size;
+
+  int32_t num_rows = rows->Read<int32_t>();
+  to = CompressUtil::PutVarint32(to, num_rows);
+
+  int32_t prev_row_id = 0;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    const uint8_t *row_begin = rows->GetPtr();
+    const uint8_t *mem = row_begin;
+    int32_t row_id = Read<int32_t>(&mem);
+    to = CompressUtil::PutVarint32(
+        to, CompressUtil::ZigZagEncode(row_id - prev_row_id));
+    prev_row_id = row_id;
+
+    int32_t num_updates = info.dense_num_updates;
+    if (num_updates == 0) {
+      num_updates = Read<int32_t>(&mem);
+      to = CompressUtil::PutVarint32(to, num_updates);
+
+      if (info.compress_type & CompressType::kVarintIds) {
+        int32_t prev_col_id = 0;
+        for (int32_t j = 0; j < num_updates; ++j) {
+          int32_t col_id = Read<int32_t>(&mem);
+          to = CompressUtil::PutVarint32(
+              to, CompressUtil::ZigZagEncode(col_id - prev_col_id));
+          prev_col_id = col_id;
+        }
+      } else {
+        memcpy(to, mem, num_updates*sizeof(int32_t));
+        mem += num_updates*sizeof(int32_t);
+        to += num_updates*sizeof(int32_t);
+      }
+    }
+
+    if (info.compress_type & kValueCodingFlags) {
+      bool bfloat16 = info.compress_type & CompressType::kBFloat16;
+      for (int32_t j = 0; j < num_updates; ++j) {
+        float update = Read<float>(&mem);
+        uint16_t coded = bfloat16 ? CompressUtil::FloatToBFloat16(update)
+                         : Float16Compressor::compress(update);
+        memcpy(to, &coded, sizeof(uint16_t));
+        to += sizeof(uint16_t);
+      }
+    } else {
+      memcpy(to, mem, num_updates*update_size);
+      mem += num_updates*update_size;
+      to += num_updates*update_size;
+    }
+    rows->Advance(mem - row_begin);
+  }
+  CHECK_EQ(rows->get_num_read() - rows_begin, raw_size)
+      << "table rows do not match the serialized size";
+  return to - to_begin;
+}
+
+size_t MsgCompressor::DecodeRows(const uint8_t *encoded,
+                                 int32_t compress_type, size_t update_size,
+                                 int32_t dense_num_updates, uint8_t *to) {
+  uint8_t *to_begin = to;
+  uint32_t val;
+  encoded = CompressUtil::GetVarint32(encoded, &val);
+  int32_t num_rows = val;
+  memcpy(to, &num_rows, sizeof(int32_t));
+  to += sizeof(int32_t);
+
+  int32_t row_id = 0;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    encoded = CompressUtil::GetVarint32(encoded, &val);
+    row_id += CompressUtil::ZigZagDecode(val);
+    memcpy(to, &row_id, sizeof(int32_t));
+    to += sizeof(int32_t);
+
+    int32_t num_updates = dense_num_updates;
+    if (num_updates == 0) {
+      encoded = CompressUtil::GetVarint32(encoded, &val);
+      num_updates = val;
+      memcpy(to, &num_updates, sizeof(int32_t));
+      to += sizeof(int32_t);
+
+      if (compress_type & CompressType::kVarintIds) {
+        int32_t col_id = 0;
+        for (int32_t j = 0; j < num_updates; ++j) {
+          encoded = CompressUtil::GetVarint32(encoded, &val);
+          col_id += CompressUtil::ZigZagDecode(val);
+          memcpy(to, &col_id, sizeof(int32_t));
+          to += sizeof(int32_t);
+        }
+      } else {
+        memcpy(to, encoded, num_updates*sizeof(int32_t));
+        encoded += num_updates*sizeof(int32_t);
+        to += num_updates*sizeof(int32_t);
+      }
+    }
+
+    if (compress_type & CompressType::kFloat16) {
+      std::vector<uint16_t> coded(num_updates);
+      memcpy(coded.data(), encoded, num_updates*sizeof(uint16_t));
+      std::vector<float> updates(num_updates);
+      DenseKernels::DecompressFloat16(updates.data(), coded.data(),
+                                      num_updates);
+      memcpy(to, updates.data(), num_updates*sizeof(float));
+      encoded += num_updates*sizeof(uint16_t);
+      to += num_updates*sizeof(float);
+    } else if (compress_type & CompressType::kBFloat16) {
+      for (int32_t j = 0; j < num_updates; ++j) {
+        float update = CompressUtil::BFloat16ToFloat(Read<uint16_t>(&encoded));
+        memcpy(to, &update, sizeof(float));
+        to += sizeof(float);
+      }
+    } else {
+      memcpy(to, encoded, num_updates*update_size);
+      encoded += num_updates*update_size;
+      to += num_updates*update_size;
+    }
+  }
+  return to - to_begin;
+}
+
+ClientSendOpLogMsg *MsgCompressor::CompressOpLogMsg(
+    ClientSendOpLogMsg &msg, const OpLogMsgGather &gather,
+    const std::map<int32_t, size_t> &table_sizes) {
+  if (!compress_oplog_)
+    return 0;
+
+  gather.GetDataSegments(&msg, &data_segments_);
+  MemSegmentReader reader(data_segments_.data(), data_segments_.size());
+  int32_t num_tables = reader.Read<int32_t>();
+  CHECK_EQ(num_tables, (int32_t) table_sizes.size());
+
+  std::vector<uint8_t> msg_buff;
+  Append<int32_t>(&msg_buff, num_tables);
+  std::vector<uint8_t> row_coded;
+  std::vector<uint8_t> snappy_coded;
+  bool compressed = false;
+
+  for (const auto &table_pair : table_sizes) {
+    int32_t table_id = reader.Read<int32_t>();
+    CHECK_EQ(table_id, table_pair.first);
+    size_t update_size = reader.Read<size_t>();
+    const MemSegmentReader rows = reader;
+    size_t raw_size = table_pair.second;
+    reader.Skip(raw_size);
+
+    auto info_iter = table_info_.find(table_id);
+    CHECK(info_iter != table_info_.end()) << "unknown table " << table_id;
+    TableCompressInfo &info = info_iter->second;
+
+    int32_t compress_type = info.compress_type;
+    if (compress_type != CompressType::kNone && !info.gate.ShouldTry())
+      compress_type = CompressType::kNone;
+
+    // Rows are read where they are, which may be several segments.
+    MemSegmentReader encoded_reader = rows;
+    MemSegment encoded_segment;
+    size_t encoded_size = raw_size;
+    if (compress_type & kRowCodingFlags) {
+      row_coded.resize(raw_size + raw_size / 4
+                       + CompressUtil::kMaxVarint32Size);
+      encoded_size = EncodeRows(&encoded_reader, raw_size, info,
+                                row_coded.data());
+      encoded_segment = MemSegment(row_coded.data(), encoded_size);
+      encoded_reader = MemSegmentReader(&encoded_segment, 1);
+    }
+
+    if (compress_type & CompressType::kSnappy) {
+      snappy_coded.resize(snappy::MaxCompressedLength(encoded_size));
+      SegmentSource source(&encoded_reader, encoded_size);
+      snappy::UncheckedByteArraySink sink(
+          reinterpret_cast<char*>(snappy_coded.data()));
+      encoded_size = snappy::Compress(&source, &sink);
+      encoded_segment = MemSegment(snappy_coded.data(), encoded_size);
+      encoded_reader = MemSegmentReader(&encoded_segment, 1);
+    }
+
+    if (compress_type != CompressType::kNone
+        && !info.gate.Report(raw_size, encoded_size)) {
+      compress_type = CompressType::kNone;
+      encoded_reader = rows;
+      encoded_size = raw_size;
+    }
+    compressed = compressed || (compress_type != CompressType::kNone);
+
+    Append<int32_t>(&msg_buff, table_id);
+    Append<size_t>(&msg_buff, update_size);
+    Append<int32_t>(&msg_buff, compress_type);
+    Append<uint64_t>(&msg_buff, raw_size);
+    Append<uint64_t>(&msg_buff, encoded_size);
+    Append<int32_t>(&msg_buff, info.dense_num_updates);
+    size_t encoded_offset = msg_buff.size();
+    msg_buff.resize(encoded_offset + encoded_size);
+    encoded_reader.Copy(msg_buff.data() + encoded_offset, encoded_size);
+  }
+
+  // Per-table headers may outweigh what a small table saved.
+  if (!compressed || msg_buff.size() >= msg.get_avai_size())
+    return 0;
+
+  ClientSendOpLogMsg *compressed_msg = new ClientSendOpLogMsg(msg_buff.size());
+  memcpy(compressed_msg->get_data(), msg_buff.data(), msg_buff.size());
+  compressed_msg->get_is_compressed() = true;
+  return compressed_msg;
+}
+
+void *MsgCompressor::DecompressOpLogMsg(
+    ClientSendOpLogMsg &msg, std::vector<uint8_t> *buff, size_t *size) {
+  if (!msg.get_is_compressed()) {
+    *size = msg.get_avai_size();
+    return msg.get_data();
+  }
+
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(msg.get_data());
+  const uint8_t *mem = data;
+  int32_t num_tables = Read<int32_t>(&mem);
+
+  // Find the raw size first.
+  size_t total_size = sizeof(int32_t);
+  for (int32_t i = 0; i < num_tables; ++i) {
+    mem += sizeof(int32_t) + sizeof(size_t) + sizeof(int32_t);
+    uint64_t raw_size = Read<uint64_t>(&mem);
+    uint64_t encoded_size = Read<uint64_t>(&mem);
+    mem += sizeof(int32_t) + encoded_size;
+    total_size += sizeof(int32_t) + sizeof(size_t) + raw_size;
+  }
+
+  buff->resize(total_size);
+  uint8_t *to = buff->data();
+  memcpy(to, &num_tables, sizeof(int32_t));
+  to += sizeof(int32_t);
+
+  std::vector<uint8_t> snappy_decoded;
+  mem = data + sizeof(int32_t);
+  for (int32_t i = 0; i < num_tables; ++i) {
+    memcpy(to, mem, sizeof(int32_t) + sizeof(size_t));
+    to += sizeof(int32_t);
+    mem += sizeof(int32_t);
+    size_t update_size = Read<size_t>(&mem);
+    to += sizeof(size_t);
+
+    int32_t compress_type = Read<int32_t>(&mem);
+    uint64_t raw_size = Read<uint64_t>(&mem);
+    uint64_t encoded_size = Read<uint64_t>(&mem);
+    int32_t dense_num_updates = Read<int32_t>(&mem);
+
+    const uint8_t *encoded = mem;
+    size_t decoded_size = encoded_size;
+    if (compress_type & CompressType::kSnappy) {
+      CHECK(snappy::GetUncompressedLength(
+          reinterpret_cast<const char*>(encoded), encoded_size,
+          &decoded_size));
+      snappy_decoded.resize(decoded_size);
+      CHECK(snappy::RawUncompress(
+          reinterpret_cast<const char*>(encoded), encoded_size,
+          reinterpret_cast<char*>(snappy_decoded.data())));
+      encoded = snappy_decoded.data();
+    }
+
+    if (compress_type & kRowCodingFlags) {
+      size_t rows_size = DecodeRows(encoded, compress_type, update_size,
+                                    dense_num_updates, to);
+      CHECK_EQ(rows_size, raw_size);
+    } else {
+      CHECK_EQ(decoded_size, raw_size);
+      memcpy(to, encoded, raw_size);
+    }
+    to += raw_size;
+    mem += encoded_size;
+  }
+
+  *size = total_size;
+  return buff->data();
+}
+
+ServerPushRowMsg *MsgCompressor::CompressPushRowMsg(ServerPushRowMsg &msg) {
+  if (!compress_push_ || !push_gate_.ShouldTry())
+    return 0;
+
+  size_t raw_size = msg.get_avai_size();
+  ServerPushRowMsg *compressed_msg = new ServerPushRowMsg(
+      sizeof(uint64_t) + snappy::MaxCompressedLength(raw_size));
+  uint8_t *data = reinterpret_cast<uint8_t*>(compressed_msg->get_data());
+  *(reinterpret_cast<uint64_t*>(data)) = raw_size;
+
+  size_t compressed_size;
+  snappy::RawCompress(reinterpret_cast<const char*>(msg.get_data()), raw_size,
+                      reinterpret_cast<char*>(data + sizeof(uint64_t)),
+                      &compressed_size);
+  compressed_size += sizeof(uint64_t);
+
+  if (!push_gate_.Report(raw_size, compressed_size)) {
+    delete compressed_msg;
+    return 0;
+  }
+
+  compressed_msg->get_avai_size() = compressed_size;
+  compressed_msg->get_is_compressed() = true;
+  return compressed_msg;
+}
+
+void *MsgCompressor::DecompressPushRowMsg(
+    ServerPushRowMsg &msg, std::vector<uint8_t> *buff, size_t *size) {
+  if (!msg.get_is_compressed()) {
+    *size = msg.get_avai_size();
+    return msg.get_data();
+  }
+
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(msg.get_data());
+  uint64_t raw_size = *(reinterpret_cast<const uint64_t*>(data));
+  buff->resize(raw_size);
+  CHECK(snappy::RawUncompress(
+      reinterpret_cast<const char*>(data + sizeof(uint64_t)),
+      msg.get_avai_size() - sizeof(uint64_t),
+      reinterpret_cast<char*>(buff->data())));
+  *size = raw_size;
+  return buff->data();
+}
+
+}  // namespace petuum
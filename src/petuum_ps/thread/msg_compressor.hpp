@@ -0,0 +1,114 @@
+// author: jinliang
+#pragma once
+
+#include <petuum_ps/thread/ps_msgs.hpp>
+#include <petuum_ps/thread/oplog_msg_gather.hpp>
+#include <petuum_ps_common/util/compress_util.hpp>
+#include <petuum_ps_common/util/mem_segments.hpp>
+
+#include <boost/noncopyable.hpp>
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+// Compresses ClientSendOpLogMsg and ServerPushRowMsg payloads according to
+// each table's TableInfo::compress_type.
+//
+// OpLogs are compressed table by table. A compressed oplog message keeps
+// the layout read by SerializedOpLogReader, except that each table's rows
+// are replaced by:
+// 1. int32_t : compress type applied (CompressType flags)
+// 2. uint64_t : raw size of the table's rows
+// 3. uint64_t : encoded size
+// 4. int32_t : number of updates per row if dense serialized, otherwise 0
+// 5. encoded rows
+//
+// With kVarintIds or kFloat16/kBFloat16, rows are re-coded as:
+// varint num_rows, then for each row the varint zigzag delta of its row id,
+// varint num_updates (sparse serialized only), column ids (varint zigzag
+// deltas with kVarintIds, raw otherwise) and updates (16-bit with kFloat16
+// or kBFloat16, raw otherwise). kSnappy is applied last.
+//
+// Pushed rows are opaque to the server, so push messages are only snappy
+// compressed as a whole, if any table on the server asks for kSnappy.
+//
+// A table's rows are sent raw while CompressGate finds compression does
+// not pay.
+class MsgCompressor : boost::noncopyable {
+public:
+  MsgCompressor():
+      compress_oplog_(false),
+      compress_push_(false) { }
+
+  // Bg side. Id and value coding is dropped for row oplogs whose serialized
+  // form is not the plain one (versioned or float16 dense row oplogs) and
+  // value coding for non-float updates.
+  void AddTable(int32_t table_id, int32_t compress_type, size_t update_size,
+                bool dense_serialized, int32_t row_oplog_type,
+                bool version_maintain, size_t dense_row_oplog_capacity,
+                bool float_updates);
+
+  // table_sizes gives the size of each table's rows in msg, the same as
+  // passed to OpLogSerializer::Init(). Rows left in gather's buffers are
+  // read there. Returns a compressed copy of msg, or 0 if msg is to be sent
+  // as is.
+  ClientSendOpLogMsg *CompressOpLogMsg(
+      ClientSendOpLogMsg &msg, const OpLogMsgGather &gather,
+      const std::map<int32_t, size_t> &table_sizes);
+
+  // Returns the serialized oplogs in msg; they are decoded into buff if msg
+  // is compressed.
+  static void *DecompressOpLogMsg(ClientSendOpLogMsg &msg,
+                                  std::vector<uint8_t> *buff, size_t *size);
+
+  // Server side.
+  void AddServerTable(int32_t compress_type) {
+    if (compress_type & CompressType::kSnappy)
+      compress_push_ = true;
+  }
+
+  bool get_compress_push() const {
+    return compress_push_;
+  }
+
+  // Returns a compressed copy of msg, or 0 if msg is to be sent as is.
+  ServerPushRowMsg *CompressPushRowMsg(ServerPushRowMsg &msg);
+
+  static void *DecompressPushRowMsg(ServerPushRowMsg &msg,
+                                    std::vector<uint8_t> *buff, size_t *size);
+
+private:
+  friend class MsgCompressorTest;
+
+  struct TableCompressInfo {
+    int32_t compress_type;
+    size_t update_size;
+    int32_t dense_num_updates;
+    CompressGate gate;
+  };
+
+  static const size_t kTableHeaderSize = sizeof(int32_t) + sizeof(uint64_t)
+      + sizeof(uint64_t) + sizeof(int32_t);
+
+  // Reads raw_size bytes of rows, each of which is in one segment.
+  static size_t EncodeRows(MemSegmentReader *rows, size_t raw_size,
+                           const TableCompressInfo &info, uint8_t *to);
+
+  // dense_num_updates is 0 for sparse serialized rows. Returns the decoded
+  // size.
+  static size_t DecodeRows(const uint8_t *encoded, int32_t compress_type,
+                         size_t update_size, int32_t dense_num_updates,
+                         uint8_t *to);
+
+  std::map<int32_t, TableCompressInfo> table_info_;
+  // Reused to keep its capacity.
+  std::vector<MemSegment> data_segments_;
+
+  bool compress_oplog_;
+  bool compress_push_;
+  CompressGate push_gate_;
+};
+
+}  // namespace petuum
@@ -0,0 +1,112 @@
+#include <petuum_ps/thread/oplog_msg_gather.hpp>
+#include <petuum_ps/thread/row_oplog_serializer.hpp>
+#include <petuum_ps_common/util/mem_block.hpp>
+#include <glog/logging.h>
+#include <string.h>
+
+namespace petuum {
+
+OpLogMsgGather::~OpLogMsgGather() {
+  Clear();
+}
+
+void OpLogMsgGather::AddBuffers(uint8_t *mem,
+                                std::vector<SerializedOpLogBuffer*> *buffs) {
+  gaps_.push_back(Gap());
+  gaps_.back().mem = mem;
+  gaps_.back().buffs.swap(*buffs);
+}
+
+void OpLogMsgGather::CopyTo() {
+  for (auto &gap : gaps_) {
+    uint8_t *mem = gap.mem;
+    for (auto buff : gap.buffs) {
+      memcpy(mem, buff->get_mem(), buff->get_size());
+      mem += buff->get_size();
+    }
+  }
+  Clear();
+}
+
+void OpLogMsgGather::GetDataSegments(
+    ClientSendOpLogMsg *msg, std::vector<MemSegment> *segments) const {
+  segments->clear();
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(msg->get_data());
+  const uint8_t *piece_begin = data;
+  for (const auto &gap : gaps_) {
+    segments->push_back(MemSegment(piece_begin, gap.mem - piece_begin));
+    piece_begin = gap.mem;
+    for (auto buff : gap.buffs) {
+      segments->push_back(MemSegment(buff->get_mem(), buff->get_size()));
+      piece_begin += buff->get_size();
+    }
+  }
+  segments->push_back(MemSegment(
+      piece_begin, msg->get_avai_size() - (piece_begin - data)));
+}
+
+void OpLogMsgGather::Clear() {
+  for (auto &gap : gaps_) {
+    for (auto buff : gap.buffs) {
+      SerializedOpLogBufferPool::Put(buff);
+    }
+  }
+  gaps_.clear();
+}
+
+void OpLogMsgGather::ZmqFreeMsgMem(void *data, void *hint) {
+  SharedMsgMem *shared_mem = reinterpret_cast<SharedMsgMem*>(hint);
+  if (shared_mem->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    MemBlock::MemFree(shared_mem->mem);
+    delete shared_mem;
+  }
+}
+
+size_t OpLogMsgGather::Send(CommBus *comm_bus, int32_t server_id,
+                            ClientSendOpLogMsg *msg) {
+  size_t msg_size = msg->get_size();
+  size_t num_buffs = 0;
+  for (const auto &gap : gaps_) {
+    num_buffs += gap.buffs.size();
+  }
+
+  SharedMsgMem *shared_mem = new SharedMsgMem;
+  shared_mem->mem = reinterpret_cast<uint8_t*>(msg->ReleaseMem());
+  // One reference for each message piece plus ours.
+  shared_mem->ref_count = gaps_.size() + 2;
+
+  zmq::message_t *frames = new zmq::message_t[num_buffs + gaps_.size() + 1];
+  int32_t num_frames = 0;
+  uint8_t *piece_begin = shared_mem->mem;
+  size_t accum_size = 0;
+  for (auto &gap : gaps_) {
+    size_t piece_size = gap.mem - piece_begin;
+    frames[num_frames++].rebuild(piece_begin, piece_size, &ZmqFreeMsgMem,
+                                 shared_mem);
+    accum_size += piece_size;
+    piece_begin = gap.mem;
+    for (auto buff : gap.buffs) {
+      frames[num_frames++].rebuild(buff->get_mem(), buff->get_size(),
+                                   &SerializedOpLogBufferPool::ZmqFree, buff);
+      accum_size += buff->get_size();
+      // The rows take the place of the gap in the message.
+      piece_begin += buff->get_size();
+    }
+    gap.buffs.clear();
+  }
+  size_t piece_size = msg_size - (piece_begin - shared_mem->mem);
+  frames[num_frames++].rebuild(piece_begin, piece_size, &ZmqFreeMsgMem,
+                               shared_mem);
+  accum_size += piece_size;
+  CHECK_EQ(accum_size, msg_size);
+
+  size_t sent_size = comm_bus->SendMultiPart(server_id, frames, num_frames);
+  CHECK_EQ(sent_size, msg_size);
+  delete[] frames;
+  ZmqFreeMsgMem(0, shared_mem);
+
+  gaps_.clear();
+  return sent_size;
+}
+
+}  // namespace petuum
@@ -0,0 +1,70 @@
+// author: jinliang
+#pragma once
+
+#include <petuum_ps/thread/ps_msgs.hpp>
+#include <petuum_ps_common/comm_bus/comm_bus.hpp>
+#include <petuum_ps_common/util/mem_segments.hpp>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+class SerializedOpLogBuffer;
+
+// Rows of a ClientSendOpLogMsg that are left in the SerializedOpLogBuffers
+// RowOpLogSerializer wrote them to, instead of being copied into the
+// message. Send() hands the message and the buffers to zmq as one multipart
+// message, whose frames the server reads in place. Buffers go back to
+// SerializedOpLogBufferPool once zmq is done with them.
+class OpLogMsgGather : boost::noncopyable {
+public:
+  OpLogMsgGather() { }
+
+  // Returns the buffers not sent to the pool.
+  ~OpLogMsgGather();
+
+  // The rows in buffs belong at mem, which points into the message data.
+  // Takes the buffers from buffs.
+  void AddBuffers(uint8_t *mem, std::vector<SerializedOpLogBuffer*> *buffs);
+
+  bool empty() const {
+    return gaps_.empty();
+  }
+
+  // Copy the buffers into msg and return them to the pool, for messages
+  // that are transferred in process.
+  void CopyTo();
+
+  // The message data with the buffers in place, in the order Send() sends
+  // them.
+  void GetDataSegments(ClientSendOpLogMsg *msg,
+                       std::vector<MemSegment> *segments) const;
+
+  // Return the buffers to the pool, for messages replaced by a compressed
+  // copy.
+  void Clear();
+
+  // Send msg to server_id with the buffers in place, without copying. Takes
+  // msg's memory. Returns the number of bytes sent.
+  size_t Send(CommBus *comm_bus, int32_t server_id, ClientSendOpLogMsg *msg);
+
+private:
+  struct Gap {
+    uint8_t *mem;
+    std::vector<SerializedOpLogBuffer*> buffs;
+  };
+
+  // Frames pointing into the message memory share it.
+  struct SharedMsgMem {
+    uint8_t *mem;
+    std::atomic<int32_t> ref_count;
+  };
+
+  static void ZmqFreeMsgMem(void *data, void *hint);
+
+  std::vector<Gap> gaps_;
+};
+
+}  // namespace petuum
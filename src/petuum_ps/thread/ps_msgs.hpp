@@ -5,6 +5,8 @@
 
 #include <petuum_ps_common/thread/msg_base.hpp>
 #include <petuum_ps_common/include/configs.hpp>
+#include <petuum_ps_common/include/constants.hpp>
+#include <petuum_ps/thread/row_partitioner.hpp>
 
 namespace petuum {
 
@@ -117,7 +119,8 @@ public:
         + sizeof(size_t)  + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
         + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
         + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t)
-        + sizeof(size_t) + sizeof(int32_t) + sizeof(bool);
+        + sizeof(size_t) + sizeof(int32_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(int32_t);
   }
 
   int32_t &get_table_id() {
@@ -297,6 +300,30 @@ public:
         + sizeof(size_t) + sizeof(int32_t) ));
   }
 
+  int32_t &get_compress_type() {
+    return *(reinterpret_cast<int32_t*>(
+        mem_.get_mem()
+        + NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
+        + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(int32_t) + sizeof(bool) ));
+  }
+
+  int32_t &get_num_row_shards() {
+    return *(reinterpret_cast<int32_t*>(
+        mem_.get_mem()
+        + NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
+        + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(int32_t) + sizeof(bool) + sizeof(int32_t) ));
+  }
+
 protected:
   void InitMsg() {
     NumberedMsg::InitMsg();
@@ -326,7 +353,7 @@ public:
     return NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
         + sizeof(int32_t) + sizeof(size_t)
         + sizeof(bool) + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
-        + sizeof(int32_t) + sizeof(bool);
+        + sizeof(int32_t) + sizeof(bool) + sizeof(int32_t);
   }
 
   int32_t &get_table_id() {
@@ -393,6 +420,14 @@ return *(reinterpret_cast<bool*>(
         + sizeof(size_t) + sizeof(int32_t) ));
   }
 
+  int32_t &get_compress_type() {
+    return *(reinterpret_cast<int32_t*>(
+        mem_.get_mem() + NumberedMsg::get_size()
+        + sizeof(int32_t) + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(bool) + sizeof(int32_t) +sizeof(size_t)
+        + sizeof(size_t) + sizeof(int32_t) + sizeof(bool) ));
+  }
+
 protected:
   void InitMsg() {
     NumberedMsg::InitMsg();
@@ -400,36 +435,43 @@ protected:
   }
 };
 
-struct CreateTableReplyMsg : public NumberedMsg {
+// Data holds the RowPlacements of the table, only set in the reply from the
+// name node to bg threads.
+struct CreateTableReplyMsg : public ArbitrarySizedMsg {
 public:
-  CreateTableReplyMsg() {
-    if (get_size() > PETUUM_MSG_STACK_BUFF_SIZE) {
-      own_mem_ = true;
-      use_stack_buff_ = false;
-      mem_.Alloc(get_size());
-     } else {
-      own_mem_ = false;
-      use_stack_buff_ = true;
-      mem_.Reset(stack_buff_);
-    }
-    InitMsg();
+  explicit CreateTableReplyMsg(size_t avai_size) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + avai_size);
+    InitMsg(avai_size);
   }
 
   explicit CreateTableReplyMsg(void *msg):
-    NumberedMsg(msg) {}
+    ArbitrarySizedMsg(msg) {}
 
-  size_t get_size() {
-    return NumberedMsg::get_size() + sizeof(int32_t);
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t);
   }
 
   int32_t &get_table_id() {
     return *(reinterpret_cast<int32_t*>(mem_.get_mem()
-      + NumberedMsg::get_size()));
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  RowPlacement *get_row_placements() {
+    return reinterpret_cast<RowPlacement*>(mem_.get_mem() + get_header_size());
+  }
+
+  int32_t get_num_row_placements() {
+    return get_avai_size() / sizeof(RowPlacement);
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
   }
 
 protected:
-  void InitMsg(){
-    NumberedMsg::InitMsg();
+  virtual void InitMsg(size_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
     get_msg_type() = kCreateTableReply;
   }
 };
@@ -454,7 +496,7 @@ public:
 
   size_t get_size() {
     return NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
-        + sizeof(int32_t) + sizeof(bool);
+        + sizeof(int32_t) + sizeof(bool) + sizeof(bool) + sizeof(uint64_t);
   }
 
   int32_t &get_table_id() {
@@ -478,10 +520,26 @@ public:
         + sizeof(int32_t) + sizeof(int32_t)));
   }
 
+  // Set by the bg thread: whether a delta reply may be sent, and the
+  // version of the row it caches (kNoRowDeltaVersion if none).
+  bool &get_accept_row_delta() {
+    return *(reinterpret_cast<bool*>(
+        mem_.get_mem() + NumberedMsg::get_size() + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(int32_t) + sizeof(bool)));
+  }
+
+  uint64_t &get_cached_row_version() {
+    return *(reinterpret_cast<uint64_t*>(
+        mem_.get_mem() + NumberedMsg::get_size() + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(int32_t) + sizeof(bool) + sizeof(bool)));
+  }
+
 protected:
   void InitMsg() {
     NumberedMsg::InitMsg();
     get_msg_type() = kRowRequest;
+    get_accept_row_delta() = false;
+    get_cached_row_version() = kNoRowDeltaVersion;
   }
 };
 
@@ -941,6 +999,17 @@ protected:
   }
 };
 
+// Leads the row data of a row request reply. If base_version is
+// kNoRowDeltaVersion, the rest is the serialized row, otherwise it is the
+// sum of the updates of the other clients between base_version and
+// row_version in the sparse oplog format: int32_t number of updates,
+// int32_t column ids, updates.
+struct RowReplyHeader {
+  uint64_t row_version;
+  uint64_t base_version;
+};
+
+// The row data starts with a RowReplyHeader.
 struct ServerRowRequestReplyMsg : public ArbitrarySizedMsg {
 public:
   explicit ServerRowRequestReplyMsg(size_t avai_size) {
@@ -1000,6 +1069,112 @@ protected:
   }
 };
 
+// Replies to a number of row requests from one bg thread. The data is a
+// sequence of rows, each being:
+// 1. int32_t : table id
+// 2. int32_t : row id
+// 3. size_t : row size
+// 4. row data, starting with a RowReplyHeader
+struct ServerBatchRowRequestReplyMsg : public ArbitrarySizedMsg {
+public:
+  explicit ServerBatchRowRequestReplyMsg(size_t avai_size) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + avai_size);
+    InitMsg(avai_size);
+  }
+
+  explicit ServerBatchRowRequestReplyMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
+
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+        + sizeof(uint32_t) + sizeof(int32_t);
+  }
+
+  int32_t &get_clock() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  uint32_t &get_version() {
+    return *(reinterpret_cast<uint32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)));
+  }
+
+  int32_t &get_num_rows() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+      + sizeof(uint32_t)));
+  }
+
+  uint8_t *get_data() {
+    return mem_.get_mem() + get_header_size();
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
+  }
+
+  static size_t get_row_header_size() {
+    return sizeof(int32_t) + sizeof(int32_t) + sizeof(size_t);
+  }
+
+protected:
+  virtual void InitMsg(size_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kServerBatchRowRequestReply;
+  }
+};
+
+// Requests a set of rows of one table; sent by an app thread to a bg worker
+// and by the bg worker to each server with the rows that server owns.
+struct BatchRowRequestMsg : public ArbitrarySizedMsg {
+public:
+  explicit BatchRowRequestMsg(size_t avai_size) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + avai_size);
+    InitMsg(avai_size);
+  }
+
+  explicit BatchRowRequestMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
+
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(int32_t);
+  }
+
+  int32_t &get_table_id() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  int32_t &get_clock() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)));
+  }
+
+  int32_t &get_num_rows() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+      + sizeof(int32_t)));
+  }
+
+  int32_t *get_row_ids() {
+    return reinterpret_cast<int32_t*>(mem_.get_mem() + get_header_size());
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
+  }
+
+protected:
+  virtual void InitMsg(size_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kBatchRowRequest;
+  }
+};
+
 struct ClientSendOpLogMsg : public ArbitrarySizedMsg {
 public:
   explicit ClientSendOpLogMsg(size_t avai_size) {
@@ -1013,7 +1188,8 @@ public:
 
   size_t get_header_size() {
     return ArbitrarySizedMsg::get_header_size() + sizeof(bool)
-        + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t);
+        + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t)
+        + sizeof(bool);
   }
 
   bool &get_is_clock() {
@@ -1038,6 +1214,13 @@ public:
       + sizeof(int32_t) + sizeof(uint32_t)));
   }
 
+  // data is encoded by MsgCompressor
+  bool &get_is_compressed() {
+    return *(reinterpret_cast<bool*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(bool)
+      + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t)));
+  }
+
   // data is to be accessed via SerializedOpLogAccessor
   void *get_data() {
     return mem_.get_mem() + get_header_size();
@@ -1051,6 +1234,7 @@ protected:
   virtual void InitMsg(size_t avai_size) {
     ArbitrarySizedMsg::InitMsg(avai_size);
     get_msg_type() = kClientSendOpLog;
+    get_is_compressed() = false;
   }
 };
 
@@ -1067,7 +1251,7 @@ public:
 
   size_t get_header_size() {
     return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
-        + sizeof(uint32_t) + sizeof(bool);
+        + sizeof(uint32_t) + sizeof(bool) + sizeof(bool);
   }
 
   int32_t &get_clock() {
@@ -1086,6 +1270,13 @@ public:
       + sizeof(uint32_t) ));
   }
 
+  // data is encoded by MsgCompressor
+  bool &get_is_compressed() {
+    return *(reinterpret_cast<bool*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+      + sizeof(uint32_t) + sizeof(bool) ));
+  }
+
   // data is to be accessed via SerializedRowReader
   void *get_data() {
     return mem_.get_mem() + get_header_size();
@@ -1099,6 +1290,7 @@ protected:
   virtual void InitMsg(size_t avai_size) {
     ArbitrarySizedMsg::InitMsg(avai_size);
     get_msg_type() = kServerPushRow;
+    get_is_compressed() = false;
   }
 };
 
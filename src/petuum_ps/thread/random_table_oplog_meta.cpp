@@ -36,7 +36,7 @@ int32_t RandomTableOpLogMeta::GetAndClearNextInOrder() {
 
   int32_t row_id = meta_iter_->first;
 
-  oplog_meta_.erase(meta_iter_);
+  EraseOpLogMeta(meta_iter_);
   return row_id;
 }
 
@@ -57,7 +57,7 @@ int32_t RandomTableOpLogMeta::GetAndClearNextUptoClock() {
   if (meta_iter_ == oplog_meta_.end()) return -1;
 
   int32_t row_id = meta_iter_->first;
-  meta_iter_ = oplog_meta_.erase(meta_iter_);
+  meta_iter_ = EraseOpLogMeta(meta_iter_);
 
   return row_id;
 }
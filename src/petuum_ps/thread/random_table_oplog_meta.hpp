@@ -26,6 +26,12 @@ public:
   virtual size_t GetNumRowOpLogs() const;
 
 protected:
+  // All oplog metas are erased through here.
+  virtual std::unordered_map<int32_t, RowOpLogMeta>::iterator EraseOpLogMeta(
+      std::unordered_map<int32_t, RowOpLogMeta>::iterator iter) {
+    return oplog_meta_.erase(iter);
+  }
+
   const AbstractRow *sample_row_;
   std::unordered_map<int32_t, RowOpLogMeta> oplog_meta_;
 
@@ -0,0 +1,38 @@
+#include <petuum_ps/thread/row_oplog_serializer.hpp>
+#include <mutex>
+#include <queue>
+
+namespace petuum {
+
+namespace {
+
+std::mutex pool_mtx;
+std::queue<SerializedOpLogBuffer*> buffer_pool;
+
+}  // anonymous namespace
+
+SerializedOpLogBuffer *SerializedOpLogBufferPool::Get(bool dense_serialize) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mtx);
+    if (!buffer_pool.empty()) {
+      SerializedOpLogBuffer *buffer = buffer_pool.front();
+      buffer_pool.pop();
+      buffer->Reset(dense_serialize);
+      return buffer;
+    }
+  }
+  return new SerializedOpLogBuffer(dense_serialize);
+}
+
+void SerializedOpLogBufferPool::Put(SerializedOpLogBuffer *buffer) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mtx);
+    if (buffer_pool.size() < kMaxNumFreeBuffers) {
+      buffer_pool.push(buffer);
+      return;
+    }
+  }
+  delete buffer;
+}
+
+}  // namespace petuum
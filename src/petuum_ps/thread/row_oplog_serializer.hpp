@@ -2,8 +2,11 @@
 
 #include <memory>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <boost/noncopyable.hpp>
 #include <petuum_ps/thread/context.hpp>
+#include <petuum_ps/thread/oplog_msg_gather.hpp>
 #include <petuum_ps_common/include/constants.hpp>
 #include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
 #include <glog/logging.h>
@@ -24,9 +27,14 @@ public:
   }
 
   SerializedOpLogBuffer(bool dense_serialize):
-      size_(0),
-      mem_(new uint8_t[capacity_]),
-      num_row_oplogs_(0) {
+      mem_(new uint8_t[capacity_]) {
+    Reset(dense_serialize);
+  }
+
+  // Empty the buffer for reuse.
+  void Reset(bool dense_serialize) {
+    size_ = 0;
+    num_row_oplogs_ = 0;
     if (dense_serialize) {
       SerializeOpLog_ = &AbstractRowOpLog::SerializeDense;
       GetSerializedRowOpLogSize_ = GetDenseSerializedRowOpLogSize;
@@ -59,7 +67,7 @@ public:
     return size_;
   }
 
-  const uint8_t *get_mem() const {
+  uint8_t *get_mem() const {
     return mem_;
   }
 
@@ -76,10 +84,30 @@ private:
   size_t num_row_oplogs_;
 };
 
+// Buffers are handed to zmq by OpLogMsgGather and come back from zmq's io
+// thread (or the receiving server thread for inproc) once sent, so the pool
+// is shared by all bg threads.
+class SerializedOpLogBufferPool : boost::noncopyable {
+public:
+  static SerializedOpLogBuffer *Get(bool dense_serialize);
+
+  static void Put(SerializedOpLogBuffer *buffer);
+
+  // zmq::free_fn for frames pointing into a buffer passed as hint.
+  static void ZmqFree(void *data, void *hint) {
+    Put(reinterpret_cast<SerializedOpLogBuffer*>(hint));
+  }
+
+private:
+  // 64MB of free buffers at most.
+  static const size_t kMaxNumFreeBuffers = 16;
+};
+
 class RowOpLogSerializer : boost::noncopyable {
 public:
-  RowOpLogSerializer(bool dense_serialize,
+  RowOpLogSerializer(int32_t table_id, bool dense_serialize,
                      int32_t my_comm_channel_idx):
+      table_id_(table_id),
       dense_serialize_(dense_serialize),
       my_comm_channel_idx_(my_comm_channel_idx),
       total_accum_size_(0),
@@ -99,7 +127,7 @@ public:
 
   size_t AppendRowOpLog(int32_t row_id, AbstractRowOpLog *row_oplog) {
     int32_t server_id = GlobalContext::GetPartitionServerID(
-        row_id, my_comm_channel_idx_);
+        table_id_, row_id, my_comm_channel_idx_);
 
     auto map_iter = buffer_map_.find(server_id);
 
@@ -107,13 +135,15 @@ public:
       buffer_map_.insert(std::make_pair(
           server_id, std::vector<SerializedOpLogBuffer*>(1) ) );
       map_iter = buffer_map_.find(server_id);
-      (map_iter->second)[0] = new SerializedOpLogBuffer(dense_serialize_);
+      (map_iter->second)[0]
+          = SerializedOpLogBufferPool::Get(dense_serialize_);
     }
 
     SerializedOpLogBuffer *buffer = map_iter->second.back();
     size_t serialized_size = buffer->AppendRowOpLog(row_id, row_oplog);
     if (serialized_size == 0) {
-      SerializedOpLogBuffer *new_buffer = new SerializedOpLogBuffer(dense_serialize_);
+      SerializedOpLogBuffer *new_buffer
+          = SerializedOpLogBufferPool::Get(dense_serialize_);
       serialized_size = new_buffer->AppendRowOpLog(row_id, row_oplog);
       CHECK_GT(serialized_size, 0) << "row id = " << row_id;
       map_iter->second.push_back(new_buffer);
@@ -136,8 +166,11 @@ public:
     }
   }
 
-  void SerializeByServer(std::map<int32_t, void* > *bytes_by_server) {
-
+  // Write the number of rows for each server and hand the buffers holding
+  // the rows to the server's OpLogMsgGather, which sends them without
+  // copying them into the oplog message.
+  void SerializeByServer(std::map<int32_t, void* > *bytes_by_server,
+                         std::map<int32_t, OpLogMsgGather> *gather_by_server) {
     for (auto &server_bytes : (*bytes_by_server)) {
       int32_t server_id = server_bytes.first;
       uint8_t *mem = reinterpret_cast<uint8_t*>(server_bytes.second);
@@ -150,22 +183,20 @@ public:
 
       std::vector<SerializedOpLogBuffer*> &buff_vec = server_buff_iter->second;
 
-      size_t mem_offset = sizeof(int32_t);
-
       for (auto &buff : buff_vec) {
-        memcpy(mem + mem_offset, buff->get_mem(), buff->get_size());
         num_rows += buff->get_num_row_oplogs();
-        mem_offset += buff->get_size();
 
         total_accum_size_ -= buff->get_size();
         total_accum_num_rows_ -= buff->get_num_row_oplogs();
-        delete buff;
       }
+      (*gather_by_server)[server_id].AddBuffers(mem + sizeof(int32_t),
+                                               &buff_vec);
       buffer_map_.erase(server_id);
     }
   }
 
 private:
+  const int32_t table_id_;
   const bool dense_serialize_;
   const int32_t my_comm_channel_idx_;
   std::unordered_map<int32_t, std::vector<SerializedOpLogBuffer*> >
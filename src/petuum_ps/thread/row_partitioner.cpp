@@ -0,0 +1,105 @@
+#include <petuum_ps/thread/row_partitioner.hpp>
+#include <glog/logging.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace petuum {
+
+RowPartitioner::RowPartitioner():
+    GetPartition_(&RowPartitioner::GetPartitionModulo),
+    num_partitions_(1) { }
+
+void RowPartitioner::Init(RowPartitionerType type,
+                          int32_t num_comm_channels_per_client,
+                          int32_t num_clients, int32_t num_virtual_nodes) {
+  num_partitions_ = num_comm_channels_per_client * num_clients;
+  ring_.clear();
+  placements_.clear();
+
+  switch (type) {
+    case kModuloPartitioner:
+      GetPartition_ = &RowPartitioner::GetPartitionModulo;
+      break;
+    case kTableHashPartitioner:
+      GetPartition_ = &RowPartitioner::GetPartitionTableHash;
+      break;
+    case kConsistentHashPartitioner:
+      {
+        CHECK_GT(num_virtual_nodes, 0);
+        GetPartition_ = &RowPartitioner::GetPartitionConsistentHash;
+        ring_.reserve(num_partitions_ * num_virtual_nodes);
+        for (int32_t p = 0; p < num_partitions_; ++p) {
+          for (int32_t v = 0; v < num_virtual_nodes; ++v) {
+            ring_.push_back(std::make_pair(Hash(GetKey(p, v) + 1), p));
+          }
+        }
+        std::sort(ring_.begin(), ring_.end());
+      }
+      break;
+    default:
+      LOG(FATAL) << "Unknown row partitioner type " << type;
+  }
+}
+
+void RowPartitioner::AddPlacements(const RowPlacement *placements,
+                                   int32_t num_placements) {
+  for (int32_t i = 0; i < num_placements; ++i) {
+    CHECK(placements[i].partition >= 0
+          && placements[i].partition < num_partitions_)
+        << "table " << placements[i].table_id
+        << " row " << placements[i].row_id
+        << " partition " << placements[i].partition;
+    placements_[GetKey(placements[i].table_id, placements[i].row_id)]
+        = placements[i].partition;
+  }
+}
+
+int32_t RowPartitioner::GetPartitionModulo(int32_t table_id,
+                                           int32_t row_id) const {
+  return row_id % num_partitions_;
+}
+
+int32_t RowPartitioner::GetPartitionTableHash(int32_t table_id,
+                                              int32_t row_id) const {
+  return Hash(GetKey(table_id, row_id)) % num_partitions_;
+}
+
+int32_t RowPartitioner::GetPartitionConsistentHash(int32_t table_id,
+                                                   int32_t row_id) const {
+  uint64_t hash = Hash(GetKey(table_id, row_id));
+  auto iter = std::upper_bound(
+      ring_.begin(), ring_.end(),
+      std::make_pair(hash, num_partitions_));
+  if (iter == ring_.end())
+    iter = ring_.begin();
+  return iter->second;
+}
+
+void RowPartitioner::ReadPlacements(const std::string &filename,
+                                    int32_t num_comm_channels_per_client,
+                                    int32_t num_clients,
+                                    std::vector<RowPlacement> *placements) {
+  std::ifstream input(filename.c_str());
+  CHECK(input) << "Cannot open row placement file " << filename;
+
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream line_stream(line);
+    RowPlacement placement;
+    int32_t client_id, comm_channel_idx;
+    CHECK(line_stream >> placement.table_id >> placement.row_id
+          >> client_id >> comm_channel_idx)
+        << "Bad line in " << filename << ": " << line;
+    CHECK(client_id >= 0 && client_id < num_clients) << line;
+    CHECK(comm_channel_idx >= 0
+          && comm_channel_idx < num_comm_channels_per_client) << line;
+    placement.partition = client_id * num_comm_channels_per_client
+                          + comm_channel_idx;
+    placements->push_back(placement);
+  }
+}
+
+}  // namespace petuum
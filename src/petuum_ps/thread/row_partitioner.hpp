@@ -0,0 +1,93 @@
+// author: jinliang
+#pragma once
+
+#include <petuum_ps_common/include/configs.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+struct RowPlacement {
+  int32_t table_id;
+  int32_t row_id;
+  int32_t partition;
+};
+
+// Maps rows to partitions, one per server thread. Partition p is the
+// server thread of comm channel p % num_comm_channels_per_client on client
+// p / num_comm_channels_per_client; the row's oplogs and requests go
+// through the bg thread of the same comm channel.
+//
+// All clients must map rows the same way. The partitioner type comes from
+// global config and explicit placements from the name node.
+class RowPartitioner : boost::noncopyable {
+public:
+  RowPartitioner();
+
+  void Init(RowPartitionerType type, int32_t num_comm_channels_per_client,
+            int32_t num_clients, int32_t num_virtual_nodes);
+
+  // Not thread-safe. Called when tables are created, before the table is
+  // accessed.
+  void AddPlacements(const RowPlacement *placements, int32_t num_placements);
+
+  int32_t GetPartition(int32_t table_id, int32_t row_id) const {
+    if (!placements_.empty()) {
+      auto iter = placements_.find(GetKey(table_id, row_id));
+      if (iter != placements_.end())
+        return iter->second;
+    }
+    return (this->*GetPartition_)(table_id, row_id);
+  }
+
+  int32_t get_num_partitions() const {
+    return num_partitions_;
+  }
+
+  // Each line is "table_id row_id client_id comm_channel_idx".
+  static void ReadPlacements(const std::string &filename,
+                             int32_t num_comm_channels_per_client,
+                             int32_t num_clients,
+                             std::vector<RowPlacement> *placements);
+
+private:
+  typedef int32_t (RowPartitioner::*GetPartitionFunc)(
+      int32_t table_id, int32_t row_id) const;
+
+  static uint64_t GetKey(int32_t table_id, int32_t row_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(table_id)) << 32)
+        | static_cast<uint32_t>(row_id);
+  }
+
+  // 64-bit finalizer of MurmurHash3.
+  static uint64_t Hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  // Same as the fixed mapping used before partitioners: comm channel
+  // row_id % C, client (row_id / C) % N.
+  int32_t GetPartitionModulo(int32_t table_id, int32_t row_id) const;
+
+  int32_t GetPartitionTableHash(int32_t table_id, int32_t row_id) const;
+
+  int32_t GetPartitionConsistentHash(int32_t table_id, int32_t row_id) const;
+
+  GetPartitionFunc GetPartition_;
+  int32_t num_partitions_;
+
+  // (hash, partition) of virtual nodes sorted by hash
+  std::vector<std::pair<uint64_t, int32_t> > ring_;
+
+  boost::unordered_map<uint64_t, int32_t> placements_;
+};
+
+}  // namespace petuum
@@ -282,7 +282,8 @@ BgOpLogPartition* SSPAggrBgWorker::PrepareOpLogsNormal(
       = table->get_sample_row()->get_update_size();
 
   BgOpLogPartition *bg_table_oplog = new BgOpLogPartition(
-      table_id, table_update_size, my_comm_channel_idx_);
+      table_id, table_update_size, my_comm_channel_idx_,
+      table->get_oplog().get_row_oplog_pool());
 
   AbstractTableOpLogMeta *table_oplog_meta = oplog_meta_.Get(table_id);
 
@@ -423,6 +424,7 @@ long SSPAggrBgWorker::HandleClockMsg(bool clock_advanced) {
 
   size_t sent_size = SendOpLogMsgs(true);
   TrackBgOpLog(bg_oplog);
+  RefillRowOpLogPools();
 
   //LOG(INFO) << "sent size = " << sent_size
   //        << " " << ThreadContext::get_id();
@@ -528,7 +530,8 @@ BgOpLogPartition* SSPAggrBgWorker::PrepareBgIdleOpLogsNormal(int32_t table_id,
     size_t table_update_size
         = table->get_sample_row()->get_update_size();
     BgOpLogPartition *bg_table_oplog = new BgOpLogPartition(
-        table_id, table_update_size, my_comm_channel_idx_);
+        table_id, table_update_size, my_comm_channel_idx_,
+        table->get_oplog().get_row_oplog_pool());
 
     AbstractTableOpLogMeta *table_oplog_meta = oplog_meta_.Get(table_id);
 
@@ -103,7 +103,8 @@ BgOpLogPartition *SSPBgWorker::PrepareOpLogsNormal(
   size_t table_update_size
       = table->get_sample_row()->get_update_size();
   BgOpLogPartition *bg_table_oplog = new BgOpLogPartition(
-        table_id, table_update_size, my_comm_channel_idx_);
+        table_id, table_update_size, my_comm_channel_idx_,
+        table_oplog.get_row_oplog_pool());
 
   for (const auto &server_id : server_ids_) {
     // Reset size to 0
@@ -175,7 +176,7 @@ void SSPBgWorker::PrepareOpLogsNormalNoReplay(
 
   if (serializer_iter == row_oplog_serializer_map_.end()) {
     RowOpLogSerializer *row_oplog_serializer
-        = new RowOpLogSerializer(table->oplog_dense_serialized(),
+        = new RowOpLogSerializer(table_id, table->oplog_dense_serialized(),
                                  my_comm_channel_idx_);
     row_oplog_serializer_map_.insert(std::make_pair(table_id, row_oplog_serializer));
     serializer_iter = row_oplog_serializer_map_.find(table_id);
@@ -218,7 +219,7 @@ void SSPBgWorker::PrepareOpLogsAppendOnlyNoReplay(
   auto serializer_iter = row_oplog_serializer_map_.find(table_id);
   if (serializer_iter == row_oplog_serializer_map_.end()) {
     RowOpLogSerializer *row_oplog_serializer
-        = new RowOpLogSerializer(table->oplog_dense_serialized(),
+        = new RowOpLogSerializer(table_id, table->oplog_dense_serialized(),
                                  my_comm_channel_idx_);
     row_oplog_serializer_map_.insert(std::make_pair(table_id, row_oplog_serializer));
     serializer_iter = row_oplog_serializer_map_.find(table_id);
@@ -16,8 +16,11 @@ void SSPPushBgWorker::HandleServerPushRow(int32_t sender_id, ServerPushRowMsg &s
   bool is_clock = server_push_row_msg.get_is_clock();
 
   // Need to apply the new rows before waking up the app threads
-  ApplyServerPushedRow(version, server_push_row_msg.get_data(),
-                       server_push_row_msg.get_avai_size());
+  std::vector<uint8_t> decompress_buff;
+  size_t rows_size;
+  void *rows = MsgCompressor::DecompressPushRowMsg(
+      server_push_row_msg, &decompress_buff, &rows_size);
+  ApplyServerPushedRow(version, rows, rows_size);
 
   STATS_BG_ADD_PER_CLOCK_SERVER_PUSH_ROW_SIZE(
       server_push_row_msg.get_size());
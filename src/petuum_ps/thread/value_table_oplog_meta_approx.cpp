@@ -15,11 +15,21 @@ void ValueTableOpLogMetaApprox::InsertMergeRowOpLogMeta(
   auto iter = oplog_meta_.find(row_id);
   if (iter == oplog_meta_.end()) {
     oplog_meta_.insert(std::make_pair(row_id, row_oplog_meta));
+    importance_histogram_.Update(0, row_oplog_meta.get_importance());
     ++num_new_oplog_metas_;
     return;
   }
+  double importance = iter->second.get_importance();
   iter->second.set_clock(row_oplog_meta.get_clock());
   iter->second.accum_importance(row_oplog_meta.get_importance());
+  importance_histogram_.Update(importance, iter->second.get_importance());
+}
+
+std::unordered_map<int32_t, RowOpLogMeta>::iterator
+ValueTableOpLogMetaApprox::EraseOpLogMeta(
+    std::unordered_map<int32_t, RowOpLogMeta>::iterator iter) {
+  importance_histogram_.Update(iter->second.get_importance(), 0);
+  return oplog_meta_.erase(iter);
 }
 
 void ValueTableOpLogMetaApprox::Prepare(size_t num_rows_to_send) {
@@ -34,31 +44,42 @@ void ValueTableOpLogMetaApprox::Prepare(size_t num_rows_to_send) {
 
   size_t num_candidate_rows
       = num_rows_to_send*row_candidate_factor;
-  if (num_candidate_rows > oplog_meta_size)
-    num_candidate_rows = oplog_meta_size;
+  // Rows less important than the threshold cannot be among the
+  // num_rows_to_send most important ones.
+  size_t num_rows_above_threshold = 0;
+  double importance_threshold = importance_histogram_.GetThreshold(
+      num_rows_to_send, &num_rows_above_threshold);
+  if (importance_threshold == 0)
+    num_rows_above_threshold = oplog_meta_size;
+
+  if (num_candidate_rows > num_rows_above_threshold)
+    num_candidate_rows = num_rows_above_threshold;
 
   sorted_vec_.resize(0);
 
-  double select_prob = double(num_candidate_rows) / double(oplog_meta_size);
+  double select_prob = double(num_candidate_rows)
+                       / double(num_rows_above_threshold);
 
   for (const auto &meta_pair : oplog_meta_) {
+    if (meta_pair.second.get_importance() < importance_threshold)
+      continue;
     double prob = uniform_dist_(generator_);
     if (prob <= select_prob)
       sorted_vec_.push_back(meta_pair);
     if (sorted_vec_.size() == num_candidate_rows) break;
   }
 
-  std::sort(sorted_vec_.begin(), sorted_vec_.end(),
-            [] (const std::pair<int32_t, RowOpLogMeta> &oplog1,
-                const std::pair<int32_t, RowOpLogMeta> &oplog2) {
-              if (oplog1.second.get_importance()
-                  == oplog2.second.get_importance()) {
-                return oplog1.first < oplog2.first;
-              } else {
-                return (oplog1.second.get_importance()
-                        > oplog2.second.get_importance());
-              }
-            });
+  SelectTopK(&sorted_vec_, num_rows_to_send,
+             [] (const std::pair<int32_t, RowOpLogMeta> &oplog1,
+                 const std::pair<int32_t, RowOpLogMeta> &oplog2) {
+               if (oplog1.second.get_importance()
+                   == oplog2.second.get_importance()) {
+                 return oplog1.first < oplog2.first;
+               } else {
+                 return (oplog1.second.get_importance()
+                         > oplog2.second.get_importance());
+               }
+             });
   vec_iter_ = sorted_vec_.begin();
 }
 
@@ -75,7 +96,7 @@ int32_t ValueTableOpLogMetaApprox::GetAndClearNextInOrder() {
     vec_iter_++;
   } while (map_iter == oplog_meta_.end());
 
-  oplog_meta_.erase(map_iter);
+  EraseOpLogMeta(map_iter);
   return row_id;
 }
 }
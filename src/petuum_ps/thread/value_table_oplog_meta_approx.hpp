@@ -1,6 +1,7 @@
 #pragma once
 
 #include <petuum_ps/thread/random_table_oplog_meta.hpp>
+#include <petuum_ps_common/util/top_k.hpp>
 
 #include <vector>
 #include <unordered_map>
@@ -18,7 +19,13 @@ public:
   virtual void Prepare(size_t num_rows_to_send);
   virtual int32_t GetAndClearNextInOrder();
 
+protected:
+  virtual std::unordered_map<int32_t, RowOpLogMeta>::iterator EraseOpLogMeta(
+      std::unordered_map<int32_t, RowOpLogMeta>::iterator iter);
+
 private:
+  ImportanceHistogram importance_histogram_;
+  // Only the first num_rows_to_send are in order.
   std::vector<std::pair<int32_t, RowOpLogMeta> > sorted_vec_;
   std::vector<std::pair<int32_t, RowOpLogMeta> >::iterator vec_iter_;
 
@@ -33,6 +33,13 @@ public:
   virtual void FlushThreadCache() = 0;
 
   virtual ClientRow *Get(int32_t row_id, RowAccessor *row_accessor) = 0;
+  // row_accessors points to num_rows accessors.
+  virtual void GetBatch(const int32_t *row_ids, int32_t num_rows,
+                        RowAccessor *row_accessors) {
+    for (int32_t i = 0; i < num_rows; ++i) {
+      Get(row_ids[i], &row_accessors[i]);
+    }
+  }
   virtual void Inc(int32_t row_id, int32_t column_id, const void *update) = 0;
   virtual void BatchInc(int32_t row_id, const int32_t* column_ids,
                         const void* updates,
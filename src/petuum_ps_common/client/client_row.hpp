@@ -3,6 +3,7 @@
 // author: jinliang
 
 #include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps_common/include/constants.hpp>
 
 #include <cstdint>
 #include <atomic>
@@ -28,7 +29,8 @@ public:
   ClientRow(int32_t clock __attribute__((unused)), AbstractRow* row_data,
             bool use_ref_count):
       num_refs_(0),
-      row_data_ptr_(row_data)
+      row_data_ptr_(row_data),
+      row_delta_version_(kNoRowDeltaVersion)
   {
     if (use_ref_count) {
       IncRef_ = &ClientRow::DoIncRef;
@@ -68,6 +70,16 @@ public:
 
   int32_t get_num_refs() const { return num_refs_; }
 
+  // Server version of the row data, kNoRowDeltaVersion if unknown. Accessed
+  // by the bg thread only.
+  uint64_t get_row_delta_version() const {
+    return row_delta_version_;
+  }
+
+  void set_row_delta_version(uint64_t row_delta_version) {
+    row_delta_version_ = row_delta_version;
+  }
+
 private:  // private members
 
   void DoIncRef() { ++num_refs_; }
@@ -84,6 +96,8 @@ private:  // private members
 
   IncDecRefFunc IncRef_;
   IncDecRefFunc DecRef_;
+
+  uint64_t row_delta_version_;
 };
 
 }  // namespace petuum
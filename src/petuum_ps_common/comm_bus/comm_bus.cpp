@@ -1,6 +1,7 @@
 // author: jinliang
 
 #include <stdlib.h>
+#include <string.h>
 #include <glog/logging.h>
 #include <sstream>
 #include <string>
@@ -35,10 +36,19 @@ bool CommBus::IsLocalEntity(int32_t entity_id) {
 
 
 CommBus::CommBus(int32_t e_st, int32_t e_end, int32_t num_clients,
-                 int32_t num_zmq_thrs) {
+                 int32_t num_zmq_thrs, bool inproc_ring,
+                 int32_t inproc_ring_spin):
+    inproc_ring_(inproc_ring),
+    inproc_ring_spin_(inproc_ring_spin) {
   e_st_ = e_st;
   e_end_ = e_end;
 
+  if (inproc_ring_) {
+    inproc_rings_.reset(new std::atomic<InProcRing*>[e_end_ - e_st_ + 1]);
+    for (int32_t i = 0; i <= e_end_ - e_st_; ++i)
+      inproc_rings_[i].store(0, std::memory_order_relaxed);
+  }
+
   try {
     zmq_ctx_ = new zmq::context_t(num_zmq_thrs);
   } catch(zmq::error_t &e) {
@@ -61,9 +71,122 @@ CommBus::CommBus(int32_t e_st, int32_t e_end, int32_t num_clients,
 }
 
 CommBus::~CommBus() {
+  if (inproc_ring_) {
+    for (int32_t i = 0; i <= e_end_ - e_st_; ++i)
+      delete inproc_rings_[i].load(std::memory_order_relaxed);
+  }
   delete zmq_ctx_;
 }
 
+InProcRing *CommBus::GetCreateInProcRing(int32_t entity_id) {
+  CHECK(IsLocalEntity(entity_id)) << "Not local entity " << entity_id;
+  std::atomic<InProcRing*> &ring_ptr = inproc_rings_[entity_id - e_st_];
+  InProcRing *ring = ring_ptr.load(std::memory_order_acquire);
+  if (ring != 0)
+    return ring;
+
+  // Whoever comes first, the receiver or a sender.
+  InProcRing *new_ring = new InProcRing(kInProcRingCapacity);
+  if (ring_ptr.compare_exchange_strong(ring, new_ring,
+                                       std::memory_order_acq_rel))
+    return new_ring;
+  delete new_ring;
+  return ring;
+}
+
+InProcRing *CommBus::GetMyInProcRing() {
+  if (thr_info_->inproc_ring_ == 0)
+    thr_info_->inproc_ring_ = GetCreateInProcRing(thr_info_->entity_id_);
+  return thr_info_->inproc_ring_;
+}
+
+ZMQFrames *CommBus::GetMoreFramesSink() {
+  return thr_info_->keep_more_frames_ ? &(thr_info_->more_frames_) : 0;
+}
+
+size_t CommBus::SendInProcRing(int32_t entity_id, zmq::message_t *msg) {
+  size_t nbytes = msg->size();
+  GetCreateInProcRing(entity_id)->Push(thr_info_->entity_id_, msg);
+  return nbytes;
+}
+
+size_t CommBus::SendInProcRing(int32_t entity_id, const void *data,
+                               size_t len) {
+  GetCreateInProcRing(entity_id)->Push(thr_info_->entity_id_, data, len);
+  return len;
+}
+
+bool CommBus::RecvInProcRing(int32_t *entity_id, zmq::message_t *msg,
+                             long timeout_milli) {
+  // Ring messages are never multipart.
+  if (thr_info_->keep_more_frames_)
+    thr_info_->more_frames_.Clear();
+  int32_t spin = (timeout_milli == 0) ? 0 : inproc_ring_spin_;
+  return GetMyInProcRing()->Pop(entity_id, msg, spin, timeout_milli);
+}
+
+bool CommBus::TryRecvInProcRingOrInterProc(int32_t *entity_id,
+                                           zmq::message_t *msg) {
+  zmq::socket_t *sock = thr_info_->interproc_sock_.get();
+  // Alternate so that neither starves the other.
+  bool interproc_first = thr_info_->interproc_first_ && sock != NULL;
+  thr_info_->interproc_first_ = !thr_info_->interproc_first_;
+  int32_t sender_id;
+  if (interproc_first
+      && ZMQUtil::ZMQRecvAsync(sock, &sender_id, msg, GetMoreFramesSink())) {
+    *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
+    return true;
+  }
+  if (RecvInProcRing(entity_id, msg, 0))
+    return true;
+  if (!interproc_first && sock != NULL
+      && ZMQUtil::ZMQRecvAsync(sock, &sender_id, msg, GetMoreFramesSink())) {
+    *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
+    return true;
+  }
+  return false;
+}
+
+bool CommBus::RecvInProcRingOrInterProc(int32_t *entity_id,
+                                        zmq::message_t *msg,
+                                        long timeout_milli) {
+  zmq::socket_t *sock = thr_info_->interproc_sock_.get();
+  if (sock == NULL)
+    return RecvInProcRing(entity_id, msg, timeout_milli);
+
+  if (TryRecvInProcRingOrInterProc(entity_id, msg))
+    return true;
+  if (timeout_milli == 0)
+    return false;
+  for (int32_t i = 0; i < inproc_ring_spin_; ++i) {
+    if (RecvInProcRing(entity_id, msg, 0))
+      return true;
+  }
+
+  InProcRing *ring = GetMyInProcRing();
+  zmq::pollitem_t pollitems[2];
+  pollitems[0].socket = NULL;
+  pollitems[0].fd = ring->get_event_fd();
+  pollitems[0].events = ZMQ_POLLIN;
+  pollitems[1].socket = *sock;
+  pollitems[1].fd = 0;
+  pollitems[1].events = ZMQ_POLLIN;
+
+  while (true) {
+    ring->PrepareWait();
+    if (TryRecvInProcRingOrInterProc(entity_id, msg)) {
+      ring->FinishWait();
+      return true;
+    }
+    int num_ready = zmq::poll(pollitems, 2, timeout_milli);
+    ring->FinishWait();
+    if (TryRecvInProcRingOrInterProc(entity_id, msg))
+      return true;
+    if (num_ready == 0 && timeout_milli > 0)
+      return false;
+  }
+}
+
 void CommBus::SetUpRouterSocket(zmq::socket_t *sock, int32_t id,
   int num_bytes_send_buff, int num_bytes_recv_buff) {
   int32_t my_id = ZMQUtil::EntityID2ZmqID(id);
@@ -93,6 +216,7 @@ void CommBus::ThreadRegister(const Config &config) {
   thr_info_.reset(new ThreadCommInfo());
   thr_info_->entity_id_ = config.entity_id_;
   thr_info_->ltype_ = config.ltype_;
+  thr_info_->keep_more_frames_ = config.keep_more_frames_;
 
   thr_info_->num_bytes_inproc_send_buff_ = config.num_bytes_inproc_send_buff_;
   thr_info_->num_bytes_inproc_recv_buff_ = config.num_bytes_inproc_recv_buff_;
@@ -102,7 +226,9 @@ void CommBus::ThreadRegister(const Config &config) {
   thr_info_->num_bytes_interproc_recv_buff_ =
     config.num_bytes_interproc_recv_buff_;
 
-  if (config.ltype_ & kInProc) {
+  if ((config.ltype_ & kInProc) && inproc_ring_) {
+    thr_info_->inproc_ring_ = GetCreateInProcRing(config.entity_id_);
+  } else if (config.ltype_ & kInProc) {
     try {
       thr_info_->inproc_sock_.reset(new zmq::socket_t(*zmq_ctx_, ZMQ_ROUTER));
     } catch(...) {
@@ -149,6 +275,13 @@ void CommBus::ThreadDeregister() {
 void CommBus::ConnectTo(int32_t entity_id, void *connect_msg, size_t size) {
   CHECK(IsLocalEntity(entity_id)) << "Not local entity " << entity_id;
 
+  if (inproc_ring_) {
+    // Replies come to my ring.
+    GetMyInProcRing();
+    SendInProcRing(entity_id, connect_msg, size);
+    return;
+  }
+
   zmq::socket_t *sock = thr_info_->inproc_sock_.get();
   if (sock == NULL) {
     try {
@@ -197,6 +330,8 @@ size_t CommBus::Send(int32_t entity_id, const void *data, size_t len) {
   zmq::socket_t *sock;
 
   if (IsLocalEntity(entity_id)) {
+    if (inproc_ring_)
+      return SendInProcRing(entity_id, data, len);
     sock = thr_info_->inproc_sock_.get();
   } else {
     sock = thr_info_->interproc_sock_.get();
@@ -209,6 +344,9 @@ size_t CommBus::Send(int32_t entity_id, const void *data, size_t len) {
 }
 
 size_t CommBus::SendInProc(int32_t entity_id, const void *data, size_t len) {
+  if (inproc_ring_)
+    return SendInProcRing(entity_id, data, len);
+
   zmq::socket_t *sock = thr_info_->inproc_sock_.get();
 
   int32_t recv_id = ZMQUtil::EntityID2ZmqID(entity_id);
@@ -230,6 +368,8 @@ size_t CommBus::Send(int32_t entity_id, zmq::message_t &msg) {
   zmq::socket_t *sock;
 
   if (IsLocalEntity(entity_id)) {
+    if (inproc_ring_)
+      return SendInProc(entity_id, msg);
     sock = thr_info_->inproc_sock_.get();
   } else {
     sock = thr_info_->interproc_sock_.get();
@@ -242,6 +382,9 @@ size_t CommBus::Send(int32_t entity_id, zmq::message_t &msg) {
 }
 
 size_t CommBus::SendInProc(int32_t entity_id, zmq::message_t &msg) {
+  if (inproc_ring_)
+    return SendInProcRing(entity_id, &msg);
+
   zmq::socket_t *sock = thr_info_->inproc_sock_.get();
 
   int32_t recv_id = ZMQUtil::EntityID2ZmqID(entity_id);
@@ -250,8 +393,44 @@ size_t CommBus::SendInProc(int32_t entity_id, zmq::message_t &msg) {
   return nbytes;
 }
 
+size_t CommBus::SendMultiPart(int32_t entity_id, zmq::message_t *frames,
+                              int32_t num_frames) {
+  zmq::socket_t *sock;
+
+  if (IsLocalEntity(entity_id)) {
+    if (inproc_ring_) {
+      // Ring messages are single frames, so the receiver gets the
+      // concatenation.
+      size_t size = 0;
+      for (int32_t i = 0; i < num_frames; ++i)
+        size += frames[i].size();
+      zmq::message_t ring_msg(size);
+      uint8_t *mem = reinterpret_cast<uint8_t*>(ring_msg.data());
+      for (int32_t i = 0; i < num_frames; ++i) {
+        memcpy(mem, frames[i].data(), frames[i].size());
+        mem += frames[i].size();
+        frames[i].rebuild();
+      }
+      return SendInProcRing(entity_id, &ring_msg);
+    }
+    sock = thr_info_->inproc_sock_.get();
+  } else {
+    sock = thr_info_->interproc_sock_.get();
+  }
+
+  int32_t recv_id = ZMQUtil::EntityID2ZmqID(entity_id);
+  size_t nbytes = ZMQUtil::ZMQSend(sock, recv_id, frames, num_frames);
+
+  return nbytes;
+}
+
 
 void CommBus::Recv(int32_t *entity_id, zmq::message_t *msg) {
+  if (inproc_ring_) {
+    RecvInProcRingOrInterProc(entity_id, msg, -1);
+    return;
+  }
+
   if (thr_info_->pollitems_.get() == NULL) {
     thr_info_->pollitems_.reset(new zmq::pollitem_t[2]);
     thr_info_->pollitems_[0].socket = *(thr_info_->inproc_sock_);
@@ -269,11 +448,14 @@ void CommBus::Recv(int32_t *entity_id, zmq::message_t *msg) {
   }
 
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(sock, &sender_id, msg);
+  ZMQUtil::ZMQRecv(sock, &sender_id, msg, GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
 }
 
 bool CommBus::RecvAsync(int32_t *entity_id, zmq::message_t *msg) {
+  if (inproc_ring_)
+    return TryRecvInProcRingOrInterProc(entity_id, msg);
+
   if (thr_info_->pollitems_.get() == NULL) {
     thr_info_->pollitems_.reset(new zmq::pollitem_t[2]);
     thr_info_->pollitems_[0].socket = *(thr_info_->inproc_sock_);
@@ -293,13 +475,16 @@ bool CommBus::RecvAsync(int32_t *entity_id, zmq::message_t *msg) {
   }
 
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(sock, &sender_id, msg);
+  ZMQUtil::ZMQRecv(sock, &sender_id, msg, GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
   return true;
 }
 
 bool CommBus::RecvTimeOut(int32_t *entity_id, zmq::message_t *msg,
     long timeout_milli) {
+  if (inproc_ring_)
+    return RecvInProcRingOrInterProc(entity_id, msg, timeout_milli);
+
   if (thr_info_->pollitems_.get() == NULL) {
     thr_info_->pollitems_.reset(new zmq::pollitem_t[2]);
     thr_info_->pollitems_[0].socket = *(thr_info_->inproc_sock_);
@@ -319,21 +504,30 @@ bool CommBus::RecvTimeOut(int32_t *entity_id, zmq::message_t *msg,
   }
 
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(sock, &sender_id, msg);
+  ZMQUtil::ZMQRecv(sock, &sender_id, msg, GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
   return true;
 }
 
 void CommBus::RecvInProc(int32_t *entity_id, zmq::message_t *msg) {
+  if (inproc_ring_) {
+    RecvInProcRing(entity_id, msg, -1);
+    return;
+  }
+
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(thr_info_->inproc_sock_.get(), &sender_id, msg);
+  ZMQUtil::ZMQRecv(thr_info_->inproc_sock_.get(), &sender_id, msg,
+                   GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
 }
 
 bool CommBus::RecvInProcAsync(int32_t *entity_id, zmq::message_t *msg) {
+  if (inproc_ring_)
+    return RecvInProcRing(entity_id, msg, 0);
+
   int32_t sender_id;
   bool recved = ZMQUtil::ZMQRecvAsync(thr_info_->inproc_sock_.get(),
-      &sender_id, msg);
+      &sender_id, msg, GetMoreFramesSink());
 
   if (recved) {
     *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
@@ -343,6 +537,9 @@ bool CommBus::RecvInProcAsync(int32_t *entity_id, zmq::message_t *msg) {
 
 bool CommBus::RecvInProcTimeOut(int32_t *entity_id, zmq::message_t *msg,
     long timeout_milli) {
+  if (inproc_ring_)
+    return RecvInProcRing(entity_id, msg, timeout_milli);
+
   if (thr_info_->inproc_pollitem_.get() == NULL) {
     thr_info_->inproc_pollitem_.reset(new zmq::pollitem_t);
     thr_info_->inproc_pollitem_->socket = *(thr_info_->inproc_sock_);
@@ -358,21 +555,22 @@ bool CommBus::RecvInProcTimeOut(int32_t *entity_id, zmq::message_t *msg,
   }
 
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(sock, &sender_id, msg);
+  ZMQUtil::ZMQRecv(sock, &sender_id, msg, GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
   return true;
 }
 
 void CommBus::RecvInterProc(int32_t *entity_id, zmq::message_t *msg) {
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(thr_info_->interproc_sock_.get(), &sender_id, msg);
+  ZMQUtil::ZMQRecv(thr_info_->interproc_sock_.get(), &sender_id, msg,
+                   GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
 }
 
 bool CommBus::RecvInterProcAsync(int32_t *entity_id, zmq::message_t *msg) {
   int32_t sender_id;
   bool recved = ZMQUtil::ZMQRecvAsync(thr_info_->interproc_sock_.get(),
-      &sender_id, msg);
+      &sender_id, msg, GetMoreFramesSink());
 
   if (recved) {
     *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
@@ -397,7 +595,7 @@ bool CommBus::RecvInterProcTimeOut(int32_t *entity_id, zmq::message_t *msg,
   }
 
   int32_t sender_id;
-  ZMQUtil::ZMQRecv(sock, &sender_id, msg);
+  ZMQUtil::ZMQRecv(sock, &sender_id, msg, GetMoreFramesSink());
   *entity_id = ZMQUtil::ZmqID2EntityID(sender_id);
   return true;
 }
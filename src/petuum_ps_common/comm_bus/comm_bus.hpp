@@ -3,7 +3,9 @@
 #pragma once
 
 #include <petuum_ps_common/comm_bus/zmq_util.hpp>
+#include <petuum_ps_common/comm_bus/inproc_ring.hpp>
 #include <zmq.hpp>
+#include <atomic>
 #include <string>
 #include <utility>
 #include <boost/thread/tss.hpp>
@@ -25,6 +27,10 @@ namespace petuum {
  * Each thread is an entity and should only register (ThreadRegister) once.
  * A thread is local if it is in the same CommBus object as myself, otherwise it
  * is remote.
+ *
+ * With inproc_ring, messages between local threads skip zmq: each local
+ * thread receives them from its own InProcRing instead of an inproc
+ * socket. The interface stays the same.
  */
 
 class CommBus : boost::noncopyable {
@@ -50,13 +56,18 @@ public:
     int num_bytes_interproc_send_buff_;
     int num_bytes_interproc_recv_buff_;
 
+    // Keep the frames of a received multipart message apart instead of
+    // concatenating them; see GetMoreFrames().
+    bool keep_more_frames_;
+
     Config():
       entity_id_(0),
       ltype_(kNone),
       num_bytes_inproc_send_buff_(0),
       num_bytes_inproc_recv_buff_(0),
       num_bytes_interproc_send_buff_(0),
-      num_bytes_interproc_recv_buff_(0) { }
+      num_bytes_interproc_recv_buff_(0),
+      keep_more_frames_(false) { }
 
     Config(int32_t entity_id, int ltype, std::string network_addr):
       entity_id_(entity_id),
@@ -65,7 +76,8 @@ public:
       num_bytes_inproc_send_buff_(0),
       num_bytes_inproc_recv_buff_(0),
       num_bytes_interproc_send_buff_(0),
-      num_bytes_interproc_recv_buff_(0) { }
+      num_bytes_interproc_recv_buff_(0),
+      keep_more_frames_(false) { }
   };
 
   struct ThreadCommInfo : boost::noncopyable {
@@ -85,12 +97,27 @@ public:
     int num_bytes_interproc_send_buff_;
     int num_bytes_interproc_recv_buff_;
 
-    ThreadCommInfo() { }
+    // Owned by CommBus. Set if inproc_ring.
+    InProcRing *inproc_ring_;
+    // Whether Recv() checks the interproc socket before the ring next.
+    bool interproc_first_;
+
+    bool keep_more_frames_;
+    ZMQFrames more_frames_;
+
+    ThreadCommInfo():
+        inproc_ring_(0),
+        interproc_first_(false),
+        keep_more_frames_(false) { }
   };
 
   bool IsLocalEntity(int32_t entity_id);
 
-  CommBus(int32_t e_st, int32_t e_end, int32_t num_clients, int32_t num_zmq_thrs = 1);
+  // inproc_ring_spin is how many times a receiver polls its empty ring
+  // before blocking.
+  CommBus(int32_t e_st, int32_t e_end, int32_t num_clients,
+          int32_t num_zmq_thrs = 1, bool inproc_ring = false,
+          int32_t inproc_ring_spin = 0);
   ~CommBus();
 
   // Register a thread, set up necessary commnication channel.
@@ -122,6 +149,12 @@ public:
   size_t Send(int32_t entity_id, zmq::message_t &msg);
   size_t SendInProc(int32_t entity_id, zmq::message_t &msg);
 
+  // Send frames as one multipart message, received as the concatenation of
+  // the frames unless the receiver keeps them apart. frames are nollified.
+  // Return the number of bytes sent.
+  size_t SendMultiPart(int32_t entity_id, zmq::message_t *frames,
+                       int32_t num_frames);
+
   void Recv(int32_t *entity_id, zmq::message_t *msg);
   bool RecvAsync(int32_t *entity_id, zmq::message_t *msg);
   bool RecvTimeOut(int32_t *entity_id, zmq::message_t *msg, long timeout_milli);
@@ -135,6 +168,14 @@ public:
   bool RecvInterProcAsync(int32_t *entity_id, zmq::message_t *msg);
   bool RecvInterProcTimeOut(int32_t *entity_id, zmq::message_t *msg,
       long timeout_milli);
+
+  // With Config::keep_more_frames_, the message received is only the first
+  // frame of a multipart message, and the other frames are here. Valid until
+  // the next receive by this thread.
+  ZMQFrames &GetMoreFrames() {
+    return thr_info_->more_frames_;
+  }
+
   typedef void (CommBus::*RecvFunc)(int32_t *sender_id,
     zmq::message_t *zmq_msg);
   typedef bool (CommBus::*RecvTimeOutFunc)(int32_t *sender_id,
@@ -162,6 +203,23 @@ private:
 
   static void SetUpRouterSocket(zmq::socket_t *sock, int32_t id,
     int num_bytes_send_buff, int num_bytes_recv_buff);
+
+  // Where ZMQUtil puts the frames after the first, 0 to concatenate them.
+  ZMQFrames *GetMoreFramesSink();
+
+  InProcRing *GetCreateInProcRing(int32_t entity_id);
+  InProcRing *GetMyInProcRing();
+  // Moves the content of msg into the receiver's ring.
+  size_t SendInProcRing(int32_t entity_id, zmq::message_t *msg);
+  size_t SendInProcRing(int32_t entity_id, const void *data, size_t len);
+  // Block for at most timeout_milli, forever if it is negative.
+  bool RecvInProcRing(int32_t *entity_id, zmq::message_t *msg,
+                      long timeout_milli);
+  bool RecvInProcRingOrInterProc(int32_t *entity_id, zmq::message_t *msg,
+                                 long timeout_milli);
+  bool TryRecvInProcRingOrInterProc(int32_t *entity_id, zmq::message_t *msg);
+
+  static const size_t kInProcRingCapacity = 16*1024;
   static const std::string kInProcPrefix;
   static const std::string kInterProcPrefix;
   zmq::context_t *zmq_ctx_;
@@ -169,5 +227,10 @@ private:
   int32_t e_st_;
   int32_t e_end_;
   boost::thread_specific_ptr<ThreadCommInfo> thr_info_;
+
+  bool inproc_ring_;
+  int32_t inproc_ring_spin_;
+  // Indexed by entity id - e_st_, created on first use.
+  boost::scoped_array<std::atomic<InProcRing*> > inproc_rings_;
 };
 }   // namespace petuum
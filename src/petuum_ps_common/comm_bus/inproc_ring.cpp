@@ -0,0 +1,185 @@
+#include <petuum_ps_common/comm_bus/inproc_ring.hpp>
+
+#include <glog/logging.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace petuum {
+
+InProcRing::InProcRing(size_t capacity):
+    num_overflow_(0),
+    tail_(0),
+    head_(0),
+    sleeping_(false) {
+  size_t size = 1;
+  while (size < capacity)
+    size *= 2;
+  mask_ = size - 1;
+  slots_.reset(new Slot[size]);
+  for (size_t i = 0; i < size; ++i)
+    slots_[i].seq.store(i, std::memory_order_relaxed);
+
+  event_fd_ = eventfd(0, EFD_NONBLOCK);
+  CHECK_GE(event_fd_, 0) << "failed to create eventfd";
+}
+
+InProcRing::~InProcRing() {
+  // Messages left in slots are closed with the slots.
+  for (auto &entry : overflow_)
+    delete entry.second;
+  close(event_fd_);
+}
+
+void InProcRing::Push(int32_t sender_id, zmq::message_t *msg) {
+  size_t pos;
+  Slot *slot = ClaimSlot(&pos);
+  if (slot != 0) {
+    slot->sender_id = sender_id;
+    slot->msg.move(msg);
+    PublishSlot(slot, pos);
+  } else {
+    zmq::message_t *overflow_msg = new zmq::message_t;
+    overflow_msg->move(msg);
+    PushOverflow(sender_id, overflow_msg);
+  }
+  WakeIfSleeping();
+}
+
+void InProcRing::Push(int32_t sender_id, const void *data, size_t len) {
+  size_t pos;
+  Slot *slot = ClaimSlot(&pos);
+  if (slot != 0) {
+    slot->sender_id = sender_id;
+    slot->msg.rebuild(len);
+    memcpy(slot->msg.data(), data, len);
+    PublishSlot(slot, pos);
+  } else {
+    zmq::message_t *overflow_msg = new zmq::message_t(len);
+    memcpy(overflow_msg->data(), data, len);
+    PushOverflow(sender_id, overflow_msg);
+  }
+  WakeIfSleeping();
+}
+
+InProcRing::Slot *InProcRing::ClaimSlot(size_t *pos) {
+  // A producer that sees no overflow has none of its own messages there, so
+  // using the ring keeps its order.
+  if (num_overflow_.load(std::memory_order_relaxed) != 0)
+    return 0;
+
+  *pos = tail_.load(std::memory_order_relaxed);
+  while (true) {
+    Slot *slot = &slots_[*pos & mask_];
+    size_t seq = slot->seq.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(*pos);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(*pos, *pos + 1,
+                                      std::memory_order_relaxed))
+        return slot;
+    } else if (diff < 0) {
+      // full
+      return 0;
+    } else {
+      // another producer took the slot
+      *pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void InProcRing::PublishSlot(Slot *slot, size_t pos) {
+  slot->seq.store(pos + 1, std::memory_order_release);
+}
+
+void InProcRing::PushOverflow(int32_t sender_id, zmq::message_t *msg) {
+  std::lock_guard<std::mutex> lock(overflow_mtx_);
+  overflow_.push_back(std::make_pair(sender_id, msg));
+  num_overflow_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void InProcRing::WakeIfSleeping() {
+  // Pairs with the fence in PrepareWait(): either the consumer sees the
+  // message or we see it sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed))
+    Wake();
+}
+
+bool InProcRing::Pop(int32_t *sender_id, zmq::message_t *msg) {
+  Slot &slot = slots_[head_ & mask_];
+  if (slot.seq.load(std::memory_order_acquire) == head_ + 1) {
+    *sender_id = slot.sender_id;
+    msg->move(&slot.msg);
+    slot.seq.store(head_ + mask_ + 1, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+  if (num_overflow_.load(std::memory_order_relaxed) == 0)
+    return false;
+  return PopOverflow(sender_id, msg);
+}
+
+bool InProcRing::PopOverflow(int32_t *sender_id, zmq::message_t *msg) {
+  std::lock_guard<std::mutex> lock(overflow_mtx_);
+  if (overflow_.empty())
+    return false;
+  // A producer claims its ring slots before it pushes to overflow_ under
+  // the mutex, so tail_ read here covers them. Those slots come first.
+  if (tail_.load(std::memory_order_relaxed) != head_)
+    return false;
+  *sender_id = overflow_.front().first;
+  msg->move(overflow_.front().second);
+  delete overflow_.front().second;
+  overflow_.pop_front();
+  num_overflow_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool InProcRing::Pop(int32_t *sender_id, zmq::message_t *msg, int32_t spin,
+                     long timeout_milli) {
+  for (int32_t i = 0; i <= spin; ++i) {
+    if (Pop(sender_id, msg))
+      return true;
+  }
+  if (timeout_milli == 0)
+    return false;
+
+  while (true) {
+    PrepareWait();
+    if (Pop(sender_id, msg)) {
+      FinishWait();
+      return true;
+    }
+    pollfd poll_fd;
+    poll_fd.fd = event_fd_;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    int ret = poll(&poll_fd, 1, (timeout_milli < 0) ? -1 : timeout_milli);
+    FinishWait();
+    if (Pop(sender_id, msg))
+      return true;
+    if (ret == 0 && timeout_milli > 0)
+      return false;
+  }
+}
+
+void InProcRing::PrepareWait() {
+  sleeping_.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void InProcRing::FinishWait() {
+  sleeping_.store(false, std::memory_order_relaxed);
+  uint64_t count;
+  ssize_t ret = read(event_fd_, &count, sizeof(count));
+  (void) ret;
+}
+
+void InProcRing::Wake() {
+  uint64_t one = 1;
+  ssize_t ret = write(event_fd_, &one, sizeof(one));
+  (void) ret;
+}
+
+}  // namespace petuum
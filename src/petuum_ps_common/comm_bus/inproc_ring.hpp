@@ -0,0 +1,101 @@
+#pragma once
+
+#include <zmq.hpp>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+namespace petuum {
+
+// Bounded lock-free multi-producer single-consumer queue of messages, the
+// inbox of one local thread when CommBus does not go through zmq for
+// in-process messages. Messages are moved into and out of preallocated
+// slots, so sending and receiving allocate nothing besides the message
+// buffer itself.
+//
+// Push() never waits for the consumer. Local threads send to each other
+// in both directions (e.g. bg threads and server threads), so two threads
+// blocked on each other's full ring would deadlock. When the ring is full,
+// messages go to a mutex-protected overflow queue instead, and keep going
+// there until the consumer has drained it. The consumer only takes from the
+// overflow queue when every slot claimed so far has been received, so the
+// messages of one producer are received in the order they were pushed.
+//
+// The consumer blocks on an eventfd, which lets it wait on the ring and
+// zmq sockets in one zmq::poll(). Producers only write to the eventfd when
+// the consumer is about to block.
+class InProcRing : boost::noncopyable {
+public:
+  // capacity is rounded up to a power of 2.
+  explicit InProcRing(size_t capacity);
+  // Drops the messages not received.
+  ~InProcRing();
+
+  // Moves the content of msg into the ring.
+  void Push(int32_t sender_id, zmq::message_t *msg);
+
+  // Copies data into the ring.
+  void Push(int32_t sender_id, const void *data, size_t len);
+
+  // Consumer only. Moves the next message into msg.
+  bool Pop(int32_t *sender_id, zmq::message_t *msg);
+
+  // Consumer only. Pop, retrying spin times and then blocking for at most
+  // timeout_milli, or forever if it is negative.
+  bool Pop(int32_t *sender_id, zmq::message_t *msg, int32_t spin,
+           long timeout_milli);
+
+  // Consumer only. To block on the ring along with other file descriptors,
+  // call PrepareWait(), Pop() once more, poll on get_event_fd() if that
+  // failed, and then FinishWait().
+  void PrepareWait();
+  void FinishWait();
+
+  int get_event_fd() const {
+    return event_fd_;
+  }
+
+  size_t get_capacity() const {
+    return mask_ + 1;
+  }
+
+private:
+  struct Slot {
+    // pos + 1 once slot pos is filled, pos + capacity once it is consumed
+    std::atomic<size_t> seq;
+    int32_t sender_id;
+    zmq::message_t msg;
+  };
+
+  // Returns 0 if the ring is full or the overflow queue is in use.
+  Slot *ClaimSlot(size_t *pos);
+  void PublishSlot(Slot *slot, size_t pos);
+  // Takes ownership of msg.
+  void PushOverflow(int32_t sender_id, zmq::message_t *msg);
+  bool PopOverflow(int32_t *sender_id, zmq::message_t *msg);
+  void WakeIfSleeping();
+  void Wake();
+
+  size_t mask_;
+  boost::scoped_array<Slot> slots_;
+  int event_fd_;
+
+  std::mutex overflow_mtx_;
+  std::deque<std::pair<int32_t, zmq::message_t*> > overflow_;
+
+  // Producers and the consumer each get their own cache line.
+  char pad0_[64];
+  std::atomic<size_t> tail_;
+  // Messages in overflow_; producers skip the ring while it is nonzero.
+  std::atomic<size_t> num_overflow_;
+  char pad1_[64];
+  size_t head_;
+  std::atomic<bool> sleeping_;
+  char pad2_[64];
+};
+
+}  // namespace petuum
@@ -1,9 +1,25 @@
 
 #include <petuum_ps_common/comm_bus/zmq_util.hpp>
 #include <glog/logging.h>
+#include <memory>
+#include <vector>
+#include <string.h>
 
 namespace petuum {
 
+zmq::message_t *ZMQFrames::Append() {
+  if (num_frames_ == frames_.size())
+    frames_.emplace_back(new zmq::message_t);
+  return frames_[num_frames_++].get();
+}
+
+void ZMQFrames::Clear() {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    frames_[i]->rebuild();
+  }
+  num_frames_ = 0;
+}
+
 int32_t ZMQUtil::EntityID2ZmqID(int32_t entity_id){
   return (entity_id << 4 | 0x1);
 }
@@ -138,7 +154,8 @@ bool ZMQUtil::ZMQRecvAsync(zmq::socket_t *sock, zmq::message_t *msg){
   return recved;
 }
 
-bool ZMQUtil::ZMQRecvAsync(zmq::socket_t *sock, int32_t *zmq_id, zmq::message_t *msg){
+bool ZMQUtil::ZMQRecvAsync(zmq::socket_t *sock, int32_t *zmq_id,
+                           zmq::message_t *msg, ZMQFrames *more_frames){
 
   zmq::message_t msg_zid;
   bool recved = ZMQRecvAsync(sock, &msg_zid);
@@ -149,6 +166,7 @@ bool ZMQUtil::ZMQRecvAsync(zmq::socket_t *sock, int32_t *zmq_id, zmq::message_t
   *zmq_id = *((int32_t *) msg_zid.data());
 
   ZMQRecv(sock, msg);
+  ZMQRecvMore(sock, msg, more_frames);
 
   return true;
 }
@@ -181,12 +199,52 @@ void ZMQUtil::ZMQRecv(zmq::socket_t *sock, zmq::message_t *msg){
 }
 
 void ZMQUtil::ZMQRecv(zmq::socket_t *sock, int32_t *zmq_id,
-                      zmq::message_t *msg){
+                      zmq::message_t *msg, ZMQFrames *more_frames){
   zmq::message_t msg_zid;
   ZMQRecv(sock, &msg_zid);
 
   *zmq_id = *((int32_t *) msg_zid.data());
   ZMQRecv(sock, msg);
+  ZMQRecvMore(sock, msg, more_frames);
+}
+
+void ZMQUtil::ZMQRecvMore(zmq::socket_t *sock, zmq::message_t *msg,
+                          ZMQFrames *more_frames){
+  if (more_frames != 0)
+    more_frames->Clear();
+
+  int more = 0;
+  size_t more_size = sizeof(more);
+  sock->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+  if (!more)
+    return;
+
+  if (more_frames != 0) {
+    do {
+      ZMQRecv(sock, more_frames->Append());
+      sock->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+    } while (more);
+    return;
+  }
+
+  std::vector<std::unique_ptr<zmq::message_t> > frames;
+  size_t total_size = msg->size();
+  do {
+    frames.emplace_back(new zmq::message_t);
+    ZMQRecv(sock, frames.back().get());
+    total_size += frames.back()->size();
+    sock->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+  } while (more);
+
+  zmq::message_t whole(total_size);
+  uint8_t *dst = reinterpret_cast<uint8_t*>(whole.data());
+  memcpy(dst, msg->data(), msg->size());
+  dst += msg->size();
+  for (const auto &frame : frames) {
+    memcpy(dst, frame->data(), frame->size());
+    dst += frame->size();
+  }
+  msg->move(&whole);
 }
 
 /*
@@ -270,4 +328,22 @@ size_t ZMQUtil::ZMQSend(zmq::socket_t *sock, int32_t zmq_id, zmq::message_t &msg
   return ZMQSend(sock, msg, flag);
 }
 
+size_t ZMQUtil::ZMQSend(zmq::socket_t *sock, int32_t zmq_id,
+  zmq::message_t *frames, int32_t num_frames){
+  CHECK_GT(num_frames, 0);
+  size_t zid_sent_size = ZMQSend(sock, &zmq_id, sizeof(zmq_id), ZMQ_SNDMORE);
+  CHECK_EQ(zid_sent_size, sizeof(zmq_id));
+
+  size_t nbytes = 0;
+  for (int32_t i = 0; i < num_frames; ++i) {
+    // socket_t::send() of a message_t only tells whether it is sent.
+    size_t frame_size = frames[i].size();
+    size_t sent = ZMQSend(sock, frames[i],
+                          (i + 1 < num_frames) ? ZMQ_SNDMORE : 0);
+    CHECK(sent) << "failed to send frame " << i << " of " << num_frames;
+    nbytes += frame_size;
+  }
+  return nbytes;
+}
+
 }
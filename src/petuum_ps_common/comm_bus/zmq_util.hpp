@@ -1,12 +1,41 @@
 #pragma once
 
 #include <zmq.hpp>
+#include <boost/noncopyable.hpp>
 #include <assert.h>
 #include <stdint.h>
 #include <time.h>
+#include <memory>
+#include <vector>
 
 namespace petuum {
 
+// The frames after the first of a received multipart message, kept as zmq
+// received them. The message_t objects are reused across messages.
+class ZMQFrames : boost::noncopyable {
+public:
+  ZMQFrames():
+      num_frames_(0) { }
+
+  size_t size() const {
+    return num_frames_;
+  }
+
+  zmq::message_t &operator[](size_t idx) {
+    return *frames_[idx];
+  }
+
+  // Returns an empty frame appended to the others.
+  zmq::message_t *Append();
+
+  // Releases the frames' memory.
+  void Clear();
+
+private:
+  std::vector<std::unique_ptr<zmq::message_t> > frames_;
+  size_t num_frames_;
+};
+
 class ZMQUtil {
 public:
   static int32_t EntityID2ZmqID(int32_t entity_id);
@@ -24,11 +53,20 @@ public:
   // True for received, false for not
   static bool ZMQRecvAsync(zmq::socket_t *sock, zmq::message_t *msg);
 
-  static bool ZMQRecvAsync(zmq::socket_t *sock, int32_t *zmq_id, zmq::message_t *msg);
+  // more_frames is passed to ZMQRecvMore().
+  static bool ZMQRecvAsync(zmq::socket_t *sock, int32_t *zmq_id,
+                           zmq::message_t *msg, ZMQFrames *more_frames = 0);
 
   static void ZMQRecv(zmq::socket_t *sock, zmq::message_t *msg);
   
-  static void ZMQRecv(zmq::socket_t *sock, int32_t *zmq_id, zmq::message_t *msg);
+  static void ZMQRecv(zmq::socket_t *sock, int32_t *zmq_id,
+                      zmq::message_t *msg, ZMQFrames *more_frames = 0);
+
+  // If msg is the first frame of a multipart message, receive the remaining
+  // frames. They are put in more_frames if given, which is cleared first,
+  // and otherwise msg is replaced with the concatenation of all frames.
+  static void ZMQRecvMore(zmq::socket_t *sock, zmq::message_t *msg,
+                          ZMQFrames *more_frames = 0);
 
   /*
    * return number of bytes sent
@@ -46,6 +84,11 @@ public:
   static size_t ZMQSend(zmq::socket_t *sock, int32_t zmq_id, 
     zmq::message_t &msg, int flag = 0);
 
+  // Send frames as one multipart message; frames are nollified. Return the
+  // total number of bytes sent.
+  static size_t ZMQSend(zmq::socket_t *sock, int32_t zmq_id,
+    zmq::message_t *frames, int32_t num_frames);
+
 
 };
 }
@@ -37,6 +37,15 @@ public:
   // fresh in SSP. The result is returned in row_accessor.
   virtual ClientRow *Get(int32_t row_id, RowAccessor* row_accessor) = 0;
 
+  // Get num_rows rows; row_accessors points to num_rows accessors. Controllers
+  // that can fetch rows in bulk override this.
+  virtual void GetBatch(const int32_t *row_ids, int32_t num_rows,
+                        RowAccessor *row_accessors) {
+    for (int32_t i = 0; i < num_rows; ++i) {
+      Get(row_ids[i], &row_accessors[i]);
+    }
+  }
+
   // Increment (update) an entry. Does not take ownership of input argument
   // delta, which should be of template type UPDATE in Table. This may trigger
   // synchronization (e.g., in value-bound) and is blocked until consistency
@@ -7,6 +7,14 @@
 
 namespace petuum {
 
+// Value types of rows whose AddUpdates() is plain addition of that type.
+struct UpdateValueType {
+  static const int32_t kOther = 0;
+  static const int32_t kFloat = 1;
+  static const int32_t kDouble = 2;
+  static const int32_t kInt32 = 3;
+};
+
 // This class defines the interface of the Row type.  ApplyUpdate() and
 // ApplyBatchUpdate() have to be concurrent with each other and with other
 // functions that may be invoked by application threads.  Petuum system does
@@ -104,6 +112,14 @@ public:
   virtual void SubtractUpdates(int32_t column_id, void *update1,
                                const void* update2) const = 0;
 
+  // If AddUpdates() is "update1 += update2" on one of the types in
+  // UpdateValueType, return that type, so the client may accumulate updates
+  // without calling AddUpdates() on each of them. Rows with other update
+  // semantics keep the default.
+  virtual int32_t get_update_value_type() const {
+    return UpdateValueType::kOther;
+  }
+
   // Get importance of this update as if it is applied on to the given value.
   virtual double GetImportance(int32_t column_id, const void *update,
                                const void *value) const = 0;
@@ -39,6 +39,19 @@ struct RowOpLogType {
   static const int32_t kDenseRowOpLogFloat16 = 3;
 };
 
+// Compression of oplog and server push messages; flags may be or-ed. Column
+// id and value coding applies to oplogs only, as pushed rows are opaque to
+// the server; kFloat16 and kBFloat16 are lossy and only used for float
+// updates.
+struct CompressType {
+  static const int32_t kNone = 0;
+  static const int32_t kSnappy = 1;
+  // Delta + varint coded row and column ids.
+  static const int32_t kVarintIds = 2;
+  static const int32_t kFloat16 = 4;
+  static const int32_t kBFloat16 = 8;
+};
+
 enum OpLogType {
   Sparse = 0,
   AppendOnly = 1,
@@ -61,6 +74,16 @@ enum NumaPolicy {
   Center = 1
 };
 
+// How rows are mapped to server threads, see RowPartitioner.
+enum RowPartitionerType {
+  // row_id modulo the number of server threads, regardless of table
+  kModuloPartitioner = 0,
+  // hash of (table_id, row_id) modulo the number of server threads
+  kTableHashPartitioner = 1,
+  // consistent hashing of (table_id, row_id) with virtual nodes
+  kConsistentHashPartitioner = 2
+};
+
 struct TableGroupConfig {
 
   TableGroupConfig():
@@ -73,6 +96,12 @@ struct TableGroupConfig {
       aggressive_cpu(false),
       snapshot_clock(-1),
       resume_clock(-1),
+      snapshot_async(false),
+      snapshot_full_interval(1),
+      resume_num_threads(0),
+      num_server_apply_threads(1),
+      ooc_num_io_threads(2),
+      ooc_write_batch_size(64),
       update_sort_policy(Random),
       bg_idle_milli(2),
       client_bandwidth_mbps(40),
@@ -85,7 +114,13 @@ struct TableGroupConfig {
       naive_table_oplog_meta(true),
       suppression_on(false),
       use_approx_sort(false),
-    num_zmq_threads(1) { }
+      row_delta_reply(false),
+      row_partitioner(kModuloPartitioner),
+      num_partition_virtual_nodes(64),
+      row_placement_file(""),
+    num_zmq_threads(1),
+    comm_bus_inproc_ring(false),
+    comm_bus_inproc_ring_spin(1000) { }
 
   std::string stats_path;
 
@@ -134,8 +169,31 @@ struct TableGroupConfig {
   std::string snapshot_dir;
   std::string resume_dir;
 
+  // If true, snapshots are written by a background I/O thread from a
+  // copy-on-write view of the tables instead of inline on the server thread.
+  bool snapshot_async;
+
+  // Every snapshot_full_interval-th snapshot contains all rows. The ones in
+  // between are deltas that only contain rows modified since the previous
+  // snapshot; resume merges the chain back to the full one.
+  int32_t snapshot_full_interval;
+
+  // Number of helper threads each server thread uses to verify and
+  // deserialize snapshot rows on resume. 0 does it all on the server thread.
+  int32_t resume_num_threads;
+
+  // Number of threads each server thread applies the rows of an oplog
+  // message with, including itself. Rows are striped by row id so each row
+  // is applied by one thread; 1 applies them on the server thread only.
+  int32_t num_server_apply_threads;
+
   std::string ooc_path_prefix;
 
+  // Out-of-core (LocalOOC) tables: number of threads doing disk reads and
+  // writes for each table, and number of evicted rows written per batch.
+  int32_t ooc_num_io_threads;
+  int32_t ooc_write_batch_size;
+
   UpdateSortPolicy update_sort_policy;
 
   // In number of milliseconds.
@@ -166,7 +224,28 @@ struct TableGroupConfig {
 
   bool use_approx_sort;
 
+  // If true, a bg thread that re-requests a row it caches tells the server
+  // the version it has, and the server replies with the updates of the
+  // other clients since that version when they are smaller than the row.
+  // Applies to tables with Sparse or Dense oplogs and oplog replay; the
+  // server keeps a history of at most the row size per such row requested.
+  bool row_delta_reply;
+
+  // Global. Rows listed in row_placement_file are placed explicitly, the
+  // others by row_partitioner. The file is only read by the name node (on
+  // client 0), which hands each table's placements out at CreateTable time.
+  // Each line is "table_id row_id client_id comm_channel_idx".
+  RowPartitionerType row_partitioner;
+  int32_t num_partition_virtual_nodes;
+  std::string row_placement_file;
+
   size_t num_zmq_threads;
+
+  // Messages between threads of this process go through lock-free rings
+  // instead of zmq inproc sockets. A receiver polls its empty ring
+  // comm_bus_inproc_ring_spin times before blocking.
+  bool comm_bus_inproc_ring;
+  int32_t comm_bus_inproc_ring_spin;
 };
 
 // TableInfo is shared between client and server.
@@ -180,7 +259,9 @@ struct TableInfo {
       dense_row_oplog_capacity(0),
       server_push_row_upper_bound(100),
       server_table_logic(-1),
-      version_maintain(false) { }
+      version_maintain(false),
+      compress_type(CompressType::kNone),
+      num_row_shards(1) { }
 
   // table_staleness is used for SSP and ClockVAP.
   int32_t table_staleness;
@@ -205,6 +286,15 @@ struct TableInfo {
   int32_t server_table_logic;
 
   bool version_maintain;
+
+  // Bitwise or of CompressType flags.
+  int32_t compress_type;
+
+  // Client only. If > 1, each row is split into num_row_shards rows of
+  // row_capacity / num_row_shards (rounded up) consecutive columns, which
+  // are placed on servers like separate rows. Apps still see whole rows.
+  // Only for dense row types.
+  int32_t num_row_shards;
 };
 
 // ClientTableConfig is used by client only.
@@ -13,4 +13,8 @@ const size_t kOneThousand = 1000;
 
 const uint64_t kMaxPendingMsgs = 200;
 const uint64_t kMaxPendingAcks = 40;
+
+// Row version of a row without delta history, see
+// TableGroupConfig::row_delta_reply.
+const uint64_t kNoRowDeltaVersion = UINT64_MAX;
 }
@@ -39,6 +39,8 @@ void InitTableConfig(ClientTableConfig *config) {
       = FLAGS_client_send_oplog_upper_bound;
   config->table_info.server_table_logic = FLAGS_server_table_logic;
   config->table_info.version_maintain = FLAGS_version_maintain;
+  config->table_info.compress_type = GetCompressType(FLAGS_compress_type);
+  config->table_info.num_row_shards = FLAGS_num_row_shards;
 }
 
 }
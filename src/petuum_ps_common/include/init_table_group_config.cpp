@@ -25,6 +25,10 @@ void InitTableGroupConfig(TableGroupConfig *config, int32_t num_tables) {
   config->resume_clock = FLAGS_resume_clock;
   config->snapshot_dir = FLAGS_snapshot_dir;
   config->resume_dir = FLAGS_resume_dir;
+  config->snapshot_async = FLAGS_snapshot_async;
+  config->snapshot_full_interval = FLAGS_snapshot_full_interval;
+  config->resume_num_threads = FLAGS_resume_num_threads;
+  config->num_server_apply_threads = FLAGS_num_server_apply_threads;
 
   config->update_sort_policy = GetUpdateSortPolicy(FLAGS_update_sort_policy);
 
@@ -51,8 +55,15 @@ void InitTableGroupConfig(TableGroupConfig *config, int32_t num_tables) {
   config->naive_table_oplog_meta = FLAGS_naive_table_oplog_meta;
   config->suppression_on = FLAGS_suppression_on;
   config->use_approx_sort = FLAGS_use_approx_sort;
+  config->row_delta_reply = FLAGS_row_delta_reply;
+
+  config->row_partitioner = GetRowPartitionerType(FLAGS_row_partitioner);
+  config->num_partition_virtual_nodes = FLAGS_num_partition_virtual_nodes;
+  config->row_placement_file = FLAGS_row_placement_file;
 
   config->num_zmq_threads = FLAGS_num_zmq_threads;
+  config->comm_bus_inproc_ring = FLAGS_comm_bus_inproc_ring;
+  config->comm_bus_inproc_ring_spin = FLAGS_comm_bus_inproc_ring_spin;
 }
 
 }
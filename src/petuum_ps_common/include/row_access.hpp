@@ -43,6 +43,7 @@ private:
   friend class LocalOOCConsistencyController;
   friend class ThreadTable;
   friend class ThreadTableSN;
+  friend class ClientTable;
 
   void Clear() {
     if (client_row_ptr_ != 0) {
@@ -91,6 +92,7 @@ private:
   friend class LocalOOCConsistencyController;
   friend class ThreadTable;
   friend class ThreadTableSN;
+  friend class ClientTable;
 
   AbstractRow *row_data_ptr_;
 };
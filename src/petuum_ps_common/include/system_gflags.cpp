@@ -33,6 +33,13 @@ DEFINE_int32(snapshot_clock, -1, "snapshot clock");
 DEFINE_int32(resume_clock, -1, "resume clock");
 DEFINE_string(snapshot_dir, "", "snap shot directory");
 DEFINE_string(resume_dir, "", "resume directory");
+DEFINE_int32(resume_num_threads, 0, "helper threads per server thread to "
+             "verify and deserialize snapshot rows on resume");
+DEFINE_int32(num_server_apply_threads, 1, "threads per server thread to "
+             "apply oplog rows with, including the server thread");
+DEFINE_bool(snapshot_async, false, "write snapshots from a background thread");
+DEFINE_int32(snapshot_full_interval, 1, "every n-th snapshot is a full one, "
+             "the others only contain rows modified since the previous one");
 
 // numa flags
 DEFINE_bool(numa_opt, false, "numa opt on?");
@@ -41,5 +48,18 @@ DEFINE_string(numa_policy, "Even", "numa policy");
 DEFINE_bool(naive_table_oplog_meta, true, "naive table oplog meta");
 DEFINE_bool(suppression_on, false, "suppression on");
 DEFINE_bool(use_approx_sort, true, "use_approx_sort");
+DEFINE_bool(row_delta_reply, false, "reply to re-requests of cached rows with "
+            "the updates since the cached version");
 
 DEFINE_uint64(num_zmq_threads, 1, "number of zmq threads");
+DEFINE_bool(comm_bus_inproc_ring, false, "send in-process messages through "
+            "lock-free rings instead of zmq");
+DEFINE_int32(comm_bus_inproc_ring_spin, 1000, "times to poll an empty ring "
+             "before blocking");
+
+// Row partitioning
+DEFINE_string(row_partitioner, "Modulo", "Modulo, TableHash or ConsistentHash");
+DEFINE_int32(num_partition_virtual_nodes, 64, "virtual nodes per server "
+             "thread for ConsistentHash");
+DEFINE_string(row_placement_file, "", "explicit placement of hot rows, each "
+              "line being: table_id row_id client_id comm_channel_idx");
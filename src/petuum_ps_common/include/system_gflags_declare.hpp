@@ -35,6 +35,10 @@ DECLARE_int32(snapshot_clock);
 DECLARE_int32(resume_clock);
 DECLARE_string(snapshot_dir);
 DECLARE_string(resume_dir);
+DECLARE_int32(resume_num_threads);
+DECLARE_bool(snapshot_async);
+DECLARE_int32(num_server_apply_threads);
+DECLARE_int32(snapshot_full_interval);
 
 // numa flags
 DECLARE_bool(numa_opt);
@@ -43,8 +47,15 @@ DECLARE_string(numa_policy);
 DECLARE_bool(naive_table_oplog_meta);
 DECLARE_bool(suppression_on);
 DECLARE_bool(use_approx_sort);
+DECLARE_bool(row_delta_reply);
 
 DECLARE_uint64(num_zmq_threads);
+DECLARE_bool(comm_bus_inproc_ring);
+DECLARE_int32(comm_bus_inproc_ring_spin);
+
+DECLARE_string(row_partitioner);
+DECLARE_int32(num_partition_virtual_nodes);
+DECLARE_string(row_placement_file);
 
 namespace petuum {
 void InitTableGroupConfig(TableGroupConfig *config, int32_t num_tables);
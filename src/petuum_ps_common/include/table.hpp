@@ -168,6 +168,14 @@ public:
         system_table_->Get(row_id, row_accessor)->GetRowDataPtr()));
   }
 
+  // Get rows in bulk. row_accessors points to row_ids.size() accessors, one
+  // per row; returns once all rows are fresh enough. Rows that need to be
+  // fetched are requested together rather than one round trip each.
+  void GetBatch(const std::vector<int32_t> &row_ids,
+                RowAccessor *row_accessors) {
+    system_table_->GetBatch(row_ids.data(), row_ids.size(), row_accessors);
+  }
+
   void Inc(int32_t row_id, int32_t column_id, UPDATE update){
     system_table_->Inc(row_id, column_id, &update);
   }
@@ -22,3 +22,8 @@ DEFINE_uint64(server_push_row_upper_bound, 100, "Server push row threshold");
 DEFINE_uint64(client_send_oplog_upper_bound, 100, "client send oplog upper bound");
 DEFINE_int32(server_table_logic, -1, "server table logic");
 DEFINE_bool(version_maintain, false, "version maintain");
+DEFINE_string(compress_type, "None", "comma-separated compression of oplog "
+              "and server push messages: Snappy, VarintIds, Float16, "
+              "BFloat16");
+DEFINE_int32(num_row_shards, 1, "split each row into this many column-range "
+             "shards placed on different servers; dense rows only");
@@ -10,6 +10,7 @@
 #include <float16_compressor.hpp>
 
 #include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+#include <petuum_ps_common/util/dense_kernels.hpp>
 #include <glog/logging.h>
 
 namespace petuum {
@@ -147,9 +148,7 @@ public:
     const uint16_t *typed_mem = reinterpret_cast<const uint16_t*>(mem);
     float *typed_oplogs = reinterpret_cast<float*>(oplogs_.get());
 
-    for (int i = 0; i < row_size_; ++i) {
-      typed_oplogs[i] = Float16Compressor::decompress(typed_mem[i]);
-    }
+    DenseKernels::DecompressFloat16(typed_oplogs, typed_mem, row_size_);
 
     *num_updates = row_size_;
     *serialized_size = row_size_*sizeof(uint16_t);
@@ -2,7 +2,9 @@
 #pragma once
 
 #include <stdint.h>
-#include <map>
+#include <string.h>
+#include <vector>
+#include <algorithm>
 
 #include <functional>
 #include <boost/noncopyable.hpp>
@@ -12,6 +14,19 @@
 #include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
 
 namespace petuum {
+
+// Updates are kept inline in one flat array, with their column ids in a
+// parallel array, instead of a tree node and an allocation per column. Rows
+// with more than kMaxLinearScanSize columns get an open-addressed index from
+// column id to position; smaller ones are scanned.
+//
+// Columns are appended, so the arrays are out of order only if columns
+// come in out of order; they are sorted in place before ordered traversal
+// and serialization, which then walk contiguous memory. Reset() keeps the
+// memory for the row oplog to be reused.
+//
+// Pointers to updates are invalidated by FindCreate(), ordered traversal
+// and ClearZerosAndGetNoneZeroSize().
 class SparseRowOpLog : public virtual AbstractRowOpLog {
 public:
   SparseRowOpLog(InitUpdateFunc InitUpdate,
@@ -19,109 +34,116 @@ public:
                  size_t update_size):
       AbstractRowOpLog(update_size),
       InitUpdate_(InitUpdate),
-      CheckZeroUpdate_(CheckZeroUpdate) { }
+      CheckZeroUpdate_(CheckZeroUpdate),
+      sorted_(true),
+      iter_idx_(0) { }
 
-  virtual ~SparseRowOpLog() {
-    auto iter = oplogs_.begin();
-    for (; iter != oplogs_.end(); iter++) {
-      delete[] iter->second;
-    }
-  }
+  virtual ~SparseRowOpLog() { }
 
   void Reset() {
-    auto iter = oplogs_.begin();
-    for (; iter != oplogs_.end(); iter++) {
-      delete[] iter->second;
+    if (column_ids_.capacity() > kMaxRetainedSize) {
+      std::vector<int32_t>().swap(column_ids_);
+      std::vector<uint8_t>().swap(updates_);
+      std::vector<int32_t>().swap(index_);
+    } else {
+      column_ids_.clear();
+      updates_.clear();
+      index_.clear();
     }
-    oplogs_.clear();
+    sorted_ = true;
   }
 
   void* Find(int32_t col_id) {
-    auto iter = oplogs_.find(col_id);
-    if (iter == oplogs_.end()) {
+    int32_t idx = FindIdx(col_id);
+    if (idx < 0) {
       return 0;
     }
-    return iter->second;
+    return GetUpdate(idx);
   }
 
   const void* FindConst(int32_t col_id) const {
-    auto iter = oplogs_.find(col_id);
-    if (iter == oplogs_.end()) {
+    int32_t idx = FindIdx(col_id);
+    if (idx < 0) {
       return 0;
     }
-    return iter->second;
+    return GetUpdate(idx);
   }
 
   void* FindCreate(int32_t col_id) {
-    auto iter = oplogs_.find(col_id);
-    if (iter == oplogs_.end()) {
-      uint8_t* update = new uint8_t[update_size_];
-      InitUpdate_(col_id, update);
-      oplogs_[col_id] = update;
-      return update;
+    int32_t idx = FindIdx(col_id);
+    if (idx >= 0) {
+      return GetUpdate(idx);
     }
-    return iter->second;
+    uint8_t *update = Append(col_id);
+    InitUpdate_(col_id, update);
+    return update;
   }
 
   // Guaranteed ordered traversal
   void* BeginIterate(int32_t *column_id) {
-    iter_ = oplogs_.begin();
-    if (iter_ == oplogs_.end()) {
+    Sort();
+    iter_idx_ = 0;
+    if (column_ids_.empty()) {
       return 0;
     }
-    *column_id = iter_->first;
-    return iter_->second;
+    *column_id = column_ids_[0];
+    return GetUpdate(0);
   }
 
   void* Next(int32_t *column_id) {
-    iter_++;
-    if (iter_ == oplogs_.end()) {
+    ++iter_idx_;
+    if (iter_idx_ >= column_ids_.size()) {
       return 0;
     }
-    *column_id = iter_->first;
-    return iter_->second;
+    *column_id = column_ids_[iter_idx_];
+    return GetUpdate(iter_idx_);
   }
 
   // Guaranteed ordered traversal, in ascending order of column_id
   const void* BeginIterateConst(int32_t *column_id) const {
-    const_iter_ = oplogs_.cbegin();
-    if (const_iter_ == oplogs_.cend()) {
+    Sort();
+    iter_idx_ = 0;
+    if (column_ids_.empty()) {
       return 0;
     }
-    *column_id = const_iter_->first;
-    return const_iter_->second;
+    *column_id = column_ids_[0];
+    return GetUpdate(0);
   }
 
   const void* NextConst(int32_t *column_id) const {
-    const_iter_++;
-    if (const_iter_ == oplogs_.cend()) {
+    ++iter_idx_;
+    if (iter_idx_ >= column_ids_.size()) {
       return 0;
     }
-    *column_id = const_iter_->first;
-    return const_iter_->second;
+    *column_id = column_ids_[iter_idx_];
+    return GetUpdate(iter_idx_);
   }
 
   size_t GetSize() const {
-    return oplogs_.size();
+    return column_ids_.size();
   }
 
   size_t ClearZerosAndGetNoneZeroSize() {
-    auto oplog_iter = oplogs_.begin();
-    while (oplog_iter != oplogs_.end()) {
-      if (CheckZeroUpdate_(oplog_iter->second)) {
-        delete[] oplog_iter->second;
-        auto orig_oplog_iter = oplog_iter;
-        ++oplog_iter;
-        oplogs_.erase(orig_oplog_iter);
-      } else {
-        ++oplog_iter;
+    size_t num_kept = 0;
+    for (size_t i = 0; i < column_ids_.size(); ++i) {
+      if (CheckZeroUpdate_(GetUpdate(i)))
+        continue;
+      if (num_kept != i) {
+        column_ids_[num_kept] = column_ids_[i];
+        memcpy(GetUpdate(num_kept), GetUpdate(i), update_size_);
       }
+      ++num_kept;
     }
-    return oplogs_.size();
+    if (num_kept != column_ids_.size()) {
+      column_ids_.resize(num_kept);
+      updates_.resize(num_kept*update_size_);
+      RebuildIndex();
+    }
+    return num_kept;
   }
 
   size_t GetSparseSerializedSize() {
-    size_t num_updates = oplogs_.size();
+    size_t num_updates = column_ids_.size();
     return sizeof(int32_t) + sizeof(int32_t)*num_updates
         + update_size_*num_updates;
   }
@@ -136,19 +158,16 @@ public:
   // 2) total size for column ids
   // 3) total size for update array
   size_t SerializeSparse(void *mem) {
-    size_t num_oplogs = oplogs_.size();
+    Sort();
+    size_t num_oplogs = column_ids_.size();
     int32_t *mem_num_updates = reinterpret_cast<int32_t*>(mem);
     *mem_num_updates = num_oplogs;
 
     uint8_t *mem_index = reinterpret_cast<uint8_t*>(mem) + sizeof(int32_t);
     uint8_t *mem_oplogs = mem_index + num_oplogs*sizeof(int32_t);
-
-    for (auto oplog_iter = oplogs_.cbegin(); oplog_iter != oplogs_.cend();
-         ++oplog_iter) {
-      *(reinterpret_cast<int32_t*>(mem_index)) = oplog_iter->first;
-      memcpy(mem_oplogs, oplog_iter->second, update_size_);
-      mem_index += sizeof(int32_t);
-      mem_oplogs += update_size_;
+    if (num_oplogs > 0) {
+      memcpy(mem_index, column_ids_.data(), num_oplogs*sizeof(int32_t));
+      memcpy(mem_oplogs, updates_.data(), num_oplogs*update_size_);
     }
     return GetSparseSerializedSize();
   }
@@ -170,24 +189,124 @@ public:
     const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
     for (int i = 0; i < num_updates; ++i) {
       int32_t col_id = i + index_st;
-      uint8_t *update;
-      auto oplog_iter = oplogs_.find(col_id);
-      if (oplog_iter == oplogs_.end()) {
-        update = new uint8_t[AbstractRowOpLog::update_size_];
-        oplogs_.insert(std::make_pair(col_id, update));
-      } else {
-        update = oplog_iter->second;
-      }
+      int32_t idx = FindIdx(col_id);
+      uint8_t *update = (idx >= 0) ? GetUpdate(idx) : Append(col_id);
       memcpy(update, updates_uint8
              + i*AbstractRowOpLog::update_size_,
              AbstractRowOpLog::update_size_);
     }
   }
+
 protected:
-  std::map<int32_t, uint8_t*> oplogs_;
+  static const size_t kMaxLinearScanSize = 16;
+  // Reset() frees rows that grew larger than this.
+  static const size_t kMaxRetainedSize = 64*1024;
+
+  static size_t Hash(int32_t col_id) {
+    return static_cast<uint32_t>(col_id)*2654435761U;
+  }
+
+  uint8_t *GetUpdate(size_t idx) const {
+    return const_cast<uint8_t*>(updates_.data()) + idx*update_size_;
+  }
+
+  int32_t FindIdx(int32_t col_id) const {
+    if (index_.empty()) {
+      for (size_t i = 0; i < column_ids_.size(); ++i) {
+        if (column_ids_[i] == col_id)
+          return i;
+      }
+      return -1;
+    }
+    size_t mask = index_.size() - 1;
+    for (size_t slot = Hash(col_id) & mask; index_[slot] >= 0;
+         slot = (slot + 1) & mask) {
+      if (column_ids_[index_[slot]] == col_id)
+        return index_[slot];
+    }
+    return -1;
+  }
+
+  // col_id must not be there yet. Returns its uninitialized update.
+  uint8_t *Append(int32_t col_id) {
+    if (!column_ids_.empty() && col_id < column_ids_.back())
+      sorted_ = false;
+    int32_t idx = column_ids_.size();
+    column_ids_.push_back(col_id);
+    updates_.resize(updates_.size() + update_size_);
+
+    if (!index_.empty() && column_ids_.size()*2 <= index_.size()) {
+      Insert(col_id, idx);
+    } else if (column_ids_.size() > kMaxLinearScanSize) {
+      RebuildIndex();
+    }
+    return GetUpdate(idx);
+  }
+
+  void Insert(int32_t col_id, int32_t idx) const {
+    size_t mask = index_.size() - 1;
+    size_t slot = Hash(col_id) & mask;
+    while (index_[slot] >= 0)
+      slot = (slot + 1) & mask;
+    index_[slot] = idx;
+  }
+
+  // Size the index for at most half full.
+  void RebuildIndex() const {
+    if (column_ids_.size() <= kMaxLinearScanSize) {
+      index_.clear();
+      return;
+    }
+    size_t index_size = 2*kMaxLinearScanSize;
+    while (index_size < column_ids_.size()*2)
+      index_size *= 2;
+    index_.assign(index_size, -1);
+    for (size_t i = 0; i < column_ids_.size(); ++i)
+      Insert(column_ids_[i], i);
+  }
+
+  // Order the updates by column id. Logically const.
+  void Sort() const {
+    if (sorted_)
+      return;
+    size_t num_updates = column_ids_.size();
+    sort_order_.resize(num_updates);
+    for (size_t i = 0; i < num_updates; ++i)
+      sort_order_[i] = i;
+    std::sort(sort_order_.begin(), sort_order_.end(),
+              [this] (int32_t idx1, int32_t idx2) {
+                return column_ids_[idx1] < column_ids_[idx2];
+              });
+
+    sort_column_ids_.resize(num_updates);
+    sort_updates_.resize(num_updates*update_size_);
+    for (size_t i = 0; i < num_updates; ++i) {
+      sort_column_ids_[i] = column_ids_[sort_order_[i]];
+      memcpy(sort_updates_.data() + i*update_size_,
+             GetUpdate(sort_order_[i]), update_size_);
+    }
+    column_ids_.swap(sort_column_ids_);
+    updates_.swap(sort_updates_);
+    sorted_ = true;
+    RebuildIndex();
+  }
+
   const InitUpdateFunc InitUpdate_;
   const CheckZeroUpdateFunc CheckZeroUpdate_;
-  std::map<int32_t, uint8_t*>::iterator iter_;
-  mutable std::map<int32_t, uint8_t*>::const_iterator const_iter_;
+
+  // Mutable as const traversal sorts them.
+  mutable std::vector<int32_t> column_ids_;
+  mutable std::vector<uint8_t> updates_;
+  // Positions in column_ids_, -1 for empty slots; empty if the row is small
+  // enough to be scanned. Size is a power of 2.
+  mutable std::vector<int32_t> index_;
+  mutable bool sorted_;
+
+  // Scratch space for Sort().
+  mutable std::vector<int32_t> sort_order_;
+  mutable std::vector<int32_t> sort_column_ids_;
+  mutable std::vector<uint8_t> sort_updates_;
+
+  mutable size_t iter_idx_;
 };
 }
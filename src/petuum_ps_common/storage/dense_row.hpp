@@ -18,20 +18,32 @@ public:
   DenseRow() { }
   ~DenseRow() { }
 
+  // Reads are lock-free; they retry if a writer got in between.
   V operator [](int32_t col_id) const {
-    std::unique_lock<std::mutex> lock(DenseRowCore<V>::mtx_);
-    return DenseRowCore<V>::store_.Get(col_id);
+    uint32_t seq;
+    V val;
+    do {
+      seq = DenseRowCore<V>::ReadBegin();
+      val = DenseRowCore<V>::store_.Get(col_id);
+    } while (DenseRowCore<V>::ReadRetry(seq));
+    return val;
   }
 
   // Bulk read. Thread-safe.
   void CopyToVector(std::vector<V> *to) const {
-    std::unique_lock<std::mutex> lock(DenseRowCore<V>::mtx_);
-    DenseRowCore<V>::store_.CopyToVector(to);
+    uint32_t seq;
+    do {
+      seq = DenseRowCore<V>::ReadBegin();
+      DenseRowCore<V>::store_.CopyToVector(to);
+    } while (DenseRowCore<V>::ReadRetry(seq));
   }
 
   void CopyToMem(void *to) const {
-    std::unique_lock<std::mutex> lock(DenseRowCore<V>::mtx_);
-    DenseRowCore<V>::store_.CopyToMem(to);
+    uint32_t seq;
+    do {
+      seq = DenseRowCore<V>::ReadBegin();
+      DenseRowCore<V>::store_.CopyToMem(to);
+    } while (DenseRowCore<V>::ReadRetry(seq));
   }
 
   // not thread-safe
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <petuum_ps_common/storage/ns_abstract_imp_calc.hpp>
+#include <petuum_ps_common/util/dense_kernels.hpp>
 
 namespace petuum {
 
@@ -82,19 +83,7 @@ double NSSumImpCalc<V>::ApplyDenseBatchIncGetImportance(
 
   V *val_array = store->GetPtr(index_st);
   const V *update_array = reinterpret_cast<const V*>(update_batch);
-  double accum_importance = 0;
-
-  for (int32_t i = 0; i < num_updates; ++i) {
-    V &val = val_array[i];
-    double importance //= double(update_array[i]);
-    = (double(val) == 0) ? double(update_array[i])
-          : double(update_array[i]) / double(val);
-    accum_importance += std::abs(importance);
-
-    val += update_array[i];
-  }
-
-  return accum_importance;
+  return DenseKernels::AddGetImportance(val_array, update_array, num_updates);
 }
 
 template<typename V>
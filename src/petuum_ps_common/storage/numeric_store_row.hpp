@@ -5,16 +5,39 @@
 #include <petuum_ps_common/storage/vector_store.hpp>
 #include <petuum_ps_common/storage/ns_sum_imp_calc.hpp>
 #include <petuum_ps_common/util/utils.hpp>
+#include <petuum_ps_common/util/dense_kernels.hpp>
 
 #include <mutex>
+#include <atomic>
 
 namespace petuum {
 
+template<typename V>
+struct UpdateValueTypeOf {
+  static const int32_t value = UpdateValueType::kOther;
+};
+
+template<>
+struct UpdateValueTypeOf<float> {
+  static const int32_t value = UpdateValueType::kFloat;
+};
+
+template<>
+struct UpdateValueTypeOf<double> {
+  static const int32_t value = UpdateValueType::kDouble;
+};
+
+template<>
+struct UpdateValueTypeOf<int32_t> {
+  static const int32_t value = UpdateValueType::kInt32;
+};
+
 template<template<typename> class StoreType, typename V,
          template<typename> class ImpCalc = NSSumImpCalc >
 class NumericStoreRow : public AbstractRow {
 public:
-  NumericStoreRow() { }
+  NumericStoreRow():
+      seq_(0) { }
   virtual ~NumericStoreRow() { }
 
   void Init(size_t capacity);
@@ -92,8 +115,50 @@ public:
 
   virtual bool CheckZeroUpdate(const void *update) const;
 
+  virtual int32_t get_update_value_type() const {
+    return UpdateValueTypeOf<V>::value;
+  }
+
 protected:
+  // Writers hold mtx_ and make seq_ odd for the duration of the write, so
+  // readers can copy data without locking and retry if seq_ changed:
+  //
+  //   uint32_t seq;
+  //   do {
+  //     seq = ReadBegin();
+  //     ... read store_ ...
+  //   } while (ReadRetry(seq));
+  //
+  // Only valid for stores whose layout does not change under concurrent
+  // writes (e.g. VectorStore).
+  void WriteBegin() const {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void WriteEnd() const {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+  }
+
+  uint32_t ReadBegin() const {
+    uint32_t seq;
+    while ((seq = seq_.load(std::memory_order_acquire)) & 1) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+    return seq;
+  }
+
+  bool ReadRetry(uint32_t seq) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq_.load(std::memory_order_relaxed) != seq;
+  }
+
   mutable std::mutex mtx_;
+  mutable std::atomic<uint32_t> seq_;
   StoreType<V> store_;
   ImpCalc<V> imp_cal_;
 };
@@ -147,11 +212,13 @@ template<template<typename> class StoreType, typename V,
          template<typename> class ImpCalc>
 void NumericStoreRow<StoreType, V, ImpCalc>::GetWriteLock() const {
   mtx_.lock();
+  WriteBegin();
 }
 
 template<template<typename> class StoreType, typename V,
          template<typename> class ImpCalc>
 void NumericStoreRow<StoreType, V, ImpCalc>::ReleaseWriteLock() const {
+  WriteEnd();
   mtx_.unlock();
 }
 
@@ -178,17 +245,16 @@ void NumericStoreRow<StoreType, V, ImpCalc>::ApplyDenseBatchIncUnsafe(
     const void* update_batch, int32_t index_st, int32_t num_updates) {
   V *val_array = store_.GetPtr(index_st);
   const V *update_array = reinterpret_cast<const V*>(update_batch);
-
-  for (int32_t i = 0; i < num_updates; ++i) {
-    val_array[i] += update_array[i];
-  }
+  DenseKernels::Add(val_array, update_array, num_updates);
 }
 
 template<template<typename> class StoreType, typename V,
          template<typename> class ImpCalc>
 void NumericStoreRow<StoreType, V, ImpCalc>::ApplyInc(int32_t column_id, const void *update) {
   std::unique_lock<std::mutex> lock(mtx_);
+  WriteBegin();
   ApplyIncUnsafe(column_id, update);
+  WriteEnd();
 }
 
 template<template<typename> class StoreType, typename V,
@@ -197,7 +263,9 @@ void NumericStoreRow<StoreType, V, ImpCalc>::ApplyBatchInc(
     const int32_t *column_ids,
     const void* update_batch, int32_t num_updates) {
   std::unique_lock<std::mutex> lock(mtx_);
+  WriteBegin();
   ApplyBatchIncUnsafe(column_ids, update_batch, num_updates);
+  WriteEnd();
 }
 
 template<template<typename> class StoreType, typename V,
@@ -205,7 +273,9 @@ template<template<typename> class StoreType, typename V,
 void NumericStoreRow<StoreType, V, ImpCalc>::ApplyDenseBatchInc(
     const void* update_batch, int32_t index_st, int32_t num_updates) {
   std::unique_lock<std::mutex> lock(mtx_);
+  WriteBegin();
   ApplyDenseBatchIncUnsafe(update_batch, index_st, num_updates);
+  WriteEnd();
 }
 
 template<template<typename> class StoreType, typename V,
@@ -237,7 +307,10 @@ template<template<typename> class StoreType, typename V,
 double NumericStoreRow<StoreType, V, ImpCalc>::ApplyIncGetImportance(int32_t column_id,
                                               const void *update) {
   std::unique_lock<std::mutex> lock(mtx_);
-  return ApplyIncUnsafeGetImportance(column_id, update);
+  WriteBegin();
+  double importance = ApplyIncUnsafeGetImportance(column_id, update);
+  WriteEnd();
+  return importance;
 }
 
 template<template<typename> class StoreType, typename V,
@@ -245,7 +318,10 @@ template<template<typename> class StoreType, typename V,
 double NumericStoreRow<StoreType, V, ImpCalc>::ApplyBatchIncGetImportance(
     const int32_t *column_ids, const void* update_batch, int32_t num_updates) {
   std::unique_lock<std::mutex> lock(mtx_);
-  return ApplyBatchIncUnsafeGetImportance(column_ids, update_batch, num_updates);
+  WriteBegin();
+  double importance = ApplyBatchIncUnsafeGetImportance(column_ids, update_batch, num_updates);
+  WriteEnd();
+  return importance;
 }
 
 template<template<typename> class StoreType, typename V,
@@ -253,7 +329,10 @@ template<template<typename> class StoreType, typename V,
 double NumericStoreRow<StoreType, V, ImpCalc>::ApplyDenseBatchIncGetImportance(
     const void* update_batch, int32_t index_st, int32_t num_updates) {
   std::unique_lock<std::mutex> lock(mtx_);
-  return ApplyDenseBatchIncUnsafeGetImportance(update_batch, index_st, num_updates);
+  WriteBegin();
+  double importance = ApplyDenseBatchIncUnsafeGetImportance(update_batch, index_st, num_updates);
+  WriteEnd();
+  return importance;
 }
 
 template<template<typename> class StoreType, typename V,
@@ -7,6 +7,7 @@
 
 #include <petuum_ps_common/storage/abstract_store.hpp>
 #include <petuum_ps_common/storage/abstract_store_iterator.hpp>
+#include <petuum_ps_common/util/dense_kernels.hpp>
 namespace petuum {
 // V must be float.
 // When Init(), memory is zero-ed out.
@@ -83,17 +84,13 @@ void VectorStoreFloat16<V>::Deserialize(const void *data, size_t num_bytes) {
   size_t num_entries = num_bytes / sizeof(uint16_t);
   data_.resize(num_entries);
   const uint16_t *typed_mem = reinterpret_cast<const uint16_t*>(data);
-  for (int i = 0; i < data_.size(); ++i) {
-    data_[i] = Float16Compressor::decompress(typed_mem[i]);
-  }
+  DenseKernels::DecompressFloat16(data_.data(), typed_mem, data_.size());
 }
 
 template<typename V>
 void VectorStoreFloat16<V>::ResetData(const void *data, size_t num_bytes) {
   const uint16_t *typed_mem = reinterpret_cast<const uint16_t*>(data);
-  for (int i = 0; i < data_.size(); ++i) {
-    data_[i] = Float16Compressor::decompress(typed_mem[i]);
-  }
+  DenseKernels::DecompressFloat16(data_.data(), typed_mem, data_.size());
 }
 
 template<typename V>
@@ -39,6 +39,8 @@ enum MsgType {
   kEarlyCommOff = 24,
   kBgServerPushRowAck = 25,
   kAdjustSuppressionLevel = 26,
+  kBatchRowRequest = 27,
+  kServerBatchRowRequestReply = 28,
   kMemTransfer = 50,
   kNonExist = 100
 };
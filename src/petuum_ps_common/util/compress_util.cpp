@@ -0,0 +1,24 @@
+#include <petuum_ps_common/util/compress_util.hpp>
+
+#include <cstring>
+
+namespace petuum {
+
+uint16_t CompressUtil::FloatToBFloat16(float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  // NaN: keep it a (quiet) NaN after truncation.
+  if ((bits & 0x7fffffff) > 0x7f800000)
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  uint32_t rounding_bias = 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>((bits + rounding_bias) >> 16);
+}
+
+float CompressUtil::BFloat16ToFloat(uint16_t v) {
+  uint32_t bits = static_cast<uint32_t>(v) << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+}  // namespace petuum
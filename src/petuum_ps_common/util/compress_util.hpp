@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace petuum {
+
+// Building blocks for message compression: LEB128 varints, zigzag coding
+// for signed deltas and bfloat16 conversion.
+class CompressUtil {
+public:
+  static uint32_t ZigZagEncode(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+  }
+
+  static int32_t ZigZagDecode(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+  }
+
+  // Writes at most kMaxVarint32Size bytes; returns the byte past the value.
+  static uint8_t *PutVarint32(uint8_t *to, uint32_t v) {
+    while (v >= 0x80) {
+      *(to++) = static_cast<uint8_t>(v | 0x80);
+      v >>= 7;
+    }
+    *(to++) = static_cast<uint8_t>(v);
+    return to;
+  }
+
+  static const uint8_t *GetVarint32(const uint8_t *from, uint32_t *v) {
+    uint32_t result = 0;
+    for (int32_t shift = 0; shift < 35; shift += 7) {
+      uint32_t byte = *(from++);
+      result |= (byte & 0x7f) << shift;
+      if (byte < 0x80)
+        break;
+    }
+    *v = result;
+    return from;
+  }
+
+  // bfloat16 keeps float's 8-bit exponent and rounds the mantissa to 7 bits
+  // (round to nearest even).
+  static uint16_t FloatToBFloat16(float v);
+  static float BFloat16ToFloat(uint16_t v);
+
+  static const size_t kMaxVarint32Size = 5;
+};
+
+// Turns compression off for a while once it stops paying. After an attempt
+// that saves less than 1/kMinSavingDenom of the raw size, the next attempts
+// are skipped, twice as many after each consecutive failure (up to
+// kMaxBackoff), then compression is probed again.
+class CompressGate {
+public:
+  CompressGate():
+      num_to_skip_(0),
+      backoff_(1) { }
+
+  bool ShouldTry() {
+    if (num_to_skip_ == 0)
+      return true;
+    --num_to_skip_;
+    return false;
+  }
+
+  // Returns true if compressed_size is worth sending instead of raw_size.
+  bool Report(size_t raw_size, size_t compressed_size) {
+    if (compressed_size + raw_size / kMinSavingDenom <= raw_size) {
+      backoff_ = 1;
+      return true;
+    }
+    num_to_skip_ = backoff_;
+    if (backoff_ < kMaxBackoff)
+      backoff_ *= 2;
+    return false;
+  }
+
+private:
+  static const size_t kMinSavingDenom = 8;
+  static const int32_t kMaxBackoff = 64;
+
+  int32_t num_to_skip_;
+  int32_t backoff_;
+};
+
+}  // namespace petuum
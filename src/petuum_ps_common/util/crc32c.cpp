@@ -0,0 +1,83 @@
+#include <petuum_ps_common/util/crc32c.hpp>
+
+#include <string.h>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace petuum {
+
+namespace {
+
+const uint32_t kCRC32CPoly = 0x82f63b78;
+
+struct CRC32CTable {
+  uint32_t table[8][256];
+
+  CRC32CTable() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int j = 0; j < 8; ++j)
+        crc = (crc & 1) ? (crc >> 1) ^ kCRC32CPoly : (crc >> 1);
+      table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int k = 1; k < 8; ++k) {
+        table[k][i] = (table[k - 1][i] >> 8)
+                      ^ table[0][table[k - 1][i] & 0xff];
+      }
+    }
+  }
+};
+
+// Function-local static is initialized once in a thread-safe manner.
+const CRC32CTable &GetTable() {
+  static const CRC32CTable crc_table;
+  return crc_table;
+}
+
+}  // anonymous namespace
+
+uint32_t CRC32C::Extend(uint32_t crc, const void *data, size_t size) {
+  const uint8_t *p = reinterpret_cast<const uint8_t*>(data);
+  uint32_t c = ~crc;
+
+#ifdef __SSE4_2__
+  while (size >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(uint64_t));
+    c = static_cast<uint32_t>(_mm_crc32_u64(c, word));
+    p += sizeof(uint64_t);
+    size -= sizeof(uint64_t);
+  }
+  while (size > 0) {
+    c = _mm_crc32_u8(c, *p);
+    ++p;
+    --size;
+  }
+#else
+  const CRC32CTable &t = GetTable();
+  while (size >= sizeof(uint64_t)) {
+    uint32_t lo, hi;
+    memcpy(&lo, p, sizeof(uint32_t));
+    memcpy(&hi, p + sizeof(uint32_t), sizeof(uint32_t));
+    lo ^= c;
+    c = t.table[7][lo & 0xff] ^ t.table[6][(lo >> 8) & 0xff]
+        ^ t.table[5][(lo >> 16) & 0xff] ^ t.table[4][lo >> 24]
+        ^ t.table[3][hi & 0xff] ^ t.table[2][(hi >> 8) & 0xff]
+        ^ t.table[1][(hi >> 16) & 0xff] ^ t.table[0][hi >> 24];
+    p += sizeof(uint64_t);
+    size -= sizeof(uint64_t);
+  }
+  while (size > 0) {
+    c = t.table[0][(c ^ *p) & 0xff] ^ (c >> 8);
+    ++p;
+    --size;
+  }
+#endif
+
+  return ~c;
+}
+
+}  // namespace petuum
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace petuum {
+
+// CRC-32C (Castagnoli). Uses the SSE4.2 crc32 instruction when the build
+// enables it and a slicing-by-8 table otherwise. The two paths produce
+// identical checksums so files written by one can be verified by the other.
+class CRC32C {
+public:
+  // Extend crc with data[0, size). Pass 0 as crc to start a new checksum.
+  static uint32_t Extend(uint32_t crc, const void *data, size_t size);
+
+  static uint32_t Value(const void *data, size_t size) {
+    return Extend(0, data, size);
+  }
+};
+
+}  // namespace petuum
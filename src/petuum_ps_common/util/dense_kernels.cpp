@@ -0,0 +1,412 @@
+#include <petuum_ps_common/util/dense_kernels.hpp>
+
+#include <float16_compressor.hpp>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PETUUM_DENSE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace petuum {
+
+namespace {
+
+typedef void (*AddFloatFunc)(float *vals, const float *updates, int32_t num);
+typedef void (*AddDoubleFunc)(double *vals, const double *updates,
+                              int32_t num);
+typedef void (*AddInt32Func)(int32_t *vals, const int32_t *updates,
+                             int32_t num);
+typedef double (*AddGetImportanceFloatFunc)(
+    float *vals, const float *updates, int32_t num);
+typedef double (*AddGetImportanceDoubleFunc)(
+    double *vals, const double *updates, int32_t num);
+typedef double (*AddGetImportanceInt32Func)(
+    int32_t *vals, const int32_t *updates, int32_t num);
+typedef void (*DecompressFloat16Func)(float *to, const uint16_t *from,
+                                      int32_t num);
+
+template<typename V>
+void AddScalar(V *vals, const V *updates, int32_t num) {
+  DenseKernels::Add<V>(vals, updates, num);
+}
+
+template<typename V>
+double AddGetImportanceScalar(V *vals, const V *updates, int32_t num) {
+  return DenseKernels::AddGetImportance<V>(vals, updates, num);
+}
+
+void DecompressFloat16Scalar(float *to, const uint16_t *from, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    to[i] = Float16Compressor::decompress(from[i]);
+  }
+}
+
+#ifdef PETUUM_DENSE_KERNELS_X86
+
+// ============================ SSE2 ============================
+
+#define PETUUM_TARGET_SSE2 __attribute__((target("sse2")))
+
+// |v == 0 ? u : u / v| for two doubles, added to accum.
+PETUUM_TARGET_SSE2 inline __m128d AccumImportanceSSE2(
+    __m128d accum, __m128d v, __m128d u) {
+  const __m128d sign_mask = _mm_set1_pd(-0.0);
+  __m128d zero_mask = _mm_cmpeq_pd(v, _mm_setzero_pd());
+  __m128d ratio = _mm_div_pd(u, v);
+  __m128d importance = _mm_or_pd(_mm_and_pd(zero_mask, u),
+                                 _mm_andnot_pd(zero_mask, ratio));
+  return _mm_add_pd(accum, _mm_andnot_pd(sign_mask, importance));
+}
+
+PETUUM_TARGET_SSE2 inline double HorizontalSumSSE2(__m128d accum) {
+  double sum[2];
+  _mm_storeu_pd(sum, accum);
+  return sum[0] + sum[1];
+}
+
+PETUUM_TARGET_SSE2 void AddFloatSSE2(
+    float *vals, const float *updates, int32_t num) {
+  int32_t i = 0;
+  for (; i + 4 <= num; i += 4) {
+    __m128 v = _mm_loadu_ps(vals + i);
+    __m128 u = _mm_loadu_ps(updates + i);
+    _mm_storeu_ps(vals + i, _mm_add_ps(v, u));
+  }
+  AddScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_SSE2 void AddDoubleSSE2(
+    double *vals, const double *updates, int32_t num) {
+  int32_t i = 0;
+  for (; i + 2 <= num; i += 2) {
+    __m128d v = _mm_loadu_pd(vals + i);
+    __m128d u = _mm_loadu_pd(updates + i);
+    _mm_storeu_pd(vals + i, _mm_add_pd(v, u));
+  }
+  AddScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_SSE2 void AddInt32SSE2(
+    int32_t *vals, const int32_t *updates, int32_t num) {
+  int32_t i = 0;
+  for (; i + 4 <= num; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vals + i));
+    __m128i u = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(updates + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(vals + i),
+                     _mm_add_epi32(v, u));
+  }
+  AddScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_SSE2 double AddGetImportanceFloatSSE2(
+    float *vals, const float *updates, int32_t num) {
+  __m128d accum = _mm_setzero_pd();
+  int32_t i = 0;
+  for (; i + 4 <= num; i += 4) {
+    __m128 v = _mm_loadu_ps(vals + i);
+    __m128 u = _mm_loadu_ps(updates + i);
+    accum = AccumImportanceSSE2(accum, _mm_cvtps_pd(v), _mm_cvtps_pd(u));
+    accum = AccumImportanceSSE2(accum, _mm_cvtps_pd(_mm_movehl_ps(v, v)),
+                                _mm_cvtps_pd(_mm_movehl_ps(u, u)));
+    _mm_storeu_ps(vals + i, _mm_add_ps(v, u));
+  }
+  return HorizontalSumSSE2(accum)
+      + AddGetImportanceScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_SSE2 double AddGetImportanceDoubleSSE2(
+    double *vals, const double *updates, int32_t num) {
+  __m128d accum = _mm_setzero_pd();
+  int32_t i = 0;
+  for (; i + 2 <= num; i += 2) {
+    __m128d v = _mm_loadu_pd(vals + i);
+    __m128d u = _mm_loadu_pd(updates + i);
+    accum = AccumImportanceSSE2(accum, v, u);
+    _mm_storeu_pd(vals + i, _mm_add_pd(v, u));
+  }
+  return HorizontalSumSSE2(accum)
+      + AddGetImportanceScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_SSE2 double AddGetImportanceInt32SSE2(
+    int32_t *vals, const int32_t *updates, int32_t num) {
+  __m128d accum = _mm_setzero_pd();
+  int32_t i = 0;
+  for (; i + 4 <= num; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vals + i));
+    __m128i u = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(updates + i));
+    accum = AccumImportanceSSE2(accum, _mm_cvtepi32_pd(v),
+                                _mm_cvtepi32_pd(u));
+    accum = AccumImportanceSSE2(accum,
+                                _mm_cvtepi32_pd(_mm_srli_si128(v, 8)),
+                                _mm_cvtepi32_pd(_mm_srli_si128(u, 8)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(vals + i),
+                     _mm_add_epi32(v, u));
+  }
+  return HorizontalSumSSE2(accum)
+      + AddGetImportanceScalar(vals + i, updates + i, num - i);
+}
+
+// ============================ AVX2 ============================
+
+#define PETUUM_TARGET_AVX2 __attribute__((target("avx2")))
+
+PETUUM_TARGET_AVX2 inline __m256d AccumImportanceAVX2(
+    __m256d accum, __m256d v, __m256d u) {
+  const __m256d sign_mask = _mm256_set1_pd(-0.0);
+  __m256d zero_mask = _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_EQ_OQ);
+  __m256d importance = _mm256_blendv_pd(_mm256_div_pd(u, v), u, zero_mask);
+  return _mm256_add_pd(accum, _mm256_andnot_pd(sign_mask, importance));
+}
+
+PETUUM_TARGET_AVX2 inline double HorizontalSumAVX2(__m256d accum) {
+  double sum[4];
+  _mm256_storeu_pd(sum, accum);
+  return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+PETUUM_TARGET_AVX2 void AddFloatAVX2(
+    float *vals, const float *updates, int32_t num) {
+  int32_t i = 0;
+  for (; i + 16 <= num; i += 16) {
+    __m256 v0 = _mm256_loadu_ps(vals + i);
+    __m256 v1 = _mm256_loadu_ps(vals + i + 8);
+    __m256 u0 = _mm256_loadu_ps(updates + i);
+    __m256 u1 = _mm256_loadu_ps(updates + i + 8);
+    _mm256_storeu_ps(vals + i, _mm256_add_ps(v0, u0));
+    _mm256_storeu_ps(vals + i + 8, _mm256_add_ps(v1, u1));
+  }
+  for (; i + 8 <= num; i += 8) {
+    __m256 v = _mm256_loadu_ps(vals + i);
+    __m256 u = _mm256_loadu_ps(updates + i);
+    _mm256_storeu_ps(vals + i, _mm256_add_ps(v, u));
+  }
+  AddScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_AVX2 void AddDoubleAVX2(
+    double *vals, const double *updates, int32_t num) {
+  int32_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m256d v0 = _mm256_loadu_pd(vals + i);
+    __m256d v1 = _mm256_loadu_pd(vals + i + 4);
+    __m256d u0 = _mm256_loadu_pd(updates + i);
+    __m256d u1 = _mm256_loadu_pd(updates + i + 4);
+    _mm256_storeu_pd(vals + i, _mm256_add_pd(v0, u0));
+    _mm256_storeu_pd(vals + i + 4, _mm256_add_pd(v1, u1));
+  }
+  for (; i + 4 <= num; i += 4) {
+    __m256d v = _mm256_loadu_pd(vals + i);
+    __m256d u = _mm256_loadu_pd(updates + i);
+    _mm256_storeu_pd(vals + i, _mm256_add_pd(v, u));
+  }
+  AddScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_AVX2 void AddInt32AVX2(
+    int32_t *vals, const int32_t *updates, int32_t num) {
+  int32_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(vals + i));
+    __m256i u = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(updates + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(vals + i),
+                        _mm256_add_epi32(v, u));
+  }
+  AddScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_AVX2 double AddGetImportanceFloatAVX2(
+    float *vals, const float *updates, int32_t num) {
+  __m256d accum = _mm256_setzero_pd();
+  int32_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m256 v = _mm256_loadu_ps(vals + i);
+    __m256 u = _mm256_loadu_ps(updates + i);
+    accum = AccumImportanceAVX2(
+        accum, _mm256_cvtps_pd(_mm256_castps256_ps128(v)),
+        _mm256_cvtps_pd(_mm256_castps256_ps128(u)));
+    accum = AccumImportanceAVX2(
+        accum, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)),
+        _mm256_cvtps_pd(_mm256_extractf128_ps(u, 1)));
+    _mm256_storeu_ps(vals + i, _mm256_add_ps(v, u));
+  }
+  return HorizontalSumAVX2(accum)
+      + AddGetImportanceScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_AVX2 double AddGetImportanceDoubleAVX2(
+    double *vals, const double *updates, int32_t num) {
+  __m256d accum = _mm256_setzero_pd();
+  int32_t i = 0;
+  for (; i + 4 <= num; i += 4) {
+    __m256d v = _mm256_loadu_pd(vals + i);
+    __m256d u = _mm256_loadu_pd(updates + i);
+    accum = AccumImportanceAVX2(accum, v, u);
+    _mm256_storeu_pd(vals + i, _mm256_add_pd(v, u));
+  }
+  return HorizontalSumAVX2(accum)
+      + AddGetImportanceScalar(vals + i, updates + i, num - i);
+}
+
+PETUUM_TARGET_AVX2 double AddGetImportanceInt32AVX2(
+    int32_t *vals, const int32_t *updates, int32_t num) {
+  __m256d accum = _mm256_setzero_pd();
+  int32_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(vals + i));
+    __m256i u = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(updates + i));
+    accum = AccumImportanceAVX2(
+        accum, _mm256_cvtepi32_pd(_mm256_castsi256_si128(v)),
+        _mm256_cvtepi32_pd(_mm256_castsi256_si128(u)));
+    accum = AccumImportanceAVX2(
+        accum, _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)),
+        _mm256_cvtepi32_pd(_mm256_extracti128_si256(u, 1)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(vals + i),
+                        _mm256_add_epi32(v, u));
+  }
+  return HorizontalSumAVX2(accum)
+      + AddGetImportanceScalar(vals + i, updates + i, num - i);
+}
+
+__attribute__((target("avx,f16c"))) void DecompressFloat16F16C(
+    float *to, const uint16_t *from, int32_t num) {
+  int32_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+    _mm256_storeu_ps(to + i, _mm256_cvtph_ps(h));
+  }
+  DecompressFloat16Scalar(to + i, from + i, num - i);
+}
+
+#endif  // PETUUM_DENSE_KERNELS_X86
+
+struct KernelTable {
+  AddFloatFunc AddFloat;
+  AddDoubleFunc AddDouble;
+  AddInt32Func AddInt32;
+  AddGetImportanceFloatFunc AddGetImportanceFloat;
+  AddGetImportanceDoubleFunc AddGetImportanceDouble;
+  AddGetImportanceInt32Func AddGetImportanceInt32;
+  DecompressFloat16Func DecompressFloat16;
+  const char *name;
+
+  KernelTable() {
+    SetScalar();
+#ifdef PETUUM_DENSE_KERNELS_X86
+    if (!Select("avx2"))
+      Select("sse2");
+    // F16C decodes IEEE half exactly, same as Float16Compressor.
+    if (SupportsF16C())
+      DecompressFloat16 = DecompressFloat16F16C;
+#endif
+  }
+
+  void SetScalar() {
+    AddFloat = AddScalar<float>;
+    AddDouble = AddScalar<double>;
+    AddInt32 = AddScalar<int32_t>;
+    AddGetImportanceFloat = AddGetImportanceScalar<float>;
+    AddGetImportanceDouble = AddGetImportanceScalar<double>;
+    AddGetImportanceInt32 = AddGetImportanceScalar<int32_t>;
+    DecompressFloat16 = DecompressFloat16Scalar;
+    name = "scalar";
+  }
+
+#ifdef PETUUM_DENSE_KERNELS_X86
+  static bool SupportsF16C() {
+    return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+  }
+#endif
+
+  // "avx2" comes with F16C decompression, the others with the scalar one.
+  bool Select(const std::string &kernel_name) {
+    if (kernel_name == "scalar") {
+      SetScalar();
+      return true;
+    }
+#ifdef PETUUM_DENSE_KERNELS_X86
+    __builtin_cpu_init();
+    if (kernel_name == "avx2" && __builtin_cpu_supports("avx2")
+        && SupportsF16C()) {
+      AddFloat = AddFloatAVX2;
+      AddDouble = AddDoubleAVX2;
+      AddInt32 = AddInt32AVX2;
+      AddGetImportanceFloat = AddGetImportanceFloatAVX2;
+      AddGetImportanceDouble = AddGetImportanceDoubleAVX2;
+      AddGetImportanceInt32 = AddGetImportanceInt32AVX2;
+      DecompressFloat16 = DecompressFloat16F16C;
+      name = "avx2";
+      return true;
+    }
+    if (kernel_name == "sse2" && __builtin_cpu_supports("sse2")) {
+      AddFloat = AddFloatSSE2;
+      AddDouble = AddDoubleSSE2;
+      AddInt32 = AddInt32SSE2;
+      AddGetImportanceFloat = AddGetImportanceFloatSSE2;
+      AddGetImportanceDouble = AddGetImportanceDoubleSSE2;
+      AddGetImportanceInt32 = AddGetImportanceInt32SSE2;
+      DecompressFloat16 = DecompressFloat16Scalar;
+      name = "sse2";
+      return true;
+    }
+#endif
+    return false;
+  }
+};
+
+// Function-local static is initialized once in a thread-safe manner.
+KernelTable &GetKernelTable() {
+  static KernelTable kernel_table;
+  return kernel_table;
+}
+
+}  // anonymous namespace
+
+void DenseKernels::Add(float *vals, const float *updates, int32_t num) {
+  GetKernelTable().AddFloat(vals, updates, num);
+}
+
+void DenseKernels::Add(double *vals, const double *updates, int32_t num) {
+  GetKernelTable().AddDouble(vals, updates, num);
+}
+
+void DenseKernels::Add(int32_t *vals, const int32_t *updates, int32_t num) {
+  GetKernelTable().AddInt32(vals, updates, num);
+}
+
+double DenseKernels::AddGetImportance(float *vals, const float *updates,
+                                      int32_t num) {
+  return GetKernelTable().AddGetImportanceFloat(vals, updates, num);
+}
+
+double DenseKernels::AddGetImportance(double *vals, const double *updates,
+                                      int32_t num) {
+  return GetKernelTable().AddGetImportanceDouble(vals, updates, num);
+}
+
+double DenseKernels::AddGetImportance(int32_t *vals, const int32_t *updates,
+                                      int32_t num) {
+  return GetKernelTable().AddGetImportanceInt32(vals, updates, num);
+}
+
+void DenseKernels::DecompressFloat16(float *to, const uint16_t *from,
+                                     int32_t num) {
+  GetKernelTable().DecompressFloat16(to, from, num);
+}
+
+const char *DenseKernels::GetKernelName() {
+  return GetKernelTable().name;
+}
+
+bool DenseKernels::SelectKernels(const std::string &kernel_name) {
+  return GetKernelTable().Select(kernel_name);
+}
+
+}  // namespace petuum
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cmath>
+#include <string>
+
+namespace petuum {
+
+// Kernels for applying dense update batches to contiguous row storage.
+// float, double and int32_t have vectorized versions (AVX2 or SSE2, picked
+// at runtime from the CPU we run on, with a scalar fallback elsewhere);
+// other value types use the generic scalar templates.
+//
+// Importance follows NSSumImpCalc: |update / val| of the value before the
+// update, or |update| if the value is 0. Vectorized kernels accumulate in a
+// different order than the scalar loop, so the sums may differ in the last
+// bits.
+class DenseKernels {
+public:
+  // vals[i] += updates[i] for i in [0, num).
+  template<typename V>
+  static void Add(V *vals, const V *updates, int32_t num) {
+    for (int32_t i = 0; i < num; ++i) {
+      vals[i] += updates[i];
+    }
+  }
+
+  static void Add(float *vals, const float *updates, int32_t num);
+  static void Add(double *vals, const double *updates, int32_t num);
+  static void Add(int32_t *vals, const int32_t *updates, int32_t num);
+
+  // Same as Add() but also returns the accumulated importance.
+  template<typename V>
+  static double AddGetImportance(V *vals, const V *updates, int32_t num) {
+    double accum_importance = 0;
+    for (int32_t i = 0; i < num; ++i) {
+      double importance = (double(vals[i]) == 0) ? double(updates[i])
+                          : double(updates[i]) / double(vals[i]);
+      accum_importance += std::abs(importance);
+      vals[i] += updates[i];
+    }
+    return accum_importance;
+  }
+
+  static double AddGetImportance(float *vals, const float *updates,
+                                 int32_t num);
+  static double AddGetImportance(double *vals, const double *updates,
+                                 int32_t num);
+  static double AddGetImportance(int32_t *vals, const int32_t *updates,
+                                 int32_t num);
+
+  // Expand IEEE half-precision values to float.
+  static void DecompressFloat16(float *to, const uint16_t *from,
+                                int32_t num);
+
+  // Name of the kernel set selected for this CPU ("avx2", "sse2" or
+  // "scalar").
+  static const char *GetKernelName();
+
+  // Use the named kernel set instead of the one picked for this CPU.
+  // Returns false, changing nothing, if the CPU does not support it. Not
+  // thread-safe with concurrent kernel calls; meant for tests and
+  // benchmarks.
+  static bool SelectKernels(const std::string &kernel_name);
+};
+
+}  // namespace petuum
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glog/logging.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+
+namespace petuum {
+
+// A piece of a byte string held in several pieces of memory, such as the
+// frames of a multipart message.
+struct MemSegment {
+  const uint8_t *mem;
+  size_t size;
+
+  MemSegment():
+      mem(0),
+      size(0) { }
+
+  MemSegment(const void *_mem, size_t _size):
+      mem(reinterpret_cast<const uint8_t*>(_mem)),
+      size(_size) { }
+};
+
+// Sequential reader of a byte string held in MemSegments. Items returned
+// by pointer must not be split across segments; fixed-size values and
+// Skip() may be. Does not own the memory.
+class MemSegmentReader {
+public:
+  MemSegmentReader(const MemSegment *segments, size_t num_segments):
+      segment_(segments),
+      segments_end_(segments + num_segments),
+      offset_(0),
+      num_read_(0) { }
+
+  // Bytes left in the current segment, moving past exhausted segments
+  // first. 0 once all is read.
+  size_t GetContiguousSize() {
+    while (segment_ != segments_end_ && offset_ == segment_->size) {
+      ++segment_;
+      offset_ = 0;
+    }
+    return (segment_ == segments_end_) ? 0 : segment_->size - offset_;
+  }
+
+  // The next byte to read.
+  const uint8_t *GetPtr() {
+    CHECK_GT(GetContiguousSize(), 0) << "read past the end";
+    return segment_->mem + offset_;
+  }
+
+  // size bytes past GetPtr(), which must be in the same segment.
+  void Advance(size_t size) {
+    CHECK_LE(size, GetContiguousSize()) << "item split across segments";
+    offset_ += size;
+    num_read_ += size;
+  }
+
+  template<typename T>
+  T Read() {
+    T val;
+    Copy(&val, sizeof(T));
+    return val;
+  }
+
+  void Copy(void *to, size_t size) {
+    uint8_t *dst = reinterpret_cast<uint8_t*>(to);
+    while (size > 0) {
+      size_t copy_size = std::min(size, GetContiguousSize());
+      CHECK_GT(copy_size, 0) << "read past the end";
+      memcpy(dst, segment_->mem + offset_, copy_size);
+      dst += copy_size;
+      Advance(copy_size);
+      size -= copy_size;
+    }
+  }
+
+  void Skip(size_t size) {
+    while (size > 0) {
+      size_t skip_size = std::min(size, GetContiguousSize());
+      CHECK_GT(skip_size, 0) << "read past the end";
+      Advance(skip_size);
+      size -= skip_size;
+    }
+  }
+
+  size_t get_num_read() const {
+    return num_read_;
+  }
+
+private:
+  const MemSegment *segment_;
+  const MemSegment *segments_end_;
+  size_t offset_;
+  size_t num_read_;
+};
+
+}  // namespace petuum
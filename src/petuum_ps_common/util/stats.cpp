@@ -6,6 +6,7 @@
 #include <glog/logging.h>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
 namespace petuum {
 TableGroupConfig Stats::table_group_config_;
@@ -49,6 +50,10 @@ double Stats::app_accum_tg_clock_sec_ = 0;
 std::vector<double> Stats::app_accum_append_only_flush_oplog_sec_;
 std::vector<size_t> Stats::app_append_only_flush_oplog_count_;
 
+std::vector<size_t> Stats::app_num_row_oplog_created_;
+std::vector<size_t> Stats::app_num_row_oplog_recycled_;
+size_t Stats::app_max_row_oplog_in_use_ = 0;
+
 double Stats::bg_accum_clock_end_oplog_serialize_sec_ = 0;
 double Stats::bg_accum_total_oplog_serialize_sec_ = 0;
 double Stats::bg_accum_server_push_row_apply_sec_ = 0;
@@ -123,6 +128,19 @@ std::vector<size_t> Stats::server_accum_num_waits_on_ack_clock_(0);
 
 std::map<int32_t, ServerLogicStats> Stats::server_table_logic_stats_;
 
+std::vector<double> Stats::server_accum_snapshot_stall_sec_;
+std::vector<double> Stats::server_accum_snapshot_write_sec_;
+std::vector<double> Stats::server_accum_snapshot_mb_;
+std::vector<size_t> Stats::server_accum_num_snapshots_;
+std::vector<double> Stats::server_accum_resume_sec_;
+std::vector<double> Stats::server_accum_resume_mb_;
+
+std::vector<double> Stats::server_thread_oplog_recv_mb_;
+std::vector<size_t> Stats::server_thread_oplog_rows_;
+
+std::vector<size_t> Stats::server_row_delta_replies_;
+std::vector<double> Stats::server_row_delta_saved_mb_;
+
 void Stats::Init(const TableGroupConfig &table_group_config) {
   table_group_config_ = table_group_config;
 
@@ -306,6 +324,13 @@ void Stats::DeregisterAppThread() {
 
   app_append_only_flush_oplog_count_.push_back(
       app_thread_stats_->append_only_flush_oplog_count);
+
+  app_num_row_oplog_created_.push_back(
+      app_thread_stats_->num_row_oplog_created);
+  app_num_row_oplog_recycled_.push_back(
+      app_thread_stats_->num_row_oplog_recycled);
+  app_max_row_oplog_in_use_ = std::max(
+      app_max_row_oplog_in_use_, app_thread_stats_->max_row_oplog_in_use);
 }
 
 void Stats::DeregisterBgThread() {
@@ -604,6 +629,20 @@ void Stats::DeregisterServerThread() {
     server_table_logic_stats_[table_id].accum_logic_info_size
       += table_logic_stats.second.accum_logic_info_size;
   }
+
+  server_accum_snapshot_stall_sec_.push_back(stats.accum_snapshot_stall_sec);
+  server_accum_snapshot_write_sec_.push_back(stats.accum_snapshot_write_sec);
+  server_accum_snapshot_mb_.push_back(stats.accum_snapshot_mb);
+  server_accum_num_snapshots_.push_back(stats.accum_num_snapshots);
+  server_accum_resume_sec_.push_back(stats.accum_resume_sec);
+  server_accum_resume_mb_.push_back(stats.accum_resume_mb);
+
+  server_thread_oplog_recv_mb_.push_back(
+      stats.accum_oplog_recv_kb / double(k1_Ki));
+  server_thread_oplog_rows_.push_back(stats.accum_oplog_rows);
+
+  server_row_delta_replies_.push_back(stats.accum_row_delta_replies);
+  server_row_delta_saved_mb_.push_back(stats.accum_row_delta_saved_mb);
 }
 
 void Stats::AppLoadDataBegin() {
@@ -897,6 +936,20 @@ void Stats::AppAccumAppendOnlyFlushOpLogEnd() {
   ++(stats.append_only_flush_oplog_count);
 }
 
+void Stats::AppRowOpLogCreated(size_t num_in_use) {
+  AppThreadStats &stats = *app_thread_stats_;
+  ++(stats.num_row_oplog_created);
+  stats.max_row_oplog_in_use = std::max(stats.max_row_oplog_in_use,
+                                        num_in_use);
+}
+
+void Stats::AppRowOpLogRecycled(size_t num_in_use) {
+  AppThreadStats &stats = *app_thread_stats_;
+  ++(stats.num_row_oplog_recycled);
+  stats.max_row_oplog_in_use = std::max(stats.max_row_oplog_in_use,
+                                        num_in_use);
+}
+
 void Stats::BgAccumOpLogSerializeBegin() {
   bg_thread_stats_->oplog_serialize_timer.restart();
 }
@@ -1296,6 +1349,39 @@ void Stats::ServerAccumCheck(int32_t table_id, bool permitted, size_t logic_info
   table_logic_stats.accum_logic_info_size += logic_info_size;
 }
 
+void Stats::ServerAccumSnapShotStallBegin() {
+  server_thread_stats_->snapshot_stall_timer.restart();
+}
+
+void Stats::ServerAccumSnapShotStallEnd() {
+  ServerThreadStats &stats = *server_thread_stats_;
+  stats.accum_snapshot_stall_sec += stats.snapshot_stall_timer.elapsed();
+}
+
+void Stats::ServerAccumSnapShotWritten(size_t num_bytes, double write_sec) {
+  ServerThreadStats &stats = *server_thread_stats_;
+  stats.accum_snapshot_mb += num_bytes / double(k1_Mi);
+  stats.accum_snapshot_write_sec += write_sec;
+  ++stats.accum_num_snapshots;
+}
+
+void Stats::ServerAccumOpLogRows(size_t num_rows) {
+  ServerThreadStats &stats = *server_thread_stats_;
+  stats.accum_oplog_rows += num_rows;
+}
+
+void Stats::ServerAccumRowDeltaReply(size_t row_size, size_t delta_size) {
+  ServerThreadStats &stats = *server_thread_stats_;
+  ++stats.accum_row_delta_replies;
+  stats.accum_row_delta_saved_mb += (row_size - delta_size) / double(k1_Mi);
+}
+
+void Stats::ServerAccumResume(size_t num_bytes, double resume_sec) {
+  ServerThreadStats &stats = *server_thread_stats_;
+  stats.accum_resume_mb += num_bytes / double(k1_Mi);
+  stats.accum_resume_sec += resume_sec;
+}
+
 template<typename T>
 void Stats::YamlPrintSequence(YAML::Emitter *yaml_out,
     const std::vector<T> &sequence) {
@@ -1478,6 +1564,17 @@ void Stats::PrintStats() {
            << YAML::Value;
   YamlPrintSequence(&yaml_out, app_append_only_flush_oplog_count_);
 
+  yaml_out << YAML::Key << "app_num_row_oplog_created"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, app_num_row_oplog_created_);
+
+  yaml_out << YAML::Key << "app_num_row_oplog_recycled"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, app_num_row_oplog_recycled_);
+
+  yaml_out << YAML::Key << "app_max_row_oplog_in_use"
+           << YAML::Value << app_max_row_oplog_in_use_;
+
   yaml_out << YAML::EndMap;
 
   for (auto table_stats_iter = table_stats_.begin();
@@ -1766,6 +1863,46 @@ void Stats::PrintStats() {
            << YAML::Value;
   YamlPrintSequence(&yaml_out, server_accum_num_waits_on_ack_clock_);
 
+  yaml_out << YAML::Key << "server_accum_snapshot_stall_sec"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_accum_snapshot_stall_sec_);
+
+  yaml_out << YAML::Key << "server_accum_snapshot_write_sec"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_accum_snapshot_write_sec_);
+
+  yaml_out << YAML::Key << "server_accum_snapshot_mb"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_accum_snapshot_mb_);
+
+  yaml_out << YAML::Key << "server_accum_num_snapshots"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_accum_num_snapshots_);
+
+  yaml_out << YAML::Key << "server_thread_oplog_recv_mb"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_thread_oplog_recv_mb_);
+
+  yaml_out << YAML::Key << "server_thread_oplog_rows"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_thread_oplog_rows_);
+
+  yaml_out << YAML::Key << "server_row_delta_replies"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_row_delta_replies_);
+
+  yaml_out << YAML::Key << "server_row_delta_saved_mb"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_row_delta_saved_mb_);
+
+  yaml_out << YAML::Key << "server_accum_resume_sec"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_accum_resume_sec_);
+
+  yaml_out << YAML::Key << "server_accum_resume_mb"
+           << YAML::Value;
+  YamlPrintSequence(&yaml_out, server_accum_resume_mb_);
+
   yaml_out << YAML::Key << "server_table_logic"
 	   << YAML::Value
 	   << YAML::BeginMap;
@@ -148,6 +148,12 @@
 #define STATS_APP_ACCUM_APPEND_ONLY_FLUSH_OPLOG_END() \
   petuum::Stats::AppAccumAppendOnlyFlushOpLogEnd()
 
+#define STATS_APP_ROW_OPLOG_CREATED(num_in_use) \
+  petuum::Stats::AppRowOpLogCreated(num_in_use)
+
+#define STATS_APP_ROW_OPLOG_RECYCLED(num_in_use) \
+  petuum::Stats::AppRowOpLogRecycled(num_in_use)
+
 #define STATS_SET_APP_DEFINED_VEC_NAME(name) \
   petuum::Stats::SetAppDefinedVecName(name)
 
@@ -311,6 +317,24 @@
 #define STATS_SERVER_ACCUM_CHECK(table_id, permitted, logic_info_size)	\
   Stats::ServerAccumCheck(table_id, permitted, logic_info_size)
 
+#define STATS_SERVER_ACCUM_SNAPSHOT_STALL_BEGIN() \
+  Stats::ServerAccumSnapShotStallBegin()
+
+#define STATS_SERVER_ACCUM_SNAPSHOT_STALL_END() \
+  Stats::ServerAccumSnapShotStallEnd()
+
+#define STATS_SERVER_ACCUM_SNAPSHOT_WRITTEN(num_bytes, write_sec) \
+  Stats::ServerAccumSnapShotWritten(num_bytes, write_sec)
+
+#define STATS_SERVER_ACCUM_RESUME(num_bytes, resume_sec) \
+  Stats::ServerAccumResume(num_bytes, resume_sec)
+
+#define STATS_SERVER_ACCUM_OPLOG_ROWS(num_rows) \
+  Stats::ServerAccumOpLogRows(num_rows)
+
+#define STATS_SERVER_ACCUM_ROW_DELTA_REPLY(row_size, delta_size) \
+  Stats::ServerAccumRowDeltaReply(row_size, delta_size)
+
 #define STATS_PRINT() \
   Stats::PrintStats()
 
@@ -367,6 +391,8 @@
 
 #define STATS_APP_ACCUM_APPEND_ONLY_FLUSH_OPLOG_BEGIN() ((void) 0)
 #define STATS_APP_ACCUM_APPEND_ONLY_FLUSH_OPLOG_END() ((void) 0)
+#define STATS_APP_ROW_OPLOG_CREATED(num_in_use) ((void) 0)
+#define STATS_APP_ROW_OPLOG_RECYCLED(num_in_use) ((void) 0)
 
 #define STATS_SET_APP_DEFINED_VEC_NAME(name) ((void) 0)
 #define STATS_APPEND_APP_DEFINED_VEC(val) ((void) 0)
@@ -443,6 +469,14 @@
 
 #define STATS_SERVER_ACCUM_CHECK(table_id, permitted, logic_info_size) ((void) 0)
 
+#define STATS_SERVER_ACCUM_SNAPSHOT_STALL_BEGIN() ((void) 0)
+#define STATS_SERVER_ACCUM_SNAPSHOT_STALL_END() ((void) 0)
+#define STATS_SERVER_ACCUM_SNAPSHOT_WRITTEN(num_bytes, write_sec) ((void) 0)
+#define STATS_SERVER_ACCUM_RESUME(num_bytes, resume_sec) ((void) 0)
+
+#define STATS_SERVER_ACCUM_OPLOG_ROWS(num_rows) ((void) 0)
+#define STATS_SERVER_ACCUM_ROW_DELTA_REPLY(row_size, delta_size) ((void) 0)
+
 #define STATS_PRINT() ((void) 0)
 #endif
 
@@ -574,6 +608,13 @@ struct AppThreadStats {
   double accum_append_only_oplog_flush_sec;
   size_t append_only_flush_oplog_count;
 
+  // Row oplogs taken from RowOpLogPools, newly created or recycled, and the
+  // most that were taken and not yet put back at once in the pool of any
+  // table.
+  size_t num_row_oplog_created;
+  size_t num_row_oplog_recycled;
+  size_t max_row_oplog_in_use;
+
   AppThreadStats():
       load_data_sec(0),
       init_sec(0),
@@ -589,7 +630,10 @@ struct AppThreadStats {
       app_defined_accum_sec(0),
       app_defined_accum_val(0),
       accum_append_only_oplog_flush_sec(0) ,
-      append_only_flush_oplog_count(0) { }
+      append_only_flush_oplog_count(0),
+      num_row_oplog_created(0),
+      num_row_oplog_recycled(0),
+      max_row_oplog_in_use(0) { }
 };
 
 struct BgThreadStats {
@@ -746,6 +790,23 @@ struct ServerThreadStats {
   std::map<int32_t, ServerLogicStats>
   table_logic_stats;
 
+  // time the server thread is blocked by snapshots
+  HighResolutionTimer snapshot_stall_timer;
+  double accum_snapshot_stall_sec;
+  double accum_snapshot_write_sec;
+  double accum_snapshot_mb;
+  size_t accum_num_snapshots;
+
+  // number of row oplogs applied
+  size_t accum_oplog_rows;
+
+  // row request replies sent as deltas and the bytes saved by them
+  size_t accum_row_delta_replies;
+  double accum_row_delta_saved_mb;
+
+  double accum_resume_sec;
+  double accum_resume_mb;
+
   ServerThreadStats():
     accum_apply_oplog_sec(0.0),
     accum_push_row_sec(0.0),
@@ -762,7 +823,16 @@ struct ServerThreadStats {
     accum_idle_send_sec(0.0),
     accum_idle_send_bytes_mb(0.0),
     accum_num_waits_on_ack_idle(1, 0),
-    accum_num_waits_on_ack_clock(1, 0) { }
+    accum_num_waits_on_ack_clock(1, 0),
+    accum_snapshot_stall_sec(0.0),
+    accum_snapshot_write_sec(0.0),
+    accum_snapshot_mb(0.0),
+    accum_num_snapshots(0),
+    accum_oplog_rows(0),
+    accum_row_delta_replies(0),
+    accum_row_delta_saved_mb(0.0),
+    accum_resume_sec(0.0),
+    accum_resume_mb(0.0) { }
 };
 
 struct NameNodeThreadStats {
@@ -834,6 +904,9 @@ public:
   static void AppAccumAppendOnlyFlushOpLogBegin();
   static void AppAccumAppendOnlyFlushOpLogEnd();
 
+  static void AppRowOpLogCreated(size_t num_in_use);
+  static void AppRowOpLogRecycled(size_t num_in_use);
+
   // the following funcitons are not thread safe
   static void SetAppDefinedAccumSecName(const std::string &name);
 
@@ -918,6 +991,14 @@ public:
 
   static void ServerAccumCheck(int32_t table_id, bool permitted, size_t logic_info_size);
 
+  static void ServerAccumSnapShotStallBegin();
+  static void ServerAccumSnapShotStallEnd();
+  static void ServerAccumSnapShotWritten(size_t num_bytes, double write_sec);
+  static void ServerAccumResume(size_t num_bytes, double resume_sec);
+
+  static void ServerAccumOpLogRows(size_t num_rows);
+  static void ServerAccumRowDeltaReply(size_t row_size, size_t delta_size);
+
   static void PrintStats();
 private:
 
@@ -996,6 +1077,10 @@ private:
   static std::vector<double> app_accum_append_only_flush_oplog_sec_;
   static std::vector<size_t> app_append_only_flush_oplog_count_;
 
+  static std::vector<size_t> app_num_row_oplog_created_;
+  static std::vector<size_t> app_num_row_oplog_recycled_;
+  static size_t app_max_row_oplog_in_use_;
+
   // Bg thread stats
   static double bg_accum_clock_end_oplog_serialize_sec_;
   static double bg_accum_total_oplog_serialize_sec_;
@@ -1073,6 +1158,20 @@ private:
   static std::vector<size_t> server_accum_num_waits_on_ack_idle_;
   static std::vector<size_t> server_accum_num_waits_on_ack_clock_;
   static std::map<int32_t, ServerLogicStats> server_table_logic_stats_;
+
+  static std::vector<double> server_accum_snapshot_stall_sec_;
+  static std::vector<double> server_accum_snapshot_write_sec_;
+  static std::vector<double> server_accum_snapshot_mb_;
+  static std::vector<size_t> server_accum_num_snapshots_;
+  static std::vector<double> server_accum_resume_sec_;
+  static std::vector<double> server_accum_resume_mb_;
+
+  // per server thread, to check how evenly rows are partitioned
+  static std::vector<double> server_thread_oplog_recv_mb_;
+  static std::vector<size_t> server_thread_oplog_rows_;
+
+  static std::vector<size_t> server_row_delta_replies_;
+  static std::vector<double> server_row_delta_saved_mb_;
 };
 
 }   // namespace petuum
@@ -0,0 +1,54 @@
+#include <petuum_ps_common/util/top_k.hpp>
+
+#include <math.h>
+
+namespace petuum {
+
+ImportanceHistogram::ImportanceHistogram():
+    counts_(kNumBuckets) {
+  for (auto &count : counts_)
+    count.store(0, std::memory_order_relaxed);
+}
+
+ImportanceHistogram::ImportanceHistogram(ImportanceHistogram &&other):
+    counts_(std::move(other.counts_)) { }
+
+int32_t ImportanceHistogram::GetBucket(double importance) {
+  if (!(importance > 0))
+    return 0;
+  int exp;
+  frexp(importance, &exp);
+  int32_t bucket = exp - kMinExp;
+  if (bucket < 0)
+    return 0;
+  if (bucket >= kNumBuckets)
+    return kNumBuckets - 1;
+  return bucket;
+}
+
+void ImportanceHistogram::Update(double old_importance,
+                                 double new_importance) {
+  int32_t old_bucket = (old_importance > 0) ? GetBucket(old_importance) : -1;
+  int32_t new_bucket = (new_importance > 0) ? GetBucket(new_importance) : -1;
+  if (old_bucket == new_bucket)
+    return;
+  if (old_bucket >= 0)
+    counts_[old_bucket].fetch_sub(1, std::memory_order_relaxed);
+  if (new_bucket >= 0)
+    counts_[new_bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+double ImportanceHistogram::GetThreshold(size_t k, size_t *num_rows) const {
+  int64_t accum = 0;
+  for (int32_t bucket = kNumBuckets - 1; bucket > 0; --bucket) {
+    accum += counts_[bucket].load(std::memory_order_relaxed);
+    if (accum >= static_cast<int64_t>(k) && k > 0) {
+      *num_rows = accum;
+      return ldexp(1.0, bucket - 1 + kMinExp);
+    }
+  }
+  *num_rows = accum + counts_[0].load(std::memory_order_relaxed);
+  return 0;
+}
+
+}  // namespace petuum
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+// Order the k first elements of vec by comp and leave the rest after them,
+// unordered. O(n + k log k) instead of the O(n log n) of a full sort.
+template<typename T, typename Comp>
+void SelectTopK(std::vector<T> *vec, size_t k, Comp comp) {
+  if (k >= vec->size()) {
+    std::sort(vec->begin(), vec->end(), comp);
+    return;
+  }
+  if (k == 0)
+    return;
+  std::nth_element(vec->begin(), vec->begin() + k, vec->end(), comp);
+  std::sort(vec->begin(), vec->begin() + k, comp);
+}
+
+// Counts of rows by importance in power-of-2 buckets, kept up to date as
+// importances change, so that the importance of about the k-th most
+// important row is known without looking at the rows. Push preparation
+// uses it to skip the rows that cannot make the top k.
+//
+// Update() may be called concurrently.
+class ImportanceHistogram {
+public:
+  ImportanceHistogram();
+  ImportanceHistogram(ImportanceHistogram &&other);
+
+  // A row's importance went from old_importance to new_importance. A new
+  // row comes from 0, but rows of importance 0 are not counted.
+  void Update(double old_importance, double new_importance);
+
+  // Lower bound of the importance of the k-th most important row counted,
+  // rounded down to a power of 2; 0 if fewer than k rows are counted.
+  // num_rows is set to the number of rows of importance at least that.
+  double GetThreshold(size_t k, size_t *num_rows) const;
+
+private:
+  // Bucket b > 0 holds importances in [2^(b - 1 + kMinExp),
+  // 2^(b + kMinExp)); bucket 0 holds those below.
+  static int32_t GetBucket(double importance);
+
+  static const int32_t kMinExp = -64;
+  static const int32_t kNumBuckets = 129;
+
+  std::vector<std::atomic<int64_t> > counts_;
+};
+
+}  // namespace petuum
@@ -69,6 +69,19 @@ UpdateSortPolicy GetUpdateSortPolicy(const std::string &policy) {
   return Random;
 }
 
+RowPartitionerType GetRowPartitionerType(const std::string &partitioner) {
+  if (partitioner == "Modulo") {
+    return kModuloPartitioner;
+  } else if (partitioner == "TableHash") {
+    return kTableHashPartitioner;
+  } else if (partitioner == "ConsistentHash") {
+    return kConsistentHashPartitioner;
+  } else {
+    LOG(FATAL) << "Unknown row partitioner: " << partitioner;
+  }
+  return kModuloPartitioner;
+}
+
 ConsistencyModel GetConsistencyModel(const std::string &consistency_model) {
   if (consistency_model == "SSPPush") {
     return SSPPush;
@@ -121,6 +134,33 @@ ProcessStorageType GetProcessStroageType(
   }
   return BoundedSparse;
 }
+
+int32_t GetCompressType(const std::string &compress_type) {
+  int32_t flags = CompressType::kNone;
+  size_t begin = 0;
+  while (begin <= compress_type.size()) {
+    size_t end = compress_type.find(',', begin);
+    if (end == std::string::npos)
+      end = compress_type.size();
+    std::string type = compress_type.substr(begin, end - begin);
+    if (type == "None" || type == "") {
+    } else if (type == "Snappy") {
+      flags |= CompressType::kSnappy;
+    } else if (type == "VarintIds") {
+      flags |= CompressType::kVarintIds;
+    } else if (type == "Float16") {
+      flags |= CompressType::kFloat16;
+    } else if (type == "BFloat16") {
+      flags |= CompressType::kBFloat16;
+    } else {
+      LOG(FATAL) << "Unknown compress type " << type;
+    }
+    begin = end + 1;
+  }
+  CHECK(!((flags & CompressType::kFloat16) && (flags & CompressType::kBFloat16)))
+      << "Float16 and BFloat16 are exclusive";
+  return flags;
+}
   
 float RestoreInf(float x) {
   if (isinf(x)) { 
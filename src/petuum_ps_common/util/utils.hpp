@@ -25,6 +25,8 @@ void GetServerIDsFromHostMap(std::vector<int32_t> *server_ids,
 
 UpdateSortPolicy GetUpdateSortPolicy(const std::string &policy);
 
+RowPartitionerType GetRowPartitionerType(const std::string &partitioner);
+
 ConsistencyModel GetConsistencyModel(const std::string &consistency_model);
 
 OpLogType GetOpLogType(const std::string &oplog_type);
@@ -35,6 +37,10 @@ AppendOnlyOpLogType GetAppendOnlyOpLogType(
 ProcessStorageType GetProcessStroageType(
     const std::string &process_storage_type);
 
+// compress_type is a comma-separated list of "Snappy", "VarintIds",
+// "Float16" and "BFloat16", or "None".
+int32_t GetCompressType(const std::string &compress_type);
+
 float RestoreInf(float x);
 
 float RestoreInfNaN(float x);
@@ -29,6 +29,8 @@ TableGroupSN::TableGroupSN(const TableGroupConfig &table_group_config,
     num_local_table_threads,
     num_tables,
     table_group_config.ooc_path_prefix,
+    table_group_config.ooc_num_io_threads,
+    table_group_config.ooc_write_batch_size,
     table_group_config.consistency_model);
 
   CommBus *comm_bus = new CommBus(local_id_min, local_id_max, 0);
@@ -19,16 +19,23 @@ LocalOOCConsistencyController::LocalOOCConsistencyController(
 
   std::string db_path;
   MakeOOCDBPath(&db_path);
+  ooc_store_.reset(new OOCStore(
+      db_path, GlobalContextSN::get_ooc_num_io_threads(),
+      GlobalContextSN::get_ooc_write_batch_size()));
+}
+
+LocalOOCConsistencyController::~LocalOOCConsistencyController() { }
 
-  leveldb::Options options;
-  options.create_if_missing = true;
-  options.error_if_exists = true;
-  leveldb::Status status = leveldb::DB::Open(options, db_path, &db_);
-  CHECK(status.ok()) << "creating db at " << db_path << " failed";
+void LocalOOCConsistencyController::GetAsync(int32_t row_id) {
+  RowAccessor row_accessor;
+  bool found = process_storage_.Find(row_id, &row_accessor);
+  if (found)
+    return;
+  ooc_store_->Prefetch(row_id);
 }
 
-LocalOOCConsistencyController::~LocalOOCConsistencyController() {
-  delete db_;
+void LocalOOCConsistencyController::WaitPendingAsnycGet() {
+  ooc_store_->WaitPrefetch();
 }
 
 void LocalOOCConsistencyController::MakeOOCDBPath(std::string *db_path) {
@@ -43,26 +50,30 @@ void LocalOOCConsistencyController::MakeOOCDBPath(std::string *db_path) {
 void LocalOOCConsistencyController::CreateInsertRow(int32_t row_id,
                                                  RowAccessor *row_accessor) {
 
-  std::lock_guard<std::mutex> lock(create_row_mtx_);
+  Unlocker<> unlocker;
+  locks_.Lock(row_id, &unlocker);
   bool found = process_storage_.Find(row_id, row_accessor);
   if (found)
     return;
 
-  size_t count = on_disk_row_index_.count(row_id);
+  // The row cannot enter the store once this is checked, as it is not in
+  // the process cache and its lock is held, nor leave it but by the Take()
+  // below.
+  bool in_store;
+  {
+    std::lock_guard<std::mutex> lock(create_row_mtx_);
+    in_store = ooc_store_->Contains(row_id);
+  }
 
   AbstractRow *row_data
     = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(row_type_);
 
-  if (count == 1) {
-    leveldb::Slice key(reinterpret_cast<const char*>(&row_id), sizeof(int32_t));
+  if (in_store) {
     std::string value;
-    leveldb::Status s = db_->Get(leveldb::ReadOptions(), key, &value);
-    CHECK(s.ok());
+    bool taken = ooc_store_->Take(row_id, &value);
+    CHECK(taken);
     bool suc = row_data->Deserialize(value.data(), value.size());
     CHECK(suc);
-    on_disk_row_index_.erase(row_id);
-    s = db_->Delete(leveldb::WriteOptions(), key);
-    CHECK(s.ok());
   } else {
     row_data->Init(row_capacity_);
   }
@@ -70,6 +81,7 @@ void LocalOOCConsistencyController::CreateInsertRow(int32_t row_id,
   ClientRow *client_row = new ClientRow(0, row_data);
   int32_t evicted_row_id;
   ClientRow *evicted_row;
+  std::lock_guard<std::mutex> lock(create_row_mtx_);
   process_storage_.Insert(row_id, client_row, row_accessor, &evicted_row_id,
                           &evicted_row);
 
@@ -79,22 +91,11 @@ void LocalOOCConsistencyController::CreateInsertRow(int32_t row_id,
   std::shared_ptr<AbstractRow> row_data_ptr;
   evicted_row->GetRowDataPtr(&row_data_ptr);
 
-  size_t serialized_size = row_data_ptr->SerializedSize();
-  uint8_t *membuf = new uint8_t[serialized_size];
-
-  row_data_ptr->Serialize(membuf);
-
-  leveldb::Slice key(reinterpret_cast<const char*>(&evicted_row_id),
-                     sizeof(int32_t));
-  leveldb::Slice value(reinterpret_cast<const char*>(membuf),
-                       serialized_size);
-
-  leveldb::Status s = db_->Put(leveldb::WriteOptions(), key, value);
-  CHECK(s.ok());
-  on_disk_row_index_.insert(evicted_row_id);
+  std::string value(row_data_ptr->SerializedSize(), '\0');
+  row_data_ptr->Serialize(&value[0]);
+  ooc_store_->Put(evicted_row_id, &value);
 
   delete evicted_row;
-  delete[] membuf;
 }
 
 }   // namespace petuum
@@ -1,18 +1,21 @@
 #pragma once
 
 #include <petuum_ps_sn/consistency/local_consistency_controller.hpp>
+#include <petuum_ps_sn/storage/ooc_store.hpp>
 
 #include <utility>
 #include <vector>
 #include <cstdint>
 #include <atomic>
 #include <string>
-#include <leveldb/db.h>
-#include <set>
 #include <mutex>
+#include <boost/scoped_ptr.hpp>
 
 namespace petuum {
 
+// Rows evicted from the process cache go to an OOCStore. Reading a row back
+// from disk holds only the row's lock, so that loads of different rows
+// overlap; GetAsync() starts the read ahead of the Get().
 class LocalOOCConsistencyController : public LocalConsistencyController {
 public:
   LocalOOCConsistencyController(const ClientTableConfig& config,
@@ -23,13 +26,17 @@ public:
 
   ~LocalOOCConsistencyController();
 
+  virtual void GetAsync(int32_t row_id);
+  virtual void WaitPendingAsnycGet();
+
 protected:
   void MakeOOCDBPath(std::string *db_path);
   virtual void CreateInsertRow(int32_t row_id, RowAccessor *row_accessor);
 
+  // Serializes inserting into the process cache with putting the evicted
+  // row into ooc_store_, so that a row is always in one or the other.
   std::mutex create_row_mtx_;
-  leveldb::DB* db_;
-  std::set<int32_t> on_disk_row_index_;
+  boost::scoped_ptr<OOCStore> ooc_store_;
 };
 
 }  // namespace petuum
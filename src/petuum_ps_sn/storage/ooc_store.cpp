@@ -0,0 +1,198 @@
+#include <petuum_ps_sn/storage/ooc_store.hpp>
+
+#include <glog/logging.h>
+#include <leveldb/write_batch.h>
+
+namespace petuum {
+
+OOCStore::OOCStore(const std::string &db_path, int32_t num_io_threads,
+                   size_t num_write_batch):
+    num_write_batch_(num_write_batch),
+    write_in_progress_(false),
+    num_pending_reads_(0),
+    shutting_down_(false) {
+  CHECK_GT(num_io_threads, 0);
+  CHECK_GT(num_write_batch, 0);
+
+  leveldb::Options options;
+  options.create_if_missing = true;
+  options.error_if_exists = true;
+  leveldb::Status status = leveldb::DB::Open(options, db_path, &db_);
+  CHECK(status.ok()) << "creating db at " << db_path << " failed";
+
+  for (int32_t i = 0; i < num_io_threads; ++i)
+    io_threads_.emplace_back(&OOCStore::IOThreadMain, this);
+}
+
+OOCStore::~OOCStore() {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    shutting_down_ = true;
+    read_queue_.clear();
+    // Keep only the batch being written, if any.
+    while (write_queue_.size() > (write_in_progress_ ? 1 : 0))
+      write_queue_.pop_back();
+    io_cv_.notify_all();
+  }
+  for (auto &io_thread : io_threads_)
+    io_thread.join();
+  delete db_;
+}
+
+const size_t OOCStore::kMaxQueuedBatches;
+
+void OOCStore::Put(int32_t row_id, std::string *value) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  // The I/O threads notify done_cv_ after every batch they write.
+  while (write_queue_.size() >= kMaxQueuedBatches && !shutting_down_)
+    done_cv_.wait(lock);
+  bool inserted = row_index_.insert(row_id).second;
+  CHECK(inserted) << "row " << row_id << " is already in the store";
+  write_buffer_[row_id].swap(*value);
+
+  if (write_buffer_.size() >= num_write_batch_) {
+    write_queue_.emplace_back();
+    write_queue_.back().swap(write_buffer_);
+    io_cv_.notify_one();
+  }
+}
+
+bool OOCStore::Contains(int32_t row_id) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  return row_index_.count(row_id) == 1;
+}
+
+bool OOCStore::Take(int32_t row_id, std::string *value) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  if (row_index_.erase(row_id) == 0)
+    return false;
+
+  auto buff_iter = write_buffer_.find(row_id);
+  if (buff_iter != write_buffer_.end()) {
+    value->swap(buff_iter->second);
+    write_buffer_.erase(buff_iter);
+    return true;
+  }
+
+  const std::string *unwritten = FindUnwritten(row_id);
+  if (unwritten != 0) {
+    *value = *unwritten;
+    return true;
+  }
+
+  auto prefetch_iter = prefetched_.find(row_id);
+  if (prefetch_iter != prefetched_.end()) {
+    while (!prefetch_iter->second.done) {
+      done_cv_.wait(lock);
+      prefetch_iter = prefetched_.find(row_id);
+    }
+    value->swap(prefetch_iter->second.value);
+    prefetched_.erase(prefetch_iter);
+    return true;
+  }
+  lock.unlock();
+
+  leveldb::Slice key(reinterpret_cast<const char*>(&row_id), sizeof(int32_t));
+  leveldb::Status s = db_->Get(leveldb::ReadOptions(), key, value);
+  CHECK(s.ok()) << "reading row " << row_id << " failed";
+  return true;
+}
+
+void OOCStore::Prefetch(int32_t row_id) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  if (row_index_.count(row_id) == 0
+      || prefetched_.count(row_id) == 1
+      || write_buffer_.count(row_id) == 1
+      || FindUnwritten(row_id) != 0)
+    return;
+
+  prefetched_[row_id].done = false;
+  read_queue_.push_back(row_id);
+  ++num_pending_reads_;
+  io_cv_.notify_one();
+}
+
+void OOCStore::WaitPrefetch() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (num_pending_reads_ > 0)
+    done_cv_.wait(lock);
+}
+
+void OOCStore::Flush() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  if (!write_buffer_.empty()) {
+    write_queue_.emplace_back();
+    write_queue_.back().swap(write_buffer_);
+    io_cv_.notify_one();
+  }
+  while (!write_queue_.empty())
+    done_cv_.wait(lock);
+}
+
+const std::string *OOCStore::FindUnwritten(int32_t row_id) {
+  for (auto batch_iter = write_queue_.rbegin();
+       batch_iter != write_queue_.rend(); ++batch_iter) {
+    auto row_iter = batch_iter->find(row_id);
+    if (row_iter != batch_iter->end())
+      return &(row_iter->second);
+  }
+  return 0;
+}
+
+void OOCStore::IOThreadMain() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (true) {
+    if (!write_queue_.empty() && !write_in_progress_) {
+      // Only one batch is written at a time so that a row evicted twice
+      // ends up with its latest value on disk. The batch stays in the
+      // queue, readable, until it is written.
+      write_in_progress_ = true;
+      const RowBatch &batch = write_queue_.front();
+      lock.unlock();
+
+      leveldb::WriteBatch write_batch;
+      for (const auto &row : batch) {
+        write_batch.Put(
+            leveldb::Slice(reinterpret_cast<const char*>(&row.first),
+                           sizeof(int32_t)),
+            row.second);
+      }
+      leveldb::Status s = db_->Write(leveldb::WriteOptions(), &write_batch);
+      CHECK(s.ok()) << "writing " << batch.size() << " rows failed";
+
+      lock.lock();
+      write_queue_.pop_front();
+      write_in_progress_ = false;
+      io_cv_.notify_all();
+      done_cv_.notify_all();
+      continue;
+    }
+
+    if (!read_queue_.empty()) {
+      int32_t row_id = read_queue_.front();
+      read_queue_.pop_front();
+      lock.unlock();
+
+      std::string value;
+      leveldb::Slice key(reinterpret_cast<const char*>(&row_id),
+                         sizeof(int32_t));
+      leveldb::Status s = db_->Get(leveldb::ReadOptions(), key, &value);
+      CHECK(s.ok()) << "reading row " << row_id << " failed";
+
+      lock.lock();
+      auto prefetch_iter = prefetched_.find(row_id);
+      CHECK(prefetch_iter != prefetched_.end());
+      prefetch_iter->second.value.swap(value);
+      prefetch_iter->second.done = true;
+      --num_pending_reads_;
+      done_cv_.notify_all();
+      continue;
+    }
+
+    if (shutting_down_ && write_queue_.empty())
+      return;
+    io_cv_.wait(lock);
+  }
+}
+
+}  // namespace petuum
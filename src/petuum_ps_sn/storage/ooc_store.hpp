@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/noncopyable.hpp>
+#include <leveldb/db.h>
+
+namespace petuum {
+
+// On-disk rows of an out-of-core table, kept in a leveldb and read and
+// written by a pool of I/O threads.
+//
+// Put() only buffers a row. Rows are written num_write_batch at a time in
+// one WriteBatch, in the order they were put, one batch at a time. A row
+// stays readable from memory until its batch is written. Put() blocks
+// while kMaxQueuedBatches full batches wait to be written, so that rows
+// evicted faster than the disk takes them do not pile up in memory.
+//
+// Prefetch() reads a row in the background so that the Take() that loads
+// it later does not wait on the disk.
+//
+// A row is in the store from Put() to Take(). The caller must not Put() a
+// row that is in the store, or Take() one concurrently with a Put() of the
+// same row.
+class OOCStore : boost::noncopyable {
+public:
+  OOCStore(const std::string &db_path, int32_t num_io_threads,
+           size_t num_write_batch);
+  // Joins the I/O threads. Rows not written yet are dropped, as the store
+  // does not outlive its table.
+  ~OOCStore();
+
+  // Takes the content of value.
+  void Put(int32_t row_id, std::string *value);
+
+  bool Contains(int32_t row_id);
+
+  // Removes a row and returns its value, false if it is not in the store.
+  // Reads the disk if the row is neither buffered nor prefetched.
+  bool Take(int32_t row_id, std::string *value);
+
+  // Starts reading a row if it is on disk.
+  void Prefetch(int32_t row_id);
+
+  // Waits for all Prefetch() reads to finish.
+  void WaitPrefetch();
+
+  // Writes the buffered rows and waits until all rows put so far are
+  // written.
+  void Flush();
+
+  static const size_t kMaxQueuedBatches = 4;
+
+private:
+  friend class OOCStoreTest;
+
+  typedef std::unordered_map<int32_t, std::string> RowBatch;
+
+  struct PrefetchEntry {
+    bool done;
+    std::string value;
+  };
+
+  void IOThreadMain();
+  // Called with mtx_ held. Returns the row's value if it is not written
+  // yet, 0 otherwise.
+  const std::string *FindUnwritten(int32_t row_id);
+
+  leveldb::DB *db_;
+  const size_t num_write_batch_;
+
+  std::mutex mtx_;
+  std::condition_variable io_cv_;
+  std::condition_variable done_cv_;
+
+  // Rows in the store, wherever they are.
+  std::unordered_set<int32_t> row_index_;
+  RowBatch write_buffer_;
+  // Batches handed to the I/O threads, oldest first. The front one is
+  // being written if write_in_progress_.
+  std::list<RowBatch> write_queue_;
+  bool write_in_progress_;
+
+  std::unordered_map<int32_t, PrefetchEntry> prefetched_;
+  std::deque<int32_t> read_queue_;
+  size_t num_pending_reads_;
+
+  bool shutting_down_;
+  std::vector<std::thread> io_threads_;
+};
+
+}  // namespace petuum
@@ -22,6 +22,10 @@ std::condition_variable GlobalContextSN::clock_cond_var_;
 
 std::string GlobalContextSN::ooc_path_prefix_;
 
+int32_t GlobalContextSN::ooc_num_io_threads_ = 2;
+
+int32_t GlobalContextSN::ooc_write_batch_size_ = 64;
+
 ConsistencyModel GlobalContextSN::consistency_model_;
 
 }   // namespace petuum
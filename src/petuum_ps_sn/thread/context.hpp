@@ -87,11 +87,15 @@ public:
       int32_t num_table_threads,
       int32_t num_tables,
       const std::string &ooc_path_prefix,
+      int32_t ooc_num_io_threads,
+      int32_t ooc_write_batch_size,
       ConsistencyModel consistency_model) {
     num_app_threads_ = num_app_threads;
     num_table_threads_ = num_table_threads;
     num_tables_ = num_tables;
     ooc_path_prefix_ = ooc_path_prefix;
+    ooc_num_io_threads_ = ooc_num_io_threads;
+    ooc_write_batch_size_ = ooc_write_batch_size;
     consistency_model_ = consistency_model;
   }
 
@@ -121,6 +125,14 @@ public:
     return ooc_path_prefix_;
   }
 
+  static int32_t get_ooc_num_io_threads() {
+    return ooc_num_io_threads_;
+  }
+
+  static int32_t get_ooc_write_batch_size() {
+    return ooc_write_batch_size_;
+  }
+
   static ConsistencyModel get_consistency_model() {
     return consistency_model_;
   }
@@ -153,6 +165,8 @@ private:
   static int32_t num_tables_;
   static float cuckoo_expansion_factor_;
   static std::string ooc_path_prefix_;
+  static int32_t ooc_num_io_threads_;
+  static int32_t ooc_write_batch_size_;
   static ConsistencyModel consistency_model_;
 };
 
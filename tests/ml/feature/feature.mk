@@ -1,7 +1,8 @@
 FEATURE_TESTS_DIR = $(TESTS)/ml/feature
 FEATURE_SRC_DIR=$(SRC)/ml/feature
 
-feature_test_run_all: sparse_feature_test_run dense_feature_test_run
+feature_test_run_all: sparse_feature_test_run dense_feature_test_run \
+	feature_matrix_test_run
 
 $(TESTS_BIN)/sparse_feature_test: $(FEATURE_TESTS_DIR)/sparse_feature_test.cpp \
 	$(FEATURE_SRC_DIR)/sparse_feature.hpp
@@ -24,3 +25,10 @@ $(TESTS_BIN)/dense_decay_feature_test: \
 
 dense_decay_feature_test_run: $(TESTS_BIN)/dense_decay_feature_test
 	$<
+
+$(TESTS_BIN)/feature_matrix_test: $(FEATURE_TESTS_DIR)/feature_matrix_test.cpp \
+	$(FEATURE_SRC_DIR)/feature_matrix.hpp
+	$(CXX) $(CXXFLAGS) $(INCFLAGS) $^ $(TESTS_LDFLAGS) -o $@
+
+feature_matrix_test_run: $(TESTS_BIN)/feature_matrix_test
+	$<
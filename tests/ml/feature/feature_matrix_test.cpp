@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <ml/feature/feature_matrix.hpp>
+#include <ml/feature/sparse_feature.hpp>
+#include <ml/feature/dense_feature.hpp>
+
+namespace petuum {
+namespace ml {
+
+TEST(FeatureMatrixTest, SmokeTests) {
+  int feature_dim = 6;
+  FeatureMatrix<float> matrix(feature_dim);
+  EXPECT_EQ(0, matrix.GetNumRows());
+
+  // Row 0: 1:1 4:2.
+  std::vector<int> feature_ids = {1, 4};
+  std::vector<float> vals = {1, 2};
+  matrix.AddRow(SparseFeature<float>(feature_ids, vals, feature_dim));
+
+  // Row 1: 0:3 4:4, stored without its zeros.
+  std::vector<float> dense_vals = {3, 0, 0, 0, 4, 0};
+  matrix.AddRow(DenseFeature<float>(dense_vals));
+
+  EXPECT_EQ(2, matrix.GetNumRows());
+  EXPECT_EQ(4, matrix.GetNumEntries());
+  const int32_t* row_offsets = matrix.GetRowOffsets();
+  EXPECT_EQ(0, row_offsets[0]);
+  EXPECT_EQ(2, row_offsets[1]);
+  EXPECT_EQ(4, row_offsets[2]);
+  EXPECT_EQ(1, matrix.GetFeatureIds()[0]);
+  EXPECT_EQ(0, matrix.GetFeatureIds()[2]);
+  EXPECT_EQ(4., matrix.GetVals()[3]);
+  LOG(INFO) << "matrix: " << matrix.ToString();
+
+  EXPECT_FALSE(matrix.HasCSC());
+  matrix.BuildCSC();
+  EXPECT_TRUE(matrix.HasCSC());
+  const int32_t* col_offsets = matrix.GetColOffsets();
+  // Column 4 holds row 0 then row 1.
+  EXPECT_EQ(2, col_offsets[4]);
+  EXPECT_EQ(4, col_offsets[5]);
+  EXPECT_EQ(0, matrix.GetColRowIds()[2]);
+  EXPECT_EQ(1, matrix.GetColRowIds()[3]);
+  EXPECT_EQ(2., matrix.GetColVals()[2]);
+  EXPECT_EQ(4., matrix.GetColVals()[3]);
+  EXPECT_EQ(4, col_offsets[feature_dim]);
+
+  matrix.Clear();
+  EXPECT_EQ(0, matrix.GetNumRows());
+  EXPECT_EQ(0, matrix.GetNumEntries());
+  EXPECT_FALSE(matrix.HasCSC());
+}
+
+}  // namespace ml
+}  // namespace petuum
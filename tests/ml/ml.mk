@@ -1 +1,2 @@
-ml_test_run_all: feature_test_run_all util_test_run_all disk_stream_run_all
+ml_test_run_all: feature_test_run_all util_test_run_all disk_stream_run_all \
+	parsers_test_run_all
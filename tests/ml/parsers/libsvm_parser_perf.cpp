@@ -0,0 +1,112 @@
+// Compare ReadDataLabelLibSVM, which loads the whole file and parses it with
+// iostreams and strtod, against streaming it through DiskReader and
+// LibsvmParser.
+
+#include <glog/logging.h>
+#include <gflags/gflags.h>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+#include <ml/util/data_loading.hpp>
+#include <ml/disk_stream/disk_reader.hpp>
+#include <ml/disk_stream/multi_buffer.hpp>
+#include <ml/disk_stream/byte_buffer.hpp>
+#include <ml/parsers/libsvm_parser.hpp>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
+
+DEFINE_string(data_file, "", "LibSVM data file");
+DEFINE_int32(feature_dim, 0, "Feature dimension");
+DEFINE_int32(num_data, 0, "Number of records in data_file");
+DEFINE_bool(feature_one_based, false, "Feature ids start from 1");
+DEFINE_bool(label_one_based, false, "Labels start from 1");
+DEFINE_int64(chunk_size, 64 * 1024 * 1024, "DiskReader chunk size in bytes");
+DEFINE_int32(num_buffers, 4, "Number of MultiBuffer buffers");
+DEFINE_int32(block_size, 1024, "Records per LibsvmBlock");
+DEFINE_bool(run_baseline, true, "Also time ReadDataLabelLibSVM");
+DEFINE_string(file_list, "/tmp/libsvm_parser_perf.filelist",
+              "Scratch file listing data_file for DiskReader");
+
+namespace {
+
+void RunBaseline() {
+  std::vector<petuum::ml::AbstractFeature<float>*> features;
+  std::vector<int32_t> labels;
+  petuum::HighResolutionTimer timer;
+  petuum::ml::ReadDataLabelLibSVM(FLAGS_data_file, FLAGS_feature_dim,
+                                  FLAGS_num_data, &features, &labels,
+                                  FLAGS_feature_one_based,
+                                  FLAGS_label_one_based);
+  double sec = timer.elapsed();
+  size_t nnz = 0;
+  for (auto feature : features) {
+    nnz += feature->GetNumEntries();
+    delete feature;
+  }
+  LOG(INFO) << "ReadDataLabelLibSVM: " << features.size() << " records "
+            << nnz << " nnz in " << sec << " sec";
+}
+
+void RunStreaming() {
+  {
+    std::ofstream os(FLAGS_file_list);
+    CHECK(os) << "Failed to open " << FLAGS_file_list;
+    os << FLAGS_data_file << std::endl;
+  }
+  petuum::ml::DiskReaderConfig reader_config;
+  reader_config.read_mode = petuum::ml::kFileList;
+  reader_config.file_list = FLAGS_file_list;
+  reader_config.chunk_size = FLAGS_chunk_size;
+
+  petuum::ml::LibsvmParserConfig parser_config;
+  parser_config.feature_dim = FLAGS_feature_dim;
+  parser_config.feature_one_based = FLAGS_feature_one_based;
+  parser_config.label_one_based = FLAGS_label_one_based;
+
+  petuum::HighResolutionTimer timer;
+  petuum::ml::MultiBuffer multi_buffer(FLAGS_num_buffers);
+  petuum::ml::DiskReader disk_reader(reader_config, &multi_buffer);
+  std::thread reader_thread(&petuum::ml::DiskReader::Start,
+                            std::ref(disk_reader));
+
+  petuum::ml::LibsvmParser parser(parser_config);
+  petuum::ml::LibsvmBlock block;
+  size_t nnz = 0;
+  size_t num_bytes = 0;
+  for (petuum::ml::ByteBuffer *buffer = multi_buffer.GetWorkBuffer();
+       buffer != 0; buffer = multi_buffer.GetWorkBuffer()) {
+    parser.AssignBuffer(buffer->GetNextBytes(), buffer->GetNumRemainingBytes());
+    num_bytes += buffer->GetNumRemainingBytes();
+    do {
+      block.Clear();
+      parser.GetNextBlock(FLAGS_block_size, &block);
+      nnz += block.feature_ids.size();
+    } while (block.GetNumRows() > 0);
+    multi_buffer.DoneConsumingWorkBuffer();
+  }
+  parser.SetEndOfStream();
+  block.Clear();
+  parser.GetNextBlock(FLAGS_block_size, &block);
+  nnz += block.feature_ids.size();
+  reader_thread.join();
+  double sec = timer.elapsed();
+  LOG(INFO) << "LibsvmParser: " << parser.get_num_records() << " records "
+            << nnz << " nnz in " << sec << " sec ("
+            << num_bytes / 1e6 / sec << " MB/s)";
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  CHECK(!FLAGS_data_file.empty()) << "--data_file is required";
+  CHECK_GT(FLAGS_feature_dim, 0);
+
+  RunStreaming();
+  if (FLAGS_run_baseline) {
+    CHECK_GT(FLAGS_num_data, 0) << "ReadDataLabelLibSVM needs --num_data";
+    RunBaseline();
+  }
+  return 0;
+}
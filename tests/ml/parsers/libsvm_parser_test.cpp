@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <vector>
+#include <string>
+#include <ml/parsers/libsvm_parser.hpp>
+#include <ml/feature/sparse_feature.hpp>
+
+namespace petuum {
+namespace ml {
+
+namespace {
+
+const std::string kData =
+  "1 3:0.5 10:2 11:-1.25e1\n"
+  "\n"
+  "0 1:7\r\n"
+  "+1 2:.125 4:3.0E-2\n"
+  "-1\n"
+  "2 0:1e3 5:123456789";
+
+// Parse kData in buffers of buff_size bytes into block.
+void ParseInBuffers(size_t buff_size, LibsvmBlock *block) {
+  LibsvmParserConfig config;
+  config.feature_dim = 12;
+  LibsvmParser parser(config);
+  block->Clear();
+  for (size_t offset = 0; offset < kData.size(); offset += buff_size) {
+    // Each buffer is only valid while it is being parsed.
+    std::string buff = kData.substr(offset, buff_size);
+    parser.AssignBuffer(buff.data(), buff.size());
+    while (parser.GetNextBlock(2, block) > 0);
+  }
+  parser.SetEndOfStream();
+  while (parser.GetNextBlock(2, block) > 0);
+}
+
+}  // anonymous namespace
+
+TEST(LibsvmParserTest, ParseNumbers) {
+  const std::string nums[] = {"0", "-17", "3.25", "1e-3", "-2.5E+2",
+    "0.000001", "123456789012345678901234"};
+  const float expected[] = {0, -17, 3.25, 1e-3, -250, 1e-6,
+    1.23456789012345678901234e23};
+  for (int i = 0; i < 7; ++i) {
+    float val;
+    const char *end = nums[i].data() + nums[i].size();
+    EXPECT_EQ(end, LibsvmParser::ParseFloat(nums[i].data(), end, &val));
+    EXPECT_FLOAT_EQ(expected[i], val);
+  }
+  int32_t ival;
+  const std::string id = "42:1";
+  EXPECT_EQ(id.data() + 2,
+            LibsvmParser::ParseInt(id.data(), id.data() + id.size(), &ival));
+  EXPECT_EQ(42, ival);
+}
+
+TEST(LibsvmParserTest, RecordsSpanningBuffers) {
+  LibsvmBlock expected;
+  ParseInBuffers(kData.size(), &expected);
+  ASSERT_EQ(5, expected.GetNumRows());
+  EXPECT_EQ(1, expected.labels[0]);
+  EXPECT_EQ(-1, expected.labels[3]);
+  EXPECT_EQ(2, expected.labels[4]);
+  EXPECT_EQ(3, expected.row_offsets[1]);
+  EXPECT_EQ(expected.row_offsets[3], expected.row_offsets[4]);
+  EXPECT_EQ(11, expected.feature_ids[2]);
+  EXPECT_FLOAT_EQ(-12.5, expected.feature_vals[2]);
+  EXPECT_FLOAT_EQ(0.03, expected.feature_vals[5]);
+  EXPECT_FLOAT_EQ(123456789, expected.feature_vals[7]);
+
+  for (size_t buff_size = 1; buff_size < kData.size(); ++buff_size) {
+    LibsvmBlock block;
+    ParseInBuffers(buff_size, &block);
+    EXPECT_EQ(expected.labels, block.labels) << "buff_size " << buff_size;
+    EXPECT_EQ(expected.row_offsets, block.row_offsets);
+    EXPECT_EQ(expected.feature_ids, block.feature_ids);
+    EXPECT_EQ(expected.feature_vals, block.feature_vals);
+  }
+}
+
+TEST(LibsvmParserTest, SparseFeatureOutput) {
+  LibsvmParserConfig config;
+  config.feature_dim = 12;
+  config.label_one_based = true;
+  LibsvmParser parser(config);
+  parser.AssignBuffer(kData.data(), kData.size());
+  int32_t label;
+  SparseFeature<float> feature;
+  ASSERT_TRUE(parser.GetNext(&label, &feature));
+  EXPECT_EQ(0, label);
+  EXPECT_EQ(3, feature.GetNumEntries());
+  EXPECT_FLOAT_EQ(2, feature[10]);
+  EXPECT_FLOAT_EQ(0, feature[4]);
+  int num_records = 1;
+  while (parser.GetNext(&label, &feature)) ++num_records;
+  // The last record has no trailing newline.
+  EXPECT_EQ(4, num_records);
+  parser.SetEndOfStream();
+  ASSERT_TRUE(parser.GetNext(&label, &feature));
+  EXPECT_EQ(1, label);
+  EXPECT_FALSE(parser.GetNext(&label, &feature));
+  EXPECT_EQ(5, parser.get_num_records());
+}
+
+}  // namespace ml
+}  // namespace petuum
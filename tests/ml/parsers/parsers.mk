@@ -0,0 +1,28 @@
+PARSERS_TESTS_DIR = $(TESTS)/ml/parsers
+PARSERS_SRC_DIR=$(SRC)/ml/parsers
+
+parsers_test_run_all: libsvm_parser_test_run
+
+$(TESTS_BIN)/libsvm_parser_test: $(PARSERS_TESTS_DIR)/libsvm_parser_test.cpp \
+	$(PARSERS_SRC_DIR)/libsvm_parser.hpp $(PARSERS_SRC_DIR)/libsvm_parser.o
+	$(CXX) $(CXXFLAGS) $(INCFLAGS) $^ $(TESTS_LDFLAGS) -o $@
+
+libsvm_parser_test_run: $(TESTS_BIN)/libsvm_parser_test
+	$<
+
+# Benchmark against ReadDataLabelLibSVM, e.g.
+# make libsvm_parser_perf_run LIBSVM_PERF_ARGS="--data_file=... \
+#   --feature_dim=... --num_data=..."
+$(TESTS_BIN)/libsvm_parser_perf: $(PARSERS_TESTS_DIR)/libsvm_parser_perf.cpp \
+	$(PARSERS_SRC_DIR)/libsvm_parser.o \
+	$(SRC)/ml/util/data_loading.o \
+	$(SRC)/ml/disk_stream/disk_reader.o \
+	$(SRC)/ml/disk_stream/multi_buffer.o \
+	$(SRC)/ml/disk_stream/byte_buffer.o \
+	$(SRC)/petuum_ps_common/util/high_resolution_timer.o
+	$(CXX) $(CXXFLAGS) $(INCFLAGS) $^ $(LDFLAGS) -o $@
+
+libsvm_parser_perf_run: $(TESTS_BIN)/libsvm_parser_perf
+	GLOG_logtostderr=true $< $(LIBSVM_PERF_ARGS)
+
+.PHONY: libsvm_parser_perf_run
@@ -220,5 +220,148 @@ TEST(MathUtilTest, FeatureScaleAndAdd) {
   }
 }
 
+TEST(MathUtilTest, FeatureMatrixKernels) {
+  int feature_dim = 50;
+  int num_rows = 7;
+  int num_labels = 3;
+  std::vector<SparseFeature<float> > features(num_rows);
+  FeatureMatrix<float> minibatch(feature_dim);
+  std::vector<int32_t> labels(num_rows);
+  // An empty row, rows shorter than the 8-wide gather, one of exactly 8
+  // and longer ones with and without a tail.
+  int row_sizes[] = {0, 3, 7, 8, 13, 24, 50};
+  for (int i = 0; i < num_rows; ++i) {
+    std::vector<int> feature_ids;
+    std::vector<float> vals;
+    for (int k = 0; k < row_sizes[i]; ++k) {
+      int j = k * feature_dim / row_sizes[i];
+      feature_ids.push_back(j);
+      vals.push_back((j % 3 == 0 ? -1 : 1) * (0.1 * j + i + 1));
+    }
+    features[i] = SparseFeature<float>(feature_ids, vals, feature_dim);
+    minibatch.AddRow(features[i]);
+    ASSERT_EQ(row_sizes[i], minibatch.GetRowOffsets()[i + 1]
+        - minibatch.GetRowOffsets()[i]);
+    labels[i] = i % num_labels;
+  }
+
+  std::vector<DenseFeature<float> > w(num_labels,
+      DenseFeature<float>(feature_dim));
+  std::vector<const float*> w_ptrs(num_labels);
+  for (int k = 0; k < num_labels; ++k) {
+    for (int j = 0; j < feature_dim; ++j) {
+      w[k][j] = 0.01 * (j - k);
+    }
+    w_ptrs[k] = w[k].GetVector().data();
+  }
+
+  std::vector<float> dots(num_rows);
+  FeatureMatrixDotProduct(minibatch, w_ptrs[1], dots.data());
+  for (int i = 0; i < num_rows; ++i) {
+    EXPECT_NEAR(SparseDenseFeatureDotProduct(features[i], w[1]), dots[i],
+        1e-4);
+  }
+
+  std::vector<float> coeffs;
+  FeatureMatrixSoftmaxGradient(minibatch, w_ptrs, labels, &coeffs);
+  ASSERT_EQ(num_rows * num_labels, coeffs.size());
+  std::vector<float> predict(num_labels);
+  DenseFeature<float> expected_w(w[0]);
+  for (int i = 0; i < num_rows; ++i) {
+    for (int k = 0; k < num_labels; ++k) {
+      predict[k] = SparseDenseFeatureDotProduct(features[i], w[k]);
+    }
+    Softmax(&predict);
+    predict[labels[i]] -= 1.;
+    for (int k = 0; k < num_labels; ++k) {
+      EXPECT_NEAR(predict[k], coeffs[k * num_rows + i], 1e-4);
+    }
+    FeatureScaleAndAdd(-0.5 * predict[0], features[i], &expected_w);
+  }
+
+  // Both the CSR and the CSC paths.
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1) {
+      minibatch.BuildCSC();
+    }
+    DenseFeature<float> w0(w[0]);
+    FeatureMatrixScaleAndAdd(-0.5, minibatch, coeffs.data(),
+        w0.GetVector().data());
+    for (int j = 0; j < feature_dim; ++j) {
+      EXPECT_NEAR(expected_w[j], w0[j], 1e-4) << "j: " << j;
+    }
+  }
+}
+
+// The gather kernels agree with the scalar one on rows of every length
+// around the 8-wide vector loop.
+TEST(MathUtilTest, FeatureMatrixGatherKernels) {
+  int feature_dim = 100;
+  int num_rows = 34;
+  FeatureMatrix<float> minibatch(feature_dim);
+  for (int i = 0; i < num_rows; ++i) {
+    std::vector<int> feature_ids;
+    std::vector<float> vals;
+    for (int k = 0; k < i; ++k) {
+      // Out of order across rows, and hitting both ends of w.
+      int j = (k * 37 + i) % feature_dim;
+      feature_ids.push_back(j);
+      vals.push_back(0.25 * (k + 1) - 0.1 * i);
+    }
+    std::vector<int> order(feature_ids.size());
+    for (int k = 0; k < static_cast<int>(order.size()); ++k) {
+      order[k] = k;
+    }
+    std::sort(order.begin(), order.end(), [&feature_ids](int a, int b) {
+        return feature_ids[a] < feature_ids[b]; });
+    std::vector<int> sorted_ids;
+    std::vector<float> sorted_vals;
+    for (int k : order) {
+      sorted_ids.push_back(feature_ids[k]);
+      sorted_vals.push_back(vals[k]);
+    }
+    minibatch.AddRow(SparseFeature<float>(sorted_ids, sorted_vals,
+        feature_dim));
+  }
+  minibatch.BuildCSC();
+
+  std::vector<float> w(feature_dim);
+  for (int j = 0; j < feature_dim; ++j) {
+    w[j] = 0.01 * j - 0.3;
+  }
+  std::vector<float> coeffs(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    coeffs[i] = 0.5 - 0.03 * i;
+  }
+
+  ASSERT_TRUE(SelectFeatureMatrixKernels("scalar"));
+  std::vector<float> expected_dots(num_rows);
+  FeatureMatrixDotProduct(minibatch, w.data(), expected_dots.data());
+  std::vector<float> expected_w(w);
+  FeatureMatrixScaleAndAdd(-0.5, minibatch, coeffs.data(),
+      expected_w.data());
+
+  if (SelectFeatureMatrixKernels("avx2")) {
+    std::vector<float> dots(num_rows);
+    FeatureMatrixDotProduct(minibatch, w.data(), dots.data());
+    for (int i = 0; i < num_rows; ++i) {
+      EXPECT_NEAR(expected_dots[i], dots[i], 1e-4) << "row " << i;
+    }
+    std::vector<float> w_avx2(w);
+    FeatureMatrixScaleAndAdd(-0.5, minibatch, coeffs.data(), w_avx2.data());
+    for (int j = 0; j < feature_dim; ++j) {
+      EXPECT_NEAR(expected_w[j], w_avx2[j], 1e-4) << "j: " << j;
+    }
+  } else {
+    LOG(INFO) << "CPU without AVX2, only the scalar kernel is tested.";
+  }
+  EXPECT_FALSE(SelectFeatureMatrixKernels("no_such_kernel"));
+
+  // Back to the default.
+  if (!SelectFeatureMatrixKernels("avx2")) {
+    SelectFeatureMatrixKernels("scalar");
+  }
+}
+
 }  // namespace ml
 }  // namespace petuum
@@ -0,0 +1,15 @@
+TESTS_CLIENT_DIR=$(TESTS)/petuum_ps/client
+
+row_shards_test: $(TESTS_CLIENT_DIR)/row_shards_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_CLIENT_DIR)/row_shards_test.cpp $(PETUUM_PS_LIB) $(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_CLIENT_DIR)/row_shards_test
+
+run_row_shards_test: row_shards_test
+	GLOG_logtostderr=true \
+	$(TESTS_CLIENT_DIR)/row_shards_test
+
+clean_row_shards_test:
+	rm -rf $(TESTS_CLIENT_DIR)/row_shards_test
+
+.PHONY: row_shards_test run_row_shards_test clean_row_shards_test
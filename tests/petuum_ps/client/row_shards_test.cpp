@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps/client/row_shards.hpp>
+#include <petuum_ps_common/storage/dense_row.hpp>
+#include <petuum_ps_common/util/class_register.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace petuum {
+
+namespace {
+
+const int32_t kDenseRowType = 1;
+// 10 columns in shards of 4, 4 and 2 (+2 unused) columns.
+const int32_t kNumShards = 3;
+const size_t kRowCapacity = 10;
+const int32_t kRowID = 5;
+
+// One call of the func passed to ForEachShardBatch().
+struct ShardBatch {
+  int32_t shard_row_id;
+  std::vector<int32_t> column_ids;
+  std::vector<float> updates;
+};
+
+class RowShardsTest : public ::testing::Test {
+protected:
+  RowShardsTest() {
+    ClassRegistry<AbstractRow>::GetRegistry().AddCreator(
+        kDenseRowType, CreateObj<AbstractRow, DenseRow<float> >);
+  }
+
+  std::vector<ShardBatch> SplitBatch(const RowShards &row_shards,
+                                     const std::vector<int32_t> &column_ids,
+                                     const std::vector<float> &updates) {
+    std::vector<ShardBatch> batches;
+    row_shards.ForEachShardBatch(
+        kRowID, column_ids.data(), updates.data(), column_ids.size(),
+        &column_ids_buff_, &updates_buff_,
+        [&batches](int32_t shard_row_id, const int32_t *shard_column_ids,
+                   const void *shard_updates, int32_t num_shard_updates) {
+          const float *shard_updates_float
+              = reinterpret_cast<const float*>(shard_updates);
+          ShardBatch batch;
+          batch.shard_row_id = shard_row_id;
+          batch.column_ids.assign(shard_column_ids,
+                                  shard_column_ids + num_shard_updates);
+          batch.updates.assign(shard_updates_float,
+                               shard_updates_float + num_shard_updates);
+          batches.push_back(batch);
+        });
+    return batches;
+  }
+
+  std::vector<int32_t> column_ids_buff_;
+  std::vector<uint8_t> updates_buff_;
+};
+
+}  // anonymous namespace
+
+TEST_F(RowShardsTest, ShardCapacity) {
+  EXPECT_EQ(4u, RowShards::GetShardCapacity(10, 3));
+  EXPECT_EQ(5u, RowShards::GetShardCapacity(10, 2));
+  EXPECT_EQ(10u, RowShards::GetShardCapacity(10, 1));
+
+  RowShards row_shards(kNumShards, kRowCapacity, kDenseRowType);
+  EXPECT_TRUE(row_shards.is_split());
+  EXPECT_EQ(4u, row_shards.get_shard_capacity());
+  EXPECT_FALSE(RowShards(1, kRowCapacity, kDenseRowType).is_split());
+
+  std::vector<int32_t> shard_row_ids;
+  row_shards.GetShardRowIDs(kRowID, &shard_row_ids);
+  EXPECT_EQ(std::vector<int32_t>({15, 16, 17}), shard_row_ids);
+}
+
+TEST_F(RowShardsTest, GetShardColumn) {
+  RowShards row_shards(kNumShards, kRowCapacity, kDenseRowType);
+  // {column_id, shard, shard_column_id}, at the shard boundaries.
+  const int32_t cases[][3] = {{0, 0, 0}, {3, 0, 3}, {4, 1, 0}, {7, 1, 3},
+                              {8, 2, 0}, {9, 2, 1}};
+  for (const auto &c : cases) {
+    int32_t shard_column_id = -1;
+    EXPECT_EQ(kRowID*kNumShards + c[1],
+              row_shards.GetShardColumn(kRowID, c[0], &shard_column_id));
+    EXPECT_EQ(c[2], shard_column_id);
+  }
+
+  int32_t shard_column_id;
+  EXPECT_DEATH(row_shards.GetShardColumn(kRowID, -1, &shard_column_id), "");
+  EXPECT_DEATH(row_shards.GetShardColumn(kRowID, kRowCapacity,
+                                         &shard_column_id), "");
+}
+
+TEST_F(RowShardsTest, ForEachShardBatch) {
+  RowShards row_shards(kNumShards, kRowCapacity, kDenseRowType);
+  std::vector<ShardBatch> batches = SplitBatch(
+      row_shards, {9, 0, 4, 3, 8, 7}, {9.0f, 0.0f, 4.0f, 3.0f, 8.0f, 7.0f});
+  ASSERT_EQ(3u, batches.size());
+
+  // Shards in order, updates within a shard in the order given.
+  EXPECT_EQ(15, batches[0].shard_row_id);
+  EXPECT_EQ(std::vector<int32_t>({0, 3}), batches[0].column_ids);
+  EXPECT_EQ(std::vector<float>({0.0f, 3.0f}), batches[0].updates);
+  EXPECT_EQ(16, batches[1].shard_row_id);
+  EXPECT_EQ(std::vector<int32_t>({0, 3}), batches[1].column_ids);
+  EXPECT_EQ(std::vector<float>({4.0f, 7.0f}), batches[1].updates);
+  EXPECT_EQ(17, batches[2].shard_row_id);
+  EXPECT_EQ(std::vector<int32_t>({1, 0}), batches[2].column_ids);
+  EXPECT_EQ(std::vector<float>({9.0f, 8.0f}), batches[2].updates);
+
+  // Shards without updates are skipped.
+  batches = SplitBatch(row_shards, {8, 1}, {8.0f, 1.0f});
+  ASSERT_EQ(2u, batches.size());
+  EXPECT_EQ(15, batches[0].shard_row_id);
+  EXPECT_EQ(std::vector<int32_t>({1}), batches[0].column_ids);
+  EXPECT_EQ(17, batches[1].shard_row_id);
+  EXPECT_EQ(std::vector<int32_t>({0}), batches[1].column_ids);
+
+  EXPECT_TRUE(SplitBatch(row_shards, {}, {}).empty());
+}
+
+TEST_F(RowShardsTest, ForEachShardBatchOutOfRange) {
+  RowShards row_shards(kNumShards, kRowCapacity, kDenseRowType);
+  EXPECT_DEATH(SplitBatch(row_shards, {0, -1}, {0.0f, 1.0f}), "");
+  // In the unused tail of the last shard.
+  EXPECT_DEATH(SplitBatch(row_shards, {10}, {1.0f}), "");
+}
+
+TEST_F(RowShardsTest, ForEachShardDenseBatch) {
+  RowShards row_shards(kNumShards, kRowCapacity, kDenseRowType);
+  std::vector<float> updates = {2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f};
+  // {shard_row_id, shard_index_st, num_shard_updates, first update}
+  std::vector<std::vector<int32_t> > calls;
+  row_shards.ForEachShardDenseBatch(
+      kRowID, updates.data(), 2, updates.size(),
+      [&calls](int32_t shard_row_id, const void *shard_updates,
+               int32_t shard_index_st, int32_t num_shard_updates) {
+        calls.push_back({shard_row_id, shard_index_st, num_shard_updates,
+                static_cast<int32_t>(
+                    *reinterpret_cast<const float*>(shard_updates))});
+      });
+  ASSERT_EQ(3u, calls.size());
+  EXPECT_EQ(std::vector<int32_t>({15, 2, 2, 2}), calls[0]);
+  EXPECT_EQ(std::vector<int32_t>({16, 0, 4, 4}), calls[1]);
+  EXPECT_EQ(std::vector<int32_t>({17, 0, 1, 8}), calls[2]);
+
+  // Ends exactly at a shard boundary.
+  calls.clear();
+  row_shards.ForEachShardDenseBatch(
+      kRowID, updates.data(), 4, 4,
+      [&calls](int32_t shard_row_id, const void *shard_updates,
+               int32_t shard_index_st, int32_t num_shard_updates) {
+        calls.push_back({shard_row_id, shard_index_st, num_shard_updates});
+      });
+  ASSERT_EQ(1u, calls.size());
+  EXPECT_EQ(std::vector<int32_t>({16, 0, 4}), calls[0]);
+
+  EXPECT_DEATH(row_shards.ForEachShardDenseBatch(
+      kRowID, updates.data(), 4, 7,
+      [](int32_t, const void*, int32_t, int32_t) { }), "");
+}
+
+TEST_F(RowShardsTest, Assemble) {
+  RowShards row_shards(kNumShards, kRowCapacity, kDenseRowType);
+  std::vector<std::unique_ptr<DenseRow<float> > > shard_rows;
+  std::vector<AbstractRow*> shard_row_ptrs;
+  for (int32_t shard = 0; shard < kNumShards; ++shard) {
+    shard_rows.emplace_back(new DenseRow<float>);
+    shard_rows[shard]->Init(row_shards.get_shard_capacity());
+    for (size_t col = 0; col < row_shards.get_shard_capacity(); ++col) {
+      float update = shard*row_shards.get_shard_capacity() + col;
+      shard_rows[shard]->ApplyInc(col, &update);
+    }
+    shard_row_ptrs.push_back(shard_rows[shard].get());
+  }
+
+  DenseRow<float> row;
+  row.Init(kRowCapacity);
+  std::vector<uint8_t> buff;
+  row_shards.Assemble(shard_row_ptrs.data(), &row, &buff);
+  for (size_t col = 0; col < kRowCapacity; ++col) {
+    EXPECT_EQ(static_cast<float>(col), row[col]);
+  }
+
+  // Assembling again overwrites the row rather than adding to it.
+  float update = 100.0f;
+  shard_rows[1]->ApplyInc(0, &update);
+  row_shards.Assemble(shard_row_ptrs.data(), &row, &buff);
+  EXPECT_EQ(104.0f, row[4]);
+  EXPECT_EQ(5.0f, row[5]);
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
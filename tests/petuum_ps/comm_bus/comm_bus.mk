@@ -0,0 +1,15 @@
+TESTS_COMM_BUS_DIR=$(TESTS)/petuum_ps/comm_bus
+
+inproc_ring_test: $(TESTS_COMM_BUS_DIR)/inproc_ring_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_COMM_BUS_DIR)/inproc_ring_test.cpp $(PETUUM_PS_LIB) $(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_COMM_BUS_DIR)/inproc_ring_test
+
+run_inproc_ring_test: inproc_ring_test
+	GLOG_logtostderr=true \
+	$(TESTS_COMM_BUS_DIR)/inproc_ring_test
+
+clean_inproc_ring_test:
+	rm -rf $(TESTS_COMM_BUS_DIR)/inproc_ring_test
+
+.PHONY: inproc_ring_test run_inproc_ring_test clean_inproc_ring_test
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps_common/comm_bus/inproc_ring.hpp>
+
+#include <poll.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace petuum {
+
+namespace {
+
+void PushValue(InProcRing *ring, int32_t sender_id, int64_t value) {
+  ring->Push(sender_id, &value, sizeof(value));
+}
+
+// Pushes through the zmq::message_t overload.
+void PushValueMsg(InProcRing *ring, int32_t sender_id, int64_t value) {
+  zmq::message_t msg(sizeof(value));
+  memcpy(msg.data(), &value, sizeof(value));
+  ring->Push(sender_id, &msg);
+  EXPECT_EQ(0u, msg.size());
+}
+
+int64_t GetValue(const zmq::message_t &msg) {
+  EXPECT_EQ(sizeof(int64_t), msg.size());
+  int64_t value;
+  memcpy(&value, msg.data(), sizeof(value));
+  return value;
+}
+
+void ExpectPop(InProcRing *ring, int32_t sender_id, int64_t value) {
+  int32_t popped_sender_id;
+  zmq::message_t msg;
+  ASSERT_TRUE(ring->Pop(&popped_sender_id, &msg));
+  EXPECT_EQ(sender_id, popped_sender_id);
+  EXPECT_EQ(value, GetValue(msg));
+}
+
+void ExpectEmpty(InProcRing *ring) {
+  int32_t sender_id;
+  zmq::message_t msg;
+  EXPECT_FALSE(ring->Pop(&sender_id, &msg));
+}
+
+}  // anonymous namespace
+
+TEST(InProcRingTest, PushPop) {
+  InProcRing ring(8);
+  ExpectEmpty(&ring);
+  PushValue(&ring, 1, 10);
+  PushValueMsg(&ring, 2, 20);
+  ExpectPop(&ring, 1, 10);
+  ExpectPop(&ring, 2, 20);
+  ExpectEmpty(&ring);
+
+  // Empty messages are messages too.
+  char unused;
+  ring.Push(3, &unused, 0);
+  int32_t sender_id;
+  zmq::message_t msg;
+  ASSERT_TRUE(ring.Pop(&sender_id, &msg));
+  EXPECT_EQ(3, sender_id);
+  EXPECT_EQ(0u, msg.size());
+}
+
+TEST(InProcRingTest, WrapAround) {
+  InProcRing ring(3);
+  EXPECT_EQ(4u, ring.get_capacity());
+  int64_t next_push = 0;
+  int64_t next_pop = 0;
+  // Go around the ring many times, from empty to full and at odd offsets.
+  for (int32_t round = 0; round < 100; ++round) {
+    int32_t num_push = round % 4 + 1;
+    for (int32_t i = 0; i < num_push; ++i) {
+      PushValue(&ring, 0, next_push++);
+    }
+    for (int32_t i = 0; i < num_push; ++i) {
+      ExpectPop(&ring, 0, next_pop++);
+    }
+    ExpectEmpty(&ring);
+  }
+}
+
+// Push() on a full ring does not wait for the consumer, and messages that
+// overflow the ring are received after the ones in it.
+TEST(InProcRingTest, FullRingOverflows) {
+  InProcRing ring(4);
+  for (int64_t i = 0; i < 20; ++i) {
+    PushValue(&ring, 0, i);
+  }
+  // Received in order; pushes in between go after the overflowed ones.
+  for (int64_t i = 0; i < 10; ++i) {
+    ExpectPop(&ring, 0, i);
+  }
+  for (int64_t i = 20; i < 25; ++i) {
+    PushValueMsg(&ring, 0, i);
+  }
+  for (int64_t i = 10; i < 25; ++i) {
+    ExpectPop(&ring, 0, i);
+  }
+  ExpectEmpty(&ring);
+
+  // Once drained, the ring is used again.
+  for (int64_t i = 0; i < 4; ++i) {
+    PushValue(&ring, 0, i);
+  }
+  for (int64_t i = 0; i < 4; ++i) {
+    ExpectPop(&ring, 0, i);
+  }
+  ExpectEmpty(&ring);
+
+  // Messages left behind are freed with the ring.
+  for (int64_t i = 0; i < 10; ++i) {
+    PushValue(&ring, 0, i);
+  }
+}
+
+// Each producer's messages arrive in the order it pushed them, with the
+// ring wrapping and overflowing, and the consumer blocking when it runs
+// dry.
+TEST(InProcRingTest, MultiProducerOrder) {
+  const int32_t kNumProducers = 4;
+  const int64_t kNumMsgs = 100000;
+  InProcRing ring(64);
+
+  std::vector<std::thread> producers;
+  for (int32_t producer = 0; producer < kNumProducers; ++producer) {
+    producers.emplace_back([&ring, producer, kNumMsgs]() {
+        for (int64_t i = 0; i < kNumMsgs; ++i) {
+          if (i % 2 == 0)
+            PushValue(&ring, producer, i);
+          else
+            PushValueMsg(&ring, producer, i);
+          if (i % 1000 == 0)
+            std::this_thread::yield();
+        }
+      });
+  }
+
+  std::vector<int64_t> next_values(kNumProducers, 0);
+  for (int64_t n = 0; n < kNumProducers*kNumMsgs; ++n) {
+    int32_t sender_id;
+    zmq::message_t msg;
+    ASSERT_TRUE(ring.Pop(&sender_id, &msg, 16, -1));
+    ASSERT_GE(sender_id, 0);
+    ASSERT_LT(sender_id, kNumProducers);
+    ASSERT_EQ(next_values[sender_id], GetValue(msg)) << sender_id;
+    ++next_values[sender_id];
+  }
+  for (auto &producer : producers)
+    producer.join();
+  ExpectEmpty(&ring);
+}
+
+// A consumer blocked in Pop() is woken by a Push().
+TEST(InProcRingTest, BlockingPopWakes) {
+  InProcRing ring(8);
+  int32_t sender_id;
+  zmq::message_t msg;
+  EXPECT_FALSE(ring.Pop(&sender_id, &msg, 0, 0));
+  EXPECT_FALSE(ring.Pop(&sender_id, &msg, 0, 20));
+
+  for (int32_t round = 0; round < 20; ++round) {
+    std::atomic<bool> popped(false);
+    std::thread consumer([&ring, &popped, round]() {
+        int32_t sender_id;
+        zmq::message_t msg;
+        EXPECT_TRUE(ring.Pop(&sender_id, &msg, 0, -1));
+        EXPECT_EQ(round, GetValue(msg));
+        popped = true;
+      });
+    // Odd rounds race the consumer going to sleep.
+    if (round % 2 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      EXPECT_FALSE(popped);
+    }
+    PushValue(&ring, 0, round);
+    consumer.join();
+    EXPECT_TRUE(popped);
+  }
+}
+
+// The PrepareWait() protocol lets the consumer poll the eventfd itself.
+TEST(InProcRingTest, EventFdWait) {
+  InProcRing ring(8);
+  pollfd poll_fd;
+  poll_fd.fd = ring.get_event_fd();
+  poll_fd.events = POLLIN;
+
+  // Not sleeping: producers leave the eventfd alone.
+  PushValue(&ring, 0, 1);
+  poll_fd.revents = 0;
+  EXPECT_EQ(0, poll(&poll_fd, 1, 0));
+  ExpectPop(&ring, 0, 1);
+
+  ring.PrepareWait();
+  ExpectEmpty(&ring);
+  std::thread producer([&ring]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      PushValue(&ring, 0, 2);
+    });
+  poll_fd.revents = 0;
+  EXPECT_EQ(1, poll(&poll_fd, 1, 10000));
+  ring.FinishWait();
+  producer.join();
+  ExpectPop(&ring, 0, 2);
+
+  // FinishWait() reset the eventfd.
+  poll_fd.revents = 0;
+  EXPECT_EQ(0, poll(&poll_fd, 1, 0));
+}
+
+// Two threads that fill each other's ring before receiving anything, as a
+// bg thread and a server thread may, do not deadlock.
+TEST(InProcRingTest, MutualFullRings) {
+  const int64_t kNumMsgs = 1000;
+  InProcRing ring0(16);
+  InProcRing ring1(16);
+  InProcRing *rings[2] = {&ring0, &ring1};
+  std::vector<std::thread> threads;
+  for (int32_t me = 0; me < 2; ++me) {
+    threads.emplace_back([&rings, me, kNumMsgs]() {
+        InProcRing *peer_ring = rings[1 - me];
+        for (int64_t i = 0; i < kNumMsgs; ++i) {
+          PushValue(peer_ring, me, i);
+        }
+        for (int64_t i = 0; i < kNumMsgs; ++i) {
+          int32_t sender_id;
+          zmq::message_t msg;
+          ASSERT_TRUE(rings[me]->Pop(&sender_id, &msg, 0, -1));
+          EXPECT_EQ(1 - me, sender_id);
+          EXPECT_EQ(i, GetValue(msg));
+        }
+      });
+  }
+  for (auto &thread : threads)
+    thread.join();
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
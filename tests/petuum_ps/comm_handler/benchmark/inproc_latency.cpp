@@ -0,0 +1,79 @@
+// Round-trip latency of CommBus in-process messages between two threads,
+// through zmq inproc sockets and through InProcRing.
+
+#include <petuum_ps_common/comm_bus/comm_bus.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+#include <glog/logging.h>
+#include <gflags/gflags.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+DEFINE_int32(num_round_trips, 100000, "number of round trips.");
+DEFINE_int32(msg_size, 64, "message size in bytes.");
+DEFINE_int32(inproc_ring_spin, 1000, "times to poll an empty ring before "
+             "blocking.");
+
+namespace {
+
+const int32_t kPingerID = 1;
+const int32_t kPongerID = 2;
+
+double RunPingPong(bool inproc_ring) {
+  petuum::CommBus comm_bus(0, 10, 1, 1, inproc_ring, FLAGS_inproc_ring_spin);
+
+  std::thread ponger([&comm_bus]() {
+      petuum::CommBus::Config config(kPongerID, petuum::CommBus::kInProc, "");
+      comm_bus.ThreadRegister(config);
+      int32_t sender_id;
+      zmq::message_t msg;
+      comm_bus.RecvInProc(&sender_id, &msg);  // connect
+      CHECK_EQ(sender_id, kPingerID);
+      for (int32_t i = 0; i < FLAGS_num_round_trips; ++i) {
+        comm_bus.RecvInProc(&sender_id, &msg);
+        comm_bus.SendInProc(sender_id, msg.data(), msg.size());
+      }
+      comm_bus.ThreadDeregister();
+    });
+
+  petuum::CommBus::Config config(kPingerID, petuum::CommBus::kInProc, "");
+  comm_bus.ThreadRegister(config);
+  // For zmq, the ponger must bind before we connect.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  int32_t connect = 0;
+  comm_bus.ConnectTo(kPongerID, &connect, sizeof(connect));
+
+  std::vector<uint8_t> buff(FLAGS_msg_size, 1);
+  int32_t sender_id;
+  zmq::message_t msg;
+  petuum::HighResolutionTimer timer;
+  for (int32_t i = 0; i < FLAGS_num_round_trips; ++i) {
+    comm_bus.SendInProc(kPongerID, buff.data(), buff.size());
+    comm_bus.RecvInProc(&sender_id, &msg);
+    CHECK_EQ(msg.size(), buff.size());
+  }
+  double elapsed = timer.elapsed();
+
+  ponger.join();
+  comm_bus.ThreadDeregister();
+  return elapsed;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  double zmq_sec = RunPingPong(false);
+  double ring_sec = RunPingPong(true);
+
+  LOG(INFO) << "msg_size = " << FLAGS_msg_size
+            << " num_round_trips = " << FLAGS_num_round_trips;
+  LOG(INFO) << "zmq inproc: "
+            << zmq_sec / FLAGS_num_round_trips * 1000000 << " us/round trip";
+  LOG(INFO) << "InProcRing (spin " << FLAGS_inproc_ring_spin << "): "
+            << ring_sec / FLAGS_num_round_trips * 1000000 << " us/round trip";
+  LOG(INFO) << "speedup = " << zmq_sec / ring_sec;
+  return 0;
+}
@@ -152,3 +152,8 @@ tests_comm_ct1client: mk_tests_bin $(TESTS_COMM_SRC_CPP) $(TESTS_COMM_SRC_HPP) \
 	$(CXX) $(INCFLAGS) $(TESTS_COMM_INCFLAGS) $(CPPFLAGS) $(TESTS_COMM_SRC_CPP) \
 	$(TESTS_COMM_TESTS)/complex_test1/client.cpp $(TESTS_COMM_ST_LIBS) $(TESTS_COMM_DY_LIBS) \
 	-o $(TESTS_BIN)/$@
+
+inproc_latency_benchmark: $(TESTS_COMM_TESTS)/benchmark/inproc_latency.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_COMM_TESTS)/benchmark/inproc_latency.cpp $(PETUUM_PS_LIB) \
+	$(PETUUM_LDFLAGS) -o $(TESTS_COMM_TESTS)/benchmark/inproc_latency
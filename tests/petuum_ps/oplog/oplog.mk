@@ -33,6 +33,34 @@ run_append_only_oplog_benchmark: append_only_oplog_benchmark
 clean_append_only_oplog_benchmark:
 	rm -rf append_only_oplog_benchmark
 
+sparse_row_oplog_benchmark: $(TESTS_OPLOG_DIR)/sparse_row_oplog_benchmark.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_OPLOG_DIR)/sparse_row_oplog_benchmark.cpp $(PETUUM_PS_LIB) $(PETUUM_LDFLAGS) \
+	-o $(TESTS_OPLOG_DIR)/sparse_row_oplog_benchmark
+
+run_sparse_row_oplog_benchmark: sparse_row_oplog_benchmark
+	GLOG_logtostderr=true \
+	$(TESTS_OPLOG_DIR)/sparse_row_oplog_benchmark
+
+clean_sparse_row_oplog_benchmark:
+	rm -rf sparse_row_oplog_benchmark
+
+sparse_row_oplog_test: $(TESTS_OPLOG_DIR)/sparse_row_oplog_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_OPLOG_DIR)/sparse_row_oplog_test.cpp $(PETUUM_PS_LIB) $(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_OPLOG_DIR)/sparse_row_oplog_test
+
+run_sparse_row_oplog_test: sparse_row_oplog_test
+	GLOG_logtostderr=true \
+	$(TESTS_OPLOG_DIR)/sparse_row_oplog_test
+
+clean_sparse_row_oplog_test:
+	rm -rf $(TESTS_OPLOG_DIR)/sparse_row_oplog_test
+
 .PHONY: oplog_benchmark run_oplog_benchmark clean_oplog_benchmark \
 	append_only_oplog_benchmark run_append_only_oplog_benchmark \
-	clean_append_only_oplog_benchmark
+	clean_append_only_oplog_benchmark \
+	sparse_row_oplog_benchmark run_sparse_row_oplog_benchmark \
+	clean_sparse_row_oplog_benchmark \
+	sparse_row_oplog_test run_sparse_row_oplog_test \
+	clean_sparse_row_oplog_test
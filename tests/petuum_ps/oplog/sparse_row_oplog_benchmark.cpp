@@ -0,0 +1,111 @@
+// Accumulating random sparse updates into a row oplog and serializing it:
+// SparseRowOpLog against the std::map of separately allocated updates it
+// used to keep.
+
+#include <petuum_ps_common/oplog/sparse_row_oplog.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+#include <glog/logging.h>
+#include <gflags/gflags.h>
+#include <map>
+#include <random>
+#include <vector>
+
+DEFINE_int32(row_size, 100000, "number of columns in a row.");
+DEFINE_int32(min_num_updates, 4, "fewest updates per row oplog.");
+DEFINE_int32(max_num_updates, 65536, "most updates per row oplog.");
+DEFINE_int32(total_updates, 10000000, "updates per measurement.");
+
+namespace {
+
+void InitFloat(int32_t col_id, void *update) {
+  *reinterpret_cast<float*>(update) = 0;
+}
+
+bool CheckZeroFloat(const void *update) {
+  return *reinterpret_cast<const float*>(update) == 0;
+}
+
+class MapRowOpLog {
+public:
+  ~MapRowOpLog() {
+    Reset();
+  }
+
+  void Reset() {
+    for (auto &oplog : oplogs_)
+      delete[] oplog.second;
+    oplogs_.clear();
+  }
+
+  void *FindCreate(int32_t col_id) {
+    auto iter = oplogs_.find(col_id);
+    if (iter != oplogs_.end())
+      return iter->second;
+    uint8_t *update = new uint8_t[sizeof(float)];
+    InitFloat(col_id, update);
+    oplogs_[col_id] = update;
+    return update;
+  }
+
+  size_t GetSparseSerializedSize() const {
+    return sizeof(int32_t) + (sizeof(int32_t) + sizeof(float))*oplogs_.size();
+  }
+
+  void SerializeSparse(void *mem) const {
+    *reinterpret_cast<int32_t*>(mem) = oplogs_.size();
+    int32_t *mem_index = reinterpret_cast<int32_t*>(mem) + 1;
+    uint8_t *mem_oplogs = reinterpret_cast<uint8_t*>(
+        mem_index + oplogs_.size());
+    for (const auto &oplog : oplogs_) {
+      *(mem_index++) = oplog.first;
+      memcpy(mem_oplogs, oplog.second, sizeof(float));
+      mem_oplogs += sizeof(float);
+    }
+  }
+
+private:
+  std::map<int32_t, uint8_t*> oplogs_;
+};
+
+template<typename RowOpLog>
+double TimeRowOpLog(RowOpLog *row_oplog, const std::vector<int32_t> &col_ids,
+                    int32_t num_updates, std::vector<uint8_t> *mem) {
+  petuum::HighResolutionTimer timer;
+  for (size_t i = 0; i + num_updates <= col_ids.size(); i += num_updates) {
+    row_oplog->Reset();
+    for (int32_t j = 0; j < num_updates; ++j)
+      *reinterpret_cast<float*>(row_oplog->FindCreate(col_ids[i + j])) += 1;
+    mem->resize(row_oplog->GetSparseSerializedSize());
+    row_oplog->SerializeSparse(mem->data());
+  }
+  return timer.elapsed();
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int32_t> col_dist(0, FLAGS_row_size - 1);
+  std::vector<int32_t> col_ids(FLAGS_total_updates);
+  for (auto &col_id : col_ids)
+    col_id = col_dist(generator);
+
+  std::vector<uint8_t> mem;
+  petuum::SparseRowOpLog flat_row_oplog(InitFloat, CheckZeroFloat,
+                                        sizeof(float));
+  MapRowOpLog map_row_oplog;
+  for (int32_t num_updates = FLAGS_min_num_updates;
+       num_updates <= FLAGS_max_num_updates; num_updates *= 4) {
+    double map_sec = TimeRowOpLog(&map_row_oplog, col_ids, num_updates, &mem);
+    double flat_sec = TimeRowOpLog(&flat_row_oplog, col_ids, num_updates,
+                                   &mem);
+    LOG(INFO) << "num_updates = " << num_updates
+              << " map: " << map_sec / col_ids.size() * 1e9 << " ns/update"
+              << " flat: " << flat_sec / col_ids.size() * 1e9 << " ns/update"
+              << " speedup = " << map_sec / flat_sec;
+  }
+  return 0;
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps_common/oplog/sparse_row_oplog.hpp>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace petuum {
+
+namespace {
+
+SparseRowOpLog *CreateOpLog() {
+  return new SparseRowOpLog(
+      [](int32_t col_id, void *update) {
+        *reinterpret_cast<float*>(update) = 0.0f;
+      },
+      [](const void *update) {
+        return *reinterpret_cast<const float*>(update) == 0.0f;
+      },
+      sizeof(float));
+}
+
+float GetValue(int32_t col_id) {
+  return col_id + 0.5f;
+}
+
+// Sets col_id to GetValue(col_id) through FindCreate().
+void Set(SparseRowOpLog *oplog, int32_t col_id) {
+  float *update = reinterpret_cast<float*>(oplog->FindCreate(col_id));
+  ASSERT_TRUE(update != 0);
+  *update = GetValue(col_id);
+}
+
+// All (column id, update) pairs in ordered traversal.
+std::vector<std::pair<int32_t, float> > Iterate(SparseRowOpLog *oplog) {
+  std::vector<std::pair<int32_t, float> > updates;
+  int32_t col_id;
+  for (const void *update = oplog->BeginIterateConst(&col_id); update != 0;
+       update = oplog->NextConst(&col_id)) {
+    updates.push_back(
+        std::make_pair(col_id, *reinterpret_cast<const float*>(update)));
+  }
+  return updates;
+}
+
+void ExpectContains(SparseRowOpLog *oplog,
+                    const std::vector<int32_t> &col_ids) {
+  EXPECT_EQ(col_ids.size(), oplog->GetSize());
+  for (int32_t col_id : col_ids) {
+    const float *update
+        = reinterpret_cast<const float*>(oplog->FindConst(col_id));
+    ASSERT_TRUE(update != 0) << col_id;
+    EXPECT_EQ(GetValue(col_id), *update);
+  }
+}
+
+}  // anonymous namespace
+
+// Rows grow past the linear scan size, the size the index starts at and
+// the sizes it is rebuilt at.
+TEST(SparseRowOpLogTest, FindCreateAcrossIndexThreshold) {
+  std::unique_ptr<SparseRowOpLog> oplog(CreateOpLog());
+  const int32_t kNumColumns = 101;
+  std::vector<int32_t> col_ids;
+  for (int32_t i = 0; i < kNumColumns; ++i) {
+    // Out of order, with collisions in the index.
+    int32_t col_id = (i*37) % kNumColumns * 64;
+    EXPECT_TRUE(oplog->Find(col_id) == 0);
+    Set(oplog.get(), col_id);
+    col_ids.push_back(col_id);
+    ExpectContains(oplog.get(), col_ids);
+    EXPECT_TRUE(oplog->Find(col_id + 1) == 0);
+    EXPECT_TRUE(oplog->Find(-col_id - 1) == 0);
+  }
+
+  // FindCreate() of an existing column keeps its update.
+  for (int32_t col_id : col_ids) {
+    EXPECT_EQ(GetValue(col_id),
+              *reinterpret_cast<float*>(oplog->FindCreate(col_id)));
+  }
+  EXPECT_EQ(col_ids.size(), oplog->GetSize());
+}
+
+TEST(SparseRowOpLogTest, LazySort) {
+  const int32_t sizes[] = {5, 16, 17, 40};
+  for (int32_t size : sizes) {
+    std::unique_ptr<SparseRowOpLog> oplog(CreateOpLog());
+    std::vector<int32_t> col_ids;
+    for (int32_t i = size - 1; i >= 0; --i) {
+      Set(oplog.get(), i*3);
+      col_ids.push_back(i*3);
+    }
+    std::vector<std::pair<int32_t, float> > updates = Iterate(oplog.get());
+    ASSERT_EQ(static_cast<size_t>(size), updates.size());
+    for (int32_t i = 0; i < size; ++i) {
+      EXPECT_EQ(i*3, updates[i].first);
+      EXPECT_EQ(GetValue(i*3), updates[i].second);
+    }
+
+    // The index follows the sorted order, and later inserts out of order
+    // are sorted again.
+    ExpectContains(oplog.get(), col_ids);
+    Set(oplog.get(), 1);
+    col_ids.push_back(1);
+    ExpectContains(oplog.get(), col_ids);
+    int32_t col_id;
+    float *update = reinterpret_cast<float*>(oplog->BeginIterate(&col_id));
+    EXPECT_EQ(0, col_id);
+    update = reinterpret_cast<float*>(oplog->Next(&col_id));
+    EXPECT_EQ(1, col_id);
+    EXPECT_EQ(GetValue(1), *update);
+  }
+}
+
+TEST(SparseRowOpLogTest, ClearZerosAndGetNoneZeroSize) {
+  std::unique_ptr<SparseRowOpLog> oplog(CreateOpLog());
+  EXPECT_EQ(0u, oplog->ClearZerosAndGetNoneZeroSize());
+
+  // 40 columns, of which 30 are zeros: shrinks below the linear scan size.
+  std::vector<int32_t> kept;
+  for (int32_t i = 39; i >= 0; --i) {
+    if (i % 4 == 0) {
+      Set(oplog.get(), i);
+      kept.push_back(i);
+    } else {
+      oplog->FindCreate(i);
+    }
+  }
+  EXPECT_EQ(40u, oplog->GetSize());
+  EXPECT_EQ(kept.size(), oplog->ClearZerosAndGetNoneZeroSize());
+  ExpectContains(oplog.get(), kept);
+  EXPECT_TRUE(oplog->Find(1) == 0);
+  EXPECT_TRUE(oplog->Find(39) == 0);
+
+  std::vector<std::pair<int32_t, float> > updates = Iterate(oplog.get());
+  ASSERT_EQ(kept.size(), updates.size());
+  EXPECT_EQ(0, updates.front().first);
+  EXPECT_EQ(36, updates.back().first);
+
+  // Stays above the linear scan size.
+  for (int32_t i = 100; i < 140; ++i) {
+    Set(oplog.get(), i);
+    kept.push_back(i);
+  }
+  oplog->FindCreate(1000);
+  EXPECT_EQ(kept.size(), oplog->ClearZerosAndGetNoneZeroSize());
+  ExpectContains(oplog.get(), kept);
+  EXPECT_TRUE(oplog->Find(1000) == 0);
+
+  // All zeros.
+  *reinterpret_cast<float*>(oplog->FindCreate(0)) = 0.0f;
+  for (int32_t col_id : kept) {
+    *reinterpret_cast<float*>(oplog->FindCreate(col_id)) = 0.0f;
+  }
+  EXPECT_EQ(0u, oplog->ClearZerosAndGetNoneZeroSize());
+  EXPECT_EQ(0u, oplog->GetSize());
+  EXPECT_TRUE(oplog->Find(0) == 0);
+}
+
+TEST(SparseRowOpLogTest, SerializeSparse) {
+  const int32_t sizes[] = {0, 1, 16, 50};
+  for (int32_t size : sizes) {
+    std::unique_ptr<SparseRowOpLog> oplog(CreateOpLog());
+    std::map<int32_t, float> expected;
+    for (int32_t i = 0; i < size; ++i) {
+      int32_t col_id = (i*7) % size * 2;
+      Set(oplog.get(), col_id);
+      expected[col_id] = GetValue(col_id);
+    }
+
+    size_t serialized_size = oplog->GetSparseSerializedSize();
+    EXPECT_EQ(sizeof(int32_t) + size*(sizeof(int32_t) + sizeof(float)),
+              serialized_size);
+    std::vector<uint8_t> mem(serialized_size);
+    EXPECT_EQ(serialized_size, oplog->SerializeSparse(mem.data()));
+
+    const int32_t *col_ids;
+    int32_t num_updates;
+    size_t parsed_size;
+    const float *updates = reinterpret_cast<const float*>(
+        oplog->ParseSparseSerializedOpLog(mem.data(), &col_ids, &num_updates,
+                                          &parsed_size));
+    EXPECT_EQ(serialized_size, parsed_size);
+    ASSERT_EQ(size, num_updates);
+    EXPECT_TRUE(std::is_sorted(col_ids, col_ids + num_updates));
+
+    std::unique_ptr<SparseRowOpLog> parsed_oplog(CreateOpLog());
+    for (int32_t i = 0; i < num_updates; ++i) {
+      *reinterpret_cast<float*>(parsed_oplog->FindCreate(col_ids[i]))
+          = updates[i];
+    }
+    std::vector<std::pair<int32_t, float> > expected_updates(
+        expected.begin(), expected.end());
+    EXPECT_EQ(expected_updates, Iterate(parsed_oplog.get()));
+  }
+}
+
+TEST(SparseRowOpLogTest, ResetAndOverwrite) {
+  std::unique_ptr<SparseRowOpLog> oplog(CreateOpLog());
+  for (int32_t i = 0; i < 30; ++i) {
+    Set(oplog.get(), 30 - i);
+  }
+  oplog->Reset();
+  EXPECT_EQ(0u, oplog->GetSize());
+  EXPECT_TRUE(oplog->Find(1) == 0);
+  int32_t col_id;
+  EXPECT_TRUE(oplog->BeginIterate(&col_id) == 0);
+
+  Set(oplog.get(), 5);
+  float dense_updates[] = {GetValue(4), 1.0f, GetValue(6)};
+  oplog->OverwriteWithDenseUpdate(dense_updates, 4, 3);
+  std::vector<std::pair<int32_t, float> > expected
+      = {{4, GetValue(4)}, {5, 1.0f}, {6, GetValue(6)}};
+  EXPECT_EQ(expected, Iterate(oplog.get()));
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps/server/pending_row_requests.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace petuum {
+
+namespace {
+
+const int32_t kTableID = 1;
+
+// (bg_id, row_id) of each requester, in the order given.
+std::vector<std::pair<int32_t, int32_t> > GetRequests(
+    const FulfilledRowRequests &fulfilled) {
+  std::vector<std::pair<int32_t, int32_t> > requests;
+  for (const auto &requester : fulfilled.requesters) {
+    EXPECT_LT(requester.row_idx, static_cast<int32_t>(fulfilled.rows.size()));
+    requests.push_back(std::make_pair(
+        requester.bg_id, fulfilled.rows[requester.row_idx].row_id));
+  }
+  return requests;
+}
+
+typedef std::vector<std::pair<int32_t, int32_t> > Requests;
+
+}  // anonymous namespace
+
+TEST(PendingRowRequestsTest, TakeFulfilled) {
+  PendingRowRequests pending;
+  FulfilledRowRequests fulfilled;
+  EXPECT_FALSE(pending.TakeFulfilled(0, &fulfilled));
+
+  pending.Add(0, kTableID, 10, 3, true, 7);
+  pending.Add(1, kTableID, 10, 3);
+  pending.Add(1, kTableID + 1, 10, 3);
+  pending.Add(2, kTableID, 11, 4);
+  EXPECT_EQ(4u, pending.get_num_pending());
+
+  EXPECT_FALSE(pending.TakeFulfilled(2, &fulfilled));
+  ASSERT_TRUE(pending.TakeFulfilled(3, &fulfilled));
+  // The same row of two tables are different rows.
+  ASSERT_EQ(2u, fulfilled.rows.size());
+  EXPECT_EQ(kTableID, fulfilled.rows[0].table_id);
+  EXPECT_EQ(kTableID + 1, fulfilled.rows[1].table_id);
+  EXPECT_EQ(Requests({{0, 10}, {1, 10}, {1, 10}}), GetRequests(fulfilled));
+  EXPECT_TRUE(fulfilled.requesters[0].accept_row_delta);
+  EXPECT_EQ(7u, fulfilled.requesters[0].cached_row_version);
+  EXPECT_FALSE(fulfilled.requesters[1].accept_row_delta);
+  EXPECT_EQ(kNoRowDeltaVersion, fulfilled.requesters[1].cached_row_version);
+  EXPECT_EQ(1u, pending.get_num_pending());
+
+  ASSERT_TRUE(pending.TakeFulfilled(4, &fulfilled));
+  EXPECT_EQ(Requests({{2, 11}}), GetRequests(fulfilled));
+  EXPECT_EQ(0u, pending.get_num_pending());
+  EXPECT_FALSE(pending.TakeFulfilled(4, &fulfilled));
+  EXPECT_TRUE(fulfilled.rows.empty());
+  EXPECT_TRUE(fulfilled.requesters.empty());
+}
+
+TEST(PendingRowRequestsTest, TakeFulfilledSkippedClocks) {
+  PendingRowRequests pending;
+  FulfilledRowRequests fulfilled;
+  pending.Add(0, kTableID, 1, 1);
+  pending.Add(1, kTableID, 2, 3);
+  pending.Add(2, kTableID, 1, 6);
+  pending.Add(3, kTableID, 3, 6);
+  pending.Add(4, kTableID, 4, 7);
+
+  // The min clock jumps from 0 to 6 at once: the requests of clocks 1, 3
+  // and 6 are merged and row 1 is sent once.
+  ASSERT_TRUE(pending.TakeFulfilled(6, &fulfilled));
+  EXPECT_EQ(3u, fulfilled.rows.size());
+  EXPECT_EQ(Requests({{0, 1}, {1, 2}, {2, 1}, {3, 3}}),
+            GetRequests(fulfilled));
+  EXPECT_EQ(fulfilled.requesters[0].row_idx, fulfilled.requesters[2].row_idx);
+  EXPECT_EQ(1u, pending.get_num_pending());
+
+  // Past every pending clock.
+  ASSERT_TRUE(pending.TakeFulfilled(100, &fulfilled));
+  EXPECT_EQ(Requests({{4, 4}}), GetRequests(fulfilled));
+  EXPECT_EQ(0u, pending.get_num_pending());
+
+  // Requests after a jump start a new window.
+  pending.Add(0, kTableID, 5, 101);
+  EXPECT_FALSE(pending.TakeFulfilled(100, &fulfilled));
+  ASSERT_TRUE(pending.TakeFulfilled(101, &fulfilled));
+  EXPECT_EQ(Requests({{0, 5}}), GetRequests(fulfilled));
+}
+
+TEST(PendingRowRequestsTest, Grow) {
+  PendingRowRequests pending;
+  FulfilledRowRequests fulfilled;
+  // 1 and 9 share a bucket of the initial ring of 8, so it has to grow.
+  pending.Add(0, kTableID, 1, 1);
+  pending.Add(0, kTableID, 9, 9);
+  // Far beyond the ring.
+  pending.Add(1, kTableID, 100, 100);
+  // Below the min clock.
+  pending.Add(2, kTableID, 0, 0);
+  pending.Add(3, kTableID, 9, 9);
+  EXPECT_EQ(5u, pending.get_num_pending());
+
+  ASSERT_TRUE(pending.TakeFulfilled(0, &fulfilled));
+  EXPECT_EQ(Requests({{2, 0}}), GetRequests(fulfilled));
+  ASSERT_TRUE(pending.TakeFulfilled(8, &fulfilled));
+  EXPECT_EQ(Requests({{0, 1}}), GetRequests(fulfilled));
+  ASSERT_TRUE(pending.TakeFulfilled(9, &fulfilled));
+  EXPECT_EQ(1u, fulfilled.rows.size());
+  EXPECT_EQ(Requests({{0, 9}, {3, 9}}), GetRequests(fulfilled));
+  EXPECT_FALSE(pending.TakeFulfilled(99, &fulfilled));
+  ASSERT_TRUE(pending.TakeFulfilled(100, &fulfilled));
+  EXPECT_EQ(Requests({{1, 100}}), GetRequests(fulfilled));
+  EXPECT_EQ(0u, pending.get_num_pending());
+}
+
+TEST(PendingRowRequestsTest, GrowKeepsEveryClock) {
+  PendingRowRequests pending;
+  FulfilledRowRequests fulfilled;
+  // One request per clock, the window growing one clock at a time.
+  const int32_t kNumClocks = 40;
+  for (int32_t clock = 0; clock < kNumClocks; ++clock) {
+    pending.Add(clock % 4, kTableID, clock, clock);
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumClocks), pending.get_num_pending());
+
+  for (int32_t clock = 0; clock < kNumClocks; ++clock) {
+    ASSERT_TRUE(pending.TakeFulfilled(clock, &fulfilled));
+    EXPECT_EQ(Requests({{clock % 4, clock}}), GetRequests(fulfilled));
+  }
+  EXPECT_EQ(0u, pending.get_num_pending());
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
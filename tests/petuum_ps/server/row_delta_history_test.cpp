@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps/server/row_delta_history.hpp>
+#include <petuum_ps/server/server_table.hpp>
+#include <petuum_ps_common/storage/dense_row.hpp>
+#include <petuum_ps_common/util/class_register.hpp>
+
+#include <string.h>
+#include <map>
+#include <vector>
+
+namespace petuum {
+
+namespace {
+
+const int32_t kDenseRowType = 1;
+const size_t kUpdateSize = sizeof(float);
+// Size of a recorded sparse update of one column.
+const size_t kEntrySize = sizeof(int32_t) + kUpdateSize;
+
+// Parses a delta in the sparse oplog format.
+std::map<int32_t, float> ParseDelta(const std::vector<uint8_t> &mem,
+                                    size_t size) {
+  int32_t num_updates;
+  memcpy(&num_updates, mem.data(), sizeof(int32_t));
+  EXPECT_EQ(sizeof(int32_t) + num_updates*kEntrySize, size);
+  const uint8_t *column_ids = mem.data() + sizeof(int32_t);
+  const uint8_t *updates = column_ids + num_updates*sizeof(int32_t);
+  std::map<int32_t, float> delta;
+  for (int32_t i = 0; i < num_updates; ++i) {
+    int32_t column_id;
+    float update;
+    memcpy(&column_id, column_ids + i*sizeof(int32_t), sizeof(int32_t));
+    memcpy(&update, updates + i*kUpdateSize, kUpdateSize);
+    delta[column_id] = update;
+  }
+  return delta;
+}
+
+class RowDeltaHistoryTest : public ::testing::Test {
+protected:
+  RowDeltaHistoryTest():
+      mem_(1024) {
+    ClassRegistry<AbstractRow>::GetRegistry().AddCreator(
+        kDenseRowType, CreateObj<AbstractRow, DenseRow<float> >);
+    sample_row_.Init(16);
+  }
+
+  void Record(int32_t client_id, int32_t column_id, float update,
+              size_t max_size) {
+    history_.Record(client_id, &column_id, &update, 1, false, kUpdateSize,
+                    max_size);
+  }
+
+  size_t SerializeDelta(uint64_t base_version, int32_t client_id,
+                        size_t max_size = 1024) {
+    return history_.SerializeDelta(base_version, client_id, &sample_row_,
+                                   kUpdateSize, max_size, mem_.data());
+  }
+
+  RowDeltaHistory history_;
+  DenseRow<float> sample_row_;
+  std::vector<uint8_t> mem_;
+};
+
+}  // anonymous namespace
+
+TEST_F(RowDeltaHistoryTest, SumOfOtherClients) {
+  Record(0, 1, 1.0f, 1024);
+  Record(1, 1, 2.0f, 1024);
+  Record(1, 3, 4.0f, 1024);
+  Record(2, 1, 8.0f, 1024);
+  EXPECT_EQ(4u, history_.get_version());
+
+  size_t size = SerializeDelta(0, 1);
+  EXPECT_EQ((std::map<int32_t, float>{{1, 9.0f}}), ParseDelta(mem_, size));
+  size = SerializeDelta(1, 0);
+  EXPECT_EQ((std::map<int32_t, float>{{1, 10.0f}, {3, 4.0f}}),
+            ParseDelta(mem_, size));
+  size = SerializeDelta(3, 1);
+  EXPECT_EQ((std::map<int32_t, float>{{1, 8.0f}}), ParseDelta(mem_, size));
+
+  // Nothing since the latest version.
+  size = SerializeDelta(4, 0);
+  EXPECT_EQ(sizeof(int32_t), size);
+  EXPECT_TRUE(ParseDelta(mem_, size).empty());
+  // A version the row never had.
+  EXPECT_EQ(0u, SerializeDelta(5, 0));
+}
+
+TEST_F(RowDeltaHistoryTest, Dense) {
+  float updates[] = {1.0f, 0.0f, 2.0f};
+  history_.Record(0, 0, updates, 3, true, kUpdateSize, 1024);
+  history_.Record(0, 0, updates, 2, true, kUpdateSize, 1024);
+  size_t size = SerializeDelta(0, 1);
+  EXPECT_EQ((std::map<int32_t, float>{{0, 2.0f}, {1, 0.0f}, {2, 2.0f}}),
+            ParseDelta(mem_, size));
+}
+
+TEST_F(RowDeltaHistoryTest, EvictionOrder) {
+  // Room for 3 entries; version v is reached by the update of column v.
+  const size_t max_size = 3*kEntrySize;
+  for (int32_t column_id = 1; column_id <= 5; ++column_id) {
+    Record(0, column_id, 1.0f, max_size);
+  }
+  EXPECT_EQ(5u, history_.get_version());
+
+  // The oldest entries went first: versions 0 and 1 are gone.
+  EXPECT_EQ(0u, SerializeDelta(0, 1));
+  EXPECT_EQ(0u, SerializeDelta(1, 1));
+  size_t size = SerializeDelta(2, 1);
+  EXPECT_EQ((std::map<int32_t, float>{{3, 1.0f}, {4, 1.0f}, {5, 1.0f}}),
+            ParseDelta(mem_, size));
+  size = SerializeDelta(4, 1);
+  EXPECT_EQ((std::map<int32_t, float>{{5, 1.0f}}), ParseDelta(mem_, size));
+
+  // An entry larger than max_size evicts everything, itself included.
+  float updates[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  int32_t column_ids[4] = {0, 1, 2, 3};
+  history_.Record(1, column_ids, updates, 4, false, kUpdateSize, max_size);
+  EXPECT_EQ(6u, history_.get_version());
+  EXPECT_EQ(0u, SerializeDelta(5, 0));
+  EXPECT_EQ(sizeof(int32_t), SerializeDelta(6, 0));
+}
+
+TEST_F(RowDeltaHistoryTest, DeltaLargerThanMaxSize) {
+  Record(0, 1, 1.0f, 1024);
+  Record(0, 2, 1.0f, 1024);
+  EXPECT_EQ(0u, SerializeDelta(0, 1, sizeof(int32_t) + kEntrySize));
+  EXPECT_EQ(sizeof(int32_t) + 2*kEntrySize,
+            SerializeDelta(0, 1, sizeof(int32_t) + 2*kEntrySize));
+  EXPECT_EQ(0u, SerializeDelta(0, 1, sizeof(int32_t) - 1));
+}
+
+// A client whose cached version fell out of the history gets the full row.
+TEST_F(RowDeltaHistoryTest, EvictedVersionFallsBackToRow) {
+  const size_t kRowCapacity = 4;
+  TableInfo table_info;
+  table_info.row_type = kDenseRowType;
+  table_info.row_capacity = kRowCapacity;
+  ServerTable server_table(0, table_info);
+  ServerRow *server_row = server_table.CreateRow(0);
+  size_t row_size = server_row->SerializedSize();
+  ASSERT_EQ(kRowCapacity*kUpdateSize, row_size);
+
+  std::vector<uint8_t> reply(
+      server_table.GetRowReplySizeBound(server_row));
+  const RowReplyHeader *header
+      = reinterpret_cast<const RowReplyHeader*>(reply.data());
+
+  // The first request starts the history.
+  size_t reply_size = server_table.SerializeRowReply(
+      server_row, 0, true, kNoRowDeltaVersion, reply.data());
+  EXPECT_EQ(sizeof(RowReplyHeader) + row_size, reply_size);
+  EXPECT_EQ(0u, header->row_version);
+  EXPECT_EQ(kNoRowDeltaVersion, header->base_version);
+
+  int32_t column_id = 1;
+  float update = 1.0f;
+  server_table.ApplyRowOpLog(0, &column_id, &update, 1, 1);
+  reply_size = server_table.SerializeRowReply(server_row, 0, true, 0,
+                                              reply.data());
+  EXPECT_EQ(sizeof(RowReplyHeader) + sizeof(int32_t) + kEntrySize,
+            reply_size);
+  EXPECT_EQ(1u, header->row_version);
+  EXPECT_EQ(0u, header->base_version);
+
+  // The history holds row_size bytes, i.e. 2 such updates; version 0 is
+  // evicted by the 3rd.
+  for (int32_t i = 0; i < 2; ++i) {
+    server_table.ApplyRowOpLog(0, &column_id, &update, 1, 1);
+  }
+  reply_size = server_table.SerializeRowReply(server_row, 0, true, 0,
+                                              reply.data());
+  EXPECT_EQ(sizeof(RowReplyHeader) + row_size, reply_size);
+  EXPECT_EQ(3u, header->row_version);
+  EXPECT_EQ(kNoRowDeltaVersion, header->base_version);
+  float row_data[kRowCapacity];
+  memcpy(row_data, reply.data() + sizeof(RowReplyHeader), row_size);
+  EXPECT_EQ(3.0f, row_data[column_id]);
+  EXPECT_EQ(0.0f, row_data[0]);
+
+  // A version still in the history gets a delta.
+  reply_size = server_table.SerializeRowReply(server_row, 0, true, 2,
+                                              reply.data());
+  EXPECT_EQ(sizeof(RowReplyHeader) + sizeof(int32_t) + kEntrySize,
+            reply_size);
+  EXPECT_EQ(2u, header->base_version);
+
+  // A client that does not accept deltas gets the row and no row version.
+  reply_size = server_table.SerializeRowReply(server_row, 0, false, 2,
+                                              reply.data());
+  EXPECT_EQ(sizeof(RowReplyHeader) + row_size, reply_size);
+  EXPECT_EQ(kNoRowDeltaVersion, header->row_version);
+  EXPECT_EQ(kNoRowDeltaVersion, header->base_version);
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,47 @@
+TESTS_SERVER_DIR=$(TESTS)/petuum_ps/server
+
+server_table_snapshot_test: $(TESTS_SERVER_DIR)/server_table_snapshot_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_SERVER_DIR)/server_table_snapshot_test.cpp $(PETUUM_PS_LIB) \
+	$(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_SERVER_DIR)/server_table_snapshot_test
+
+run_server_table_snapshot_test: server_table_snapshot_test
+	GLOG_logtostderr=true \
+	$(TESTS_SERVER_DIR)/server_table_snapshot_test
+
+clean_server_table_snapshot_test:
+	rm -rf $(TESTS_SERVER_DIR)/server_table_snapshot_test
+
+pending_row_requests_test: $(TESTS_SERVER_DIR)/pending_row_requests_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_SERVER_DIR)/pending_row_requests_test.cpp $(PETUUM_PS_LIB) \
+	$(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_SERVER_DIR)/pending_row_requests_test
+
+run_pending_row_requests_test: pending_row_requests_test
+	GLOG_logtostderr=true \
+	$(TESTS_SERVER_DIR)/pending_row_requests_test
+
+clean_pending_row_requests_test:
+	rm -rf $(TESTS_SERVER_DIR)/pending_row_requests_test
+
+row_delta_history_test: $(TESTS_SERVER_DIR)/row_delta_history_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_SERVER_DIR)/row_delta_history_test.cpp $(PETUUM_PS_LIB) \
+	$(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_SERVER_DIR)/row_delta_history_test
+
+run_row_delta_history_test: row_delta_history_test
+	GLOG_logtostderr=true \
+	$(TESTS_SERVER_DIR)/row_delta_history_test
+
+clean_row_delta_history_test:
+	rm -rf $(TESTS_SERVER_DIR)/row_delta_history_test
+
+.PHONY: server_table_snapshot_test run_server_table_snapshot_test \
+	clean_server_table_snapshot_test \
+	pending_row_requests_test run_pending_row_requests_test \
+	clean_pending_row_requests_test \
+	row_delta_history_test run_row_delta_history_test \
+	clean_row_delta_history_test
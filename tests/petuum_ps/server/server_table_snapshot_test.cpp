@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps/server/server_table_snapshot.hpp>
+#include <petuum_ps_common/util/crc32c.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+using namespace petuum;
+
+namespace {
+
+// Row i holds i*7 bytes, so row 0 is empty.
+std::vector<uint8_t> MakeRow(int32_t row_id) {
+  std::vector<uint8_t> row(row_id*7);
+  for (size_t i = 0; i < row.size(); ++i)
+    row[i] = static_cast<uint8_t>(row_id + i*31);
+  return row;
+}
+
+void FlipByte(const std::string &filename, long offset) {
+  FILE *file = fopen(filename.c_str(), "r+b");
+  ASSERT_TRUE(file != 0);
+  ASSERT_EQ(0, fseek(file, offset, SEEK_SET));
+  int byte = fgetc(file);
+  ASSERT_NE(EOF, byte);
+  ASSERT_EQ(0, fseek(file, offset, SEEK_SET));
+  fputc(byte ^ 0x10, file);
+  fclose(file);
+}
+
+}  // anonymous namespace
+
+class SnapShotTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    char dir_template[] = "/tmp/snapshot_test.XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir_template) != 0);
+    dir_ = dir_template;
+    filename_ = dir_ + "/table.0.snapshot";
+  }
+
+  virtual void TearDown() {
+    unlink(filename_.c_str());
+    rmdir(dir_.c_str());
+  }
+
+  void WriteSnapShot(int32_t num_rows) {
+    SnapShotWriter writer;
+    writer.Open(filename_, 3, 1, 10, 0);
+    for (int32_t row_id = 0; row_id < num_rows; ++row_id) {
+      std::vector<uint8_t> row = MakeRow(row_id);
+      writer.AppendRow(row_id, row.data(), row.size());
+    }
+    writer.Close();
+  }
+
+  std::string dir_;
+  std::string filename_;
+};
+
+TEST(CRC32CTest, KnownAnswers) {
+  EXPECT_EQ(0u, CRC32C::Value("", 0));
+  EXPECT_EQ(0xE3069283u, CRC32C::Value("123456789", 9));
+
+  // RFC 3720, B.4.
+  std::vector<uint8_t> zeros(32, 0);
+  EXPECT_EQ(0x8A9136AAu, CRC32C::Value(zeros.data(), zeros.size()));
+  std::vector<uint8_t> ones(32, 0xff);
+  EXPECT_EQ(0x62A8AB43u, CRC32C::Value(ones.data(), ones.size()));
+  std::vector<uint8_t> incrementing(32);
+  for (int i = 0; i < 32; ++i)
+    incrementing[i] = i;
+  EXPECT_EQ(0x46DD794Eu,
+            CRC32C::Value(incrementing.data(), incrementing.size()));
+}
+
+TEST(CRC32CTest, ExtendMatchesValue) {
+  const char data[] = "The quick brown fox jumps over the lazy dog";
+  size_t size = strlen(data);
+  uint32_t whole = CRC32C::Value(data, size);
+  // Split at every offset, including unaligned ones.
+  for (size_t split = 0; split <= size; ++split) {
+    uint32_t crc = CRC32C::Value(data, split);
+    EXPECT_EQ(whole, CRC32C::Extend(crc, data + split, size - split))
+        << "split = " << split;
+  }
+}
+
+TEST_F(SnapShotTest, RoundTrip) {
+  int32_t num_rows = 100;
+  WriteSnapShot(num_rows);
+  EXPECT_EQ(-1, access((filename_ + ".tmp").c_str(), F_OK));
+
+  SnapShotReader reader;
+  reader.Open(filename_);
+  EXPECT_EQ(3, reader.get_header().table_id);
+  EXPECT_EQ(1, reader.get_header().server_id);
+  EXPECT_EQ(10, reader.get_header().clock);
+  EXPECT_EQ(static_cast<uint32_t>(kSnapShotFull), reader.get_header().kind);
+  EXPECT_EQ(10, reader.get_header().base_clock);
+  EXPECT_EQ(static_cast<uint64_t>(num_rows), reader.get_num_rows());
+
+  int32_t row_id;
+  size_t row_size;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    const void *data = reader.Next(&row_id, &row_size);
+    ASSERT_TRUE(data != 0);
+    EXPECT_EQ(i, row_id);
+    std::vector<uint8_t> row = MakeRow(i);
+    ASSERT_EQ(row.size(), row_size);
+    EXPECT_EQ(0, memcmp(row.data(), data, row_size));
+  }
+  EXPECT_TRUE(reader.Next(&row_id, &row_size) == 0);
+}
+
+TEST_F(SnapShotTest, NextBatchRoundTrip) {
+  int32_t num_rows = 10;
+  WriteSnapShot(num_rows);
+
+  SnapShotReader reader;
+  reader.Open(filename_);
+  SnapShotRowRef rows[4];
+  int32_t num_read = 0;
+  size_t num_batch_rows;
+  while ((num_batch_rows = reader.NextBatch(rows, 4)) > 0) {
+    for (size_t i = 0; i < num_batch_rows; ++i) {
+      EXPECT_TRUE(rows[i].Verify());
+      EXPECT_EQ(num_read, rows[i].row_id);
+      EXPECT_EQ(MakeRow(num_read).size(), rows[i].size);
+      ++num_read;
+    }
+  }
+  EXPECT_EQ(num_rows, num_read);
+}
+
+TEST_F(SnapShotTest, CorruptedRowIsRejected) {
+  WriteSnapShot(3);
+  // Row 0 is empty, so row 1's bytes follow the header and two frames.
+  long row1_offset = sizeof(SnapShotHeader) + 2*sizeof(SnapShotRowHeader);
+  FlipByte(filename_, row1_offset + 3);
+
+  SnapShotReader reader;
+  reader.Open(filename_);
+  SnapShotRowRef rows[3];
+  ASSERT_EQ(3u, reader.NextBatch(rows, 3));
+  EXPECT_TRUE(rows[0].Verify());
+  EXPECT_FALSE(rows[1].Verify());
+  EXPECT_TRUE(rows[2].Verify());
+  reader.Close();
+
+  SnapShotReader strict_reader;
+  strict_reader.Open(filename_);
+  int32_t row_id;
+  size_t row_size;
+  ASSERT_TRUE(strict_reader.Next(&row_id, &row_size) != 0);
+  EXPECT_DEATH(strict_reader.Next(&row_id, &row_size), "checksum mismatch");
+}
+
+TEST_F(SnapShotTest, CorruptedRowHeaderIsRejected) {
+  WriteSnapShot(3);
+  // Corrupt row 1's row_id; its data and row_size are intact.
+  long row1_header_offset = sizeof(SnapShotHeader)
+      + sizeof(SnapShotRowHeader) + offsetof(SnapShotRowHeader, row_id);
+  FlipByte(filename_, row1_header_offset);
+
+  SnapShotReader reader;
+  reader.Open(filename_);
+  SnapShotRowRef rows[3];
+  ASSERT_EQ(3u, reader.NextBatch(rows, 3));
+  EXPECT_NE(1, rows[1].row_id);
+  EXPECT_TRUE(rows[0].Verify());
+  EXPECT_FALSE(rows[1].Verify());
+  EXPECT_TRUE(rows[2].Verify());
+  reader.Close();
+
+  SnapShotReader strict_reader;
+  strict_reader.Open(filename_);
+  int32_t row_id;
+  size_t row_size;
+  ASSERT_TRUE(strict_reader.Next(&row_id, &row_size) != 0);
+  EXPECT_DEATH(strict_reader.Next(&row_id, &row_size), "checksum mismatch");
+}
+
+TEST_F(SnapShotTest, CorruptedHeaderIsRejected) {
+  WriteSnapShot(3);
+  FlipByte(filename_, offsetof(SnapShotHeader, clock));
+  SnapShotReader reader;
+  EXPECT_DEATH(reader.Open(filename_), "corrupted snapshot header");
+}
+
+TEST_F(SnapShotTest, CorruptedFooterIsRejected) {
+  WriteSnapShot(3);
+  SnapShotReader reader;
+  reader.Open(filename_);
+  size_t file_size = reader.get_file_size();
+  reader.Close();
+
+  FlipByte(filename_, file_size - sizeof(SnapShotFooter));
+  EXPECT_DEATH(reader.Open(filename_), "corrupted snapshot footer");
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
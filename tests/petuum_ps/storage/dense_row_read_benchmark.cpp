@@ -0,0 +1,128 @@
+// Compare DenseRow's seqlock read path with the mutex-guarded read path it
+// replaced. Reader threads repeatedly read from one row while an optional
+// writer thread applies dense batch updates to it.
+
+#include <petuum_ps_common/storage/dense_row.hpp>
+#include <petuum_ps_common/storage/vector_store.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+#include <glog/logging.h>
+#include <gflags/gflags.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+DEFINE_int32(num_readers, 4, "number of reader threads.");
+DEFINE_int32(num_reads, 1000000, "number of reads per reader thread.");
+DEFINE_int32(row_capacity, 1000, "number of columns in the row.");
+DEFINE_bool(with_writer, true, "run a writer thread concurrently.");
+DEFINE_string(read_op, "get", "get (operator[]) or copy (CopyToVector).");
+
+namespace {
+
+// The previous DenseRow read path: every read takes the row mutex.
+template<typename V>
+class MutexDenseRow {
+public:
+  void Init(size_t capacity) {
+    store_.Init(capacity);
+  }
+
+  V operator [](int32_t col_id) const {
+    std::unique_lock<std::mutex> lock(mtx_);
+    return store_.Get(col_id);
+  }
+
+  void CopyToVector(std::vector<V> *to) const {
+    std::unique_lock<std::mutex> lock(mtx_);
+    store_.CopyToVector(to);
+  }
+
+  void ApplyDenseBatchInc(const void *update_batch, int32_t index_st,
+                          int32_t num_updates) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    V *val_array = store_.GetPtr(index_st);
+    const V *update_array = reinterpret_cast<const V*>(update_batch);
+    for (int32_t i = 0; i < num_updates; ++i) {
+      val_array[i] += update_array[i];
+    }
+  }
+
+private:
+  mutable std::mutex mtx_;
+  petuum::VectorStore<V> store_;
+};
+
+template<typename RowType>
+double RunReaders(RowType *row) {
+  std::atomic<bool> stop_writer(false);
+  std::thread writer;
+  if (FLAGS_with_writer) {
+    writer = std::thread([row, &stop_writer]() {
+        std::vector<float> updates(FLAGS_row_capacity, 1.0);
+        while (!stop_writer.load(std::memory_order_relaxed)) {
+          row->ApplyDenseBatchInc(updates.data(), 0, FLAGS_row_capacity);
+        }
+      });
+  }
+
+  petuum::HighResolutionTimer timer;
+  std::vector<std::thread> readers;
+  std::vector<double> sums(FLAGS_num_readers, 0);
+  bool copy = (FLAGS_read_op == "copy");
+  for (int32_t t = 0; t < FLAGS_num_readers; ++t) {
+    readers.emplace_back([row, t, copy, &sums]() {
+        // CopyToVector() does not resize its target.
+        std::vector<float> buff(FLAGS_row_capacity);
+        double sum = 0;
+        for (int32_t i = 0; i < FLAGS_num_reads; ++i) {
+          if (copy) {
+            row->CopyToVector(&buff);
+            sum += buff[i % FLAGS_row_capacity];
+          } else {
+            sum += (*row)[i % FLAGS_row_capacity];
+          }
+        }
+        sums[t] = sum;
+      });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  double elapsed = timer.elapsed();
+
+  stop_writer = true;
+  if (FLAGS_with_writer)
+    writer.join();
+  return elapsed;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  CHECK(FLAGS_read_op == "get" || FLAGS_read_op == "copy")
+      << "unknown read_op " << FLAGS_read_op;
+
+  petuum::DenseRow<float> seqlock_row;
+  seqlock_row.Init(FLAGS_row_capacity);
+  double seqlock_sec = RunReaders(&seqlock_row);
+
+  MutexDenseRow<float> mutex_row;
+  mutex_row.Init(FLAGS_row_capacity);
+  double mutex_sec = RunReaders(&mutex_row);
+
+  double total_reads = static_cast<double>(FLAGS_num_readers)
+                       * FLAGS_num_reads;
+  LOG(INFO) << "read_op = " << FLAGS_read_op
+            << " num_readers = " << FLAGS_num_readers
+            << " with_writer = " << FLAGS_with_writer;
+  LOG(INFO) << "seqlock: " << seqlock_sec << " sec, "
+            << total_reads / seqlock_sec << " reads/sec";
+  LOG(INFO) << "mutex: " << mutex_sec << " sec, "
+            << total_reads / mutex_sec << " reads/sec";
+  LOG(INFO) << "speedup = " << mutex_sec / seqlock_sec;
+  return 0;
+}
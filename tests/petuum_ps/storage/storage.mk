@@ -40,5 +40,24 @@ run_row_test: row_test
 clean_row_test:
 	rm -rf $(TESTS_STORAGE_DIR)/row_test
 
+dense_row_read_benchmark: $(TESTS_STORAGE_DIR)/dense_row_read_benchmark.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_STORAGE_DIR)/dense_row_read_benchmark.cpp $(PETUUM_PS_LIB) \
+	$(PETUUM_LDFLAGS) -o $(TESTS_STORAGE_DIR)/dense_row_read_benchmark
+
+run_dense_row_read_benchmark: dense_row_read_benchmark
+	GLOG_logtostderr=true \
+	$(TESTS_STORAGE_DIR)/dense_row_read_benchmark \
+	--num_readers 4 \
+	--num_reads 1000000 \
+	--row_capacity 1000 \
+	--with_writer true \
+	--read_op get
+
+clean_dense_row_read_benchmark:
+	rm -rf $(TESTS_STORAGE_DIR)/dense_row_read_benchmark
+
 .PHONY: storage_test run_storage_test clean_storage_test \
-row_test run_row_test clean_row_test
+row_test run_row_test clean_row_test \
+dense_row_read_benchmark run_dense_row_read_benchmark \
+clean_dense_row_read_benchmark
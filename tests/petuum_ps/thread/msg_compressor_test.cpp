@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps/thread/msg_compressor.hpp>
+#include <petuum_ps_common/util/compress_util.hpp>
+
+#include <stdint.h>
+#include <string.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace petuum {
+
+// Rows in the serialized oplog layout EncodeRows() reads.
+class SerializedRows {
+public:
+  SerializedRows():
+      num_rows_(0) {
+    Append<int32_t>(0);
+  }
+
+  void AddSparseRow(int32_t row_id, const std::vector<int32_t> &col_ids,
+                    const std::vector<float> &updates) {
+    Append<int32_t>(row_id);
+    Append<int32_t>(col_ids.size());
+    for (int32_t col_id : col_ids)
+      Append<int32_t>(col_id);
+    for (float update : updates)
+      Append<float>(update);
+    SetNumRows(++num_rows_);
+  }
+
+  void AddDenseRow(int32_t row_id, const std::vector<float> &updates) {
+    Append<int32_t>(row_id);
+    for (float update : updates)
+      Append<float>(update);
+    SetNumRows(++num_rows_);
+  }
+
+  const std::vector<uint8_t> &get_mem() const {
+    return mem_;
+  }
+
+private:
+  template<typename T>
+  void Append(T val) {
+    const uint8_t *val_ptr = reinterpret_cast<const uint8_t*>(&val);
+    mem_.insert(mem_.end(), val_ptr, val_ptr + sizeof(T));
+  }
+
+  void SetNumRows(int32_t num_rows) {
+    memcpy(mem_.data(), &num_rows, sizeof(int32_t));
+  }
+
+  int32_t num_rows_;
+  std::vector<uint8_t> mem_;
+};
+
+class MsgCompressorTest : public ::testing::Test {
+protected:
+  // Encodes rows held in segments.
+  static std::vector<uint8_t> Encode(
+      const std::vector<MemSegment> &segments, size_t raw_size,
+      int32_t compress_type, int32_t dense_num_updates) {
+    MsgCompressor::TableCompressInfo info;
+    info.compress_type = compress_type;
+    info.update_size = sizeof(float);
+    info.dense_num_updates = dense_num_updates;
+
+    std::vector<uint8_t> encoded(raw_size + raw_size / 4
+                                 + CompressUtil::kMaxVarint32Size);
+    MemSegmentReader reader(segments.data(), segments.size());
+    size_t encoded_size = MsgCompressor::EncodeRows(&reader, raw_size, info,
+                                                    encoded.data());
+    EXPECT_LE(encoded_size, encoded.size());
+    EXPECT_EQ(0u, reader.GetContiguousSize());
+    encoded.resize(encoded_size);
+    return encoded;
+  }
+
+  // Encodes rows and decodes them back; returns the decoded rows.
+  static std::vector<uint8_t> RoundTrip(
+      const std::vector<uint8_t> &rows, int32_t compress_type,
+      int32_t dense_num_updates, size_t *encoded_size) {
+    std::vector<MemSegment> segments(1, MemSegment(rows.data(), rows.size()));
+    std::vector<uint8_t> encoded = Encode(segments, rows.size(),
+                                          compress_type, dense_num_updates);
+    *encoded_size = encoded.size();
+
+    std::vector<uint8_t> decoded(rows.size());
+    size_t decoded_size = MsgCompressor::DecodeRows(
+        encoded.data(), compress_type, sizeof(float), dense_num_updates,
+        decoded.data());
+    EXPECT_EQ(rows.size(), decoded_size);
+    return decoded;
+  }
+};
+
+TEST(CompressUtilTest, ZigZag) {
+  EXPECT_EQ(0u, CompressUtil::ZigZagEncode(0));
+  EXPECT_EQ(1u, CompressUtil::ZigZagEncode(-1));
+  EXPECT_EQ(2u, CompressUtil::ZigZagEncode(1));
+  EXPECT_EQ(3u, CompressUtil::ZigZagEncode(-2));
+  EXPECT_EQ(0xfffffffeu,
+            CompressUtil::ZigZagEncode(std::numeric_limits<int32_t>::max()));
+  EXPECT_EQ(0xffffffffu,
+            CompressUtil::ZigZagEncode(std::numeric_limits<int32_t>::min()));
+
+  const int32_t vals[] = {0, 1, -1, 63, -64, 1000000, -1000000,
+                          std::numeric_limits<int32_t>::max(),
+                          std::numeric_limits<int32_t>::min()};
+  for (int32_t val : vals) {
+    EXPECT_EQ(val, CompressUtil::ZigZagDecode(CompressUtil::ZigZagEncode(val)));
+  }
+}
+
+TEST(CompressUtilTest, Varint32) {
+  const uint32_t vals[] = {0, 1, 127, 128, 16383, 16384, 0x7fffffff,
+                           0xffffffffu};
+  const size_t sizes[] = {1, 1, 1, 2, 2, 3, 5, 5};
+  for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); ++i) {
+    uint8_t buff[CompressUtil::kMaxVarint32Size + 1];
+    memset(buff, 0xaa, sizeof(buff));
+    uint8_t *end = CompressUtil::PutVarint32(buff, vals[i]);
+    EXPECT_EQ(sizes[i], static_cast<size_t>(end - buff));
+    EXPECT_EQ(0xaa, buff[CompressUtil::kMaxVarint32Size]);
+
+    uint32_t val;
+    const uint8_t *read_end = CompressUtil::GetVarint32(buff, &val);
+    EXPECT_EQ(vals[i], val);
+    EXPECT_EQ(end, read_end);
+  }
+}
+
+TEST(CompressUtilTest, BFloat16) {
+  // Exactly representable values survive.
+  const float exact_vals[] = {0.0f, -0.0f, 1.0f, -2.5f, 0.15625f,
+                              std::numeric_limits<float>::infinity(),
+                              -std::numeric_limits<float>::infinity()};
+  for (float val : exact_vals) {
+    float decoded = CompressUtil::BFloat16ToFloat(
+        CompressUtil::FloatToBFloat16(val));
+    EXPECT_EQ(0, memcmp(&val, &decoded, sizeof(float))) << val;
+  }
+  EXPECT_EQ(0x3f80, CompressUtil::FloatToBFloat16(1.0f));
+  EXPECT_EQ(0x8000, CompressUtil::FloatToBFloat16(-0.0f));
+
+  // Round to nearest even.
+  uint32_t bits = 0x3f808000;   // halfway between 0x3f80 and 0x3f81
+  float val;
+  memcpy(&val, &bits, sizeof(float));
+  EXPECT_EQ(0x3f80, CompressUtil::FloatToBFloat16(val));
+  bits = 0x3f818000;            // halfway between 0x3f81 and 0x3f82
+  memcpy(&val, &bits, sizeof(float));
+  EXPECT_EQ(0x3f82, CompressUtil::FloatToBFloat16(val));
+  bits = 0x3f808001;
+  memcpy(&val, &bits, sizeof(float));
+  EXPECT_EQ(0x3f81, CompressUtil::FloatToBFloat16(val));
+
+  // The largest float is above the largest bfloat16 by more than half an
+  // ulp.
+  EXPECT_EQ(0x7f80, CompressUtil::FloatToBFloat16(
+      std::numeric_limits<float>::max()));
+  EXPECT_EQ(0xff80, CompressUtil::FloatToBFloat16(
+      -std::numeric_limits<float>::max()));
+
+  // A NaN whose payload is all in the dropped bits stays a NaN.
+  bits = 0x7f800001;
+  memcpy(&val, &bits, sizeof(float));
+  EXPECT_TRUE(std::isnan(CompressUtil::BFloat16ToFloat(
+      CompressUtil::FloatToBFloat16(val))));
+}
+
+TEST_F(MsgCompressorTest, SparseVarintIds) {
+  SerializedRows rows;
+  rows.AddSparseRow(5, {0, 3, 2, std::numeric_limits<int32_t>::max(), 1},
+                    {1.0f, -2.0f, 0.0f, 3.5f,
+                     std::numeric_limits<float>::max()});
+  // Empty rows and decreasing row ids, so row deltas are negative.
+  rows.AddSparseRow(2, {}, {});
+  rows.AddSparseRow(std::numeric_limits<int32_t>::max(), {7}, {-1.0f});
+  rows.AddSparseRow(0, {}, {});
+
+  size_t encoded_size;
+  std::vector<uint8_t> decoded = RoundTrip(
+      rows.get_mem(), CompressType::kVarintIds, 0, &encoded_size);
+  EXPECT_EQ(rows.get_mem(), decoded);
+  EXPECT_LT(encoded_size, rows.get_mem().size());
+}
+
+TEST_F(MsgCompressorTest, NoRows) {
+  SerializedRows rows;
+  const int32_t compress_types[] = {
+    CompressType::kVarintIds, CompressType::kFloat16,
+    CompressType::kBFloat16,
+    CompressType::kVarintIds | CompressType::kBFloat16};
+  for (int32_t compress_type : compress_types) {
+    size_t encoded_size;
+    EXPECT_EQ(rows.get_mem(),
+              RoundTrip(rows.get_mem(), compress_type, 0, &encoded_size));
+    EXPECT_EQ(1u, encoded_size);
+  }
+}
+
+TEST_F(MsgCompressorTest, SparseFloat16) {
+  // Values float16 represents exactly, including its max and a denormal.
+  std::vector<float> updates = {0.0f, -1.5f, 2.0f, 65504.0f, -65504.0f,
+                                std::ldexp(1.0f, -24)};
+  std::vector<int32_t> col_ids = {1, 2, 3, 4, 5, 6};
+  SerializedRows rows;
+  rows.AddSparseRow(3, col_ids, updates);
+  rows.AddSparseRow(4, {}, {});
+
+  size_t encoded_size;
+  EXPECT_EQ(rows.get_mem(), RoundTrip(
+      rows.get_mem(), CompressType::kVarintIds | CompressType::kFloat16, 0,
+      &encoded_size));
+  // Raw ids, 16-bit values.
+  EXPECT_EQ(rows.get_mem(), RoundTrip(
+      rows.get_mem(), CompressType::kFloat16, 0, &encoded_size));
+}
+
+TEST_F(MsgCompressorTest, DenseBFloat16) {
+  int32_t dense_num_updates = 4;
+  SerializedRows rows;
+  rows.AddDenseRow(0, {0.0f, -0.0f, 1.0f, -2.5f});
+  rows.AddDenseRow(10, {std::numeric_limits<float>::infinity(), 0.15625f,
+                        -std::numeric_limits<float>::infinity(), 3.0f});
+  rows.AddDenseRow(1, {0.0f, 0.0f, 0.0f, 0.0f});
+
+  size_t encoded_size;
+  EXPECT_EQ(rows.get_mem(), RoundTrip(
+      rows.get_mem(), CompressType::kBFloat16, dense_num_updates,
+      &encoded_size));
+  // 1 byte row count, 1 byte per row id delta and 2 bytes per update.
+  EXPECT_EQ(1u + 3*(1 + 2*dense_num_updates), encoded_size);
+}
+
+TEST_F(MsgCompressorTest, BFloat16Rounds) {
+  SerializedRows rows;
+  rows.AddSparseRow(0, {0, 1}, {1.0f + std::ldexp(1.0f, -10), 3.14159f});
+
+  size_t encoded_size;
+  std::vector<uint8_t> decoded = RoundTrip(
+      rows.get_mem(), CompressType::kBFloat16, 0, &encoded_size);
+  // Header, row id, num_updates and ids are kept.
+  size_t header_size = 4*sizeof(int32_t) + sizeof(int32_t);
+  ASSERT_EQ(rows.get_mem().size(), decoded.size());
+  EXPECT_EQ(0, memcmp(rows.get_mem().data(), decoded.data(), header_size));
+  float updates[2];
+  memcpy(updates, decoded.data() + header_size, sizeof(updates));
+  EXPECT_EQ(1.0f, updates[0]);
+  EXPECT_NEAR(3.14159f, updates[1], 3.14159f / 128);
+}
+
+// Rows gathered in buffers are read in place, as OpLogMsgGather leaves
+// them: the row count in the message and whole rows in each buffer.
+TEST_F(MsgCompressorTest, SegmentedRows) {
+  SerializedRows rows;
+  rows.AddSparseRow(5, {0, 3, 2}, {1.0f, -2.0f, 0.5f});
+  rows.AddSparseRow(2, {}, {});
+  rows.AddSparseRow(9, {7}, {-1.0f});
+  const std::vector<uint8_t> &mem = rows.get_mem();
+  size_t row_sizes[] = {5*sizeof(int32_t) + 3*sizeof(float),
+                        2*sizeof(int32_t),
+                        3*sizeof(int32_t) + sizeof(float)};
+
+  // Separate copies, so segments are not contiguous.
+  std::vector<std::vector<uint8_t> > pieces;
+  size_t offset = 0;
+  for (size_t size : {sizeof(int32_t), row_sizes[0], size_t(0),
+                      row_sizes[1] + row_sizes[2]}) {
+    pieces.emplace_back(mem.begin() + offset, mem.begin() + offset + size);
+    offset += size;
+  }
+  ASSERT_EQ(mem.size(), offset);
+  std::vector<MemSegment> segments;
+  for (const auto &piece : pieces)
+    segments.push_back(MemSegment(piece.data(), piece.size()));
+
+  const int32_t compress_types[] = {
+    CompressType::kVarintIds, CompressType::kFloat16,
+    CompressType::kVarintIds | CompressType::kBFloat16};
+  for (int32_t compress_type : compress_types) {
+    std::vector<MemSegment> whole(1, MemSegment(mem.data(), mem.size()));
+    EXPECT_EQ(Encode(whole, mem.size(), compress_type, 0),
+              Encode(segments, mem.size(), compress_type, 0));
+  }
+}
+
+TEST(MemSegmentReaderTest, ValuesSplitAcrossSegments) {
+  const uint8_t bytes[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<MemSegment> segments = {
+    MemSegment(bytes, 3), MemSegment(bytes + 3, 0), MemSegment(bytes + 3, 4),
+    MemSegment(bytes + 7, 2)};
+  MemSegmentReader reader(segments.data(), segments.size());
+
+  uint32_t val = reader.Read<uint32_t>();
+  EXPECT_EQ(0, memcmp(&val, bytes, sizeof(val)));
+  EXPECT_EQ(3u, reader.GetContiguousSize());
+  EXPECT_EQ(bytes + 4, reader.GetPtr());
+  reader.Advance(1);
+  reader.Skip(3);
+  EXPECT_EQ(bytes + 8, reader.GetPtr());
+  EXPECT_EQ(8u, reader.get_num_read());
+  reader.Advance(1);
+  EXPECT_EQ(0u, reader.GetContiguousSize());
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
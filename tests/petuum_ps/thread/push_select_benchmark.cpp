@@ -0,0 +1,98 @@
+// Push preparation latency versus table size: picking the rows to push
+// with a full sort of the candidates, as GetPartialTableToSend used to,
+// against SelectTopK, with and without an ImportanceHistogram threshold
+// pruning the candidates first.
+
+#include <petuum_ps_common/util/top_k.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+#include <glog/logging.h>
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+DEFINE_int32(min_table_size, 10000, "smallest number of rows.");
+DEFINE_int32(max_table_size, 10000000, "largest number of rows.");
+DEFINE_double(push_fraction, 0.01, "fraction of the rows pushed.");
+DEFINE_int32(num_reps, 5, "number of push preparations per table size.");
+
+namespace {
+
+struct Candidate {
+  int32_t row_id;
+  double importance;
+};
+
+bool CompCandidate(const Candidate &c1, const Candidate &c2) {
+  if (c1.importance == c2.importance)
+    return c1.row_id < c2.row_id;
+  return c1.importance > c2.importance;
+}
+
+double TimeFullSort(const std::vector<Candidate> &rows, size_t k) {
+  petuum::HighResolutionTimer timer;
+  std::vector<Candidate> candidates(rows);
+  std::sort(candidates.begin(), candidates.end(), CompCandidate);
+  CHECK_GE(candidates.size(), k);
+  return timer.elapsed();
+}
+
+double TimeTopK(const std::vector<Candidate> &rows, size_t k) {
+  petuum::HighResolutionTimer timer;
+  std::vector<Candidate> candidates(rows);
+  petuum::SelectTopK(&candidates, k, CompCandidate);
+  return timer.elapsed();
+}
+
+double TimeHistogramTopK(const std::vector<Candidate> &rows,
+                         const petuum::ImportanceHistogram &histogram,
+                         size_t k) {
+  petuum::HighResolutionTimer timer;
+  size_t num_rows_above = 0;
+  double threshold = histogram.GetThreshold(k, &num_rows_above);
+  std::vector<Candidate> candidates;
+  candidates.reserve(num_rows_above);
+  for (const auto &row : rows) {
+    if (row.importance >= threshold)
+      candidates.push_back(row);
+  }
+  CHECK_GE(candidates.size(), k);
+  petuum::SelectTopK(&candidates, k, CompCandidate);
+  return timer.elapsed();
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::mt19937 generator(0);
+  // Update magnitudes are heavy tailed.
+  std::lognormal_distribution<double> importance_dist(0, 2);
+
+  for (int64_t table_size = FLAGS_min_table_size;
+       table_size <= FLAGS_max_table_size; table_size *= 10) {
+    std::vector<Candidate> rows(table_size);
+    petuum::ImportanceHistogram histogram;
+    for (int32_t i = 0; i < table_size; ++i) {
+      rows[i].row_id = i;
+      rows[i].importance = importance_dist(generator);
+      histogram.Update(0, rows[i].importance);
+    }
+    size_t k = std::max<size_t>(1, table_size*FLAGS_push_fraction);
+
+    double sort_sec = 0, top_k_sec = 0, histogram_sec = 0;
+    for (int32_t rep = 0; rep < FLAGS_num_reps; ++rep) {
+      sort_sec += TimeFullSort(rows, k);
+      top_k_sec += TimeTopK(rows, k);
+      histogram_sec += TimeHistogramTopK(rows, histogram, k);
+    }
+    LOG(INFO) << "table_size = " << table_size << " k = " << k
+              << " sort: " << sort_sec / FLAGS_num_reps * 1000 << " ms"
+              << " top_k: " << top_k_sec / FLAGS_num_reps * 1000 << " ms"
+              << " histogram + top_k: "
+              << histogram_sec / FLAGS_num_reps * 1000 << " ms";
+  }
+  return 0;
+}
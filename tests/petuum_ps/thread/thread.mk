@@ -11,3 +11,35 @@ run_value_oplog_meta_test: value_oplog_meta_test
 
 clean_value_oplog_meta_test:
 	rm -rf $(TESTS_THREAD_DIR)/value_oplog_meta_test
+
+msg_compressor_test: $(TESTS_THREAD_DIR)/msg_compressor_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_THREAD_DIR)/msg_compressor_test.cpp $(PETUUM_PS_LIB) $(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_THREAD_DIR)/msg_compressor_test
+
+run_msg_compressor_test: msg_compressor_test
+	GLOG_logtostderr=true \
+	$(TESTS_THREAD_DIR)/msg_compressor_test
+
+clean_msg_compressor_test:
+	rm -rf $(TESTS_THREAD_DIR)/msg_compressor_test
+
+push_select_benchmark: $(TESTS_THREAD_DIR)/push_select_benchmark.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_THREAD_DIR)/push_select_benchmark.cpp $(PETUUM_PS_LIB) \
+	$(PETUUM_LDFLAGS) -o $(TESTS_THREAD_DIR)/push_select_benchmark
+
+run_push_select_benchmark: push_select_benchmark
+	GLOG_logtostderr=true \
+	$(TESTS_THREAD_DIR)/push_select_benchmark \
+	--min_table_size 10000 \
+	--max_table_size 10000000 \
+	--push_fraction 0.01
+
+clean_push_select_benchmark:
+	rm -rf $(TESTS_THREAD_DIR)/push_select_benchmark
+
+.PHONY: value_oplog_meta_test run_value_oplog_meta_test \
+clean_value_oplog_meta_test \
+msg_compressor_test run_msg_compressor_test clean_msg_compressor_test \
+push_select_benchmark run_push_select_benchmark clean_push_select_benchmark
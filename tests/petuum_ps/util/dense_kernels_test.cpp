@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps_common/util/dense_kernels.hpp>
+
+#include <stdint.h>
+#include <string.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace petuum;
+
+namespace {
+
+const int32_t kLengths[] = {0, 1, 7, 15, 17, 33};
+const char *kKernelNames[] = {"scalar", "sse2", "avx2"};
+
+// IEEE half to float, independent of the code under test.
+float ReferenceDecompressFloat16(uint16_t half) {
+  int32_t exponent = (half >> 10) & 0x1f;
+  int32_t mantissa = half & 0x3ff;
+  float val;
+  if (exponent == 0) {
+    val = std::ldexp(static_cast<float>(mantissa), -24);
+  } else if (exponent == 0x1f) {
+    val = (mantissa == 0) ? std::numeric_limits<float>::infinity()
+                          : std::numeric_limits<float>::quiet_NaN();
+  } else {
+    val = std::ldexp(static_cast<float>(mantissa + 0x400), exponent - 25);
+  }
+  return (half & 0x8000) ? -val : val;
+}
+
+// Values with every fourth one 0, so that AddGetImportance() takes both the
+// ratio and the zero branch within a vector.
+template<typename V>
+std::vector<V> MakeVals(int32_t num, std::mt19937 *generator) {
+  std::uniform_int_distribution<int32_t> dist(-50, 50);
+  std::vector<V> vals(num);
+  for (int32_t i = 0; i < num; ++i) {
+    vals[i] = (i % 4 == 1) ? V(0) : V(dist(*generator)) / V(4);
+    if (vals[i] == V(0) && i % 4 != 1)
+      vals[i] = V(3);
+  }
+  return vals;
+}
+
+}  // anonymous namespace
+
+class DenseKernelsTest : public ::testing::TestWithParam<const char*> {
+protected:
+  virtual void SetUp() {
+    if (!DenseKernels::SelectKernels(GetParam())) {
+      supported_ = false;
+      return;
+    }
+    supported_ = true;
+    ASSERT_STREQ(GetParam(), DenseKernels::GetKernelName());
+  }
+
+  virtual void TearDown() {
+    DenseKernels::SelectKernels("scalar");
+  }
+
+  template<typename V>
+  void TestAdd() {
+    std::mt19937 generator(0);
+    for (int32_t num : kLengths) {
+      std::vector<V> vals = MakeVals<V>(num, &generator);
+      std::vector<V> updates = MakeVals<V>(num, &generator);
+      std::vector<V> expected = vals;
+      DenseKernels::Add<V>(expected.data(), updates.data(), num);
+      DenseKernels::Add(vals.data(), updates.data(), num);
+      for (int32_t i = 0; i < num; ++i) {
+        EXPECT_EQ(expected[i], vals[i]) << "num = " << num << " i = " << i;
+      }
+    }
+  }
+
+  template<typename V>
+  void TestAddGetImportance() {
+    std::mt19937 generator(1);
+    for (int32_t num : kLengths) {
+      std::vector<V> vals = MakeVals<V>(num, &generator);
+      std::vector<V> updates = MakeVals<V>(num, &generator);
+      std::vector<V> expected = vals;
+      double expected_importance = DenseKernels::AddGetImportance<V>(
+          expected.data(), updates.data(), num);
+      double importance = DenseKernels::AddGetImportance(
+          vals.data(), updates.data(), num);
+      EXPECT_NEAR(expected_importance, importance,
+                  1e-9*(1 + std::abs(expected_importance)))
+          << "num = " << num;
+      for (int32_t i = 0; i < num; ++i) {
+        EXPECT_EQ(expected[i], vals[i]) << "num = " << num << " i = " << i;
+      }
+    }
+  }
+
+  bool supported_;
+};
+
+TEST_P(DenseKernelsTest, Add) {
+  if (!supported_)
+    return;
+  TestAdd<float>();
+  TestAdd<double>();
+  TestAdd<int32_t>();
+}
+
+TEST_P(DenseKernelsTest, AddGetImportance) {
+  if (!supported_)
+    return;
+  TestAddGetImportance<float>();
+  TestAddGetImportance<double>();
+  TestAddGetImportance<int32_t>();
+}
+
+TEST_P(DenseKernelsTest, AddGetImportanceAllZeroVals) {
+  if (!supported_)
+    return;
+  // Importance of an update to a 0 value is |update|.
+  for (int32_t num : kLengths) {
+    std::vector<float> vals(num, 0);
+    std::vector<float> updates(num);
+    double expected_importance = 0;
+    for (int32_t i = 0; i < num; ++i) {
+      updates[i] = (i % 2 == 0) ? i + 1 : -(i + 1);
+      expected_importance += i + 1;
+    }
+    double importance = DenseKernels::AddGetImportance(
+        vals.data(), updates.data(), num);
+    EXPECT_DOUBLE_EQ(expected_importance, importance) << "num = " << num;
+    for (int32_t i = 0; i < num; ++i) {
+      EXPECT_EQ(updates[i], vals[i]);
+    }
+  }
+}
+
+TEST_P(DenseKernelsTest, DecompressFloat16) {
+  if (!supported_)
+    return;
+  // All half values: zeros, denormals, normals, infinities and NaNs.
+  std::vector<uint16_t> halves(1 << 16);
+  for (size_t i = 0; i < halves.size(); ++i)
+    halves[i] = i;
+
+  for (int32_t num : kLengths) {
+    std::vector<float> floats(num);
+    DenseKernels::DecompressFloat16(floats.data(), halves.data() + 1, num);
+    for (int32_t i = 0; i < num; ++i) {
+      EXPECT_EQ(ReferenceDecompressFloat16(i + 1), floats[i]);
+    }
+  }
+
+  std::vector<float> floats(halves.size());
+  DenseKernels::DecompressFloat16(floats.data(), halves.data(),
+                                  halves.size());
+  for (size_t i = 0; i < halves.size(); ++i) {
+    float expected = ReferenceDecompressFloat16(halves[i]);
+    if (std::isnan(expected)) {
+      EXPECT_TRUE(std::isnan(floats[i])) << "half = " << halves[i];
+    } else {
+      // Bitwise, so that -0 and 0 are told apart.
+      EXPECT_EQ(0, memcmp(&expected, &floats[i], sizeof(float)))
+          << "half = " << halves[i] << " expected " << expected
+          << " got " << floats[i];
+    }
+  }
+  EXPECT_EQ(std::ldexp(1.0f, -24), floats[0x0001]);   // smallest denormal
+  EXPECT_EQ(std::ldexp(1023.0f, -24), floats[0x03ff]);   // largest denormal
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), floats[0x7c00]);
+  EXPECT_EQ(-std::numeric_limits<float>::infinity(), floats[0xfc00]);
+  EXPECT_EQ(65504.0f, floats[0x7bff]);
+}
+
+INSTANTIATE_TEST_CASE_P(AllKernels, DenseKernelsTest,
+                        ::testing::ValuesIn(kKernelNames));
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -51,3 +51,17 @@ $(TESTS_BIN)/stats_test: $(UTIL_TESTS_DIR)/stats_test.cpp \
 
 stats_test_run: $(TESTS_BIN)/stats_test
 	$<
+
+dense_kernels_test: $(UTIL_TESTS_DIR)/dense_kernels_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(UTIL_TESTS_DIR)/dense_kernels_test.cpp $(PETUUM_PS_LIB) $(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(UTIL_TESTS_DIR)/dense_kernels_test
+
+run_dense_kernels_test: dense_kernels_test
+	GLOG_logtostderr=true \
+	$(UTIL_TESTS_DIR)/dense_kernels_test
+
+clean_dense_kernels_test:
+	rm -rf $(UTIL_TESTS_DIR)/dense_kernels_test
+
+.PHONY: dense_kernels_test run_dense_kernels_test clean_dense_kernels_test
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <petuum_ps_sn/storage/ooc_store.hpp>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace petuum {
+
+namespace {
+
+std::string MakeValue(int32_t row_id, int32_t generation = 0) {
+  return std::string(row_id % 97 + 1, static_cast<char>('a' + row_id % 26))
+      + std::to_string(row_id) + "." + std::to_string(generation);
+}
+
+}  // anonymous namespace
+
+class OOCStoreTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    char dir_template[] = "/tmp/ooc_store_test.XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir_template) != 0);
+    dir_ = dir_template;
+    db_path_ = dir_ + "/db";
+  }
+
+  virtual void TearDown() {
+    store_.reset();
+    leveldb::DestroyDB(db_path_, leveldb::Options());
+    rmdir(dir_.c_str());
+  }
+
+  void CreateStore(int32_t num_io_threads, size_t num_write_batch) {
+    store_.reset(new OOCStore(db_path_, num_io_threads, num_write_batch));
+  }
+
+  void Put(int32_t row_id, int32_t generation = 0) {
+    std::string value = MakeValue(row_id, generation);
+    store_->Put(row_id, &value);
+    EXPECT_TRUE(value.empty());
+  }
+
+  void ExpectTake(int32_t row_id, int32_t generation = 0) {
+    std::string value;
+    ASSERT_TRUE(store_->Take(row_id, &value)) << row_id;
+    EXPECT_EQ(MakeValue(row_id, generation), value);
+    EXPECT_FALSE(store_->Contains(row_id));
+  }
+
+  // Keeps the I/O threads from starting another write, as if the disk
+  // were stuck on one.
+  void StallWriter() {
+    std::unique_lock<std::mutex> lock(store_->mtx_);
+    while (store_->write_in_progress_)
+      store_->done_cv_.wait(lock);
+    store_->write_in_progress_ = true;
+  }
+
+  void ResumeWriter() {
+    std::unique_lock<std::mutex> lock(store_->mtx_);
+    store_->write_in_progress_ = false;
+    store_->io_cv_.notify_all();
+  }
+
+  size_t GetNumQueuedBatches() {
+    std::unique_lock<std::mutex> lock(store_->mtx_);
+    return store_->write_queue_.size();
+  }
+
+  std::string dir_;
+  std::string db_path_;
+  std::unique_ptr<OOCStore> store_;
+};
+
+TEST_F(OOCStoreTest, PutTake) {
+  CreateStore(2, 4);
+  std::string value;
+  EXPECT_FALSE(store_->Contains(0));
+  EXPECT_FALSE(store_->Take(0, &value));
+
+  // Buffered.
+  Put(0);
+  EXPECT_TRUE(store_->Contains(0));
+  ExpectTake(0);
+  EXPECT_FALSE(store_->Take(0, &value));
+
+  // Buffered, queued or being written, whichever the I/O threads got to.
+  for (int32_t row_id = 0; row_id < 64; ++row_id) {
+    Put(row_id);
+  }
+  for (int32_t row_id = 63; row_id >= 0; --row_id) {
+    ExpectTake(row_id);
+  }
+
+  // On disk.
+  for (int32_t row_id = 0; row_id < 10; ++row_id) {
+    Put(row_id);
+  }
+  store_->Flush();
+  for (int32_t row_id = 0; row_id < 10; ++row_id) {
+    EXPECT_TRUE(store_->Contains(row_id));
+    ExpectTake(row_id);
+  }
+}
+
+// A row put again after it was taken comes back with its latest value,
+// though the disk still holds the old one for a while.
+TEST_F(OOCStoreTest, PutTakeSameRow) {
+  CreateStore(2, 1);
+  for (int32_t generation = 0; generation < 20; ++generation) {
+    Put(7, generation);
+    if (generation % 2 == 0)
+      store_->Flush();
+    ExpectTake(7, generation);
+  }
+
+  // Rewritten while older batches with the row may still be in the queue.
+  for (int32_t generation = 0; generation < 20; ++generation) {
+    Put(7, generation);
+    ExpectTake(7, generation);
+  }
+  Put(7, 100);
+  store_->Flush();
+  store_->Prefetch(7);
+  store_->WaitPrefetch();
+  ExpectTake(7, 100);
+}
+
+TEST_F(OOCStoreTest, Prefetch) {
+  CreateStore(2, 4);
+  // Not in the store, or buffered: nothing to read.
+  store_->Prefetch(0);
+  Put(1);
+  store_->Prefetch(1);
+  store_->WaitPrefetch();
+  ExpectTake(1);
+
+  for (int32_t row_id = 0; row_id < 32; ++row_id) {
+    Put(row_id);
+  }
+  store_->Flush();
+  for (int32_t row_id = 0; row_id < 32; ++row_id) {
+    store_->Prefetch(row_id);
+    // Prefetching twice reads once.
+    store_->Prefetch(row_id);
+  }
+  store_->WaitPrefetch();
+  for (int32_t row_id = 0; row_id < 32; ++row_id) {
+    ExpectTake(row_id);
+  }
+}
+
+// Take() of a row whose read is in flight waits for it.
+TEST_F(OOCStoreTest, PrefetchRacesTake) {
+  const int32_t kNumRows = 256;
+  CreateStore(4, 8);
+  for (int32_t row_id = 0; row_id < kNumRows; ++row_id) {
+    Put(row_id);
+  }
+  store_->Flush();
+
+  std::thread prefetcher([this]() {
+      for (int32_t row_id = 0; row_id < kNumRows; ++row_id) {
+        store_->Prefetch(row_id);
+      }
+    });
+  // Half in the order they are prefetched, half against it.
+  for (int32_t i = 0; i < kNumRows / 2; ++i) {
+    ExpectTake(i);
+    ExpectTake(kNumRows - 1 - i);
+  }
+  prefetcher.join();
+  store_->WaitPrefetch();
+
+  // Prefetched right before the Take().
+  for (int32_t row_id = 0; row_id < kNumRows; ++row_id) {
+    Put(row_id, 1);
+  }
+  store_->Flush();
+  for (int32_t row_id = 0; row_id < kNumRows; ++row_id) {
+    store_->Prefetch(row_id);
+    ExpectTake(row_id, 1);
+  }
+  store_->WaitPrefetch();
+}
+
+// Put() waits while the write queue is full and resumes once the I/O
+// threads drain it.
+TEST_F(OOCStoreTest, PutBlocksOnFullWriteQueue) {
+  const size_t kNumWriteBatch = 2;
+  const int32_t kNumQueuedRows = OOCStore::kMaxQueuedBatches*kNumWriteBatch;
+  CreateStore(2, kNumWriteBatch);
+  StallWriter();
+  for (int32_t row_id = 0; row_id < kNumQueuedRows; ++row_id) {
+    Put(row_id);
+  }
+  EXPECT_EQ(OOCStore::kMaxQueuedBatches, GetNumQueuedBatches());
+
+  std::atomic<bool> put_done(false);
+  std::thread putter([this, &put_done, kNumQueuedRows]() {
+      Put(kNumQueuedRows);
+      put_done = true;
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(put_done);
+  EXPECT_EQ(OOCStore::kMaxQueuedBatches, GetNumQueuedBatches());
+
+  ResumeWriter();
+  putter.join();
+  EXPECT_TRUE(put_done);
+  store_->Flush();
+  EXPECT_EQ(0u, GetNumQueuedBatches());
+  for (int32_t row_id = 0; row_id <= kNumQueuedRows; ++row_id) {
+    ExpectTake(row_id);
+  }
+}
+
+// Rows not written yet are dropped at shutdown, the batch being written is
+// finished and reads in flight are waited for.
+TEST_F(OOCStoreTest, ShutDownWithPendingWrites) {
+  for (int32_t round = 0; round < 20; ++round) {
+    CreateStore(3, 2);
+    for (int32_t row_id = 0; row_id < 16; ++row_id) {
+      Put(row_id);
+    }
+    if (round % 2 == 0) {
+      store_->Flush();
+      for (int32_t row_id = 0; row_id < 16; ++row_id) {
+        store_->Prefetch(row_id);
+      }
+      for (int32_t row_id = 16; row_id < 64; ++row_id) {
+        Put(row_id);
+      }
+    }
+    store_.reset();
+    leveldb::DestroyDB(db_path_, leveldb::Options());
+  }
+
+  // Flushed rows are all there before shutdown.
+  CreateStore(1, 3);
+  for (int32_t row_id = 0; row_id < 10; ++row_id) {
+    Put(row_id);
+  }
+  store_->Flush();
+  store_->Flush();
+  for (int32_t row_id = 0; row_id < 10; ++row_id) {
+    ExpectTake(row_id);
+  }
+}
+
+}  // namespace petuum
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
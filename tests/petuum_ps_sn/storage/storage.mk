@@ -0,0 +1,16 @@
+TESTS_SN_STORAGE_DIR=$(TESTS)/petuum_ps_sn/storage
+
+ooc_store_test: $(TESTS_SN_STORAGE_DIR)/ooc_store_test.cpp
+	$(PETUUM_CXX) $(PETUUM_CXXFLAGS) $(PETUUM_INCFLAGS) \
+	$(TESTS_SN_STORAGE_DIR)/ooc_store_test.cpp $(PETUUM_PS_SN_LIB) \
+	$(PETUUM_LDFLAGS) \
+	-lgtest_main -o $(TESTS_SN_STORAGE_DIR)/ooc_store_test
+
+run_ooc_store_test: ooc_store_test
+	GLOG_logtostderr=true \
+	$(TESTS_SN_STORAGE_DIR)/ooc_store_test
+
+clean_ooc_store_test:
+	rm -rf $(TESTS_SN_STORAGE_DIR)/ooc_store_test
+
+.PHONY: ooc_store_test run_ooc_store_test clean_ooc_store_test
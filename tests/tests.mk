@@ -7,9 +7,14 @@ include $(TESTS)/petuum_ps/thread/thread.mk
 include $(TESTS)/petuum_ps/independent/independent.mk
 include $(TESTS)/petuum_ps/oplog/oplog.mk
 include $(TESTS)/petuum_ps/storage/storage.mk
+include $(TESTS)/petuum_ps/server/server.mk
+include $(TESTS)/petuum_ps/client/client.mk
+include $(TESTS)/petuum_ps/comm_bus/comm_bus.mk
+include $(TESTS)/petuum_ps_sn/storage/storage.mk
 include $(TESTS)/ml/feature/feature.mk
 include $(TESTS)/ml/util/util.mk
 include $(TESTS)/ml/disk_stream/disk_stream.mk
+include $(TESTS)/ml/parsers/parsers.mk
 include $(TESTS)/ml/ml.mk
 include $(TESTS)/third_party/cuckoo_perf/cuckoo_perf.mk
 include $(TESTS)/third_party/cuckoo_map/cuckoo_map.mk